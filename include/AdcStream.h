@@ -0,0 +1,70 @@
+// ================== CONTINUOUS ADC ==================
+// Two ADC1 channels converted back to back by the ADC's digital
+// controller and moved to memory by DMA (IDF 4.4 adc_digi_* driver),
+// instead of one analogRead() per value.
+//
+// read() drains everything converted since the previous call, converts
+// each raw code to millivolts through a table built once from the chip's
+// eFuse calibration, and returns the mean per channel. The hardware rate
+// over the read() rate is the oversampling ratio: 20 kHz shared by two
+// channels and read at 50 Hz averages ~200 conversions per value.
+//
+// When the continuous driver cannot be set up, read() falls back to
+// analogReadMilliVolts(), which applies the same calibration per call.
+
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include <Arduino.h>
+
+#define ADC_STREAM_HZ      20000   // Conversions/s over both channels; ESP32 minimum
+#define ADC_STREAM_POOL    2048    // Driver ring buffer, bytes
+#define ADC_STREAM_FRAME   256     // Bytes per DMA interrupt / read chunk
+
+class AdcStream {
+ public:
+  AdcStream();
+
+  // Both pins must be ADC1 inputs (GPIO 32-39)
+  bool begin(uint8_t pinA, uint8_t pinB, uint32_t sampleHz = ADC_STREAM_HZ);
+
+  // Mean of the conversions since the last call, in mV. Returns false and
+  // leaves the outputs alone if nothing new was converted.
+  bool read(uint16_t &mvA, uint16_t &mvB);
+
+  bool continuous() const { return _continuous; }
+  const char *calibrationName() const { return _calName; }
+
+  // Per-batch cost of read(): conversion, calibration and averaging
+  uint32_t batches() const { return _batches; }
+  uint32_t samples() const { return _samples; }
+  uint32_t overflows() const { return _overflows; }
+  uint32_t lastBatchUs() const { return _lastBatchUs; }
+  uint32_t lastBatchSamples() const { return _lastBatchSamples; }
+  uint32_t nsPerSample() const {
+    return _samples ? (uint32_t)(_busyUs * 1000ULL / _samples) : 0;
+  }
+
+ private:
+  bool readContinuous(uint32_t &sumA, uint32_t &nA,
+                      uint32_t &sumB, uint32_t &nB);
+
+  uint8_t _pinA;
+  uint8_t _pinB;
+  int8_t _chA;
+  int8_t _chB;
+  bool _continuous;
+  const char *_calName;
+
+  uint8_t _frame[ADC_STREAM_FRAME];
+  uint16_t _mvLut[4096];          // Raw 12-bit code -> calibrated mV
+
+  uint32_t _batches;
+  uint32_t _samples;
+  uint32_t _overflows;
+  uint64_t _busyUs;
+  uint32_t _lastBatchUs;
+  uint32_t _lastBatchSamples;
+};
+
+#endif
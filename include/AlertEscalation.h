@@ -0,0 +1,98 @@
+// ================== ALERT ESCALATION ==================
+// Call ladder for an active alert: each contact is called up to
+// maxAttempts times in order until somebody answers.
+//
+// The machine is driven by call progress events (from +CLCC,
+// VOICE CALL: BEGIN, NO CARRIER ... URCs) and by tick(now) for timers,
+// instead of polling AT+CLCC. All times are passed in, so the same code
+// runs against millis() on the device and a virtual clock elsewhere.
+
+#ifndef ALERT_ESCALATION_H
+#define ALERT_ESCALATION_H
+
+#include <stdint.h>
+
+enum EscalationState {
+  ESC_IDLE,          // No alert
+  ESC_WAIT_RETRY,    // Alert active, waiting before the next dial
+  ESC_DIALING,       // ATD sent, no ringing indication yet
+  ESC_RINGING,       // Remote phone is ringing
+  ESC_CONNECTED,     // Answered, holding the line briefly
+  ESC_ACKNOWLEDGED   // Someone answered, quiet until cooldown ends
+};
+
+enum CallEvent {
+  CALL_EVT_DIAL_OK,      // ATD accepted
+  CALL_EVT_DIAL_FAILED,  // ATD rejected / not sent
+  CALL_EVT_RINGING,      // +CLCC stat 3 (alerting)
+  CALL_EVT_ANSWERED,     // +CLCC stat 0, VOICE CALL: BEGIN
+  CALL_EVT_ENDED         // NO CARRIER, BUSY, +CLCC stat 6, VOICE CALL: END
+};
+
+struct EscalationConfig {
+  uint8_t maxAttempts;          // Calls per contact before moving on
+  unsigned long retryDelay;     // Gap between two dial attempts
+  unsigned long setupTimeout;   // Dial -> ringing indication
+  unsigned long callTimeout;    // Dial -> answer
+  unsigned long answerHold;     // Keep an answered call up this long
+  unsigned long cooldown;       // Quiet period after acknowledgement
+};
+
+struct EscalationActions {
+  // Start a call to contact (0-based); attempt is 1-based.
+  // Return false if the call could not be started.
+  bool (*dial)(uint8_t contact, uint8_t attempt);
+  void (*hangup)();
+  void (*stateChanged)(EscalationState from, EscalationState to,
+                       unsigned long now);
+};
+
+class AlertEscalation {
+ public:
+  AlertEscalation();
+
+  void begin(const EscalationConfig &config, const EscalationActions &actions);
+
+  // Alert condition and number of callable contacts, from the sensor path
+  void setAlert(bool active, uint8_t contacts, unsigned long now);
+
+  void onCallEvent(CallEvent event, unsigned long now);
+
+  // Advance timers; call as often as possible
+  void tick(unsigned long now);
+
+  EscalationState state() const { return _state; }
+  uint8_t contact() const { return _contact; }
+  uint8_t attempt() const { return _attempt; }
+  uint16_t totalAttempts() const { return _totalAttempts; }
+  bool alertActive() const { return _alert; }
+  unsigned long stateSince() const { return _since; }
+
+ private:
+  void enter(EscalationState next, unsigned long now);
+  void startAttempt(unsigned long now);
+  void attemptFailed(unsigned long now);
+  bool inCall() const;
+
+  EscalationConfig _config;
+  EscalationActions _actions;
+
+  EscalationState _state;
+  bool _alert;
+  uint8_t _contacts;
+  uint8_t _contact;
+  uint8_t _attempt;
+  uint16_t _totalAttempts;
+  unsigned long _since;
+  unsigned long _dialedAt;
+  unsigned long _nextDialAt;
+};
+
+const char *escalationStateName(EscalationState state);
+
+// Map a "+CLCC: <id>,<dir>,<stat>,..." report to a call event. Stat 2
+// (dialing) means the network has not reached the callee yet and gives no
+// event, like the held / incoming / waiting states.
+bool clccCallEvent(const char *line, CallEvent &event);
+
+#endif
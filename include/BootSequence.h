@@ -0,0 +1,78 @@
+// ================== STAGED BOOT ==================
+// Slow start-up work (display splash, WiFi AP, modem power-up and
+// registration) runs as background stages, each in its own FreeRTOS
+// task, so setup() can return and sampling / alarms run right away.
+//
+// A stage starts once all stages it depends on have finished. Stage
+// start and finish times, and milestones such as the first reading, are
+// logged in ms since power-up so boot-to-reading and boot-to-modem-ready
+// can be compared between builds.
+
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+#include <freertos/event_groups.h>
+
+#define BOOT_MAX_STAGES     8
+#define BOOT_MAX_MILESTONES 4
+
+typedef void (*BootStageFn)();
+
+class BootSequence {
+ public:
+  BootSequence();
+
+  // Stage ids are bit numbers; dependencies are a mask of BOOT_BIT(id).
+  // Returns the id, or -1 when full. Call before start().
+  int add(const char *name, BootStageFn fn, uint32_t dependsOn = 0,
+          uint32_t stackSize = 4096, BaseType_t core = tskNO_AFFINITY);
+
+  // Spawn all stage tasks
+  bool start();
+
+  bool done(int id) const;
+  bool allDone() const;
+
+  // Block the caller until the stage has finished
+  bool wait(int id, uint32_t timeoutMs = portMAX_DELAY);
+
+  // Log a named point in time, once per name
+  void milestone(const char *name);
+
+  // Stage and milestone timeline
+  void printReport() const;
+
+ private:
+  struct Stage {
+    BootSequence *owner;
+    uint8_t id;
+    const char *name;
+    BootStageFn fn;
+    uint32_t dependsOn;
+    uint32_t stackSize;
+    BaseType_t core;
+    uint32_t startMs;
+    uint32_t endMs;
+  };
+
+  struct Milestone {
+    const char *name;
+    uint32_t atMs;
+  };
+
+  static void stageEntry(void *arg);
+  void runStage(uint8_t id);
+
+  Stage _stages[BOOT_MAX_STAGES];
+  uint8_t _count;
+  EventGroupHandle_t _events;
+
+  Milestone _milestones[BOOT_MAX_MILESTONES];
+  uint8_t _milestoneCount;
+  portMUX_TYPE _mux;
+};
+
+#define BOOT_BIT(id) (1UL << (id))
+
+#endif
@@ -0,0 +1,58 @@
+// ================== CHUNKED RESPONSE ==================
+// Streams a WebServer response of unknown length through one fixed
+// buffer, so an export costs the same memory for ten rows or ten
+// thousand.
+//
+// begin() sends the headers with CONTENT_LENGTH_UNKNOWN, which makes the
+// server use chunked transfer encoding. print()/printf() append to the
+// buffer; every time it fills, it goes out as one chunk. end() sends the
+// rest and the terminating empty chunk. Once the client has gone away
+// ok() turns false and further output is discarded, so a producer can
+// stop early.
+//
+// The server has one task and serves one connection at a time, so every
+// other request (/job polls included) waits for an export to finish. A
+// client that takes longer than CHUNKED_STALL_MS to accept one chunk,
+// i.e. reads slower than about 1 KB/s or not at all, is disconnected to
+// bound that wait.
+
+#ifndef CHUNKED_RESPONSE_H
+#define CHUNKED_RESPONSE_H
+
+#include <Arduino.h>
+#include <WebServer.h>
+
+#define CHUNKED_BUFFER_SIZE 1024
+#define CHUNKED_STALL_MS    1000    // Longest accepted write of one chunk
+
+class ChunkedResponse {
+ public:
+  explicit ChunkedResponse(WebServer &server);
+
+  void begin(int code, const char *contentType);
+  void print(const char *text);
+  void printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+  void end();
+
+  bool ok() const { return _ok; }
+  bool stalled() const { return _stalled; }   // Dropped as too slow
+
+  uint32_t bytes() const { return _bytes; }
+  uint16_t chunks() const { return _chunks; }
+  uint32_t lowestHeap() const { return _lowestHeap; }  // Seen at a flush
+
+ private:
+  void write(const char *data, size_t len);
+  void flush();
+
+  WebServer &_server;
+  char _buf[CHUNKED_BUFFER_SIZE];
+  size_t _len;
+  bool _ok;
+  bool _stalled;
+  uint32_t _bytes;
+  uint16_t _chunks;
+  uint32_t _lowestHeap;
+};
+
+#endif
@@ -0,0 +1,85 @@
+// ================== SPI TRAFFIC COUNTER ==================
+// Adafruit_ST7789 that counts what every drawing primitive pushes to the
+// panel. All GFX drawing ends up in one of the overridden virtual entry
+// points, so pixels * 2 bytes (RGB565) plus the address window setup per
+// call is a close estimate of the SPI payload.
+
+#ifndef COUNTING_TFT_H
+#define COUNTING_TFT_H
+
+#include <Adafruit_ST7789.h>
+
+// CASET + RASET + RAMWR with their parameters
+#define TFT_WINDOW_OVERHEAD 11
+
+class CountingST7789 : public Adafruit_ST7789 {
+ public:
+  CountingST7789(int8_t cs, int8_t dc, int8_t rst)
+    : Adafruit_ST7789(cs, dc, rst), _pixels(0), _bytes(0) {}
+
+  uint32_t pixelsWritten() const { return _pixels; }
+  uint32_t bytesWritten() const { return _bytes; }
+  void resetCounters() { _pixels = 0; _bytes = 0; }
+
+  // Bulk writePixels() is not virtual; callers pushing a buffer count it here
+  void countBlit(int16_t w, int16_t h) { count(w, h); }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    count(1, 1);
+    Adafruit_ST7789::drawPixel(x, y, color);
+  }
+
+  void writePixel(int16_t x, int16_t y, uint16_t color) override {
+    count(1, 1);
+    Adafruit_ST7789::writePixel(x, y, color);
+  }
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                uint16_t color) override {
+    count(w, h);
+    Adafruit_ST7789::fillRect(x, y, w, h, color);
+  }
+
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                     uint16_t color) override {
+    count(w, h);
+    Adafruit_ST7789::writeFillRect(x, y, w, h, color);
+  }
+
+  void drawFastHLine(int16_t x, int16_t y, int16_t w,
+                     uint16_t color) override {
+    count(w, 1);
+    Adafruit_ST7789::drawFastHLine(x, y, w, color);
+  }
+
+  void drawFastVLine(int16_t x, int16_t y, int16_t h,
+                     uint16_t color) override {
+    count(1, h);
+    Adafruit_ST7789::drawFastVLine(x, y, h, color);
+  }
+
+  void writeFastHLine(int16_t x, int16_t y, int16_t w,
+                      uint16_t color) override {
+    count(w, 1);
+    Adafruit_ST7789::writeFastHLine(x, y, w, color);
+  }
+
+  void writeFastVLine(int16_t x, int16_t y, int16_t h,
+                      uint16_t color) override {
+    count(1, h);
+    Adafruit_ST7789::writeFastVLine(x, y, h, color);
+  }
+
+ private:
+  void count(int16_t w, int16_t h) {
+    if (w <= 0 || h <= 0) return;
+    uint32_t px = (uint32_t)w * (uint32_t)h;
+    _pixels += px;
+    _bytes += px * 2 + TFT_WINDOW_OVERHEAD;
+  }
+
+  uint32_t _pixels;
+  uint32_t _bytes;
+};
+
+#endif
@@ -0,0 +1,169 @@
+// ================== RETAINED DASHBOARD ==================
+// Keeps what was last drawn on the 240x240 dashboard and only redraws the
+// parts of a new frame that changed:
+//  - card frame (background, border, label, unit) when its alert state flips
+//  - value text, drawn opaque over the old one, trimming leftover columns
+//  - header indicator dot when its colour changes
+//  - status bar when its text, colours or decoration change
+// The first frame after invalidate() is drawn in full.
+//
+// With DISPLAY_FRAMEBUFFER defined, changed regions are composed as whole
+// tiles (header, card, status bar) in off-screen GFXcanvas16 buffers and
+// pushed by a flush task in one address window + bulk pixel transfer per
+// tile, so render() returns while the SPI transfer is still running.
+
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <Adafruit_GFX.h>
+#include "CountingTFT.h"
+
+#define DASH_CARDS 4
+
+// Frame time histogram bucket upper bounds in ms; last bucket is open
+#define FRAME_HIST_BUCKETS 8
+
+struct CardView {
+  const char *label;
+  String value;
+  const char *unit;
+  uint16_t valueColor;
+  bool alert;
+};
+
+enum StatusDecor {
+  DECOR_OK,       // Small green dots
+  DECOR_ALERT,    // Yellow triangles
+  DECOR_FIRE      // Yellow dots
+};
+
+enum CallIndicator {
+  CALL_DOTS_NONE,
+  CALL_DOTS_ACTIVE,     // Dialing / ringing
+  CALL_DOTS_CONNECTED
+};
+
+struct StatusView {
+  const char *text;
+  uint16_t bgColor;
+  uint16_t textColor;
+  StatusDecor decor;
+  CallIndicator callDots;
+};
+
+struct DashboardView {
+  CardView cards[DASH_CARDS];
+  uint16_t indicatorColor;
+  StatusView status;
+};
+
+struct FrameHistogram {
+  uint32_t counts[FRAME_HIST_BUCKETS];
+  uint32_t frames;
+  uint32_t maxUs;
+  uint64_t totalUs;
+
+  void add(uint32_t us);
+  void print(const char *name) const;
+  void reset();
+};
+
+class Dashboard {
+ public:
+  explicit Dashboard(CountingST7789 &tft);
+
+  // Allocates tile buffers and starts the flush task in framebuffer builds
+  void begin();
+
+  // Forget the screen contents (e.g. after a splash screen)
+  void invalidate() { _valid = false; }
+
+  void render(const DashboardView &view);
+
+  // Regions redrawn by the last render()
+  uint8_t lastRegions() const { return _lastRegions; }
+  bool lastWasFull() const { return _lastFull; }
+
+  // Time render() blocked the caller / until the frame was on the panel.
+  // The flush task adds to the frame histogram, so it is returned as a copy
+  const FrameHistogram &cpuHistogram() const { return _cpuHist; }
+  FrameHistogram frameHistogram() const;
+  void printHistograms();
+
+ private:
+  struct CardCache {
+    bool drawn;
+    bool alert;
+    String value;
+    uint16_t valueColor;
+    int16_t boxX;
+    uint16_t boxW;
+  };
+
+  struct StatusCache {
+    bool drawn;
+    String text;
+    uint16_t bgColor;
+    uint16_t textColor;
+    StatusDecor decor;
+    CallIndicator callDots;
+  };
+
+  void drawChrome();
+  void drawHeader(Adafruit_GFX &g, int16_t ox, int16_t oy);
+  void drawIndicator(Adafruit_GFX &g, int16_t ox, int16_t oy, uint16_t color);
+  void drawCardFrame(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                     uint8_t i, const CardView &card);
+  void drawCardValue(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                     uint8_t i, const CardView &card, bool frameRedrawn);
+  void drawStatus(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                  const StatusView &status);
+
+  void renderDirect(const DashboardView &view);
+  void addFrameTime(uint32_t us);
+
+  bool statusChanged(const StatusView &status) const;
+  void rememberStatus(const StatusView &status);
+
+  CountingST7789 &_tft;
+  bool _valid;
+  CardCache _cards[DASH_CARDS];
+  uint16_t _indicatorColor;
+  StatusCache _status;
+
+  uint8_t _lastRegions;
+  bool _lastFull;
+
+  FrameHistogram _cpuHist;
+  FrameHistogram _frameHist;      // Guarded by _histMux
+  mutable portMUX_TYPE _histMux;
+
+#ifdef DISPLAY_FRAMEBUFFER
+  enum { TILE_HEADER, TILE_CARD_A, TILE_CARD_B, TILE_STATUS, TILE_COUNT };
+
+  struct FlushJob {
+    uint8_t tile;            // TILE_COUNT marks the end of a frame
+    int16_t x;
+    int16_t y;
+    uint32_t frameStartUs;
+  };
+
+  static void flushTaskEntry(void *arg);
+  void flushTile(const FlushJob &job);
+  GFXcanvas16 *acquire(uint8_t tile);
+  void submit(uint8_t tile, int16_t x, int16_t y, uint32_t frameStartUs = 0);
+  void waitFlushIdle();
+  void renderTiles(const DashboardView &view, uint32_t frameStartUs);
+
+  GFXcanvas16 *_tiles[TILE_COUNT];
+  uint8_t _nextCardTile;          // Card tiles ping-pong so composing overlaps flushing
+
+  QueueHandle_t _flushQueue;
+  TaskHandle_t _flushTask;
+  uint32_t _tileSeq[TILE_COUNT];  // Job sequence number of each tile's last submit
+  uint32_t _submittedSeq;
+  volatile uint32_t _flushedSeq;
+#endif
+};
+
+#endif
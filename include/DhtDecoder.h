@@ -0,0 +1,46 @@
+// ================== DHT FRAME DECODER ==================
+// Turns the captured pulse train of one DHT11/DHT22 transaction into
+// temperature and humidity. No hardware access, so it can be fed from
+// recorded timings as well as from the RMT capture in DhtRmt.
+//
+// After the host releases the line the sensor answers low 80 us / high
+// 80 us, then sends 40 bits MSB first, each a ~50 us low followed by a
+// high of 26-28 us (0) or ~70 us (1), and ends with a ~50 us low.
+
+#ifndef DHT_DECODER_H
+#define DHT_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DHT_FRAME_BITS        40
+#define DHT_BIT_THRESHOLD_US  48    // High longer than this is a 1
+
+enum DhtModel {
+  DHT_MODEL_11,
+  DHT_MODEL_22
+};
+
+enum DhtStatus {
+  DHT_OK,
+  DHT_NO_RESPONSE,    // Nothing captured / line never went low
+  DHT_FRAME_ERROR,    // Fewer than 40 bits or levels out of order
+  DHT_CHECKSUM_ERROR,
+  DHT_BUSY            // Driver not started or capture not possible
+};
+
+struct DhtPulse {
+  uint8_t level;      // 0 low, 1 high
+  uint16_t us;
+};
+
+// Decode the frame bytes; data[4] is the checksum
+DhtStatus dhtDecode(const DhtPulse *pulses, size_t count, uint8_t data[5]);
+
+// Frame bytes to degrees C and %RH
+void dhtConvert(DhtModel model, const uint8_t data[5],
+                float &temperature, float &humidity);
+
+const char *dhtStatusName(DhtStatus status);
+
+#endif
@@ -0,0 +1,63 @@
+// ================== DHT OVER RMT ==================
+// DHT11/DHT22 reader that captures the sensor's pulse train with the RMT
+// peripheral instead of bit-banging it with interrupts disabled.
+//
+// read() holds the line low for the start signal (sleeping, not busy
+// waiting), releases it and arms an RMT receive channel in one short
+// critical section, then sleeps until the driver hands over the captured
+// frame. Decoding (DhtDecoder) runs afterwards in the calling task, so
+// the modem UART and display SPI are never starved. Temperature and
+// humidity come from the same transaction.
+
+#ifndef DHT_RMT_H
+#define DHT_RMT_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "DhtDecoder.h"
+
+#define DHT_START_MS       20     // Host start signal, DHT11 needs >= 18 ms
+#define DHT_RX_TIMEOUT_MS  15     // Frame is ~5 ms after the start signal
+#define DHT_RX_IDLE_US     200    // Line high this long ends the frame
+#define DHT_MAX_PULSES     96
+
+struct DhtStats {
+  uint32_t reads;
+  uint32_t ok;
+  uint32_t noResponse;
+  uint32_t frameErrors;
+  uint32_t checksumErrors;
+  uint32_t lastLatencyUs;   // Start signal to decoded values
+  uint32_t maxLatencyUs;
+  uint32_t lastDecodeUs;    // Decode and convert only
+};
+
+class DhtRmt {
+ public:
+  DhtRmt(uint8_t pin, DhtModel model,
+         rmt_channel_t channel = RMT_CHANNEL_4);
+
+  bool begin();
+
+  // One transaction. Blocks the calling task for ~25 ms (asleep).
+  // On failure the outputs are left alone.
+  DhtStatus read(float &temperature, float &humidity);
+
+  DhtStatus lastStatus() const { return _lastStatus; }
+  const DhtStats &stats() const { return _stats; }
+
+ private:
+  void count(DhtStatus status);
+
+  uint8_t _pin;
+  DhtModel _model;
+  rmt_channel_t _channel;
+  RingbufHandle_t _rx;
+  portMUX_TYPE _mux;
+
+  DhtPulse _pulses[DHT_MAX_PULSES];
+  DhtStatus _lastStatus;
+  DhtStats _stats;
+};
+
+#endif
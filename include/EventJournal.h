@@ -0,0 +1,156 @@
+// ================== EVENT JOURNAL ==================
+// Append-only log of alarms, calls, SMS results and configuration changes
+// on the LittleFS partition, kept across reboots.
+//
+//  - records are fixed 32 byte binary structs ending in a CRC-32, so a
+//    torn write at power loss is found by the CRC and cut off there
+//  - records go to numbered segment files (/journal/<n>.log) of
+//    JOURNAL_SEGMENT_RECORDS each; when the newest is full a new one is
+//    started and the oldest beyond JOURNAL_SEGMENTS deleted. Rotating
+//    whole files keeps erase cycles spread over the partition on top of
+//    LittleFS's own wear leveling
+//  - append() only copies the record into a RAM ring under a spinlock;
+//    a low priority task writes the ring out in JOURNAL_BATCH_RECORDS
+//    (one 256 byte flash page) batches, or after JOURNAL_FLUSH_MS, so the
+//    alert path never waits for flash
+//
+// On begin() the newest segment is scanned: the sequence number carries
+// on after the last valid record, and a segment with a damaged tail is
+// closed so new records never follow garbage.
+
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <Arduino.h>
+
+#define JOURNAL_DIR              "/journal"
+#define JOURNAL_SEGMENTS         8
+#define JOURNAL_SEGMENT_RECORDS  512    // 16 KiB files
+#define JOURNAL_RAM_RECORDS      64
+#define JOURNAL_BATCH_RECORDS    8      // 256 bytes
+#define JOURNAL_FLUSH_MS         5000
+#define JOURNAL_DETAIL_LEN       8
+#define JOURNAL_QUERY_SLICE      16     // Records copied per lock hold
+
+// time() before this is the unset RTC, not a date
+#define JOURNAL_MIN_UTC          1600000000UL
+
+enum JournalEvent {
+  JEV_BOOT = 1,         // code: reset reason
+  JEV_ALARM_START,      // value: reasons bitmask (JOURNAL_REASON_*)
+  JEV_ALARM_CLEAR,
+  JEV_FLAME,            // Confirmed flame edge from the interrupt path
+  JEV_CALL_STATE,       // code: EscalationState, arg: contact, value: attempt
+  JEV_SMS_SENT,         // code: attempts, detail: number tail
+  JEV_SMS_FAILED,       // code: attempts, detail: number tail
+  JEV_CONFIG,           // Settings saved from the web page
+  JEV_TYPES
+};
+
+#define JOURNAL_REASON_FIRE  0x01
+#define JOURNAL_REASON_TEMP  0x02
+#define JOURNAL_REASON_HUM   0x04
+#define JOURNAL_REASON_GAS   0x08
+#define JOURNAL_REASON_NH3   0x10
+
+#define JOURNAL_TYPE_BIT(type) (1UL << (type))
+#define JOURNAL_ALL_TYPES      0xFFFFFFFFUL
+
+struct JournalRecord {
+  uint32_t seq;
+  uint32_t utc;         // 0 while the clock is not set
+  uint32_t uptimeMs;
+  uint8_t type;         // JournalEvent
+  uint8_t code;
+  uint16_t arg;
+  int32_t value;
+  char detail[JOURNAL_DETAIL_LEN];  // Not terminated when full
+  uint32_t crc;         // CRC-32 of all bytes above
+};
+
+static_assert(sizeof(JournalRecord) == 32, "Journal records are 32 bytes");
+
+// Return false to stop the query
+typedef bool (*JournalVisitor)(const JournalRecord &record, void *ctx);
+
+struct JournalStats {
+  uint32_t appended;
+  uint32_t written;
+  uint32_t dropped;       // RAM ring full
+  uint32_t writeErrors;
+  uint32_t flushes;
+  uint32_t lastFlushUs;
+  uint32_t maxFlushUs;
+  uint32_t damaged;       // Bad records found at begin()
+  uint32_t firstSegment;
+  uint32_t lastSegment;
+};
+
+class EventJournal {
+ public:
+  EventJournal();
+
+  // Mount LittleFS (formatting it if it cannot be mounted), recover the
+  // newest segment and start the writer task
+  bool begin(BaseType_t core = 1);
+
+  // Safe from any task; never touches flash. detail may be null.
+  bool append(JournalEvent type, uint8_t code = 0, uint16_t arg = 0,
+              int32_t value = 0, const char *detail = nullptr);
+
+  // Write out everything buffered now (e.g. before a restart)
+  void flush();
+
+  // Records with utc in [fromUtc, toUtc] (records without a clock match
+  // only when fromUtc is 0) and type in typeMask, oldest first, including
+  // those still in RAM. Records are copied out JOURNAL_QUERY_SLICE at a
+  // time under the file lock and visited without it, so a slow visitor
+  // (a web client) never holds up the writer. Records appended after the
+  // query started are not visited. Returns the number visited.
+  uint32_t query(uint32_t fromUtc, uint32_t toUtc, uint32_t typeMask,
+                 JournalVisitor visit, void *ctx);
+
+  JournalStats stats();
+
+ private:
+  // Where a query carries on after each slice
+  struct QueryCursor {
+    uint32_t segment;
+    uint32_t offset;
+    uint32_t lastSeq;     // Newest record looked at, matching or not
+    uint32_t endSeq;      // Newest record when the query started
+    bool done;
+  };
+
+  static void taskEntry(void *arg);
+  uint16_t fillSlice(QueryCursor &cursor, uint32_t fromUtc, uint32_t toUtc,
+                     uint32_t typeMask, JournalRecord *slice);
+  void writeBatch(bool all);
+  void rotate();
+  uint32_t scanSegment(uint32_t segment, bool &damaged);
+  void segmentPath(uint32_t segment, char *path, size_t size) const;
+
+  bool _ready;
+  SemaphoreHandle_t _fileLock;
+  TaskHandle_t _task;
+
+  // RAM ring, written by append(), drained by the task
+  JournalRecord _ring[JOURNAL_RAM_RECORDS];
+  uint16_t _head;
+  uint16_t _count;
+  uint32_t _nextSeq;
+
+  // Owned by the writer (under _fileLock)
+  uint32_t _segment;
+  uint32_t _firstSegment;
+  uint16_t _segmentRecords;
+  unsigned long _lastFlush;
+
+  portMUX_TYPE _mux;
+  JournalStats _stats;
+};
+
+uint32_t journalCrc(const void *data, size_t len);
+const char *journalEventName(uint8_t type);
+
+#endif
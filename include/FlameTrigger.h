@@ -0,0 +1,56 @@
+// ================== FLAME FAST PATH ==================
+// Edge interrupt on the flame sensor output. The ISR only timestamps the
+// edge and wakes a small high priority task; the task waits out the
+// debounce time, re-reads the pin and reports a confirmed change through
+// the callback, without waiting for the sampling / threshold pipeline.
+//
+// The flame module pulls its output LOW while it sees a flame.
+
+#ifndef FLAME_TRIGGER_H
+#define FLAME_TRIGGER_H
+
+#include <Arduino.h>
+
+#define FLAME_DEBOUNCE_MS 20
+
+// Runs on the flame task. edgeUs is micros() of the first edge of the burst.
+typedef void (*FlameCallback)(bool active, uint32_t edgeUs);
+
+class FlameTrigger {
+ public:
+  FlameTrigger();
+
+  // One instance per firmware: the ISR has no argument
+  bool begin(uint8_t pin, FlameCallback callback,
+             uint16_t debounceMs = FLAME_DEBOUNCE_MS, BaseType_t core = 1);
+
+  // Debounced state
+  bool active() const { return _active; }
+
+  // micros() of the edge behind the last confirmed change
+  uint32_t lastEdgeUs() const { return _confirmedEdgeUs; }
+
+  uint32_t edgeCount() const { return _edges; }
+  uint32_t confirmedCount() const { return _confirmed; }
+
+ private:
+  static void isr();
+  static void taskEntry(void *arg);
+  void run();
+
+  static FlameTrigger *_instance;
+
+  uint8_t _pin;
+  uint16_t _debounceMs;
+  FlameCallback _callback;
+  TaskHandle_t _task;
+
+  volatile bool _active;
+  volatile uint32_t _edgeUs;      // First edge since the task last ran
+  volatile bool _edgePending;
+  volatile uint32_t _edges;
+  uint32_t _confirmedEdgeUs;
+  uint32_t _confirmed;
+};
+
+#endif
@@ -0,0 +1,152 @@
+// ================== MQ SENSOR CURVES ==================
+// Converts the calibrated output voltage of an MQ sensor module to ppm:
+//
+//   Rs    = RL * (VC - Vout) / Vout        load resistor divider
+//   ratio = Rs / R0                        R0: Rs in clean air
+//   log10(ppm) = (log10(ratio) - Y0) / SLOPE + X0
+//
+// The last line is the straight line through the datasheet's log-log
+// sensitivity curve, anchored at (X0, Y0) = (log10 ppm, log10 ratio).
+//
+// The whole chain only depends on Vout, so each sensor model gets a table
+// of ppm every GAS_CURVE_STEP_MV millivolts, generated by the compiler
+// with constexpr log/exp. A conversion is then one lookup and a linear
+// interpolation; nothing calls pow() or log() at runtime.
+//
+// The table holds the unclamped curve and MAX_PPM is applied to the
+// interpolated value. Clamping the entries instead would interpolate
+// across the knee where the curve crosses MAX_PPM and read low there.
+//
+// A model is a struct with static constexpr doubles:
+//   VC, RL, R0, MAX_PPM, X0, Y0, SLOPE
+// R0 is the sensor resistance in clean air, not the datasheet's clean-air
+// Rs/R0 factor.
+
+#ifndef GAS_CURVE_H
+#define GAS_CURVE_H
+
+#include <stdint.h>
+
+#define GAS_CURVE_STEP_SHIFT 4                        // 16 mV per entry
+#define GAS_CURVE_STEP_MV    (1 << GAS_CURVE_STEP_SHIFT)
+#define GAS_CURVE_MAX_MV     3328                     // Covers 0..VC
+#define GAS_CURVE_ENTRIES    (GAS_CURVE_MAX_MV / GAS_CURVE_STEP_MV + 1)
+#define GAS_CURVE_SATURATED  1e30                     // Entries at or above VC
+
+// Datasheet curves, points read off the log-log sensitivity plots
+struct Mq2LpgCurve   { static constexpr double X0 = 2.3, Y0 = 0.21, SLOPE = -0.47; };
+struct Mq2CoCurve    { static constexpr double X0 = 2.3, Y0 = 0.72, SLOPE = -0.34; };
+struct Mq2SmokeCurve { static constexpr double X0 = 2.3, Y0 = 0.53, SLOPE = -0.44; };
+struct Mq137Nh3Curve { static constexpr double X0 = 0.0, Y0 = 0.42, SLOPE = -0.263; };
+
+namespace gascurve {
+
+constexpr double LN2 = 0.69314718055994530942;
+constexpr double LN10 = 2.30258509299404568402;
+
+// ---- constexpr math (C++11: single return, recursion) ----
+
+// ln(x) for x in [1, 2): 2 * atanh((x - 1) / (x + 1)) series
+constexpr double lnSeries(double y2, double term, int k, int left) {
+  return left == 0 ? 0.0
+                   : term / k + lnSeries(y2, term * y2, k + 2, left - 1);
+}
+
+constexpr double lnReduced(double x) {
+  return 2.0 * lnSeries(((x - 1) / (x + 1)) * ((x - 1) / (x + 1)),
+                        (x - 1) / (x + 1), 1, 24);
+}
+
+constexpr double ln(double x) {
+  return x >= 2.0 ? ln(x / 2.0) + LN2
+       : x < 1.0  ? ln(x * 2.0) - LN2
+       : lnReduced(x);
+}
+
+constexpr double expSeries(double x, double term, int k, int left) {
+  return left == 0 ? 0.0 : term + expSeries(x, term * x / k, k + 1, left - 1);
+}
+
+constexpr double square(double v) { return v * v; }
+
+constexpr double exp(double x) {
+  return (x > 0.5 || x < -0.5) ? square(exp(x / 2.0))
+                               : expSeries(x, 1.0, 1, 16);
+}
+
+constexpr double clamp(double v, double lo, double hi) {
+  return v < lo ? lo : v > hi ? hi : v;
+}
+
+// ---- the sensor model ----
+
+template <class Model>
+constexpr double logPpmFromRatio(double ratio) {
+  return (ln(ratio) / LN10 - Model::Y0) / Model::SLOPE + Model::X0;
+}
+
+template <class Model>
+constexpr double ppmFromRatio(double ratio) {
+  return exp(logPpmFromRatio<Model>(ratio) * LN10);
+}
+
+// Curve value without the MAX_PPM clamp, what the table stores
+template <class Model>
+constexpr double rawPpm(double mv) {
+  return mv >= Model::VC * 1000.0 ? GAS_CURVE_SATURATED
+       : ppmFromRatio<Model>(
+           Model::RL * (Model::VC - clamp(mv, 10.0, 1e9) / 1000.0) /
+           (clamp(mv, 10.0, 1e9) / 1000.0) / Model::R0);
+}
+
+// Exact model for one output voltage, also usable at runtime as reference
+template <class Model>
+constexpr double modelPpm(double mv) {
+  return clamp(rawPpm<Model>(mv), 0.0, Model::MAX_PPM);
+}
+
+// ---- compile time table ----
+
+template <unsigned... I> struct Seq {};
+template <unsigned N, unsigned... I>
+struct MakeSeq : MakeSeq<N - 1, N - 1, I...> {};
+template <unsigned... I>
+struct MakeSeq<0, I...> { typedef Seq<I...> type; };
+
+template <class Model, class S> struct Table;
+
+template <class Model, unsigned... I>
+struct Table<Model, Seq<I...> > {
+  static constexpr float ppm[sizeof...(I)] = {
+    (float)rawPpm<Model>(I * GAS_CURVE_STEP_MV)...
+  };
+};
+
+template <class Model, unsigned... I>
+constexpr float Table<Model, Seq<I...> >::ppm[sizeof...(I)];
+
+}  // namespace gascurve
+
+// Unclamped table of one model, GAS_CURVE_ENTRIES values
+template <class Model>
+const float *gasCurveTable() {
+  return gascurve::Table<Model,
+    typename gascurve::MakeSeq<GAS_CURVE_ENTRIES>::type>::ppm;
+}
+
+// Calibrated millivolts -> ppm through the model's table
+template <class Model>
+uint16_t gasCurvePpm(uint16_t mv) {
+  const float maxPpm = (float)Model::MAX_PPM;
+  if (mv >= GAS_CURVE_MAX_MV) return (uint16_t)maxPpm;
+
+  const float *table = gasCurveTable<Model>();
+  uint16_t i = mv >> GAS_CURVE_STEP_SHIFT;
+  float a = table[i];
+  float b = table[i + 1];
+  float frac = (mv & (GAS_CURVE_STEP_MV - 1)) * (1.0f / GAS_CURVE_STEP_MV);
+  float ppm = a + (b - a) * frac;
+  return ppm >= maxPpm ? (uint16_t)maxPpm : (uint16_t)(ppm + 0.5f);
+}
+
+#endif
@@ -0,0 +1,81 @@
+// ================== LIVE FEED ==================
+// Server-Sent Events push of readings and alert / call state to every
+// browser connected to /live.
+//
+// publish() formats an event once and appends it to one shared byte
+// ring; it never touches a socket, so loop() and the flame task can call
+// it freely. service() runs on the web server task and gives each client
+// whatever part of the ring it has not had yet, with non-blocking sends.
+// A client that cannot keep up falls behind; once the data it still
+// needs has been overwritten it is disconnected rather than slowing
+// anyone down. Idle streams get a comment line every LIVE_PING_MS so
+// dead connections are noticed.
+
+#ifndef LIVE_FEED_H
+#define LIVE_FEED_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define LIVE_MAX_CLIENTS  4
+#define LIVE_BUFFER_SIZE  2048    // Shared by all clients
+#define LIVE_FRAME_MAX    256     // One formatted event
+#define LIVE_SEND_MAX     512     // Per client per service() pass
+#define LIVE_PING_MS      15000
+
+struct LiveStats {
+  uint8_t clients;
+  uint8_t peakClients;
+  uint32_t connects;
+  uint32_t rejected;        // All slots taken
+  uint32_t closed;          // Went away by themselves
+  uint32_t dropped;         // Too slow, disconnected
+  uint32_t events;          // publish() calls
+  uint32_t truncated;       // Longer than LIVE_FRAME_MAX
+  uint32_t bytesQueued;
+  uint32_t bytesSent;
+  uint32_t lastPublishUs;   // Format + append, paid once per event
+  uint32_t maxPublishUs;
+  uint32_t lastServiceUs;   // Fan-out to all clients, one pass
+  uint32_t maxServiceUs;
+};
+
+class LiveFeed {
+ public:
+  LiveFeed();
+
+  // Web task, from the /live handler: answer with the event-stream
+  // headers and keep the connection. False when every slot is taken.
+  bool subscribe(WiFiClient &client);
+
+  // Any task. data is the JSON payload of one "event: <event>" message.
+  void publish(const char *event, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+  // Web task, as often as it polls the server
+  void service();
+
+  // Any task; both read under the lock subscribe() and disconnect() take
+  uint8_t clients();
+  LiveStats stats();
+
+ private:
+  struct Client {
+    bool used;
+    WiFiClient client;
+    uint32_t pos;             // Next stream byte this client needs
+  };
+
+  void append(const char *data, size_t len);
+  void disconnect(Client &c, bool slow);
+
+  portMUX_TYPE _mux;
+  char _buf[LIVE_BUFFER_SIZE];
+  uint32_t _head;             // Stream bytes written since boot
+  unsigned long _lastAppend;
+
+  Client _clients[LIVE_MAX_CLIENTS];  // Web task only
+  LiveStats _stats;
+};
+
+#endif
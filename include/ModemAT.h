@@ -0,0 +1,191 @@
+// ================== ASYNC AT COMMAND ENGINE ==================
+// Queue based AT command runner for the A7670 modem.
+//
+// Commands are queued and written to the modem one at a time. A command
+// completes as soon as a final result code (OK / ERROR / +CME ERROR /
+// +CMS ERROR) is seen, or when its timeout expires, and the completion
+// callback receives the collected response lines.
+//
+// The engine is split in two halves:
+//  - poll() owns the UART: it writes commands, splits lines and routes
+//    them. startTask() runs it in a dedicated FreeRTOS task pinned to a
+//    core; without the task it is driven from dispatch().
+//  - dispatch() runs on the application side (loop()) and delivers
+//    completion callbacks and URC handlers in the order the lines arrived.
+//
+// Lines starting with a registered URC prefix are always delivered to
+// their handler, even while a command is in flight, unless the command
+// itself solicits that prefix (AT+CLCC -> "+CLCC:"; every command of a
+// chain such as AT+CMGF?;+CREG? counts).
+//
+// A command that times out may still be answered later. Until the modem
+// has been quiet for AT_RESYNC_QUIET_MS the engine does not start the next
+// command and throws away every line that is not a registered URC, so a
+// late OK / ERROR can never complete the wrong command.
+
+#ifndef MODEM_AT_H
+#define MODEM_AT_H
+
+#include <Arduino.h>
+
+#define AT_QUEUE_SIZE    8
+#define AT_EVENT_QUEUE   24
+#define AT_URC_MAX       16
+#define AT_LINE_MAX      256
+#define AT_RESYNC_QUIET_MS 500
+
+enum AtStatus {
+  AT_PENDING,
+  AT_OK,
+  AT_ERROR,
+  AT_CME_ERROR,
+  AT_CMS_ERROR,
+  AT_TIMEOUT
+};
+
+struct AtResult {
+  AtStatus status;
+  String response;        // Intermediate lines, '\n' separated, echo removed
+  uint32_t elapsedMs;     // Time from write to final result code
+
+  bool ok() const { return status == AT_OK; }
+};
+
+typedef void (*AtCallback)(const AtResult &result, void *ctx);
+typedef void (*AtLineHandler)(const String &line);
+typedef void (*AtWriteHook)(const char *cmd);
+
+class ModemAT {
+ public:
+  ModemAT();
+
+  void begin(Stream &io);
+
+  // Move UART handling into its own task. Call once after begin().
+  bool startTask(BaseType_t core = 0, uint32_t stackSize = 4096,
+                 UBaseType_t priority = 3);
+
+  // Queue a command. When payload is set the engine waits for the '>'
+  // prompt, then sends the payload terminated by Ctrl-Z (AT+CMGS style).
+  // Returns false when the queue is full.
+  bool enqueue(const char *cmd, uint32_t timeoutMs = 2000,
+               AtCallback cb = nullptr, void *ctx = nullptr,
+               const char *payload = nullptr);
+
+  // Blocking helper: dispatches events until this command completes.
+  // Must not be called from a completion callback or URC handler.
+  AtResult exec(const char *cmd, uint32_t timeoutMs = 2000,
+                const char *payload = nullptr);
+
+  // Register a handler for unsolicited lines starting with prefix.
+  // prefix must stay valid (string literal).
+  bool onUrc(const char *prefix, AtLineHandler handler);
+
+  // Lines received with no command in flight and no matching prefix
+  void setUrcHandler(AtLineHandler handler) { _urcHandler = handler; }
+
+  // Called on the UART side right after a command is written, for
+  // latency instrumentation. Must be short and must not queue commands.
+  void setWriteHook(AtWriteHook hook) { _writeHook = hook; }
+
+  // UART side: write commands, split and route lines. Never blocks.
+  void poll();
+
+  // Application side: run completion callbacks and URC handlers.
+  void dispatch();
+
+  // Dispatch until the queue is empty or timeoutMs elapses.
+  bool waitIdle(uint32_t timeoutMs);
+
+  bool busy();
+  uint8_t pending();
+
+  // Latency statistics since boot
+  uint32_t completedCount() const { return _completed; }
+  uint32_t timeoutCount() const { return _timeouts; }
+  uint32_t urcCount() const { return _urcs; }
+  uint32_t discardedCount() const { return _discarded; }
+  uint32_t averageLatencyMs() const {
+    return _completed ? _totalLatencyMs / _completed : 0;
+  }
+
+ private:
+  struct Command {
+    String cmd;
+    String payload;
+    uint32_t timeoutMs;
+    AtCallback cb;
+    void *ctx;
+  };
+
+  enum EventType { EVENT_COMPLETE, EVENT_URC };
+
+  struct Event {
+    EventType type;
+    AtCallback cb;
+    void *ctx;
+    AtLineHandler handler;
+    AtResult result;
+    String line;
+  };
+
+  struct UrcEntry {
+    const char *prefix;
+    uint8_t len;
+    AtLineHandler handler;
+  };
+
+  static void taskEntry(void *arg);
+
+  void lock();
+  void unlock();
+
+  void startNext();
+  void handleLine(const String &line);
+  void finish(AtStatus status);
+  bool solicited(const String &line) const;
+  void pushEvent(Event &event);
+  void deliver();
+
+  Stream *_io;
+  SemaphoreHandle_t _mutex;
+  TaskHandle_t _task;
+
+  Command _queue[AT_QUEUE_SIZE];
+  uint8_t _head;
+  uint8_t _count;
+
+  Event _events[AT_EVENT_QUEUE];
+  uint8_t _eventHead;
+  uint8_t _eventCount;
+
+  UrcEntry _urcTable[AT_URC_MAX];
+  uint8_t _urcTableSize;
+  AtLineHandler _urcHandler;
+  AtWriteHook _writeHook;
+
+  // Owned by the UART side
+  volatile bool _active;
+  Command _current;
+  String _solicited;
+  bool _payloadSent;
+  AtResult _result;
+  unsigned long _sentAt;
+
+  // Set by a timeout, cleared after AT_RESYNC_QUIET_MS without input
+  bool _draining;
+  unsigned long _lastRx;
+
+  char _line[AT_LINE_MAX];
+  uint16_t _lineLen;
+
+  uint32_t _completed;
+  uint32_t _timeouts;
+  uint32_t _urcs;
+  uint32_t _discarded;
+  uint32_t _totalLatencyMs;
+};
+
+const char *atStatusName(AtStatus status);
+
+#endif
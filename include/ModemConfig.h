@@ -0,0 +1,72 @@
+// ================== MODEM CONFIGURATION ==================
+// Applies a table of modem settings with as few AT round trips as
+// possible.
+//
+// Settings are chained on one command line (AT+CMGF=0;+CSCS="GSM";...)
+// up to MODEM_CHAIN_MAX characters. A chain that fails is replayed one
+// command at a time so a single unsupported setting does not hide the
+// others. After applying, AT&W stores the profile in the modem.
+//
+// The caller keeps a fingerprint of the table (e.g. in NVS). When the
+// stored fingerprint matches, the modem is assumed to be configured
+// already: one chained query batch checks every verifiable setting and
+// only the ones that read back differently are applied again. Settings
+// that can be neither read back nor stored by AT&W are marked
+// MODEM_SET_ALWAYS and written on every boot.
+
+#ifndef MODEM_CONFIG_H
+#define MODEM_CONFIG_H
+
+#include "ModemAT.h"
+
+#define MODEM_CHAIN_MAX    160
+#define MODEM_SETTINGS_MAX 24
+
+// ModemSetting.flags
+#define MODEM_SET_SOLO      0x01  // Never chained (slow or network action)
+#define MODEM_SET_OPTIONAL  0x02  // ERROR is fine (not supported everywhere)
+#define MODEM_SET_ALWAYS    0x04  // Not in the AT&W profile, set every boot
+
+struct ModemSetting {
+  const char *set;        // Without "AT": "+CMGF=0"
+  const char *query;      // "+CMGF?", nullptr if it cannot be read back
+  const char *expect;     // Part of the query answer once applied
+  uint16_t timeoutMs;
+  uint8_t flags;
+};
+
+struct ModemInitReport {
+  bool warm;              // Stored fingerprint matched
+  bool verified;          // Query batch answered and was checked
+  uint8_t applied;        // Settings written
+  uint8_t failed;         // Settings rejected (not optional)
+  uint16_t roundTrips;    // Command lines sent
+  uint32_t elapsedMs;
+};
+
+class ModemConfig {
+ public:
+  ModemConfig(ModemAT &modem, const ModemSetting *settings, uint8_t count);
+
+  // FNV-1a over every set command, changes whenever the table does
+  uint32_t fingerprint() const;
+
+  // Bring the modem to the table's configuration. Returns true when no
+  // required setting failed; store fingerprint() then.
+  bool run(uint32_t storedFingerprint);
+
+  const ModemInitReport &report() const { return _report; }
+
+ private:
+  AtResult send(const String &line, uint32_t timeoutMs);
+  bool verify(bool *pending);
+  void apply(const bool *pending);
+  bool applyOne(uint8_t i);
+
+  ModemAT &_modem;
+  const ModemSetting *_settings;
+  uint8_t _count;
+  ModemInitReport _report;
+};
+
+#endif
@@ -0,0 +1,102 @@
+// ================== NETWORK CLOCK ==================
+// Wall clock kept locally between occasional syncs from the modem
+// (AT+CCLK?, re-synced early when +CTZV reports a network time update).
+//
+// Between syncs the time is extrapolated from the millisecond counter,
+// corrected by the drift measured across syncs, so reading the clock
+// costs no AT traffic. Daily jobs keep their next due time and fire once
+// when the clock passes it, however late tick() gets to run; a stall
+// across several due times still fires the job only once.
+//
+// Like AlertEscalation, all times are passed in, so the same code runs
+// against millis() on the device and a virtual clock elsewhere.
+
+#ifndef NET_CLOCK_H
+#define NET_CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define NETCLOCK_JOBS            4
+#define NETCLOCK_SYNC_INTERVAL   (6UL * 3600UL * 1000UL)
+#define NETCLOCK_RETRY_INTERVAL  60000UL  // While not synced / after a failure
+
+// local is seconds since 1970 in the network's local time zone
+typedef void (*ClockJob)(time_t local);
+
+struct ClockStats {
+  uint32_t syncs;
+  uint32_t failures;
+  int32_t lastStepMs;     // Correction applied at the last sync
+  int32_t driftPpm;       // Millisecond counter vs network time
+};
+
+class NetClock {
+ public:
+  NetClock();
+
+  // Apply a +CCLK response: "+CCLK: \"yy/MM/dd,hh:mm:ss±zz\"".
+  // Returns false (and counts a failure) if it holds no valid time.
+  bool syncFromCclk(const char *resp, unsigned long nowMs);
+
+  // utc in seconds, tzMinutes east of UTC
+  void sync(time_t utc, int16_t tzMinutes, unsigned long nowMs);
+
+  // A query failed or timed out: try again after the retry interval
+  void syncFailed(unsigned long nowMs);
+
+  // Next tick asks for a sync (e.g. on +CTZV)
+  void requestSync() { _syncRequested = true; }
+  bool syncDue(unsigned long nowMs);
+
+  bool valid() const { return _valid; }
+  time_t utc(unsigned long nowMs);
+  time_t local(unsigned long nowMs) { return utc(nowMs) + _tzMinutes * 60; }
+  int16_t tzMinutes() const { return _tzMinutes; }
+
+  // Run job every day at hour:minute local time. The first run is the
+  // next occurrence after the first sync. Returns the job index or -1.
+  int addDaily(uint8_t hour, uint8_t minute, ClockJob job);
+  time_t nextDue(int index) const;
+
+  // Fire due jobs; call as often as convenient
+  void tick(unsigned long nowMs);
+
+  const ClockStats &stats() const { return _stats; }
+
+ private:
+  struct Job {
+    ClockJob fn;
+    uint16_t minuteOfDay;
+    time_t due;           // Local time, 0 until the clock is valid
+  };
+
+  uint64_t extend(unsigned long nowMs);
+  time_t nextOccurrence(uint16_t minuteOfDay, time_t after) const;
+  void schedule(time_t local);
+
+  bool _valid;
+  bool _syncRequested;
+  int16_t _tzMinutes;
+
+  // 64-bit millisecond counter built from millis() wraps
+  uint32_t _lastMs;
+  uint32_t _wraps;
+
+  // Last sync, and the first one of this run for drift measurement
+  int64_t _anchorUtcMs;
+  uint64_t _anchorMs;
+  int64_t _firstUtcMs;
+  uint64_t _firstMs;
+  uint64_t _nextSyncMs;
+
+  Job _jobs[NETCLOCK_JOBS];
+  uint8_t _jobCount;
+
+  ClockStats _stats;
+};
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+int32_t daysFromCivil(int32_t y, uint8_t m, uint8_t d);
+
+#endif
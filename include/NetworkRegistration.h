@@ -0,0 +1,80 @@
+// ================== NETWORK REGISTRATION ==================
+// Registration state kept from unsolicited reports instead of polling.
+//
+// With AT+CREG=2 / AT+CGREG=2 / AT+CEREG=2 the modem reports every
+// change of circuit, packet and LTE registration as a URC, and with
+// AT+AUTOCSQ=1,1 every change of signal quality as +CSQ. The handlers
+// feed those lines (and the answers to the initial queries) into
+// update(); everything else just reads the cached state.
+//
+// The modem is registered while any domain reports home or roaming
+// (including the SMS-only states 6/7 an LTE-only VoLTE network uses).
+
+#ifndef NETWORK_REGISTRATION_H
+#define NETWORK_REGISTRATION_H
+
+#include <stdint.h>
+
+enum RegStatus {
+  REG_NOT_SEARCHING = 0,
+  REG_HOME = 1,
+  REG_SEARCHING = 2,
+  REG_DENIED = 3,
+  REG_UNKNOWN = 4,
+  REG_ROAMING = 5,
+  REG_SMS_HOME = 6,
+  REG_SMS_ROAMING = 7
+};
+
+enum RegDomain {
+  REG_CS,     // +CREG
+  REG_PS,     // +CGREG
+  REG_EPS,    // +CEREG
+  REG_DOMAINS
+};
+
+typedef void (*RegChangeHandler)(bool registered, unsigned long now);
+
+class NetworkRegistration {
+ public:
+  NetworkRegistration();
+
+  // One +CREG: / +CGREG: / +CEREG: / +CSQ: line, URC or query answer.
+  // Returns true if the line was understood.
+  bool update(const char *line, unsigned long nowMs);
+
+  // Every line of a query response
+  void updateAll(const char *response, unsigned long nowMs);
+
+  // Called from update() when registered() flips
+  void setChangeHandler(RegChangeHandler handler) { _onChange = handler; }
+
+  bool registered() const { return _registered; }
+  RegStatus status(RegDomain domain) const { return _status[domain]; }
+  unsigned long since() const { return _since; }   // Last registered() flip
+  uint32_t changes() const { return _changes; }
+
+  // AcT from the last report carrying one: 0 GSM, 2 UTRAN, 7 E-UTRAN,
+  // -1 unknown
+  int8_t accessTech() const { return _act; }
+  const char *accessTechName() const;
+
+  // 0..31, 99 unknown
+  uint8_t csq() const { return _csq; }
+  int16_t rssiDbm() const { return _csq == 99 ? 0 : -113 + 2 * _csq; }
+
+ private:
+  bool updateReg(RegDomain domain, const char *args, unsigned long nowMs);
+
+  RegStatus _status[REG_DOMAINS];
+  bool _registered;
+  int8_t _act;
+  uint8_t _csq;
+  unsigned long _since;
+  uint32_t _changes;
+  RegChangeHandler _onChange;
+};
+
+const char *regStatusName(RegStatus status);
+
+#endif
@@ -0,0 +1,102 @@
+// ================== SENSOR ACQUISITION ==================
+// Samples the gas, ammonia and flame inputs at a fixed rate from a
+// dedicated high priority task, independent of the UI tick and of any
+// blocking modem work in loop().
+//
+//  - every 1/sampleHz the task takes the MQ-2 and MQ-137 averages from the
+//    continuous ADC stream (in mV), reads the flame input and pushes one
+//    SensorSample into a lock-free SPSC ring for the consumer (loop()) to
+//    drain into its filters
+//  - a second, low priority task reads the DHT11 through the RMT capture
+//    (DhtRmt) on its own schedule, never faster than once per second,
+//    the sensor's limit
+//  - both publish the latest values into a SensorSnapshot that any task
+//    can copy out with snapshot()
+
+#ifndef SENSOR_SAMPLER_H
+#define SENSOR_SAMPLER_H
+
+#include <Arduino.h>
+#include "DhtRmt.h"
+#include <TinyGsmFifo.h>
+#include "AdcStream.h"
+
+#ifndef SENSOR_SAMPLE_HZ
+#define SENSOR_SAMPLE_HZ 50
+#endif
+
+#define SENSOR_RING_SIZE  64     // Power of two; ~1.3 s at 50 Hz
+#define DHT_MIN_INTERVAL  1000   // DHT11 cannot be read faster than 1 Hz
+
+struct SensorSample {
+  uint32_t ms;
+  uint16_t gasMv;
+  uint16_t nh3Mv;
+  bool flame;             // Flame input active (pin LOW)
+};
+
+struct SensorSnapshot {
+  uint32_t seq;           // Bumped on every publish
+  uint32_t sampledAt;     // millis() of the latest ADC sample
+  uint16_t gasMv;
+  uint16_t nh3Mv;
+  bool flame;
+  uint32_t flameChangedAt;
+
+  float temperature;      // Latest DHT11 read, NaN when it failed
+  float humidity;
+  uint32_t dhtAt;
+
+  uint32_t samples;       // Total ADC samples taken
+  uint32_t dropped;       // Samples lost because the ring was full
+  uint32_t overruns;      // Sampling periods that started late
+};
+
+class SensorSampler {
+ public:
+  SensorSampler(uint8_t gasPin, uint8_t nh3Pin, uint8_t flamePin,
+                DhtRmt &dht);
+
+  // Start both tasks. dhtIntervalMs is clamped to DHT_MIN_INTERVAL.
+  bool begin(uint16_t sampleHz = SENSOR_SAMPLE_HZ,
+             uint32_t dhtIntervalMs = 2000, BaseType_t core = 1);
+
+  // Consumer side of the sample ring (single reader)
+  bool read(SensorSample &sample) { return _ring.get(&sample); }
+  size_t available() { return _ring.size(); }
+
+  // Copy of the latest published values, safe from any task
+  void snapshot(SensorSnapshot &out);
+
+  uint16_t sampleHz() const { return _sampleHz; }
+
+  // Statistics only; owned by the sampling task
+  const AdcStream &adc() const { return _adc; }
+  const DhtStats &dhtStats() const { return _dht.stats(); }
+
+ private:
+  static void sampleTaskEntry(void *arg);
+  static void dhtTaskEntry(void *arg);
+
+  void sampleOnce(uint32_t now);
+  void readDht(uint32_t now);
+
+  uint8_t _gasPin;
+  uint8_t _nh3Pin;
+  uint8_t _flamePin;
+  DhtRmt &_dht;
+  AdcStream _adc;
+
+  uint16_t _sampleHz;
+  uint32_t _dhtIntervalMs;
+
+  TinyGsmSpscFifo<SensorSample, SENSOR_RING_SIZE> _ring;
+
+  portMUX_TYPE _mux;
+  SensorSnapshot _snap;
+
+  TaskHandle_t _sampleTask;
+  TaskHandle_t _dhtTask;
+};
+
+#endif
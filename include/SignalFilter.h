@@ -0,0 +1,132 @@
+// ================== SIGNAL FILTERS ==================
+// Small per-channel filters for the gas sensors. Window sizes are template
+// parameters, so each instance owns a fixed buffer and nothing is shared
+// between channels.
+//
+//  MovingAverage<T, N>  running sum over the last N samples, O(1)
+//  Ema<SHIFT>           exponential average, alpha = 1 / 2^SHIFT, O(1)
+//  SlidingMedian<T, N>  median of the last N samples for spike rejection,
+//                       O(N) memmove on a small sorted window
+
+#ifndef SIGNAL_FILTER_H
+#define SIGNAL_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+
+template <typename T, uint16_t N, typename Acc = int32_t>
+class MovingAverage {
+  static_assert(N > 0, "MovingAverage window must not be empty");
+
+ public:
+  MovingAverage() { reset(); }
+
+  void reset() {
+    _sum = 0;
+    _head = 0;
+    _count = 0;
+  }
+
+  // Add a sample and return the average of the filled part of the window
+  T add(T sample) {
+    if (_count == N) {
+      _sum -= _buf[_head];
+    } else {
+      _count++;
+    }
+    _buf[_head] = sample;
+    _sum += sample;
+    if (++_head == N) _head = 0;
+    return value();
+  }
+
+  T value() const { return _count ? (T)(_sum / (Acc)_count) : 0; }
+  bool filled() const { return _count == N; }
+
+ private:
+  T _buf[N];
+  Acc _sum;
+  uint16_t _head;
+  uint16_t _count;
+};
+
+// Integer EMA: the state keeps SHIFT extra fraction bits, so small steps
+// are not lost to rounding. The first sample seeds the state.
+template <uint8_t SHIFT>
+class Ema {
+  static_assert(SHIFT > 0 && SHIFT < 16, "Ema shift out of range");
+
+ public:
+  Ema() { reset(); }
+
+  void reset() {
+    _acc = 0;
+    _seeded = false;
+  }
+
+  int32_t add(int32_t sample) {
+    if (!_seeded) {
+      _acc = sample << SHIFT;
+      _seeded = true;
+    } else {
+      _acc += sample - (_acc >> SHIFT);
+    }
+    return value();
+  }
+
+  int32_t value() const { return _acc >> SHIFT; }
+
+ private:
+  int32_t _acc;
+  bool _seeded;
+};
+
+template <typename T, uint8_t N>
+class SlidingMedian {
+  static_assert(N > 0, "SlidingMedian window must not be empty");
+
+ public:
+  SlidingMedian() { reset(); }
+
+  void reset() {
+    _head = 0;
+    _count = 0;
+  }
+
+  T add(T sample) {
+    if (_count == N) {
+      remove(_ring[_head]);
+    } else {
+      _count++;
+    }
+    _ring[_head] = sample;
+    if (++_head == N) _head = 0;
+    insert(sample);
+    return value();
+  }
+
+  T value() const { return _count ? _sorted[(_count - 1) / 2] : 0; }
+
+ private:
+  // _sorted holds _count - 1 values while one sample is being replaced
+  void remove(T old) {
+    uint8_t i = 0;
+    while (i < N - 1 && _sorted[i] != old) i++;
+    memmove(&_sorted[i], &_sorted[i + 1], (N - 1 - i) * sizeof(T));
+  }
+
+  void insert(T sample) {
+    uint8_t n = _count - 1;   // Values already in _sorted
+    uint8_t i = n;
+    while (i > 0 && _sorted[i - 1] > sample) i--;
+    memmove(&_sorted[i + 1], &_sorted[i], (n - i) * sizeof(T));
+    _sorted[i] = sample;
+  }
+
+  T _ring[N];      // Insertion order, oldest at _head once full
+  T _sorted[N];
+  uint8_t _head;
+  uint8_t _count;
+};
+
+#endif
@@ -0,0 +1,85 @@
+// ================== SMS COMPOSER ==================
+// Builds SMS texts into a caller supplied buffer without touching the
+// heap, while tracking what the text costs on the air:
+//  - GSM-7: 160 septets per single SMS, extension chars ([ ] { } ~ | ^ \ €)
+//    take two
+//  - anything outside the GSM alphabet (emoji, most accents) switches the
+//    whole message to UCS-2: 70 UTF-16 units per single SMS
+//
+// Text is appended in fields. endField() keeps a field only if the message
+// still fits one SMS in its encoding, otherwise it is rolled back so the
+// caller can try a shorter form; dropped fields set truncated().
+//
+//   SmsComposer c(buf, sizeof(buf));
+//   c.beginField(); c.put("Temp: ").put(t, 1).put("C\n");
+//   if (!c.endField()) c.add("T:...");
+
+#ifndef SMS_COMPOSER_H
+#define SMS_COMPOSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SMS_GSM7_BUDGET   160
+#define SMS_UCS2_BUDGET   70
+
+// Enough for a full UCS-2 single SMS of 4-byte UTF-8 sequences
+#define SMS_TEXT_MAX      (SMS_UCS2_BUDGET * 4 + 1)
+
+class SmsComposer {
+ public:
+  SmsComposer(char *buf, size_t size);
+
+  void reset();
+
+  void beginField();
+  bool endField();
+
+  // beginField() + put(text) + endField()
+  bool add(const char *text);
+
+  // Long form if it fits, short form otherwise
+  bool add(const char *text, const char *shortText);
+
+  SmsComposer &put(const char *text);
+  SmsComposer &put(char c);
+  SmsComposer &put(long value);
+  SmsComposer &put(int value) { return put((long)value); }
+  SmsComposer &put(float value, uint8_t decimals);
+
+  const char *c_str() const { return _buf; }
+  size_t length() const { return _len; }
+
+  bool ucs2() const { return !_gsm; }
+  // Characters used / available in the current encoding
+  uint16_t used() const { return _gsm ? _septets : _units; }
+  uint16_t budget() const { return _gsm ? SMS_GSM7_BUDGET : SMS_UCS2_BUDGET; }
+  bool truncated() const { return _truncated; }
+
+ private:
+  struct Mark {
+    size_t len;
+    uint16_t septets;
+    uint16_t units;
+    bool gsm;
+  };
+
+  void putBytes(const char *text, size_t n);
+  void count(uint32_t cp);
+
+  char *_buf;
+  size_t _size;
+  size_t _len;
+  uint16_t _septets;    // GSM-7 length, valid while _gsm
+  uint16_t _units;      // UTF-16 length
+  bool _gsm;
+  bool _overflow;       // Buffer too small for the current field
+  bool _truncated;
+  Mark _mark;
+
+  // UTF-8 decoder state across put() calls
+  uint32_t _cp;
+  uint8_t _pending;
+};
+
+#endif
@@ -0,0 +1,116 @@
+// ================== SMS OUTBOX ==================
+// Non-blocking SMS queue on top of the async AT engine.
+//
+// send() only stores the message and never touches the modem, so alarms
+// may queue SMS while the modem boot stage still owns the AT engine.
+// poll() (from loop(), once the modem is up) submits the most
+// urgent due message in PDU mode (TinyGsmSmsPdu: GSM-7 when possible,
+// UCS-2 for emoji and other text, concatenated parts when too long) as
+// AT+CMGS=<len>; the engine writes the hex PDU when the '>' prompt arrives
+// and completes on the final result code, and the next part or message
+// goes out from that completion. AT+CMGF=0 is only sent when the modem's
+// message format is unknown (boot, after an error). Failed parts are
+// retried with exponential backoff.
+//
+// Not thread safe: send() and poll() belong to the loop() task, which is
+// also where the AT engine dispatches the completions.
+
+#ifndef SMS_OUTBOX_H
+#define SMS_OUTBOX_H
+
+#include <Arduino.h>
+#include <TinyGsmSmsPdu.h>
+#include "ModemAT.h"
+
+#define SMS_OUTBOX_SIZE     8
+#define SMS_MAX_ATTEMPTS    4
+#define SMS_RETRY_BASE_MS   5000      // 5 s, 10 s, 20 s ...
+#define SMS_SUBMIT_TIMEOUT  15000
+
+enum SmsPriority {
+  SMS_PRIO_LOW,       // Daily report
+  SMS_PRIO_NORMAL,    // Test messages
+  SMS_PRIO_ALERT      // Alert start / per-call messages
+};
+
+struct SmsStats {
+  uint32_t queued;
+  uint32_t sent;          // Messages, all parts accepted
+  uint32_t parts;         // Submitted PDUs
+  uint32_t failed;        // Dropped after SMS_MAX_ATTEMPTS
+  uint32_t retries;
+  uint32_t rejected;      // Queue full
+  uint32_t lastSubmitMs;  // AT+CMGS write -> OK
+  uint32_t maxSubmitMs;
+  uint32_t lastQueueMs;   // send() -> OK
+  uint32_t maxQueueMs;
+  uint64_t totalSubmitMs;
+};
+
+// Called from the completion when a message is sent or given up on, and
+// from send() with sent = false when a message is evicted. id is the one
+// send() handed out; a number can have several messages queued.
+typedef void (*SmsResultHook)(uint32_t id, const String &number, bool sent,
+                              uint8_t attempts);
+
+class SmsOutbox {
+ public:
+  explicit SmsOutbox(ModemAT &modem);
+
+  // Queue a message. When full, a lower priority message is evicted;
+  // returns false if nothing could make room. *id receives the message's
+  // id (never 0) for matching its result.
+  bool send(const String &number, const String &text,
+            SmsPriority priority = SMS_PRIO_NORMAL, uint32_t *id = nullptr);
+
+  // Submit the next due message if the modem side is idle
+  void poll();
+
+  // Forget the modem's text mode state, e.g. after a modem restart
+  void invalidateModemState() { _pduMode = false; }
+
+  void setResultHook(SmsResultHook hook) { _resultHook = hook; }
+
+  uint8_t depth() const { return _count; }
+  bool busy() const { return _inFlight >= 0; }
+  const SmsStats &stats() const { return _stats; }
+  uint32_t averageSubmitMs() const {
+    return _stats.sent ? (uint32_t)(_stats.totalSubmitMs / _stats.sent) : 0;
+  }
+
+ private:
+  struct Message {
+    bool used;
+    SmsPriority priority;
+    uint8_t attempts;
+    uint8_t ref;            // Concatenation reference
+    uint8_t segment;        // Next part to submit
+    uint8_t segments;
+    uint32_t seq;           // FIFO order within a priority, also the id
+    unsigned long queuedAt;
+    unsigned long nextTryAt;
+    String number;
+    String text;
+  };
+
+  static void onSetupDone(const AtResult &result, void *ctx);
+  static void onSubmitDone(const AtResult &result, void *ctx);
+
+  int pickNext(unsigned long now) const;
+  int pickVictim(SmsPriority incoming) const;
+  void submit(int slot);
+  void complete(const AtResult &result);
+  void release(int slot);
+
+  ModemAT &_modem;
+  Message _slots[SMS_OUTBOX_SIZE];
+  uint8_t _count;
+  uint32_t _seq;
+  uint8_t _ref;
+  int _inFlight;            // Slot being submitted, -1 when idle
+  bool _pduMode;            // AT+CMGF=0 in effect
+  SmsResultHook _resultHook;
+  SmsStats _stats;
+};
+
+#endif
@@ -0,0 +1,37 @@
+// ================== SMS TEMPLATES ==================
+// The alert, parameter and daily report texts, rendered into an
+// SmsComposer. Each field that would push the message past one SMS falls
+// back to a short form or is dropped (see SmsComposer). Readings and
+// limits are passed in, so the texts can be checked off the device.
+
+#ifndef SMS_TEMPLATES_H
+#define SMS_TEMPLATES_H
+
+#include "SmsComposer.h"
+
+struct AlertLimits {
+  float tempLow;
+  float tempHigh;
+  float humLow;
+  float humHigh;
+  int gas;
+  int nh3;
+};
+
+// One line per limit that is exceeded, "Unknown alert" if none is
+void appendAlertReasons(SmsComposer &msg, const AlertLimits &limits,
+                        float temp, float hum, int gas, int nh3, bool fire);
+
+// Sent with every alert call
+void composeCallAlert(SmsComposer &msg, const AlertLimits &limits,
+                      int attempt, float temp, float hum, int gas, int nh3,
+                      bool fire);
+
+// Current readings, sent when an alert starts
+void composeParameters(SmsComposer &msg, float temp, float hum, int gas,
+                       int nh3, bool fire);
+
+void composeDailyReport(SmsComposer &msg, float minTemp, float maxTemp,
+                        float minHum, float maxHum);
+
+#endif
@@ -0,0 +1,234 @@
+// ================== TIME-SERIES STORE ==================
+// Recent history of the five monitored channels in a fixed amount of RAM.
+//
+// Three tiers, each a struct-of-arrays ring indexed by time:
+//  - seconds: one sample per second in 60 s blocks. The open block keeps
+//    raw values; a closed block stores per channel its minimum and a
+//    shift, and one byte per second holding (value - min) >> shift.
+//    Flame and "sample present" are one bit per second. The shift is
+//    only non-zero when a block spans more than 255 units (a gas spike);
+//    values are then quantized to 2^shift, extremes survive in the
+//    minute tier.
+//  - minutes / hours: min, max and mean per channel, sample count and
+//    seconds with flame per bucket, rolled up from the exact samples as
+//    each minute / hour closes.
+//
+// Times are seconds of uptime passed in by the caller, so clock steps
+// never reorder history. Capacities are compile-time constants and the
+// whole store is checked against TS_BUDGET_BYTES.
+
+#ifndef TIME_SERIES_STORE_H
+#define TIME_SERIES_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TS_BLOCK_SECONDS   60
+#define TS_RAW_BLOCKS      30     // 30 min of 1 s samples
+#define TS_MINUTE_BUCKETS  240    // 4 h of 1 min buckets
+#define TS_HOUR_BUCKETS    168    // 7 days of 1 h buckets
+#define TS_BUDGET_BYTES    24576
+
+enum TsChannel {
+  TS_TEMP,      // 0.1 C
+  TS_HUM,       // 0.1 %RH
+  TS_GAS,       // ppm
+  TS_NH3,       // ppm
+  TS_ANALOG     // Flame is kept as a bit, not a channel value
+};
+
+enum TsTier {
+  TS_SECONDS,
+  TS_MINUTES,
+  TS_HOURS
+};
+
+struct TsSample {
+  int16_t value[TS_ANALOG];
+  bool flame;
+};
+
+// One row of a query; a seconds row has min == max == mean, count 1
+struct TsPoint {
+  uint32_t t;               // Bucket start, seconds of uptime
+  uint16_t count;           // Samples in the bucket
+  uint16_t flame;           // Of those, samples with flame
+  int16_t min[TS_ANALOG];
+  int16_t max[TS_ANALOG];
+  int16_t mean[TS_ANALOG];
+};
+
+// Return false to stop the query
+typedef bool (*TsVisitor)(const TsPoint &point, void *ctx);
+
+struct TsRollup {
+  uint32_t start;
+  uint16_t count;
+  uint16_t flame;
+  int16_t lo[TS_ANALOG];
+  int16_t hi[TS_ANALOG];
+  int32_t sum[TS_ANALOG];
+
+  void reset(uint32_t at);
+  void add(const TsSample &sample);
+  void merge(const TsRollup &other);
+  void merge(const TsPoint &point);   // Query row, for coarser re-bucketing
+  void toPoint(TsPoint &point) const;
+  int16_t mean(uint8_t channel) const;
+};
+
+// Ring of N buckets of PERIOD seconds, one array per field
+template <uint16_t N, uint32_t PERIOD>
+class RollupTier {
+ public:
+  RollupTier() : _hasOpen(false) {
+    for (uint16_t i = 0; i < N; i++) _count[i] = 0;
+  }
+
+  // Fold a sample or a closed finer bucket in. Returns true and fills
+  // closed when this moved on to a new bucket.
+  bool merge(const TsRollup &part, TsRollup &closed) {
+    uint32_t start = part.start - part.start % PERIOD;
+    bool moved = false;
+    if (_hasOpen && start != _open.start) {
+      commit();
+      closed = _open;
+      moved = true;
+      _hasOpen = false;
+    }
+    if (!_hasOpen) {
+      _open.reset(start);
+      _hasOpen = true;
+    }
+    _open.merge(part);
+    return moved;
+  }
+
+  // Stored buckets in [from, to], then the open one
+  uint32_t query(uint32_t from, uint32_t to, TsVisitor visit, void *ctx,
+                 bool &stopped) const {
+    uint32_t rows = 0;
+    stopped = false;
+    if (!_hasOpen) return 0;
+
+    uint32_t newest = _open.start / PERIOD;
+    uint32_t first = from / PERIOD;
+    if (newest >= N && first < newest - N) first = newest - N;
+
+    TsPoint point;
+    for (uint32_t b = first; b < newest && b * PERIOD <= to; b++) {
+      uint16_t slot = b % N;
+      if (!_count[slot] || _start[slot] != b * PERIOD) continue;
+      point.t = _start[slot];
+      point.count = _count[slot];
+      point.flame = _flame[slot];
+      for (uint8_t c = 0; c < TS_ANALOG; c++) {
+        point.min[c] = _lo[c][slot];
+        point.max[c] = _hi[c][slot];
+        point.mean[c] = _mean[c][slot];
+      }
+      rows++;
+      if (!visit(point, ctx)) {
+        stopped = true;
+        return rows;
+      }
+    }
+
+    if (_open.start >= from - from % PERIOD && _open.start <= to) {
+      _open.toPoint(point);
+      rows++;
+      if (!visit(point, ctx)) stopped = true;
+    }
+    return rows;
+  }
+
+  uint16_t stored() const {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < N; i++) {
+      if (_count[i]) n++;
+    }
+    return n;
+  }
+
+ private:
+  void commit() {
+    uint16_t slot = (_open.start / PERIOD) % N;
+    _start[slot] = _open.start;
+    _count[slot] = _open.count;
+    _flame[slot] = _open.flame;
+    for (uint8_t c = 0; c < TS_ANALOG; c++) {
+      _lo[c][slot] = _open.lo[c];
+      _hi[c][slot] = _open.hi[c];
+      _mean[c][slot] = _open.mean(c);
+    }
+  }
+
+  uint32_t _start[N];
+  uint16_t _count[N];
+  uint16_t _flame[N];
+  int16_t _lo[TS_ANALOG][N];
+  int16_t _hi[TS_ANALOG][N];
+  int16_t _mean[TS_ANALOG][N];
+
+  TsRollup _open;
+  bool _hasOpen;
+};
+
+struct TsStats {
+  uint32_t samples;         // Accepted by add()
+  uint32_t rejected;        // Out of order / same second
+  uint16_t secondsStored;
+  uint16_t minutesStored;
+  uint16_t hoursStored;
+  uint32_t quantizedBlocks; // Closed with shift > 0
+};
+
+class TimeSeriesStore {
+ public:
+  TimeSeriesStore();
+
+  // At most one sample per second, in increasing time order
+  bool add(uint32_t sec, const TsSample &sample);
+
+  // Visit rows of a tier with t in [from, to], oldest first.
+  // Returns the number of rows visited.
+  uint32_t query(TsTier tier, uint32_t from, uint32_t to, TsVisitor visit,
+                 void *ctx) const;
+
+  TsStats stats() const;
+
+  // Bytes of the seconds tier per stored 5-channel sample, and of the
+  // whole store
+  static float bytesPerSecondSample();
+  static size_t bytes();
+
+ private:
+  void closeBlock();
+  uint32_t queryBlock(uint32_t block, uint32_t from, uint32_t to,
+                      TsVisitor visit, void *ctx, bool &stopped) const;
+
+  // Seconds tier, closed blocks
+  uint32_t _blkStart[TS_RAW_BLOCKS];
+  uint64_t _blkValid[TS_RAW_BLOCKS];
+  uint64_t _blkFlame[TS_RAW_BLOCKS];
+  int16_t _blkBase[TS_ANALOG][TS_RAW_BLOCKS];
+  uint8_t _blkShift[TS_ANALOG][TS_RAW_BLOCKS];
+  uint8_t _blkCode[TS_ANALOG][TS_RAW_BLOCKS][TS_BLOCK_SECONDS];
+
+  // Seconds tier, open block
+  uint32_t _openStart;
+  uint64_t _openValid;
+  uint64_t _openFlame;
+  int16_t _openValue[TS_ANALOG][TS_BLOCK_SECONDS];
+
+  RollupTier<TS_MINUTE_BUCKETS, 60> _minutes;
+  RollupTier<TS_HOUR_BUCKETS, 3600> _hours;
+
+  bool _any;
+  uint32_t _lastSec;
+  uint32_t _samples;
+  uint32_t _rejected;
+  uint32_t _quantized;
+};
+
+#endif
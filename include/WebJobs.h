@@ -0,0 +1,82 @@
+// ================== WEB JOBS ==================
+// Actions requested over HTTP that take longer than a request should
+// (test SMS, test call) run as jobs.
+//
+// The web server task submit()s a job and answers 202 Accepted with its
+// id at once. loop(), which owns the modem and the SMS outbox, takes
+// queued jobs with next(), starts them and calls finish() when they
+// complete, usually from an AT or outbox completion. The page polls the
+// job by id until it is done.
+//
+// A small fixed table: the oldest finished job is reused when it is
+// full, and submit() fails only when every slot is queued or running.
+
+#ifndef WEB_JOBS_H
+#define WEB_JOBS_H
+
+#include <Arduino.h>
+
+#define WEB_JOB_SLOTS    8
+#define WEB_JOB_TEXT_LEN 32
+
+enum WebJobKind {
+  JOB_TEST_SMS,
+  JOB_TEST_CALL
+};
+
+enum WebJobState {
+  JOB_FREE,
+  JOB_QUEUED,
+  JOB_RUNNING,
+  JOB_DONE,
+  JOB_FAILED
+};
+
+struct WebJob {
+  uint16_t id;
+  WebJobKind kind;
+  WebJobState state;
+  unsigned long queuedAt;
+  unsigned long startedAt;
+  unsigned long finishedAt;
+  char text[WEB_JOB_TEXT_LEN];  // Outcome for the page
+};
+
+struct WebJobStats {
+  uint32_t submitted;
+  uint32_t rejected;        // Table full
+  uint32_t done;
+  uint32_t failed;
+  uint32_t maxWaitMs;       // Queued -> started
+};
+
+class WebJobs {
+ public:
+  WebJobs();
+
+  // Any task. Returns the job id, 0 when the table is full.
+  uint16_t submit(WebJobKind kind);
+
+  // Oldest queued job, now marked running. False when there is none.
+  bool next(WebJob &job);
+
+  void finish(uint16_t id, bool ok, const char *text);
+
+  // Copy of the job; false for an unknown or reused id
+  bool get(uint16_t id, WebJob &job);
+
+  // A job of this kind is queued or running
+  bool pending(WebJobKind kind);
+
+  WebJobStats stats();
+
+ private:
+  WebJob _jobs[WEB_JOB_SLOTS];
+  uint16_t _nextId;
+  portMUX_TYPE _mux;
+  WebJobStats _stats;
+};
+
+const char *webJobStateName(WebJobState state);
+
+#endif
@@ -54,6 +54,7 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
  public:
   class GsmClientA7670 : public GsmClient {
     friend class TinyGsmA7670;
+    friend class TinyGsmA76xx<TinyGsmA7670>;  // waitResponseImpl()
 
    public:
     GsmClientA7670() {}
@@ -374,6 +375,30 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
     //  ^^ Requested number of data bytes (1-1460 bytes)to be read
     int16_t len_confirmed = streamGetIntBefore('\n');
     // ^^ The data length which not read in the buffer
+#if defined(TINY_GSM_RX_SPSC) && !defined(TINY_GSM_USE_HEX)
+    // Read straight into the socket fifo, no per-byte put()
+    int16_t remaining = len_requested;
+    while (remaining > 0) {
+      size_t   room;
+      uint8_t* span = sockets[mux]->rx.writeSpan(room);
+      if (!span) {
+        // Fifo full: drop the byte like put() would
+        uint32_t startMillis = millis();
+        while (!stream.available() &&
+               (millis() - startMillis < sockets[mux]->_timeout)) {
+          TINY_GSM_YIELD();
+        }
+        if (stream.read() < 0) { break; }
+        remaining--;
+        continue;
+      }
+      if (room > static_cast<size_t>(remaining)) { room = remaining; }
+      size_t got = stream.readBytes(span, room);
+      sockets[mux]->rx.commit(got);
+      remaining -= got;
+      if (got < room) { break; }  // Stream timeout
+    }
+#else
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
 #ifdef TINY_GSM_USE_HEX
@@ -396,6 +421,7 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
 #endif
       sockets[mux]->rx.put(c);
     }
+#endif
     // DBG("### READ:", len_requested, "from", mux);
     // sockets[mux]->sock_available = modemGetAvailable(mux);
     sockets[mux]->sock_available = len_confirmed;
@@ -449,90 +475,8 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
     data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        // putchar(a);
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
-          int8_t mode = streamGetIntBefore(',');
-          if (mode == 1) {
-            int8_t mux = streamGetIntBefore('\n');
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->got_data = true;
-            }
-            data = "";
-            // DBG("### Got Data:", mux);
-          } else {
-            data += mode;
-          }
-        } else if (data.endsWith(GF(GSM_NL "+RECEIVE:"))) {
-          int8_t  mux = streamGetIntBefore(',');
-          int16_t len = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->got_data = true;
-            if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
-          }
-          data = "";
-          // DBG("### Got Data:", len, "on", mux);
-        } else if (data.endsWith(GF("+IPCLOSE:"))) {
-          int8_t mux = streamGetIntBefore(',');
-          streamSkipUntil('\n');  // Skip the reason code
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        } else if (data.endsWith(GF("+CIPEVENT:"))) {
-          // Need to close all open sockets and release the network library.
-          // User will then need to reconnect.
-          DBG("### Network error!");
-          if (!isGprsConnected()) { gprsDisconnect(); }
-          data = "";
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
-    }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    return waitResponseImpl(timeout_ms, &data, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
@@ -544,8 +488,8 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    // No caller buffer: match without touching the heap
+    return waitResponseImpl(timeout_ms, NULL, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -560,7 +504,6 @@ class TinyGsmA7670 :  public TinyGsmA76xx<TinyGsmA7670>,
     return waitResponse(1000, r1, r2, r3, r4, r5);
   }
 
-
  protected:
   GsmClientA7670* sockets[TINY_GSM_MUX_COUNT];
 };
@@ -26,6 +26,7 @@
 #include "TinyGsmGPS_EX.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmEmail.tpp"
+#include "TinyGsmMatcher.h"
 
 #define GSM_NL "\r\n"
 static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
@@ -936,6 +937,109 @@ class TinyGsmA76xx : public TinyGsmModem<TinyGsmA76xx<modemType>>,
     return thisModem().waitResponse(1000, r1, r2, r3, r4, r5);
   }
 
+  /*
+   * Response loop shared by the A7670 and A7608 drivers: the expected
+   * result codes and the socket URCs go through one TinyGsmMatcher, and
+   * data is only filled when the caller asked for it.  Derived classes
+   * need a sockets[] array of TINY_GSM_MUX_COUNT clients.
+   */
+ protected:
+  enum {
+    URC_CIPRXGET = 5,
+    URC_RECEIVE,
+    URC_IPCLOSE,
+    URC_CIPEVENT,
+    URC_COUNT
+  };
+
+  int8_t waitResponseImpl(uint32_t timeout_ms, String* data, GsmConstStr r1,
+                          GsmConstStr r2, GsmConstStr r3, GsmConstStr r4,
+                          GsmConstStr r5) {
+    TinyGsmMatcher<URC_COUNT> match;
+    match.add(r1);
+    match.add(r2);
+    match.add(r3);
+    match.add(r4);
+    match.add(r5);
+    match.add(GF(GSM_NL "+CIPRXGET:"));
+    match.add(GF(GSM_NL "+RECEIVE:"));
+    match.add(GF("+IPCLOSE:"));
+    match.add(GF("+CIPEVENT:"));
+
+    modemType& modem       = thisModem();
+    uint8_t    index       = 0;
+    uint32_t   startMillis = millis();
+    do {
+      TINY_GSM_YIELD();
+      while (stream.available() > 0) {
+        TINY_GSM_YIELD();
+        int8_t a = stream.read();
+        // putchar(a);
+        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
+        if (data) { *data += static_cast<char>(a); }
+        int8_t hit = match.push(a);
+        if (hit < 0) { continue; }
+        if (hit < URC_CIPRXGET) {
+#if defined TINY_GSM_DEBUG
+          if (hit == 2 && r3 == GFP(GSM_CME_ERROR)) {
+            modem.streamSkipUntil('\n');  // Read out the error
+          }
+#endif
+          index = hit + 1;
+          goto finish;
+        } else if (hit == URC_CIPRXGET) {
+          int8_t mode = modem.streamGetIntBefore(',');
+          if (mode == 1) {
+            int8_t mux = modem.streamGetIntBefore('\n');
+            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && modem.sockets[mux]) {
+              modem.sockets[mux]->got_data = true;
+            }
+            if (data) { *data = ""; }
+            match.reset();
+            // DBG("### Got Data:", mux);
+          } else if (data) {
+            *data += mode;
+          }
+        } else if (hit == URC_RECEIVE) {
+          int8_t  mux = modem.streamGetIntBefore(',');
+          int16_t len = modem.streamGetIntBefore('\n');
+          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && modem.sockets[mux]) {
+            modem.sockets[mux]->got_data = true;
+            if (len >= 0 && len <= 1024) { modem.sockets[mux]->sock_available = len; }
+          }
+          if (data) { *data = ""; }
+          match.reset();
+          // DBG("### Got Data:", len, "on", mux);
+        } else if (hit == URC_IPCLOSE) {
+          int8_t mux = modem.streamGetIntBefore(',');
+          modem.streamSkipUntil('\n');  // Skip the reason code
+          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && modem.sockets[mux]) {
+            modem.sockets[mux]->sock_connected = false;
+          }
+          if (data) { *data = ""; }
+          match.reset();
+          DBG("### Closed: ", mux);
+        } else if (hit == URC_CIPEVENT) {
+          // Need to close all open sockets and release the network library.
+          // User will then need to reconnect.
+          DBG("### Network error!");
+          if (!modem.isGprsConnected()) { modem.gprsDisconnect(); }
+          if (data) { *data = ""; }
+          match.reset();
+        }
+      }
+    } while (millis() - startMillis < timeout_ms);
+  finish:
+    if (!index && data) {
+      data->trim();
+      if (data->length()) { DBG("### Unhandled:", *data); }
+      *data = "";
+    }
+    // data.replace(GSM_NL, "/");
+    // DBG('<', index, '>', data);
+    return index;
+  }
+
  public:
   Stream& stream;
 
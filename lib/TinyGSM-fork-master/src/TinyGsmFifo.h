@@ -138,4 +138,177 @@ private:
     int  _r;
 };
 
+#if !defined(__AVR__) && __cplusplus >= 201103L
+#include <atomic>
+#include <string.h>
+
+#define TINY_GSM_HAS_SPSC_FIFO
+
+// Single producer / single consumer variant of TinyGsmFifo.
+//
+// One context (e.g. a UART task or ISR) may write while another reads
+// without locks: the write index is only stored by the producer and the
+// read index only by the consumer, each published with release ordering and
+// observed with acquire ordering.  Indices run freely and are masked, so
+// all N slots are usable and N must be a power of two.
+//
+// Besides the TinyGsmFifo API, writeSpan()/commit() and readSpan()/consume()
+// expose the contiguous free / filled region so callers can readBytes()
+// straight into the buffer.
+template <class T, unsigned N>
+class TinyGsmSpscFifo
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0,
+                  "TinyGsmSpscFifo capacity must be a power of two");
+
+public:
+    TinyGsmSpscFifo()
+    {
+        clear();
+    }
+
+    // Only valid while the producer is idle
+    void clear()
+    {
+        _w.store(0, std::memory_order_relaxed);
+        _r.store(0, std::memory_order_release);
+    }
+
+    // writing thread/context API
+    //-------------------------------------------------------------
+
+    bool writeable(void)
+    {
+        return free() > 0;
+    }
+
+    int free(void)
+    {
+        unsigned w = _w.load(std::memory_order_relaxed);
+        unsigned r = _r.load(std::memory_order_acquire);
+        return N - (w - r);
+    }
+
+    bool put(const T& c)
+    {
+        unsigned w = _w.load(std::memory_order_relaxed);
+        if (w - _r.load(std::memory_order_acquire) == N) // !writeable()
+            return false;
+        _b[w & (N - 1)] = c;
+        _w.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    int put(const T* p, int n, bool t = false)
+    {
+        int c = n;
+        while (c)
+        {
+            size_t f;
+            T* span;
+            while ((span = writeSpan(f)) == NULL) // wait for space
+            {
+                if (!t) return n - c; // no more space and not blocking
+                /* nothing / just wait */;
+            }
+            if ((size_t)c < f) f = c;
+            memcpy(span, p, f * sizeof(T));
+            commit(f);
+            c -= f;
+            p += f;
+        }
+        return n - c;
+    }
+
+    // Contiguous free region after the write index, NULL when full
+    T* writeSpan(size_t& n)
+    {
+        unsigned w = _w.load(std::memory_order_relaxed);
+        unsigned f = N - (w - _r.load(std::memory_order_acquire));
+        unsigned m = N - (w & (N - 1));
+        n = f < m ? f : m;
+        return n ? &_b[w & (N - 1)] : NULL;
+    }
+
+    // Publish n elements written through writeSpan()
+    void commit(size_t n)
+    {
+        _w.store(_w.load(std::memory_order_relaxed) + n,
+                 std::memory_order_release);
+    }
+
+    // reading thread/context API
+    // --------------------------------------------------------
+
+    bool readable(void)
+    {
+        return size() != 0;
+    }
+
+    size_t size(void)
+    {
+        return _w.load(std::memory_order_acquire) -
+               _r.load(std::memory_order_relaxed);
+    }
+
+    bool get(T* p)
+    {
+        unsigned r = _r.load(std::memory_order_relaxed);
+        if (r == _w.load(std::memory_order_acquire)) // !readable()
+            return false;
+        *p = _b[r & (N - 1)];
+        _r.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    int get(T* p, int n, bool t = false)
+    {
+        int c = n;
+        while (c)
+        {
+            size_t f;
+            const T* span;
+            while ((span = readSpan(f)) == NULL) // wait for data
+            {
+                if (!t) return n - c; // no data and not blocking
+                /* nothing / just wait */;
+            }
+            if ((size_t)c < f) f = c;
+            memcpy(p, span, f * sizeof(T));
+            consume(f);
+            c -= f;
+            p += f;
+        }
+        return n - c;
+    }
+
+    // Contiguous filled region after the read index, NULL when empty
+    const T* readSpan(size_t& n)
+    {
+        unsigned r = _r.load(std::memory_order_relaxed);
+        unsigned s = _w.load(std::memory_order_acquire) - r;
+        unsigned m = N - (r & (N - 1));
+        n = s < m ? s : m;
+        return n ? &_b[r & (N - 1)] : NULL;
+    }
+
+    // Release n elements read through readSpan()
+    void consume(size_t n)
+    {
+        _r.store(_r.load(std::memory_order_relaxed) + n,
+                 std::memory_order_release);
+    }
+
+    T peek()
+    {
+        return _b[_r.load(std::memory_order_relaxed) & (N - 1)];
+    }
+
+private:
+    T                     _b[N];
+    std::atomic<unsigned> _w;
+    std::atomic<unsigned> _r;
+};
+#endif
+
 #endif
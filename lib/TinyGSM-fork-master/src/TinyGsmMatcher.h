@@ -0,0 +1,118 @@
+/**
+ * @file       TinyGsmMatcher.h
+ * @license    LGPL-3.0
+ * @date       Oct 2026
+ *
+ * Allocation free response matcher for waitResponse().
+ *
+ * Keeps the last TINY_GSM_MATCH_WINDOW received bytes in a fixed ring and
+ * reports which registered pattern (expected result codes first, then URC
+ * prefixes) the stream currently ends with.  A pattern is only compared when
+ * the incoming byte equals its last character, so the per-byte cost is a
+ * handful of char compares instead of one String::endsWith() per pattern on
+ * an ever growing heap String.
+ */
+
+#ifndef SRC_TINYGSMMATCHER_H_
+#define SRC_TINYGSMMATCHER_H_
+
+#include "TinyGsmCommon.h"
+
+#ifndef TINY_GSM_MATCH_WINDOW
+#define TINY_GSM_MATCH_WINDOW 64
+#endif
+
+template <uint8_t MAX_PATTERNS, uint8_t WINDOW = TINY_GSM_MATCH_WINDOW>
+class TinyGsmMatcher {
+  static_assert(WINDOW && !(WINDOW & (WINDOW - 1)),
+                "TinyGsmMatcher window must be a power of two");
+
+ public:
+  TinyGsmMatcher() : _count(0), _pos(0), _len(0) {}
+
+  /*
+   * Register a pattern.  NULL patterns are kept as never-matching slots so
+   * that pattern indices stay aligned with the r1..r5 argument order.
+   * Patterns longer than the window are matched on their last WINDOW bytes.
+   */
+  int8_t add(GsmConstStr pattern) {
+    if (_count >= MAX_PATTERNS) { return -1; }
+    Pattern& p = _patterns[_count];
+    p.str      = reinterpret_cast<const char*>(pattern);
+    p.len      = 0;
+    p.skip     = 0;
+    p.last     = 0;
+    if (p.str) {
+      size_t n = patLen(p.str);
+      p.len    = n > WINDOW ? WINDOW : n;
+      p.skip   = n - p.len;
+      if (n) { p.last = patChar(p.str, n - 1); }
+    }
+    return _count++;
+  }
+
+  // Forget received bytes (e.g. after a URC has been consumed)
+  void reset() {
+    _pos = 0;
+    _len = 0;
+  }
+
+  /*
+   * Feed one byte.  Returns the index of the first registered pattern the
+   * stream now ends with, or -1.
+   */
+  int8_t push(char c) {
+    _buf[_pos] = c;
+    _pos       = (_pos + 1) & (WINDOW - 1);
+    if (_len < WINDOW) { _len++; }
+
+    for (uint8_t i = 0; i < _count; i++) {
+      const Pattern& p = _patterns[i];
+      if (!p.len || p.last != c || p.len > _len) { continue; }
+      if (endsWith(p)) { return i; }
+    }
+    return -1;
+  }
+
+ private:
+  struct Pattern {
+    const char* str;
+    uint8_t     len;
+    size_t      skip;
+    char        last;
+  };
+
+#if defined(__AVR__) && !defined(__AVR_ATmega4809__)
+  static size_t patLen(const char* s) {
+    return strlen_P(s);
+  }
+  static char patChar(const char* s, size_t i) {
+    return pgm_read_byte(s + i);
+  }
+#else
+  static size_t patLen(const char* s) {
+    return strlen(s);
+  }
+  static char patChar(const char* s, size_t i) {
+    return s[i];
+  }
+#endif
+
+  bool endsWith(const Pattern& p) const {
+    // Last byte already matched by the caller
+    uint8_t at = (_pos - 2) & (WINDOW - 1);
+    for (int16_t i = p.len - 2; i >= 0; i--) {
+      if (_buf[at] != patChar(p.str, p.skip + i)) { return false; }
+      at = (at - 1) & (WINDOW - 1);
+    }
+    return true;
+  }
+
+  Pattern _patterns[MAX_PATTERNS];
+  uint8_t _count;
+  char    _buf[WINDOW];
+  uint8_t _pos;
+  uint8_t _len;
+};
+
+#endif  // SRC_TINYGSMMATCHER_H_
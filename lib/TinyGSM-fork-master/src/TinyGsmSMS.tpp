@@ -10,6 +10,7 @@
 #define SRC_TINYGSMSMS_H_
 
 #include "TinyGsmCommon.h"
+#include "TinyGsmSmsPdu.h"
 
 #define TINY_GSM_MODEM_HAS_SMS
 
@@ -28,6 +29,10 @@ class TinyGsmSMS {
   bool sendSMS_UTF16(const char* const number, const void* text, size_t len) {
     return thisModem().sendSMS_UTF16Impl(number, text, len);
   }
+  // UTF-8 text in PDU mode: GSM-7 or UCS-2, split into parts when needed
+  bool sendSMS_PDU(const char* const number, const char* text) {
+    return thisModem().sendSMS_PDUImpl(number, text);
+  }
 
   /*
    * CRTP Helper
@@ -202,19 +207,55 @@ class TinyGsmSMS {
     return UTF8Print(thisModem().stream);
   }
 
+  bool sendSMS_PDUImpl(const char* const number, const char* text) {
+    static uint8_t ref = 0;
+    TinyGsmSmsPdu  pdu;
+    uint8_t        parts = pdu.begin(number, text, ++ref);
+    if (!parts) { return false; }
+
+    thisModem().sendAT(GF("+CMGF=0"));
+    if (thisModem().waitResponse() != 1) { return false; }
+
+    bool ok = true;
+    char hex[TINY_GSM_PDU_HEX_MAX];
+    for (uint8_t i = 0; i < parts && ok; i++) {
+      uint16_t len = pdu.encode(i, hex, sizeof(hex));
+      thisModem().sendAT(GF("+CMGS="), len);
+      if (thisModem().waitResponse(GF(">")) != 1) {
+        ok = false;
+        break;
+      }
+      // Whole segment in one write instead of a print() per byte
+      thisModem().stream.write(reinterpret_cast<const uint8_t*>(hex),
+                               strlen(hex));
+      thisModem().stream.write(static_cast<char>(0x1A));
+      thisModem().stream.flush();
+      ok = thisModem().waitResponse(60000L) == 1;
+    }
+
+    // Other helpers expect text mode
+    thisModem().sendAT(GF("+CMGF=1"));
+    thisModem().waitResponse();
+    return ok;
+  }
+
   bool sendSMS_UTF16Impl(const char* const number, const void* text,
                          size_t len) {
     if (!sendSMS_UTF8_begin(number)) { return false; }
 
-    uint16_t* t =
-        const_cast<uint16_t*>(reinterpret_cast<const uint16_t*>(text));
+    static const char digits[] = "0123456789ABCDEF";
+    const uint16_t*   t = reinterpret_cast<const uint16_t*>(text);
+    char              buf[64];
+    size_t            n = 0;
     for (size_t i = 0; i < len; i++) {
-      uint8_t c = t[i] >> 8;
-      if (c < 0x10) { thisModem().stream.print('0'); }
-      thisModem().stream.print(c, HEX);
-      c = t[i] & 0xFF;
-      if (c < 0x10) { thisModem().stream.print('0'); }
-      thisModem().stream.print(c, HEX);
+      buf[n++] = digits[t[i] >> 12];
+      buf[n++] = digits[(t[i] >> 8) & 0x0F];
+      buf[n++] = digits[(t[i] >> 4) & 0x0F];
+      buf[n++] = digits[t[i] & 0x0F];
+      if (n == sizeof(buf) || i + 1 == len) {
+        thisModem().stream.write(reinterpret_cast<const uint8_t*>(buf), n);
+        n = 0;
+      }
     }
 
     return sendSMS_UTF8_end();
@@ -0,0 +1,294 @@
+/**
+ * @file       TinyGsmSmsPdu.h
+ * @license    LGPL-3.0
+ * @date       Oct 2026
+ *
+ * SMS-SUBMIT PDU encoder (3GPP TS 23.040 / 23.038).
+ *
+ * Takes UTF-8 text and picks the GSM 7-bit default alphabet when every
+ * character is representable (extension table included), UCS-2 otherwise.
+ * Texts longer than one SMS are split into concatenated segments with an
+ * 8-bit reference UDH (153 septets / 67 UCS-2 units per part); escape
+ * pairs and surrogate pairs are never split across parts.
+ *
+ * begin() only measures the text and records where each segment starts,
+ * encode() then writes one segment as a hex string into a caller buffer,
+ * ready to be sent after AT+CMGS=<length> in one write.
+ */
+
+#ifndef SRC_TINYGSMSMSPDU_H_
+#define SRC_TINYGSMSMSPDU_H_
+
+#include "TinyGsmCommon.h"
+
+#ifndef TINY_GSM_PDU_MAX_SEGMENTS
+#define TINY_GSM_PDU_MAX_SEGMENTS 6
+#endif
+
+// SCA + TPDU octets: first octet, MR, DA (20 digits), PID, DCS, UDL, UD
+#define TINY_GSM_PDU_MAX_OCTETS (1 + 1 + 1 + 12 + 1 + 1 + 1 + 140)
+#define TINY_GSM_PDU_HEX_MAX (TINY_GSM_PDU_MAX_OCTETS * 2 + 1)
+
+class TinyGsmSmsPdu {
+ public:
+  TinyGsmSmsPdu() : _number(NULL), _text(NULL), _segments(0), _ucs2(false) {}
+
+  /*
+   * Measure text and plan its segments.  number may start with '+' for
+   * international format.  Both strings must stay valid until the last
+   * encode().  Returns the number of segments, 0 if the text is too long
+   * for TINY_GSM_PDU_MAX_SEGMENTS or the number is invalid.
+   */
+  uint8_t begin(const char* number, const char* text, uint8_t ref) {
+    _number   = number;
+    _text     = text;
+    _ref      = ref;
+    _segments = 0;
+
+    uint8_t digits = 0;
+    for (const char* p = number; *p; p++) {
+      if (*p == '+' && p == number) { continue; }
+      if (*p < '0' || *p > '9' || ++digits > 20) { return 0; }
+    }
+    if (!digits) { return 0; }
+
+    // Pass 1: alphabet and total length
+    _ucs2          = false;
+    uint16_t total = 0;
+    for (const char* p = text; *p;) {
+      uint32_t cp = nextCodepoint(p);
+      if (gsm7Code(cp) < 0) {
+        _ucs2 = true;
+        break;
+      }
+      total += cost(cp);
+    }
+    if (_ucs2) {
+      total = 0;
+      for (const char* p = text; *p;) { total += cost(nextCodepoint(p)); }
+    }
+
+    const uint16_t single = _ucs2 ? 70 : 160;
+    const uint16_t part   = _ucs2 ? 67 : 153;
+
+    _starts[0] = 0;
+    if (total <= single) {
+      _starts[1] = strlen(text);
+      _segments  = 1;
+      return 1;
+    }
+
+    // Pass 2: segment boundaries in bytes
+    uint16_t    used = 0;
+    const char* p    = text;
+    while (*p) {
+      const char* at = p;
+      uint8_t     c  = cost(nextCodepoint(p));
+      if (used + c > part) {
+        if (++_segments >= TINY_GSM_PDU_MAX_SEGMENTS) {
+          _segments = 0;
+          return 0;
+        }
+        _starts[_segments] = at - text;
+        used               = 0;
+      }
+      used += c;
+    }
+    _segments++;
+    _starts[_segments] = p - text;
+    return _segments;
+  }
+
+  uint8_t segments() const {
+    return _segments;
+  }
+  bool ucs2() const {
+    return _ucs2;
+  }
+
+  /*
+   * Write segment index (0-based) as hex into out, NUL terminated.
+   * Returns the TPDU length in octets for AT+CMGS, 0 on error.
+   */
+  uint16_t encode(uint8_t index, char* out, size_t size) {
+    if (index >= _segments || size < TINY_GSM_PDU_HEX_MAX) { return 0; }
+
+    uint8_t  pdu[TINY_GSM_PDU_MAX_OCTETS];
+    uint16_t n      = 0;
+    bool     concat = _segments > 1;
+
+    pdu[n++] = 0x00;                   // SCA: use the SIM's SMSC
+    pdu[n++] = concat ? 0x41 : 0x01;   // SMS-SUBMIT, UDHI when concatenated
+    pdu[n++] = 0x00;                   // TP-MR, set by the modem
+
+    // TP-DA: digit count, type, swapped BCD digits padded with F
+    const char* num  = _number;
+    bool        intl = *num == '+';
+    if (intl) { num++; }
+    uint8_t digits = strlen(num);
+    pdu[n++]       = digits;
+    pdu[n++]       = intl ? 0x91 : 0x81;
+    for (uint8_t i = 0; i < digits; i += 2) {
+      uint8_t lo = num[i] - '0';
+      uint8_t hi = i + 1 < digits ? num[i + 1] - '0' : 0x0F;
+      pdu[n++]   = (hi << 4) | lo;
+    }
+
+    pdu[n++] = 0x00;                   // TP-PID
+    pdu[n++] = _ucs2 ? 0x08 : 0x00;    // TP-DCS
+
+    uint16_t udlAt = n++;
+    uint16_t udAt  = n;
+
+    uint8_t udhOctets = 0;
+    if (concat) {
+      pdu[n++]  = 0x05;                // UDHL
+      pdu[n++]  = 0x00;                // IEI: concatenation, 8-bit ref
+      pdu[n++]  = 0x03;
+      pdu[n++]  = _ref;
+      pdu[n++]  = _segments;
+      pdu[n++]  = index + 1;
+      udhOctets = 6;
+    }
+
+    const char* p   = _text + _starts[index];
+    const char* end = _text + _starts[index + 1];
+
+    if (_ucs2) {
+      while (p < end) {
+        uint32_t cp = nextCodepoint(p);
+        if (cp > 0xFFFF) {
+          cp -= 0x10000;
+          putUnit(pdu, n, 0xD800 | (cp >> 10));
+          putUnit(pdu, n, 0xDC00 | (cp & 0x3FF));
+        } else {
+          putUnit(pdu, n, cp);
+        }
+      }
+      pdu[udlAt] = n - udAt;
+    } else {
+      // Septets continue after the UDH, padded to a septet boundary
+      uint16_t bit     = udhOctets * 8;
+      uint16_t septets = (bit + 6) / 7;
+      bit              = septets * 7;
+      memset(&pdu[udAt + udhOctets], 0, sizeof(pdu) - udAt - udhOctets);
+      while (p < end) {
+        int16_t code = gsm7Code(nextCodepoint(p));
+        if (code > 0x7F) {
+          putSeptet(pdu, udAt, bit, 0x1B);
+          septets++;
+        }
+        putSeptet(pdu, udAt, bit, code & 0x7F);
+        septets++;
+      }
+      pdu[udlAt] = septets;
+      n          = udAt + (bit + 7) / 8;
+    }
+
+    static const char digitsHex[] = "0123456789ABCDEF";
+    for (uint16_t i = 0; i < n; i++) {
+      out[2 * i]     = digitsHex[pdu[i] >> 4];
+      out[2 * i + 1] = digitsHex[pdu[i] & 0x0F];
+    }
+    out[2 * n] = '\0';
+    return n - 1;  // AT+CMGS counts the TPDU only, without the SCA octet
+  }
+
+  /*
+   * GSM 7-bit code of a Unicode code point: 0x00-0x7F for the default
+   * alphabet, 0x100 | code for the extension table, -1 if unavailable.
+   */
+  static int16_t gsm7Code(uint32_t cp) {
+    if (cp == '\n' || cp == '\r') { return cp; }
+    if (cp >= 0x20 && cp < 0x7F) {
+      switch (cp) {
+        case '@': return 0x00;
+        case '$': return 0x02;
+        case '_': return 0x11;
+        case '`': return -1;
+        case '^': return 0x114;
+        case '{': return 0x128;
+        case '}': return 0x129;
+        case '\\': return 0x12F;
+        case '[': return 0x13C;
+        case '~': return 0x13D;
+        case ']': return 0x13E;
+        case '|': return 0x140;
+        default: return cp;
+      }
+    }
+
+    static const uint16_t basic[][2] = {
+        {0x00A3, 0x01}, {0x00A5, 0x03}, {0x00E8, 0x04}, {0x00E9, 0x05},
+        {0x00F9, 0x06}, {0x00EC, 0x07}, {0x00F2, 0x08}, {0x00C7, 0x09},
+        {0x00D8, 0x0B}, {0x00F8, 0x0C}, {0x00C5, 0x0E}, {0x00E5, 0x0F},
+        {0x0394, 0x10}, {0x03A6, 0x12}, {0x0393, 0x13}, {0x039B, 0x14},
+        {0x03A9, 0x15}, {0x03A0, 0x16}, {0x03A8, 0x17}, {0x03A3, 0x18},
+        {0x0398, 0x19}, {0x039E, 0x1A}, {0x00C6, 0x1C}, {0x00E6, 0x1D},
+        {0x00DF, 0x1E}, {0x00C9, 0x1F}, {0x00A4, 0x24}, {0x00A1, 0x40},
+        {0x00C4, 0x5B}, {0x00D6, 0x5C}, {0x00D1, 0x5D}, {0x00DC, 0x5E},
+        {0x00A7, 0x5F}, {0x00BF, 0x60}, {0x00E4, 0x7B}, {0x00F6, 0x7C},
+        {0x00F1, 0x7D}, {0x00FC, 0x7E}, {0x00E0, 0x7F}, {0x20AC, 0x165},
+    };
+    for (size_t i = 0; i < sizeof(basic) / sizeof(basic[0]); i++) {
+      if (basic[i][0] == cp) { return basic[i][1]; }
+    }
+    return -1;
+  }
+
+  // Decode one UTF-8 sequence and advance p; invalid bytes map to '?'
+  static uint32_t nextCodepoint(const char*& p) {
+    uint8_t b = *p++;
+    if (b < 0x80) { return b; }
+
+    uint8_t  extra;
+    uint32_t cp;
+    if ((b & 0xE0) == 0xC0) {
+      extra = 1;
+      cp    = b & 0x1F;
+    } else if ((b & 0xF0) == 0xE0) {
+      extra = 2;
+      cp    = b & 0x0F;
+    } else if ((b & 0xF8) == 0xF0) {
+      extra = 3;
+      cp    = b & 0x07;
+    } else {
+      return '?';
+    }
+    while (extra--) {
+      if ((*p & 0xC0) != 0x80) { return '?'; }
+      cp = (cp << 6) | (*p++ & 0x3F);
+    }
+    return cp;
+  }
+
+ private:
+  // Septets or UTF-16 units of one code point in the chosen alphabet
+  uint8_t cost(uint32_t cp) const {
+    if (_ucs2) { return cp > 0xFFFF ? 2 : 1; }
+    return gsm7Code(cp) > 0x7F ? 2 : 1;
+  }
+
+  static void putUnit(uint8_t* pdu, uint16_t& n, uint16_t unit) {
+    pdu[n++] = unit >> 8;
+    pdu[n++] = unit & 0xFF;
+  }
+
+  static void putSeptet(uint8_t* ud, uint16_t udAt, uint16_t& bit,
+                        uint8_t septet) {
+    uint16_t byte  = udAt + bit / 8;
+    uint8_t  shift = bit % 8;
+    ud[byte] |= septet << shift;
+    if (shift > 1) { ud[byte + 1] |= septet >> (8 - shift); }
+    bit += 7;
+  }
+
+  const char* _number;
+  const char* _text;
+  uint8_t     _ref;
+  uint8_t     _segments;
+  bool        _ucs2;
+  uint16_t    _starts[TINY_GSM_PDU_MAX_SEGMENTS + 1];
+};
+
+#endif  // SRC_TINYGSMSMSPDU_H_
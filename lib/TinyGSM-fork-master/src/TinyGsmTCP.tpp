@@ -23,6 +23,13 @@
 #endif
 #endif
 
+// Define TINY_GSM_RX_SPSC to back each socket with the lock-free
+// TinyGsmSpscFifo so it can be filled from a dedicated UART task.
+// TINY_GSM_RX_BUFFER must then be a power of two.
+#if defined(TINY_GSM_RX_SPSC) && !defined(TINY_GSM_HAS_SPSC_FIFO)
+#error "TINY_GSM_RX_SPSC needs <atomic>, not available on this platform"
+#endif
+
 enum GsmClientConnType { TINYGSM_TCP, TINYGSM_SSL, TINYGSM_WEBSOCKET };
 
 // Because of the ordering of resolution of overrides in templates, these need
@@ -75,7 +82,11 @@ class TinyGsmTCP {
   class GsmClient : public Client {
     // Make all classes created from the modem template friends
     friend class TinyGsmTCP<modemType, muxCount>;
+#if defined(TINY_GSM_RX_SPSC)
+    typedef TinyGsmSpscFifo<uint8_t, TINY_GSM_RX_BUFFER> RxFifo;
+#else
     typedef TinyGsmFifo<uint8_t, TINY_GSM_RX_BUFFER> RxFifo;
+#endif
 
    public:
     // bool init(modemType* modem, uint8_t);
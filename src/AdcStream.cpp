@@ -0,0 +1,135 @@
+#include "AdcStream.h"
+
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+
+// Default Vref for chips without eFuse calibration
+#define ADC_DEFAULT_VREF 1100
+
+AdcStream::AdcStream()
+  : _pinA(0), _pinB(0), _chA(-1), _chB(-1), _continuous(false),
+    _calName("none"), _batches(0), _samples(0), _overflows(0), _busyUs(0),
+    _lastBatchUs(0), _lastBatchSamples(0) {}
+
+bool AdcStream::begin(uint8_t pinA, uint8_t pinB, uint32_t sampleHz) {
+  _pinA = pinA;
+  _pinB = pinB;
+  _chA = digitalPinToAnalogChannel(pinA);
+  _chB = digitalPinToAnalogChannel(pinB);
+
+  // Continuous mode on the ESP32 only drives ADC1 (channels 0-7)
+  if (_chA < 0 || _chA > 7 || _chB < 0 || _chB > 7) {
+    Serial.println("❌ ADC stream: pins are not on ADC1, using analogRead");
+    return false;
+  }
+
+  esp_adc_cal_characteristics_t chars;
+  esp_adc_cal_value_t source = esp_adc_cal_characterize(
+    ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, ADC_DEFAULT_VREF, &chars);
+  switch (source) {
+    case ESP_ADC_CAL_VAL_EFUSE_TP:   _calName = "eFuse two-point"; break;
+    case ESP_ADC_CAL_VAL_EFUSE_VREF: _calName = "eFuse Vref";      break;
+    default:                         _calName = "default Vref";    break;
+  }
+  for (uint16_t raw = 0; raw < 4096; raw++) {
+    _mvLut[raw] = esp_adc_cal_raw_to_voltage(raw, &chars);
+  }
+
+  adc_digi_init_config_t init = {};
+  init.max_store_buf_size = ADC_STREAM_POOL;
+  init.conv_num_each_intr = ADC_STREAM_FRAME;
+  init.adc1_chan_mask = BIT(_chA) | BIT(_chB);
+  init.adc2_chan_mask = 0;
+  if (adc_digi_initialize(&init) != ESP_OK) {
+    Serial.println("❌ ADC stream: driver init failed, using analogRead");
+    return false;
+  }
+
+  adc_digi_pattern_config_t pattern[2] = {};
+  int8_t channels[2] = {_chA, _chB};
+  for (uint8_t i = 0; i < 2; i++) {
+    pattern[i].atten = ADC_ATTEN_DB_11;
+    pattern[i].channel = channels[i];
+    pattern[i].unit = 0;     // ADC1
+    pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+  }
+
+  adc_digi_configuration_t config = {};
+  config.conv_limit_en = 1;  // Required on the ESP32
+  config.conv_limit_num = 250;
+  config.pattern_num = 2;
+  config.adc_pattern = pattern;
+  config.sample_freq_hz = sampleHz;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+  if (adc_digi_controller_configure(&config) != ESP_OK ||
+      adc_digi_start() != ESP_OK) {
+    adc_digi_deinitialize();
+    Serial.println("❌ ADC stream: start failed, using analogRead");
+    return false;
+  }
+
+  _continuous = true;
+  Serial.printf("✓ ADC stream: %lu Hz, calibration: %s\n",
+    (unsigned long)sampleHz, _calName);
+  return true;
+}
+
+bool AdcStream::readContinuous(uint32_t &sumA, uint32_t &nA,
+                               uint32_t &sumB, uint32_t &nB) {
+  for (;;) {
+    uint32_t got = 0;
+    esp_err_t err = adc_digi_read_bytes(_frame, sizeof(_frame), &got, 0);
+
+    // INVALID_STATE: the driver ring overflowed, but data is still returned
+    if (err == ESP_ERR_INVALID_STATE) {
+      _overflows++;
+    } else if (err != ESP_OK) {
+      break;
+    }
+    if (!got) break;
+
+    // One table lookup per conversion, no per-sample calibration math
+    const adc_digi_output_data_t *out = (const adc_digi_output_data_t *)_frame;
+    uint32_t count = got / SOC_ADC_DIGI_RESULT_BYTES;
+    for (uint32_t i = 0; i < count; i++) {
+      uint16_t mv = _mvLut[out[i].type1.data];
+      uint8_t ch = out[i].type1.channel;
+      if (ch == _chA) {
+        sumA += mv;
+        nA++;
+      } else if (ch == _chB) {
+        sumB += mv;
+        nB++;
+      }
+    }
+
+    if (got < sizeof(_frame)) break;
+  }
+  return nA || nB;
+}
+
+bool AdcStream::read(uint16_t &mvA, uint16_t &mvB) {
+  uint32_t start = micros();
+  uint32_t sumA = 0, nA = 0, sumB = 0, nB = 0;
+
+  if (_continuous) {
+    readContinuous(sumA, nA, sumB, nB);
+  } else {
+    sumA = analogReadMilliVolts(_pinA);
+    sumB = analogReadMilliVolts(_pinB);
+    nA = nB = 1;
+  }
+
+  if (nA) mvA = sumA / nA;
+  if (nB) mvB = sumB / nB;
+
+  uint32_t elapsed = micros() - start;
+  _batches++;
+  _samples += nA + nB;
+  _busyUs += elapsed;
+  _lastBatchUs = elapsed;
+  _lastBatchSamples = nA + nB;
+  return nA || nB;
+}
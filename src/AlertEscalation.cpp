@@ -0,0 +1,189 @@
+#include "AlertEscalation.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+const char *escalationStateName(EscalationState state) {
+  switch (state) {
+    case ESC_IDLE:         return "IDLE";
+    case ESC_WAIT_RETRY:   return "WAIT_RETRY";
+    case ESC_DIALING:      return "DIALING";
+    case ESC_RINGING:      return "RINGING";
+    case ESC_CONNECTED:    return "CONNECTED";
+    case ESC_ACKNOWLEDGED: return "ACKNOWLEDGED";
+  }
+  return "?";
+}
+
+AlertEscalation::AlertEscalation()
+  : _state(ESC_IDLE), _alert(false), _contacts(0), _contact(0), _attempt(0),
+    _totalAttempts(0), _since(0), _dialedAt(0), _nextDialAt(0) {
+  memset(&_config, 0, sizeof(_config));
+  memset(&_actions, 0, sizeof(_actions));
+}
+
+void AlertEscalation::begin(const EscalationConfig &config,
+                            const EscalationActions &actions) {
+  _config = config;
+  _actions = actions;
+  if (_config.maxAttempts == 0) _config.maxAttempts = 1;
+}
+
+bool AlertEscalation::inCall() const {
+  return _state == ESC_DIALING || _state == ESC_RINGING ||
+         _state == ESC_CONNECTED;
+}
+
+void AlertEscalation::enter(EscalationState next, unsigned long now) {
+  if (next == _state) return;
+  EscalationState prev = _state;
+  _state = next;
+  _since = now;
+  if (_actions.stateChanged) _actions.stateChanged(prev, next, now);
+}
+
+void AlertEscalation::setAlert(bool active, uint8_t contacts,
+                               unsigned long now) {
+  _alert = active;
+  _contacts = contacts;
+
+  if (!active || contacts == 0) {
+    if (inCall() && _actions.hangup) _actions.hangup();
+    _contact = 0;
+    _attempt = 0;
+    _totalAttempts = 0;
+    enter(ESC_IDLE, now);
+    return;
+  }
+
+  if (_contact >= _contacts) {
+    _contact = 0;
+    _attempt = 0;
+  }
+
+  if (_state == ESC_IDLE) {
+    _nextDialAt = now;
+    enter(ESC_WAIT_RETRY, now);
+    tick(now);
+  }
+}
+
+void AlertEscalation::startAttempt(unsigned long now) {
+  _dialedAt = now;
+  _totalAttempts++;
+  enter(ESC_DIALING, now);
+
+  if (!_actions.dial || !_actions.dial(_contact, _attempt + 1)) {
+    attemptFailed(now);
+  }
+}
+
+void AlertEscalation::attemptFailed(unsigned long now) {
+  _attempt++;
+  if (_attempt >= _config.maxAttempts) {
+    _attempt = 0;
+    _contact++;
+    if (_contact >= _contacts) _contact = 0;  // Start the ladder over
+  }
+  _nextDialAt = now + _config.retryDelay;
+  enter(ESC_WAIT_RETRY, now);
+}
+
+void AlertEscalation::onCallEvent(CallEvent event, unsigned long now) {
+  switch (event) {
+    case CALL_EVT_DIAL_OK:
+      break;
+
+    case CALL_EVT_DIAL_FAILED:
+      if (_state == ESC_DIALING) attemptFailed(now);
+      break;
+
+    case CALL_EVT_RINGING:
+      if (_state == ESC_DIALING) enter(ESC_RINGING, now);
+      break;
+
+    case CALL_EVT_ANSWERED:
+      if (_state == ESC_DIALING || _state == ESC_RINGING) {
+        enter(ESC_CONNECTED, now);
+      }
+      break;
+
+    case CALL_EVT_ENDED:
+      if (_state == ESC_DIALING || _state == ESC_RINGING) {
+        // Declined, busy or unreachable
+        attemptFailed(now);
+      } else if (_state == ESC_CONNECTED) {
+        // Remote hung up after answering: still acknowledged
+        enter(ESC_ACKNOWLEDGED, now);
+      }
+      break;
+  }
+}
+
+void AlertEscalation::tick(unsigned long now) {
+  switch (_state) {
+    case ESC_IDLE:
+      break;
+
+    case ESC_WAIT_RETRY:
+      if ((long)(now - _nextDialAt) >= 0) startAttempt(now);
+      break;
+
+    case ESC_DIALING:
+      if (now - _dialedAt >= _config.setupTimeout) {
+        if (_actions.hangup) _actions.hangup();
+        attemptFailed(now);
+      }
+      break;
+
+    case ESC_RINGING:
+      if (now - _dialedAt >= _config.callTimeout) {
+        if (_actions.hangup) _actions.hangup();
+        attemptFailed(now);
+      }
+      break;
+
+    case ESC_CONNECTED:
+      if (now - _since >= _config.answerHold) {
+        if (_actions.hangup) _actions.hangup();
+        enter(ESC_ACKNOWLEDGED, now);
+      }
+      break;
+
+    case ESC_ACKNOWLEDGED:
+      // Alert still active after the cooldown: run the ladder again
+      if (_alert && now - _since >= _config.cooldown) {
+        _contact = 0;
+        _attempt = 0;
+        _nextDialAt = now;
+        enter(ESC_WAIT_RETRY, now);
+        startAttempt(now);
+      }
+      break;
+  }
+}
+
+bool clccCallEvent(const char *line, CallEvent &event) {
+  if (strncmp(line, "+CLCC:", 6) != 0) return false;
+
+  // Third field is <stat>
+  const char *p = line + 6;
+  for (uint8_t comma = 0; comma < 2; comma++) {
+    p = strchr(p, ',');
+    if (!p) return false;
+    p++;
+  }
+
+  switch (atoi(p)) {
+    case 0:  // Active
+      event = CALL_EVT_ANSWERED;
+      return true;
+    case 3:  // Alerting: the remote phone rings
+      event = CALL_EVT_RINGING;
+      return true;
+    case 6:  // Disconnected: rejected, busy or ended
+      event = CALL_EVT_ENDED;
+      return true;
+  }
+  return false;
+}
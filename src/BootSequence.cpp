@@ -0,0 +1,127 @@
+#include "BootSequence.h"
+
+#include <string.h>
+
+BootSequence::BootSequence()
+  : _count(0), _events(nullptr), _milestoneCount(0),
+    _mux(portMUX_INITIALIZER_UNLOCKED) {
+  memset(_stages, 0, sizeof(_stages));
+  memset(_milestones, 0, sizeof(_milestones));
+}
+
+int BootSequence::add(const char *name, BootStageFn fn, uint32_t dependsOn,
+                      uint32_t stackSize, BaseType_t core) {
+  if (_count >= BOOT_MAX_STAGES || !fn) return -1;
+
+  Stage &stage = _stages[_count];
+  stage.owner = this;
+  stage.id = _count;
+  stage.name = name;
+  stage.fn = fn;
+  stage.dependsOn = dependsOn;
+  stage.stackSize = stackSize;
+  stage.core = core;
+  return _count++;
+}
+
+bool BootSequence::start() {
+  _events = xEventGroupCreate();
+  if (!_events) return false;
+
+  for (uint8_t i = 0; i < _count; i++) {
+    if (xTaskCreatePinnedToCore(stageEntry, _stages[i].name,
+                                _stages[i].stackSize, &_stages[i], 1,
+                                nullptr, _stages[i].core) != pdPASS) {
+      // Run it here rather than never
+      Serial.printf("⚠ boot: no task for %s, running inline\n",
+        _stages[i].name);
+      runStage(i);
+    }
+  }
+  return true;
+}
+
+void BootSequence::stageEntry(void *arg) {
+  Stage *stage = static_cast<Stage *>(arg);
+  stage->owner->runStage(stage->id);
+  vTaskDelete(nullptr);
+}
+
+void BootSequence::runStage(uint8_t id) {
+  Stage &stage = _stages[id];
+  if (stage.dependsOn) {
+    xEventGroupWaitBits(_events, stage.dependsOn, pdFALSE, pdTRUE,
+                        portMAX_DELAY);
+  }
+
+  stage.startMs = millis();
+  Serial.printf("⏱ boot: %s started at %lu ms\n", stage.name,
+    (unsigned long)stage.startMs);
+
+  stage.fn();
+
+  stage.endMs = millis();
+  Serial.printf("⏱ boot: %s done at %lu ms (%lu ms)\n", stage.name,
+    (unsigned long)stage.endMs,
+    (unsigned long)(stage.endMs - stage.startMs));
+  xEventGroupSetBits(_events, BOOT_BIT(id));
+}
+
+bool BootSequence::done(int id) const {
+  if (!_events || id < 0 || id >= _count) return false;
+  return xEventGroupGetBits(_events) & BOOT_BIT(id);
+}
+
+bool BootSequence::allDone() const {
+  if (!_events) return false;
+  uint32_t all = _count ? BOOT_BIT(_count) - 1 : 0;
+  return (xEventGroupGetBits(_events) & all) == all;
+}
+
+bool BootSequence::wait(int id, uint32_t timeoutMs) {
+  if (!_events || id < 0 || id >= _count) return false;
+  TickType_t ticks = timeoutMs == portMAX_DELAY ? portMAX_DELAY
+                                                : pdMS_TO_TICKS(timeoutMs);
+  return xEventGroupWaitBits(_events, BOOT_BIT(id), pdFALSE, pdTRUE, ticks) &
+         BOOT_BIT(id);
+}
+
+void BootSequence::milestone(const char *name) {
+  uint32_t now = millis();
+  bool added = false;
+
+  portENTER_CRITICAL(&_mux);
+  bool seen = false;
+  for (uint8_t i = 0; i < _milestoneCount; i++) {
+    if (strcmp(_milestones[i].name, name) == 0) seen = true;
+  }
+  if (!seen && _milestoneCount < BOOT_MAX_MILESTONES) {
+    _milestones[_milestoneCount].name = name;
+    _milestones[_milestoneCount].atMs = now;
+    _milestoneCount++;
+    added = true;
+  }
+  portEXIT_CRITICAL(&_mux);
+
+  if (added) {
+    Serial.printf("⏱ boot: %s at %lu ms\n", name, (unsigned long)now);
+  }
+}
+
+void BootSequence::printReport() const {
+  Serial.println("--- Boot timeline (ms since power-up) ---");
+  for (uint8_t i = 0; i < _count; i++) {
+    const Stage &stage = _stages[i];
+    if (done(i)) {
+      Serial.printf("  %-10s %6lu -> %6lu (%lu)\n", stage.name,
+        (unsigned long)stage.startMs, (unsigned long)stage.endMs,
+        (unsigned long)(stage.endMs - stage.startMs));
+    } else {
+      Serial.printf("  %-10s running\n", stage.name);
+    }
+  }
+  for (uint8_t i = 0; i < _milestoneCount; i++) {
+    Serial.printf("  %-10s %6lu\n", _milestones[i].name,
+      (unsigned long)_milestones[i].atMs);
+  }
+}
@@ -0,0 +1,87 @@
+#include "ChunkedResponse.h"
+
+#include <stdarg.h>
+
+ChunkedResponse::ChunkedResponse(WebServer &server)
+  : _server(server), _len(0), _ok(false), _stalled(false), _bytes(0),
+    _chunks(0), _lowestHeap(0) {}
+
+void ChunkedResponse::begin(int code, const char *contentType) {
+  _len = 0;
+  _bytes = 0;
+  _chunks = 0;
+  _lowestHeap = ESP.getFreeHeap();
+  _ok = true;
+  _stalled = false;
+  _server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  _server.send(code, contentType, "");
+}
+
+void ChunkedResponse::write(const char *data, size_t len) {
+  while (_ok && len) {
+    size_t n = CHUNKED_BUFFER_SIZE - _len;
+    if (n > len) n = len;
+    memcpy(_buf + _len, data, n);
+    _len += n;
+    data += n;
+    len -= n;
+    if (_len == CHUNKED_BUFFER_SIZE) flush();
+  }
+}
+
+void ChunkedResponse::print(const char *text) {
+  write(text, strlen(text));
+}
+
+void ChunkedResponse::printf(const char *format, ...) {
+  if (!_ok) return;
+
+  // Rows are short; format straight into the buffer when they fit
+  va_list args;
+  va_start(args, format);
+  size_t room = CHUNKED_BUFFER_SIZE - _len;
+  int n = vsnprintf(_buf + _len, room, format, args);
+  va_end(args);
+  if (n < 0) return;
+
+  if ((size_t)n < room) {
+    _len += n;
+    return;
+  }
+
+  // Did not fit: send what is there and format again into the empty buffer
+  flush();
+  va_start(args, format);
+  n = vsnprintf(_buf, CHUNKED_BUFFER_SIZE, format, args);
+  va_end(args);
+  if (n < 0) return;
+  _len = (size_t)n < CHUNKED_BUFFER_SIZE ? n : CHUNKED_BUFFER_SIZE - 1;
+}
+
+void ChunkedResponse::flush() {
+  if (!_len) return;
+  if (_ok && !_server.client().connected()) _ok = false;
+  if (_ok) {
+    unsigned long start = millis();
+    _server.sendContent(_buf, _len);
+    if (millis() - start > CHUNKED_STALL_MS) {
+      // Blocked in the socket write; give the web task back
+      _server.client().stop();
+      _ok = false;
+      _stalled = true;
+      _len = 0;
+      return;
+    }
+    _bytes += _len;
+    _chunks++;
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < _lowestHeap) _lowestHeap = heap;
+  }
+  _len = 0;
+}
+
+void ChunkedResponse::end() {
+  flush();
+  if (_ok) _server.sendContent("");  // Last, empty chunk
+  _ok = false;
+}
@@ -0,0 +1,439 @@
+#include "Dashboard.h"
+
+#include <Adafruit_ST7789.h>
+
+// Layout of the 240x240 dashboard
+static const int16_t HEADER_H = 28;
+static const int16_t CARD_X[DASH_CARDS] = {5, 125, 5, 125};
+static const int16_t CARD_Y[DASH_CARDS] = {35, 35, 112, 112};
+static const int16_t CARD_W = 110;
+static const int16_t CARD_H = 70;
+static const int16_t STATUS_Y = 189;
+static const int16_t STATUS_H = 32;
+static const uint8_t VALUE_TEXT_SIZE = 3;
+
+// Upper bounds of the histogram buckets in ms, last bucket catches the rest
+static const uint16_t HIST_BOUND_MS[FRAME_HIST_BUCKETS - 1] = {
+  1, 2, 5, 10, 20, 50, 100
+};
+
+static uint16_t cardBg(bool alert) {
+  return alert ? 0x2000 : 0x1082;
+}
+
+// ================== FRAME HISTOGRAM ==================
+
+void FrameHistogram::add(uint32_t us) {
+  uint8_t b = 0;
+  while (b < FRAME_HIST_BUCKETS - 1 && us >= HIST_BOUND_MS[b] * 1000UL) b++;
+  counts[b]++;
+  frames++;
+  totalUs += us;
+  if (us > maxUs) maxUs = us;
+}
+
+void FrameHistogram::reset() {
+  for (uint8_t b = 0; b < FRAME_HIST_BUCKETS; b++) counts[b] = 0;
+  frames = 0;
+  maxUs = 0;
+  totalUs = 0;
+}
+
+void FrameHistogram::print(const char *name) const {
+  if (!frames) return;
+  Serial.printf("%s: n=%lu avg=%luus max=%luus |", name,
+                (unsigned long)frames,
+                (unsigned long)(totalUs / frames),
+                (unsigned long)maxUs);
+  for (uint8_t b = 0; b < FRAME_HIST_BUCKETS; b++) {
+    if (b < FRAME_HIST_BUCKETS - 1) {
+      Serial.printf(" <%u:%lu", HIST_BOUND_MS[b], (unsigned long)counts[b]);
+    } else {
+      Serial.printf(" >=%u:%lu", HIST_BOUND_MS[b - 1],
+                    (unsigned long)counts[b]);
+    }
+  }
+  Serial.println(" (ms)");
+}
+
+// ================== DASHBOARD ==================
+
+Dashboard::Dashboard(CountingST7789 &tft)
+  : _tft(tft), _valid(false), _indicatorColor(0),
+    _lastRegions(0), _lastFull(false),
+    _histMux(portMUX_INITIALIZER_UNLOCKED) {
+  for (uint8_t i = 0; i < DASH_CARDS; i++) {
+    _cards[i].drawn = false;
+    _cards[i].alert = false;
+    _cards[i].valueColor = 0;
+    _cards[i].boxX = 0;
+    _cards[i].boxW = 0;
+  }
+  _status.drawn = false;
+  _cpuHist.reset();
+  _frameHist.reset();
+#ifdef DISPLAY_FRAMEBUFFER
+  for (uint8_t t = 0; t < TILE_COUNT; t++) {
+    _tiles[t] = nullptr;
+    _tileSeq[t] = 0;
+  }
+  _nextCardTile = TILE_CARD_A;
+  _flushQueue = nullptr;
+  _flushTask = nullptr;
+  _submittedSeq = 0;
+  _flushedSeq = 0;
+#endif
+}
+
+void Dashboard::begin() {
+#ifdef DISPLAY_FRAMEBUFFER
+  _tiles[TILE_HEADER] = new GFXcanvas16(240, HEADER_H);
+  _tiles[TILE_CARD_A] = new GFXcanvas16(CARD_W, CARD_H);
+  _tiles[TILE_CARD_B] = new GFXcanvas16(CARD_W, CARD_H);
+  _tiles[TILE_STATUS] = new GFXcanvas16(240, STATUS_H);
+
+  for (uint8_t t = 0; t < TILE_COUNT; t++) {
+    if (!_tiles[t] || !_tiles[t]->getBuffer()) {
+      Serial.println("Dashboard: tile allocation failed, drawing direct");
+      for (uint8_t k = 0; k < TILE_COUNT; k++) {
+        delete _tiles[k];
+        _tiles[k] = nullptr;
+      }
+      return;
+    }
+  }
+
+  // Every tile can be in flight at once, plus the end-of-frame marker
+  _flushQueue = xQueueCreate(TILE_COUNT + 2, sizeof(FlushJob));
+  if (_flushQueue) {
+    // Off the loop() core, so composing the next tiles overlaps the SPI
+    // transfer instead of time-slicing with it
+    xTaskCreatePinnedToCore(flushTaskEntry, "tft_flush", 3072, this, 1,
+                            &_flushTask, 0);
+  }
+  if (!_flushTask) {
+    Serial.println("Dashboard: flush task not started, drawing direct");
+  }
+#endif
+}
+
+void Dashboard::drawChrome() {
+  _tft.fillScreen(0x0000);
+  _tft.drawFastHLine(0, HEADER_H, 240, 0x4208);
+  _tft.drawFastHLine(0, 188, 240, 0x4208);
+}
+
+void Dashboard::drawHeader(Adafruit_GFX &g, int16_t ox, int16_t oy) {
+  g.fillRect(0 - ox, 0 - oy, 240, HEADER_H, 0x0349);
+  g.setTextSize(2);
+  g.setTextColor(ST77XX_WHITE);
+  g.setCursor(20 - ox, 6 - oy);
+  g.print("ENVIRONMENT");
+}
+
+void Dashboard::drawIndicator(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                              uint16_t color) {
+  g.fillCircle(220 - ox, 14 - oy, 5, color);
+  _indicatorColor = color;
+  _lastRegions++;
+}
+
+void Dashboard::drawCardFrame(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                              uint8_t i, const CardView &card) {
+  int16_t x = CARD_X[i] - ox;
+  int16_t y = CARD_Y[i] - oy;
+  uint16_t bgColor = cardBg(card.alert);
+  uint16_t borderColor = card.alert ? ST77XX_RED : 0x4208;
+
+  g.fillRoundRect(x, y, CARD_W, CARD_H, 6, bgColor);
+  g.drawRoundRect(x, y, CARD_W, CARD_H, 6, borderColor);
+
+  g.setTextSize(1);
+  g.setTextColor(0x8410);
+  g.setCursor(x + 6, y + 6);
+  g.print(card.label);
+
+  int16_t x1, y1;
+  uint16_t tw, th;
+  g.setTextColor(0xC618);
+  g.getTextBounds(card.unit, 0, 0, &x1, &y1, &tw, &th);
+  g.setCursor(x + CARD_W - tw - 6, y + CARD_H - th - 6);
+  g.print(card.unit);
+
+  _cards[i].alert = card.alert;
+  _cards[i].drawn = true;
+  _lastRegions++;
+}
+
+void Dashboard::drawCardValue(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                              uint8_t i, const CardView &card,
+                              bool frameRedrawn) {
+  CardCache &cache = _cards[i];
+  if (!frameRedrawn && cache.value == card.value &&
+      cache.valueColor == card.valueColor) {
+    return;
+  }
+
+  int16_t x = CARD_X[i];
+  int16_t y = CARD_Y[i];
+  uint16_t bgColor = cardBg(card.alert);
+
+  int16_t x1, y1;
+  uint16_t tw, th;
+  g.setTextSize(VALUE_TEXT_SIZE);
+  g.getTextBounds(card.value.c_str(), 0, 0, &x1, &y1, &tw, &th);
+  int16_t boxX = x + (CARD_W - tw) / 2;
+  int16_t boxY = y + CARD_H / 2 - 8;
+
+  // Opaque glyphs overwrite the old value without a clear-then-draw flicker
+  g.setTextColor(card.valueColor, bgColor);
+  g.setCursor(boxX - ox, boxY - oy);
+  g.print(card.value);
+
+  // Trim columns of a wider previous value
+  if (!frameRedrawn && cache.boxW) {
+    int16_t oldEnd = cache.boxX + cache.boxW;
+    int16_t newEnd = boxX + tw;
+    int16_t glyphH = 8 * VALUE_TEXT_SIZE;
+    if (cache.boxX < boxX) {
+      g.fillRect(cache.boxX - ox, boxY - oy, boxX - cache.boxX, glyphH,
+                 bgColor);
+    }
+    if (oldEnd > newEnd) {
+      g.fillRect(newEnd - ox, boxY - oy, oldEnd - newEnd, glyphH, bgColor);
+    }
+  }
+
+  cache.value = card.value;
+  cache.valueColor = card.valueColor;
+  cache.boxX = boxX;
+  cache.boxW = tw;
+  _lastRegions++;
+}
+
+void Dashboard::drawStatus(Adafruit_GFX &g, int16_t ox, int16_t oy,
+                           const StatusView &status) {
+  int16_t y = STATUS_Y - oy;
+
+  g.fillRect(0 - ox, y, 240, STATUS_H, status.bgColor);
+  g.setTextSize(2);
+  g.setTextColor(status.textColor);
+  int16_t x1, y1;
+  uint16_t tw, th;
+  g.getTextBounds(status.text, 0, 0, &x1, &y1, &tw, &th);
+  g.setCursor((240 - tw) / 2 - ox, y + 8);
+  g.print(status.text);
+
+  if (status.callDots == CALL_DOTS_ACTIVE) {
+    g.fillCircle(15 - ox, y + 16, 5, ST77XX_ORANGE);
+    g.fillCircle(225 - ox, y + 16, 5, ST77XX_ORANGE);
+  } else if (status.callDots == CALL_DOTS_CONNECTED) {
+    g.fillCircle(15 - ox, y + 16, 5, ST77XX_GREEN);
+    g.fillCircle(225 - ox, y + 16, 5, ST77XX_GREEN);
+  }
+
+  switch (status.decor) {
+    case DECOR_FIRE:
+      g.fillCircle(15 - ox, 205 - oy, 6, ST77XX_YELLOW);
+      g.fillCircle(225 - ox, 205 - oy, 6, ST77XX_YELLOW);
+      break;
+    case DECOR_ALERT:
+      g.drawTriangle(15 - ox, 211 - oy, 20 - ox, 199 - oy, 25 - ox, 211 - oy,
+                     ST77XX_YELLOW);
+      g.drawTriangle(215 - ox, 211 - oy, 220 - ox, 199 - oy, 225 - ox,
+                     211 - oy, ST77XX_YELLOW);
+      break;
+    case DECOR_OK:
+      g.fillCircle(15 - ox, 205 - oy, 4, ST77XX_GREEN);
+      g.fillCircle(225 - ox, 205 - oy, 4, ST77XX_GREEN);
+      break;
+  }
+
+  rememberStatus(status);
+  _lastRegions++;
+}
+
+bool Dashboard::statusChanged(const StatusView &status) const {
+  return !_status.drawn ||
+         _status.text != status.text ||
+         _status.bgColor != status.bgColor ||
+         _status.textColor != status.textColor ||
+         _status.decor != status.decor ||
+         _status.callDots != status.callDots;
+}
+
+void Dashboard::rememberStatus(const StatusView &status) {
+  _status.drawn = true;
+  _status.text = status.text;
+  _status.bgColor = status.bgColor;
+  _status.textColor = status.textColor;
+  _status.decor = status.decor;
+  _status.callDots = status.callDots;
+}
+
+void Dashboard::renderDirect(const DashboardView &view) {
+  if (_lastFull) {
+    drawHeader(_tft, 0, 0);
+  }
+  if (_lastFull || view.indicatorColor != _indicatorColor) {
+    drawIndicator(_tft, 0, 0, view.indicatorColor);
+  }
+
+  for (uint8_t i = 0; i < DASH_CARDS; i++) {
+    const CardView &card = view.cards[i];
+    bool frameDirty = !_cards[i].drawn || _cards[i].alert != card.alert;
+    if (frameDirty) drawCardFrame(_tft, 0, 0, i, card);
+    drawCardValue(_tft, 0, 0, i, card, frameDirty);
+  }
+
+  if (statusChanged(view.status)) drawStatus(_tft, 0, 0, view.status);
+}
+
+void Dashboard::render(const DashboardView &view) {
+  uint32_t startUs = micros();
+  _lastRegions = 0;
+  _lastFull = !_valid;
+
+#ifdef DISPLAY_FRAMEBUFFER
+  bool tiled = _flushTask != nullptr;
+#endif
+
+  if (!_valid) {
+#ifdef DISPLAY_FRAMEBUFFER
+    if (tiled) waitFlushIdle();
+#endif
+    drawChrome();
+    for (uint8_t i = 0; i < DASH_CARDS; i++) _cards[i].drawn = false;
+    _status.drawn = false;
+    _valid = true;
+  }
+
+#ifdef DISPLAY_FRAMEBUFFER
+  if (tiled) {
+    renderTiles(view, startUs);
+    _cpuHist.add(micros() - startUs);
+    return;
+  }
+#endif
+
+  renderDirect(view);
+
+  // Drawing straight to the panel blocks until the pixels are out
+  uint32_t elapsed = micros() - startUs;
+  _cpuHist.add(elapsed);
+  addFrameTime(elapsed);
+}
+
+void Dashboard::addFrameTime(uint32_t us) {
+  portENTER_CRITICAL(&_histMux);
+  _frameHist.add(us);
+  portEXIT_CRITICAL(&_histMux);
+}
+
+FrameHistogram Dashboard::frameHistogram() const {
+  portENTER_CRITICAL(&_histMux);
+  FrameHistogram copy = _frameHist;
+  portEXIT_CRITICAL(&_histMux);
+  return copy;
+}
+
+void Dashboard::printHistograms() {
+  // Snapshot and reset together so no flushed frame is lost in between;
+  // printing happens outside the critical section
+  portENTER_CRITICAL(&_histMux);
+  FrameHistogram frames = _frameHist;
+  _frameHist.reset();
+  portEXIT_CRITICAL(&_histMux);
+
+  _cpuHist.print("Frame cpu");
+  frames.print("Frame flush");
+  _cpuHist.reset();
+}
+
+#ifdef DISPLAY_FRAMEBUFFER
+
+// ================== TILE FLUSH ==================
+
+void Dashboard::flushTaskEntry(void *arg) {
+  Dashboard *self = static_cast<Dashboard *>(arg);
+  FlushJob job;
+  for (;;) {
+    if (xQueueReceive(self->_flushQueue, &job, portMAX_DELAY) == pdTRUE) {
+      self->flushTile(job);
+    }
+  }
+}
+
+void Dashboard::flushTile(const FlushJob &job) {
+  if (job.tile < TILE_COUNT) {
+    GFXcanvas16 *canvas = _tiles[job.tile];
+    uint16_t w = canvas->width();
+    uint16_t h = canvas->height();
+
+    // One address window and a bulk pixel write for the whole tile
+    _tft.startWrite();
+    _tft.setAddrWindow(job.x, job.y, w, h);
+    _tft.writePixels(canvas->getBuffer(), (uint32_t)w * h);
+    _tft.endWrite();
+    _tft.countBlit(w, h);
+  } else {
+    addFrameTime(micros() - job.frameStartUs);
+  }
+  _flushedSeq = _flushedSeq + 1;
+}
+
+GFXcanvas16 *Dashboard::acquire(uint8_t tile) {
+  // Wait until the previous contents of this tile left the buffer
+  while ((int32_t)(_flushedSeq - _tileSeq[tile]) < 0) vTaskDelay(1);
+  return _tiles[tile];
+}
+
+void Dashboard::submit(uint8_t tile, int16_t x, int16_t y,
+                       uint32_t frameStartUs) {
+  FlushJob job = {tile, x, y, frameStartUs};
+  _submittedSeq++;
+  if (tile < TILE_COUNT) _tileSeq[tile] = _submittedSeq;
+  xQueueSend(_flushQueue, &job, portMAX_DELAY);
+}
+
+void Dashboard::waitFlushIdle() {
+  while (_flushedSeq != _submittedSeq) vTaskDelay(1);
+}
+
+void Dashboard::renderTiles(const DashboardView &view, uint32_t frameStartUs) {
+  if (_lastFull || view.indicatorColor != _indicatorColor) {
+    GFXcanvas16 *g = acquire(TILE_HEADER);
+    drawHeader(*g, 0, 0);
+    drawIndicator(*g, 0, 0, view.indicatorColor);
+    submit(TILE_HEADER, 0, 0);
+  }
+
+  for (uint8_t i = 0; i < DASH_CARDS; i++) {
+    const CardView &card = view.cards[i];
+    bool frameDirty = !_cards[i].drawn || _cards[i].alert != card.alert;
+    if (!frameDirty && _cards[i].value == card.value &&
+        _cards[i].valueColor == card.valueColor) {
+      continue;
+    }
+
+    // A tile holds the whole card, so it is always composed from scratch
+    uint8_t tile = _nextCardTile;
+    _nextCardTile = tile == TILE_CARD_A ? TILE_CARD_B : TILE_CARD_A;
+    GFXcanvas16 *g = acquire(tile);
+    g->fillScreen(0x0000);
+    drawCardFrame(*g, CARD_X[i], CARD_Y[i], i, card);
+    drawCardValue(*g, CARD_X[i], CARD_Y[i], i, card, true);
+    submit(tile, CARD_X[i], CARD_Y[i]);
+  }
+
+  if (statusChanged(view.status)) {
+    GFXcanvas16 *g = acquire(TILE_STATUS);
+    drawStatus(*g, 0, STATUS_Y, view.status);
+    submit(TILE_STATUS, 0, STATUS_Y);
+  }
+
+  // Marker job: the frame is on the panel once the flush task reaches it
+  submit(TILE_COUNT, 0, 0, frameStartUs);
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "DhtDecoder.h"
+
+#include <string.h>
+
+const char *dhtStatusName(DhtStatus status) {
+  switch (status) {
+    case DHT_OK:             return "OK";
+    case DHT_NO_RESPONSE:    return "NO_RESPONSE";
+    case DHT_FRAME_ERROR:    return "FRAME_ERROR";
+    case DHT_CHECKSUM_ERROR: return "CHECKSUM_ERROR";
+    case DHT_BUSY:           return "BUSY";
+  }
+  return "?";
+}
+
+DhtStatus dhtDecode(const DhtPulse *pulses, size_t count, uint8_t data[5]) {
+  memset(data, 0, 5);
+
+  // The line may still be high (pull-up) when the capture starts
+  size_t i = 0;
+  while (i < count && pulses[i].level) i++;
+  if (i >= count) return DHT_NO_RESPONSE;
+
+  // Response: low 80 us, high 80 us
+  i++;
+  if (i >= count || !pulses[i].level) return DHT_FRAME_ERROR;
+  i++;
+
+  for (uint8_t bit = 0; bit < DHT_FRAME_BITS; bit++) {
+    if (i >= count || pulses[i].level) return DHT_FRAME_ERROR;
+    i++;  // Bit start low
+
+    if (i >= count || !pulses[i].level || pulses[i].us == 0) {
+      return DHT_FRAME_ERROR;
+    }
+    if (pulses[i].us > DHT_BIT_THRESHOLD_US) {
+      data[bit / 8] |= 0x80 >> (bit % 8);
+    }
+    i++;
+  }
+
+  uint8_t sum = data[0] + data[1] + data[2] + data[3];
+  return sum == data[4] ? DHT_OK : DHT_CHECKSUM_ERROR;
+}
+
+void dhtConvert(DhtModel model, const uint8_t data[5],
+                float &temperature, float &humidity) {
+  if (model == DHT_MODEL_22) {
+    humidity = ((data[0] << 8) | data[1]) * 0.1f;
+    temperature = (((data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+    if (data[2] & 0x80) temperature = -temperature;
+    return;
+  }
+
+  // DHT11: integer and decimal bytes, sign in bit 7 of the decimal
+  humidity = data[0] + data[1] * 0.1f;
+  temperature = data[2] + (data[3] & 0x0F) * 0.1f;
+  if (data[3] & 0x80) temperature = -temperature;
+}
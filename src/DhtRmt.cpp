@@ -0,0 +1,108 @@
+#include "DhtRmt.h"
+
+DhtRmt::DhtRmt(uint8_t pin, DhtModel model, rmt_channel_t channel)
+  : _pin(pin), _model(model), _channel(channel), _rx(nullptr),
+    _lastStatus(DHT_BUSY) {
+  _mux = portMUX_INITIALIZER_UNLOCKED;
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+bool DhtRmt::begin() {
+  if (_rx) return true;
+
+  rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)_pin, _channel);
+  config.clk_div = 80;                        // 1 us per tick
+  config.mem_block_num = 1;                   // 64 items, a frame is ~43
+  config.rx_config.filter_en = true;
+  config.rx_config.filter_ticks_thresh = 100; // APB ticks, drops < 1.25 us glitches
+  config.rx_config.idle_threshold = DHT_RX_IDLE_US;
+
+  if (rmt_config(&config) != ESP_OK ||
+      rmt_driver_install(_channel, 512, 0) != ESP_OK ||
+      rmt_get_ringbuf_handle(_channel, &_rx) != ESP_OK) {
+    Serial.println("❌ DHT RMT channel unavailable");
+    _rx = nullptr;
+    return false;
+  }
+
+  // Open drain: the host only ever pulls low, the pull-up releases
+  gpio_set_pull_mode((gpio_num_t)_pin, GPIO_PULLUP_ONLY);
+  gpio_set_level((gpio_num_t)_pin, 1);
+  gpio_set_direction((gpio_num_t)_pin, GPIO_MODE_INPUT_OUTPUT_OD);
+  return true;
+}
+
+void DhtRmt::count(DhtStatus status) {
+  _lastStatus = status;
+  switch (status) {
+    case DHT_OK:             _stats.ok++; break;
+    case DHT_NO_RESPONSE:    _stats.noResponse++; break;
+    case DHT_FRAME_ERROR:    _stats.frameErrors++; break;
+    case DHT_CHECKSUM_ERROR: _stats.checksumErrors++; break;
+    case DHT_BUSY:           break;
+  }
+}
+
+DhtStatus DhtRmt::read(float &temperature, float &humidity) {
+  if (!_rx) {
+    count(DHT_BUSY);
+    return DHT_BUSY;
+  }
+  _stats.reads++;
+
+  // Drop anything left from an earlier, timed out transaction
+  size_t size = 0;
+  void *stale;
+  while ((stale = xRingbufferReceive(_rx, &size, 0)) != nullptr) {
+    vRingbufferReturnItem(_rx, stale);
+  }
+
+  uint32_t startUs = micros();
+  gpio_set_level((gpio_num_t)_pin, 0);
+  vTaskDelay(pdMS_TO_TICKS(DHT_START_MS));
+
+  // The sensor answers 20-40 us after the release: arm the receiver
+  // before anything can preempt us
+  portENTER_CRITICAL(&_mux);
+  gpio_set_level((gpio_num_t)_pin, 1);
+  rmt_rx_start(_channel, true);
+  portEXIT_CRITICAL(&_mux);
+
+  rmt_item32_t *items = static_cast<rmt_item32_t *>(
+    xRingbufferReceive(_rx, &size, pdMS_TO_TICKS(DHT_RX_TIMEOUT_MS)));
+  rmt_rx_stop(_channel);
+
+  if (!items) {
+    count(DHT_NO_RESPONSE);
+    return DHT_NO_RESPONSE;
+  }
+
+  // Off the timing critical path from here on
+  uint32_t decodeStart = micros();
+  size_t pulses = 0;
+  size_t itemCount = size / sizeof(rmt_item32_t);
+  for (size_t i = 0; i < itemCount && pulses + 2 <= DHT_MAX_PULSES; i++) {
+    if (!items[i].duration0) break;
+    _pulses[pulses].level = items[i].level0;
+    _pulses[pulses].us = items[i].duration0;
+    pulses++;
+    if (!items[i].duration1) break;
+    _pulses[pulses].level = items[i].level1;
+    _pulses[pulses].us = items[i].duration1;
+    pulses++;
+  }
+  vRingbufferReturnItem(_rx, items);
+
+  uint8_t data[5];
+  DhtStatus status = dhtDecode(_pulses, pulses, data);
+  if (status == DHT_OK) dhtConvert(_model, data, temperature, humidity);
+
+  uint32_t now = micros();
+  _stats.lastDecodeUs = now - decodeStart;
+  _stats.lastLatencyUs = now - startUs;
+  if (_stats.lastLatencyUs > _stats.maxLatencyUs) {
+    _stats.maxLatencyUs = _stats.lastLatencyUs;
+  }
+  count(status);
+  return status;
+}
@@ -0,0 +1,355 @@
+#include "EventJournal.h"
+
+#include <FS.h>
+#include <LittleFS.h>
+#include <time.h>
+
+uint32_t journalCrc(const void *data, size_t len) {
+  const uint8_t *p = static_cast<const uint8_t *>(data);
+  uint32_t crc = 0xFFFFFFFFUL;
+  while (len--) {
+    crc ^= *p++;
+    for (uint8_t k = 0; k < 8; k++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+const char *journalEventName(uint8_t type) {
+  switch (type) {
+    case JEV_BOOT:        return "BOOT";
+    case JEV_ALARM_START: return "ALARM_START";
+    case JEV_ALARM_CLEAR: return "ALARM_CLEAR";
+    case JEV_FLAME:       return "FLAME";
+    case JEV_CALL_STATE:  return "CALL_STATE";
+    case JEV_SMS_SENT:    return "SMS_SENT";
+    case JEV_SMS_FAILED:  return "SMS_FAILED";
+    case JEV_CONFIG:      return "CONFIG";
+  }
+  return "?";
+}
+
+static bool recordValid(const JournalRecord &record) {
+  return record.type > 0 && record.type < JEV_TYPES &&
+         record.crc == journalCrc(&record, offsetof(JournalRecord, crc));
+}
+
+EventJournal::EventJournal()
+  : _ready(false), _fileLock(nullptr), _task(nullptr), _head(0), _count(0),
+    _nextSeq(1), _segment(0), _firstSegment(0), _segmentRecords(0),
+    _lastFlush(0), _mux(portMUX_INITIALIZER_UNLOCKED) {
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+void EventJournal::segmentPath(uint32_t segment, char *path,
+                               size_t size) const {
+  snprintf(path, size, JOURNAL_DIR "/%08lu.log", (unsigned long)segment);
+}
+
+bool EventJournal::begin(BaseType_t core) {
+  if (_ready) return true;
+
+  if (!LittleFS.begin(true)) {
+    Serial.println("❌ LittleFS mount failed, journal disabled");
+    return false;
+  }
+  if (!LittleFS.exists(JOURNAL_DIR)) LittleFS.mkdir(JOURNAL_DIR);
+
+  _fileLock = xSemaphoreCreateMutex();
+  if (!_fileLock) return false;
+
+  // Segment numbers only grow; the file names give the range
+  bool any = false;
+  File dir = LittleFS.open(JOURNAL_DIR);
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    uint32_t n = strtoul(f.name() + (f.name()[0] == '/' ?
+                         strlen(JOURNAL_DIR) + 1 : 0), nullptr, 10);
+    f.close();
+    if (!any || n < _firstSegment) _firstSegment = n;
+    if (!any || n > _segment) _segment = n;
+    any = true;
+  }
+  dir.close();
+
+  bool damaged = false;
+  if (any) {
+    _segmentRecords = scanSegment(_segment, damaged);
+    // An empty newest segment: take the sequence from the one before
+    for (uint32_t s = _segment; _nextSeq == 1 && s > _firstSegment; s--) {
+      bool older = false;
+      scanSegment(s - 1, older);
+    }
+    if (damaged || _segmentRecords >= JOURNAL_SEGMENT_RECORDS) {
+      // Never append behind a torn record
+      _segment++;
+      _segmentRecords = 0;
+    }
+  } else {
+    _segment = _firstSegment = 0;
+  }
+
+  Serial.printf("✓ Journal: segments %lu..%lu, next seq %lu%s\n",
+    (unsigned long)_firstSegment, (unsigned long)_segment,
+    (unsigned long)_nextSeq, damaged ? ", damaged tail closed" : "");
+
+  _lastFlush = millis();
+  _ready = true;
+
+  if (xTaskCreatePinnedToCore(taskEntry, "journal", 4096, this, 1, &_task,
+                              core) != pdPASS) {
+    _task = nullptr;
+    Serial.println("⚠ Journal task failed to start, flushing inline");
+  }
+  return true;
+}
+
+uint32_t EventJournal::scanSegment(uint32_t segment, bool &damaged) {
+  char path[32];
+  segmentPath(segment, path, sizeof(path));
+  File f = LittleFS.open(path, "r");
+  damaged = false;
+  if (!f) return 0;
+
+  uint32_t valid = 0;
+  JournalRecord record;
+  size_t got;
+  while ((got = f.read((uint8_t *)&record, sizeof(record))) != 0) {
+    // A short read is a record cut off by power loss; read() has already
+    // consumed it, so available() can no longer tell
+    if (got != sizeof(record) || !recordValid(record)) {
+      damaged = true;
+      break;
+    }
+    _nextSeq = record.seq + 1;
+    valid++;
+  }
+  f.close();
+
+  if (damaged) _stats.damaged++;
+  return valid;
+}
+
+bool EventJournal::append(JournalEvent type, uint8_t code, uint16_t arg,
+                          int32_t value, const char *detail) {
+  JournalRecord record;
+  memset(&record, 0, sizeof(record));
+  time_t now = time(nullptr);
+  record.utc = now >= (time_t)JOURNAL_MIN_UTC ? (uint32_t)now : 0;
+  record.uptimeMs = millis();
+  record.type = type;
+  record.code = code;
+  record.arg = arg;
+  record.value = value;
+  if (detail) strncpy(record.detail, detail, JOURNAL_DETAIL_LEN);
+
+  bool stored = false;
+  bool wake = false;
+  portENTER_CRITICAL(&_mux);
+  if (_count < JOURNAL_RAM_RECORDS) {
+    record.seq = _nextSeq++;
+    record.crc = journalCrc(&record, offsetof(JournalRecord, crc));
+    _ring[(_head + _count) % JOURNAL_RAM_RECORDS] = record;
+    _count++;
+    _stats.appended++;
+    stored = true;
+    wake = _count >= JOURNAL_BATCH_RECORDS;
+  } else {
+    _stats.dropped++;
+  }
+  portEXIT_CRITICAL(&_mux);
+
+  if (wake && _task) xTaskNotifyGive(_task);
+  return stored;
+}
+
+void EventJournal::taskEntry(void *arg) {
+  EventJournal *self = static_cast<EventJournal *>(arg);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(JOURNAL_FLUSH_MS));
+    bool due = millis() - self->_lastFlush >= JOURNAL_FLUSH_MS;
+    self->writeBatch(due);
+  }
+}
+
+void EventJournal::flush() {
+  if (_ready) writeBatch(true);
+}
+
+void EventJournal::rotate() {
+  _segment++;
+  _segmentRecords = 0;
+
+  while (_segment - _firstSegment >= JOURNAL_SEGMENTS) {
+    char path[32];
+    segmentPath(_firstSegment, path, sizeof(path));
+    LittleFS.remove(path);
+    _firstSegment++;
+  }
+}
+
+// Full pages only unless all is set; at most one segment's worth of
+// records per file open
+void EventJournal::writeBatch(bool all) {
+  xSemaphoreTake(_fileLock, portMAX_DELAY);
+
+  for (;;) {
+    JournalRecord batch[JOURNAL_BATCH_RECORDS];
+    uint16_t n = 0;
+
+    portENTER_CRITICAL(&_mux);
+    uint16_t room = JOURNAL_SEGMENT_RECORDS - _segmentRecords;
+    if (_count >= JOURNAL_BATCH_RECORDS || (all && _count)) {
+      n = _count < JOURNAL_BATCH_RECORDS ? _count : JOURNAL_BATCH_RECORDS;
+      if (n > room) n = room;
+      for (uint16_t i = 0; i < n; i++) {
+        batch[i] = _ring[(_head + i) % JOURNAL_RAM_RECORDS];
+      }
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    if (!n) break;
+
+    uint32_t start = micros();
+    char path[32];
+    segmentPath(_segment, path, sizeof(path));
+    File f = LittleFS.open(path, "a");
+    size_t bytes = n * sizeof(JournalRecord);
+    bool ok = f && f.write((const uint8_t *)batch, bytes) == bytes;
+    if (f) f.close();   // Close commits the LittleFS metadata
+    uint32_t us = micros() - start;
+
+    portENTER_CRITICAL(&_mux);
+    if (ok) {
+      _head = (_head + n) % JOURNAL_RAM_RECORDS;
+      _count -= n;
+      _stats.written += n;
+    } else {
+      _stats.writeErrors++;
+    }
+    _stats.flushes++;
+    _stats.lastFlushUs = us;
+    if (us > _stats.maxFlushUs) _stats.maxFlushUs = us;
+    portEXIT_CRITICAL(&_mux);
+
+    if (!ok) {
+      // Do not retry forever into a bad file: move on to a fresh one
+      rotate();
+      break;
+    }
+
+    _segmentRecords += n;
+    if (_segmentRecords >= JOURNAL_SEGMENT_RECORDS) rotate();
+  }
+
+  _lastFlush = millis();
+  xSemaphoreGive(_fileLock);
+}
+
+static bool recordMatches(const JournalRecord &record, uint32_t fromUtc,
+                          uint32_t toUtc, uint32_t typeMask) {
+  if (!(typeMask & JOURNAL_TYPE_BIT(record.type))) return false;
+  return record.utc ? record.utc >= fromUtc && record.utc <= toUtc
+                    : fromUtc == 0;
+}
+
+// Called with _fileLock held, so the writer cannot move records from the
+// ring into a file meanwhile: files then ring hold every record once
+uint16_t EventJournal::fillSlice(QueryCursor &cursor, uint32_t fromUtc,
+                                 uint32_t toUtc, uint32_t typeMask,
+                                 JournalRecord *slice) {
+  uint16_t n = 0;
+
+  // Rotated away since the last slice
+  if (cursor.segment < _firstSegment) {
+    cursor.segment = _firstSegment;
+    cursor.offset = 0;
+  }
+
+  bool filesDone = false;
+  while (n < JOURNAL_QUERY_SLICE && !cursor.done) {
+    char path[32];
+    segmentPath(cursor.segment, path, sizeof(path));
+    File f = LittleFS.open(path, "r");
+    bool end = !f || !f.seek(cursor.offset);
+
+    JournalRecord record;
+    while (!end && n < JOURNAL_QUERY_SLICE) {
+      if (f.read((uint8_t *)&record, sizeof(record)) != sizeof(record) ||
+          !recordValid(record)) {
+        end = true;   // End of what is written, or a torn tail
+        break;
+      }
+      cursor.offset += sizeof(record);
+      if (record.seq <= cursor.lastSeq) continue;
+      if (record.seq > cursor.endSeq) {
+        cursor.done = true;
+        break;
+      }
+      cursor.lastSeq = record.seq;
+      if (recordMatches(record, fromUtc, toUtc, typeMask)) slice[n++] = record;
+    }
+    if (f) f.close();
+
+    if (!end) break;                  // Slice full or done
+    if (cursor.segment >= _segment) {
+      filesDone = true;               // The rest is still in RAM
+      break;
+    }
+    cursor.segment++;
+    cursor.offset = 0;
+  }
+
+  if (filesDone) {
+    portENTER_CRITICAL(&_mux);
+    for (uint16_t i = 0; i < _count && n < JOURNAL_QUERY_SLICE; i++) {
+      const JournalRecord &record = _ring[(_head + i) % JOURNAL_RAM_RECORDS];
+      if (record.seq <= cursor.lastSeq) continue;
+      if (record.seq > cursor.endSeq) break;
+      cursor.lastSeq = record.seq;
+      if (recordMatches(record, fromUtc, toUtc, typeMask)) slice[n++] = record;
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (n < JOURNAL_QUERY_SLICE) cursor.done = true;
+  }
+  return n;
+}
+
+uint32_t EventJournal::query(uint32_t fromUtc, uint32_t toUtc,
+                             uint32_t typeMask, JournalVisitor visit,
+                             void *ctx) {
+  if (!_ready) return 0;
+
+  QueryCursor cursor;
+  cursor.segment = 0;
+  cursor.offset = 0;
+  cursor.lastSeq = 0;
+  cursor.done = false;
+  portENTER_CRITICAL(&_mux);
+  cursor.endSeq = _nextSeq - 1;
+  portEXIT_CRITICAL(&_mux);
+
+  uint32_t rows = 0;
+  JournalRecord slice[JOURNAL_QUERY_SLICE];
+  while (!cursor.done) {
+    xSemaphoreTake(_fileLock, portMAX_DELAY);
+    uint16_t n = fillSlice(cursor, fromUtc, toUtc, typeMask, slice);
+    xSemaphoreGive(_fileLock);
+
+    for (uint16_t i = 0; i < n; i++) {
+      rows++;
+      if (!visit(slice[i], ctx)) return rows;
+    }
+  }
+  return rows;
+}
+
+JournalStats EventJournal::stats() {
+  JournalStats s;
+  portENTER_CRITICAL(&_mux);
+  s = _stats;
+  portEXIT_CRITICAL(&_mux);
+  s.firstSegment = _firstSegment;
+  s.lastSegment = _segment;
+  return s;
+}
@@ -0,0 +1,74 @@
+#include "FlameTrigger.h"
+
+FlameTrigger *FlameTrigger::_instance = nullptr;
+
+FlameTrigger::FlameTrigger()
+  : _pin(0), _debounceMs(FLAME_DEBOUNCE_MS), _callback(nullptr),
+    _task(nullptr), _active(false), _edgeUs(0), _edgePending(false),
+    _edges(0), _confirmedEdgeUs(0), _confirmed(0) {}
+
+bool FlameTrigger::begin(uint8_t pin, FlameCallback callback,
+                         uint16_t debounceMs, BaseType_t core) {
+  if (_task || _instance) return false;
+
+  _pin = pin;
+  _callback = callback;
+  _debounceMs = debounceMs;
+  _instance = this;
+
+  pinMode(_pin, INPUT);
+  _active = digitalRead(_pin) == LOW;
+
+  // Above the sensor sampler: this is the alert path
+  BaseType_t rc = xTaskCreatePinnedToCore(taskEntry, "flame", 3072, this, 6,
+                                          &_task, core);
+  if (rc != pdPASS) {
+    _task = nullptr;
+    _instance = nullptr;
+    Serial.println("❌ Flame task failed to start");
+    return false;
+  }
+
+  attachInterrupt(digitalPinToInterrupt(_pin), isr, CHANGE);
+  return true;
+}
+
+void IRAM_ATTR FlameTrigger::isr() {
+  FlameTrigger *self = _instance;
+  if (!self) return;
+
+  self->_edges++;
+  if (!self->_edgePending) {
+    self->_edgeUs = micros();
+    self->_edgePending = true;
+  }
+
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->_task, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void FlameTrigger::taskEntry(void *arg) {
+  static_cast<FlameTrigger *>(arg)->run();
+}
+
+void FlameTrigger::run() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Let the contact bounce settle, then drop the notifications it caused
+    vTaskDelay(pdMS_TO_TICKS(_debounceMs));
+    ulTaskNotifyTake(pdTRUE, 0);
+
+    uint32_t edgeUs = _edgeUs;
+    _edgePending = false;
+
+    bool level = digitalRead(_pin) == LOW;
+    if (level == _active) continue;   // Glitch shorter than the debounce
+
+    _active = level;
+    _confirmedEdgeUs = edgeUs;
+    _confirmed++;
+    if (_callback) _callback(level, edgeUs);
+  }
+}
@@ -0,0 +1,179 @@
+#include "LiveFeed.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <lwip/sockets.h>
+
+static const char LIVE_HEADERS[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/event-stream\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Connection: keep-alive\r\n"
+  "Access-Control-Allow-Origin: *\r\n"
+  "\r\n"
+  "retry: 3000\n\n";
+
+LiveFeed::LiveFeed()
+  : _mux(portMUX_INITIALIZER_UNLOCKED), _head(0), _lastAppend(0) {
+  for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    _clients[i].used = false;
+    _clients[i].pos = 0;
+  }
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+bool LiveFeed::subscribe(WiFiClient &client) {
+  for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    Client &c = _clients[i];
+    if (c.used) continue;
+
+    client.setNoDelay(true);
+    client.write((const uint8_t *)LIVE_HEADERS, sizeof(LIVE_HEADERS) - 1);
+
+    c.client = client;        // Shares the socket with the server's copy
+    c.used = true;
+    portENTER_CRITICAL(&_mux);
+    c.pos = _head;            // From the next event on
+    _stats.connects++;
+    _stats.clients++;
+    if (_stats.clients > _stats.peakClients) {
+      _stats.peakClients = _stats.clients;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return true;
+  }
+
+  portENTER_CRITICAL(&_mux);
+  _stats.rejected++;
+  portEXIT_CRITICAL(&_mux);
+  return false;
+}
+
+void LiveFeed::publish(const char *event, const char *format, ...) {
+  uint32_t start = micros();
+
+  char frame[LIVE_FRAME_MAX];
+  int len = snprintf(frame, sizeof(frame), "event: %s\ndata: ", event);
+  va_list args;
+  va_start(args, format);
+  int body = vsnprintf(frame + len, sizeof(frame) - len, format, args);
+  va_end(args);
+  if (body > 0) len += body;
+
+  // "\n\n" ends the event; a cut frame still has to be a whole event
+  bool truncated = len > (int)sizeof(frame) - 3;
+  if (truncated) len = sizeof(frame) - 3;
+  frame[len++] = '\n';
+  frame[len++] = '\n';
+
+  append(frame, len);
+
+  uint32_t us = micros() - start;
+  portENTER_CRITICAL(&_mux);
+  _stats.events++;
+  if (truncated) _stats.truncated++;
+  _stats.lastPublishUs = us;
+  if (us > _stats.maxPublishUs) _stats.maxPublishUs = us;
+  portEXIT_CRITICAL(&_mux);
+}
+
+void LiveFeed::append(const char *data, size_t len) {
+  portENTER_CRITICAL(&_mux);
+  for (size_t i = 0; i < len; i++) {
+    _buf[(_head + i) % LIVE_BUFFER_SIZE] = data[i];
+  }
+  _head += len;
+  _stats.bytesQueued += len;
+  _lastAppend = millis();
+  portEXIT_CRITICAL(&_mux);
+}
+
+void LiveFeed::disconnect(Client &c, bool slow) {
+  c.client.stop();
+  c.client = WiFiClient();
+  c.used = false;
+
+  portENTER_CRITICAL(&_mux);
+  uint8_t left = --_stats.clients;
+  if (slow) _stats.dropped++;
+  else _stats.closed++;
+  portEXIT_CRITICAL(&_mux);
+
+  Serial.printf("📡 /live client %s, %u left\n",
+    slow ? "too slow, dropped" : "closed", left);
+}
+
+void LiveFeed::service() {
+  if (!clients()) return;
+  uint32_t start = micros();
+
+  portENTER_CRITICAL(&_mux);
+  bool idle = millis() - _lastAppend >= LIVE_PING_MS;
+  portEXIT_CRITICAL(&_mux);
+  if (idle) append(": ping\n\n", 8);
+
+  for (uint8_t i = 0; i < LIVE_MAX_CLIENTS; i++) {
+    Client &c = _clients[i];
+    if (!c.used) continue;
+    if (!c.client.connected()) {
+      disconnect(c, false);
+      continue;
+    }
+
+    // Copy out what this client is missing, the ring may move on
+    char chunk[LIVE_SEND_MAX];
+    size_t n = 0;
+    bool lost = false;
+    portENTER_CRITICAL(&_mux);
+    uint32_t behind = _head - c.pos;
+    if (behind > LIVE_BUFFER_SIZE) {
+      lost = true;
+    } else {
+      n = behind < LIVE_SEND_MAX ? behind : LIVE_SEND_MAX;
+      for (size_t k = 0; k < n; k++) {
+        chunk[k] = _buf[(c.pos + k) % LIVE_BUFFER_SIZE];
+      }
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    if (lost) {
+      disconnect(c, true);
+      continue;
+    }
+    if (!n) continue;
+
+    // Whatever the socket takes now; the rest waits for the next pass
+    int sent = send(c.client.fd(), chunk, n, MSG_DONTWAIT);
+    if (sent < 0) {
+      if (errno == EWOULDBLOCK || errno == EAGAIN) continue;
+      disconnect(c, false);
+      continue;
+    }
+    c.pos += sent;
+
+    portENTER_CRITICAL(&_mux);
+    _stats.bytesSent += sent;
+    portEXIT_CRITICAL(&_mux);
+  }
+
+  uint32_t us = micros() - start;
+  portENTER_CRITICAL(&_mux);
+  _stats.lastServiceUs = us;
+  if (us > _stats.maxServiceUs) _stats.maxServiceUs = us;
+  portEXIT_CRITICAL(&_mux);
+}
+
+uint8_t LiveFeed::clients() {
+  portENTER_CRITICAL(&_mux);
+  uint8_t n = _stats.clients;
+  portEXIT_CRITICAL(&_mux);
+  return n;
+}
+
+LiveStats LiveFeed::stats() {
+  LiveStats s;
+  portENTER_CRITICAL(&_mux);
+  s = _stats;
+  portEXIT_CRITICAL(&_mux);
+  return s;
+}
@@ -0,0 +1,399 @@
+#include "ModemAT.h"
+
+const char *atStatusName(AtStatus status) {
+  switch (status) {
+    case AT_PENDING:   return "PENDING";
+    case AT_OK:        return "OK";
+    case AT_ERROR:     return "ERROR";
+    case AT_CME_ERROR: return "CME ERROR";
+    case AT_CMS_ERROR: return "CMS ERROR";
+    case AT_TIMEOUT:   return "TIMEOUT";
+  }
+  return "?";
+}
+
+ModemAT::ModemAT()
+  : _io(nullptr), _mutex(nullptr), _task(nullptr),
+    _head(0), _count(0), _eventHead(0), _eventCount(0),
+    _urcTableSize(0), _urcHandler(nullptr), _writeHook(nullptr),
+    _active(false), _payloadSent(false), _sentAt(0), _draining(false),
+    _lastRx(0), _lineLen(0), _completed(0), _timeouts(0), _urcs(0),
+    _discarded(0), _totalLatencyMs(0) {
+  _result.status = AT_PENDING;
+  _result.elapsedMs = 0;
+}
+
+void ModemAT::begin(Stream &io) {
+  _io = &io;
+  if (!_mutex) _mutex = xSemaphoreCreateMutex();
+}
+
+void ModemAT::lock() {
+  if (_mutex) xSemaphoreTake(_mutex, portMAX_DELAY);
+}
+
+void ModemAT::unlock() {
+  if (_mutex) xSemaphoreGive(_mutex);
+}
+
+void ModemAT::taskEntry(void *arg) {
+  ModemAT *self = static_cast<ModemAT *>(arg);
+  for (;;) {
+    self->poll();
+    vTaskDelay(1);
+  }
+}
+
+bool ModemAT::startTask(BaseType_t core, uint32_t stackSize,
+                        UBaseType_t priority) {
+  if (_task || !_io) return false;
+
+  BaseType_t rc = xTaskCreatePinnedToCore(taskEntry, "modemIO", stackSize,
+                                          this, priority, &_task, core);
+  if (rc != pdPASS) {
+    _task = nullptr;
+    Serial.println("❌ Modem I/O task failed to start");
+    return false;
+  }
+  return true;
+}
+
+bool ModemAT::onUrc(const char *prefix, AtLineHandler handler) {
+  if (_urcTableSize >= AT_URC_MAX) return false;
+
+  lock();
+  UrcEntry &entry = _urcTable[_urcTableSize];
+  entry.prefix = prefix;
+  entry.len = strlen(prefix);
+  entry.handler = handler;
+  _urcTableSize++;
+  unlock();
+  return true;
+}
+
+bool ModemAT::enqueue(const char *cmd, uint32_t timeoutMs,
+                      AtCallback cb, void *ctx, const char *payload) {
+  lock();
+  if (_count >= AT_QUEUE_SIZE) {
+    unlock();
+    Serial.print("⚠ AT queue full, dropped: ");
+    Serial.println(cmd);
+    return false;
+  }
+
+  Command &slot = _queue[(_head + _count) % AT_QUEUE_SIZE];
+  slot.cmd = cmd;
+  slot.payload = payload ? payload : "";
+  slot.timeoutMs = timeoutMs;
+  slot.cb = cb;
+  slot.ctx = ctx;
+  _count++;
+  unlock();
+
+  // The UART side picks it up on its next poll()
+  return true;
+}
+
+static void storeResult(const AtResult &result, void *ctx) {
+  AtResult *out = static_cast<AtResult *>(ctx);
+  *out = result;
+}
+
+AtResult ModemAT::exec(const char *cmd, uint32_t timeoutMs,
+                       const char *payload) {
+  AtResult result;
+  result.status = AT_PENDING;
+  result.elapsedMs = 0;
+
+  if (!enqueue(cmd, timeoutMs, storeResult, &result, payload)) {
+    result.status = AT_ERROR;
+    return result;
+  }
+
+  while (result.status == AT_PENDING) {
+    dispatch();
+    if (result.status == AT_PENDING) vTaskDelay(1);
+  }
+  return result;
+}
+
+bool ModemAT::busy() {
+  lock();
+  bool b = _active || _count > 0 || _eventCount > 0;
+  unlock();
+  return b;
+}
+
+uint8_t ModemAT::pending() {
+  lock();
+  uint8_t n = _count + (_active ? 1 : 0);
+  unlock();
+  return n;
+}
+
+bool ModemAT::waitIdle(uint32_t timeoutMs) {
+  unsigned long start = millis();
+  while (busy()) {
+    if (millis() - start >= timeoutMs) return false;
+    dispatch();
+    vTaskDelay(1);
+  }
+  return true;
+}
+
+// ---------- UART side ----------
+
+void ModemAT::startNext() {
+  if (_active || !_io) return;
+
+  // After a timeout, wait until the late answer (if any) is over
+  if (_draining) {
+    if (millis() - _lastRx < AT_RESYNC_QUIET_MS) return;
+    _draining = false;
+  }
+
+  lock();
+  if (_count == 0) {
+    unlock();
+    return;
+  }
+  _current = _queue[_head];
+  _queue[_head].cmd = "";
+  _queue[_head].payload = "";
+  _head = (_head + 1) % AT_QUEUE_SIZE;
+  _count--;
+  unlock();
+
+  // "AT+CLCC" / "AT+CREG?" solicit "+CLCC" / "+CREG" lines; a chained
+  // "AT+CMGF?;+CREG?" solicits both, kept as "+CMGF;+CREG"
+  _solicited = "";
+  if (_current.cmd.startsWith("AT+")) {
+    unsigned pos = 2;
+    bool quoted = false;
+    while (pos < _current.cmd.length()) {
+      unsigned end = pos;
+      while (end < _current.cmd.length()) {
+        char c = _current.cmd[end];
+        if (c == '"') quoted = !quoted;
+        if (!quoted && (c == '=' || c == '?' || c == ';')) break;
+        end++;
+      }
+      if (_solicited.length()) _solicited += ';';
+      _solicited += _current.cmd.substring(pos, end);
+
+      // Next command of the chain, if any
+      pos = end;
+      while (pos < _current.cmd.length()) {
+        char c = _current.cmd[pos++];
+        if (c == '"') quoted = !quoted;
+        if (!quoted && c == ';') break;
+      }
+      if (pos >= _current.cmd.length() || _current.cmd[pos] != '+') break;
+    }
+  }
+
+  _result.status = AT_PENDING;
+  _result.response = "";
+  _result.elapsedMs = 0;
+  _payloadSent = false;
+  _active = true;
+
+  Serial.print("AT CMD: ");
+  Serial.println(_current.cmd);
+
+  _io->println(_current.cmd);
+  _sentAt = millis();
+  if (_writeHook) _writeHook(_current.cmd.c_str());
+}
+
+void ModemAT::pushEvent(Event &event) {
+  for (;;) {
+    lock();
+    if (_eventCount < AT_EVENT_QUEUE) {
+      Event &slot = _events[(_eventHead + _eventCount) % AT_EVENT_QUEUE];
+      slot = event;
+      _eventCount++;
+      unlock();
+      return;
+    }
+    unlock();
+
+    // Never drop an event: wait for the application to catch up,
+    // or deliver inline when there is no separate I/O task.
+    if (_task) vTaskDelay(1);
+    else deliver();
+  }
+}
+
+void ModemAT::finish(AtStatus status) {
+  _result.status = status;
+  _result.elapsedMs = millis() - _sentAt;
+
+  _completed++;
+  _totalLatencyMs += _result.elapsedMs;
+  if (status == AT_TIMEOUT) {
+    _timeouts++;
+    _draining = true;
+    _lastRx = millis();
+    // A prompt we never saw would swallow the next command as SMS text
+    if (_current.payload.length() && !_payloadSent) _io->write(27);  // ESC
+  }
+
+  Serial.printf("AT %s: %s (%lu ms)\n", atStatusName(status),
+                _current.cmd.c_str(), (unsigned long)_result.elapsedMs);
+
+  if (_current.cb) {
+    Event event;
+    event.type = EVENT_COMPLETE;
+    event.cb = _current.cb;
+    event.ctx = _current.ctx;
+    event.handler = nullptr;
+    event.result = _result;
+    pushEvent(event);
+  }
+
+  _current.cmd = "";
+  _current.payload = "";
+  _active = false;
+}
+
+bool ModemAT::solicited(const String &line) const {
+  if (!_active) return false;
+
+  const char *name = _solicited.c_str();
+  while (*name) {
+    const char *end = strchr(name, ';');
+    size_t len = end ? (size_t)(end - name) : strlen(name);
+    if (len && strncmp(line.c_str(), name, len) == 0) return true;
+    if (!end) break;
+    name = end + 1;
+  }
+  return false;
+}
+
+void ModemAT::handleLine(const String &line) {
+  if (!solicited(line)) {
+    for (uint8_t i = 0; i < _urcTableSize; i++) {
+      if (strncmp(line.c_str(), _urcTable[i].prefix, _urcTable[i].len) == 0) {
+        Event event;
+        event.type = EVENT_URC;
+        event.cb = nullptr;
+        event.ctx = nullptr;
+        event.handler = _urcTable[i].handler;
+        event.line = line;
+        _urcs++;
+        pushEvent(event);
+        return;
+      }
+    }
+  }
+
+  if (!_active) {
+    if (_draining) {
+      // Late answer to the command that timed out
+      _discarded++;
+      Serial.print("AT late, discarded: ");
+      Serial.println(line);
+      return;
+    }
+    if (_urcHandler) {
+      Event event;
+      event.type = EVENT_URC;
+      event.cb = nullptr;
+      event.ctx = nullptr;
+      event.handler = _urcHandler;
+      event.line = line;
+      _urcs++;
+      pushEvent(event);
+    }
+    return;
+  }
+
+  // Command echo
+  if (line == _current.cmd) return;
+
+  if (line == "OK") {
+    finish(AT_OK);
+  } else if (line == "ERROR") {
+    finish(AT_ERROR);
+  } else if (line.startsWith("+CME ERROR")) {
+    _result.response += line;
+    finish(AT_CME_ERROR);
+  } else if (line.startsWith("+CMS ERROR")) {
+    _result.response += line;
+    finish(AT_CMS_ERROR);
+  } else {
+    if (_result.response.length()) _result.response += '\n';
+    _result.response += line;
+  }
+}
+
+void ModemAT::poll() {
+  if (!_io) return;
+
+  if (!_active) startNext();
+
+  while (_io->available()) {
+    char c = _io->read();
+    _lastRx = millis();
+
+    if (c == '\n' || c == '\r') {
+      if (_lineLen) {
+        _line[_lineLen] = '\0';
+        _lineLen = 0;
+        handleLine(String(_line));
+      }
+      continue;
+    }
+
+    // Keep printable ASCII only, like the old sendATCommand()
+    if (c < 32 || c > 126) continue;
+    // Result lines never start with a blank; this is the one after "> "
+    if (c == ' ' && !_lineLen) continue;
+    if (_lineLen < AT_LINE_MAX - 1) _line[_lineLen++] = c;
+
+    // The '>' prompt is not followed by a line break
+    if (_active && _current.payload.length() && !_payloadSent &&
+        _lineLen <= 2 && _line[0] == '>') {
+      _io->print(_current.payload);
+      _io->write(26);  // CTRL+Z
+      _payloadSent = true;
+      _lineLen = 0;
+    }
+  }
+
+  if (_active && millis() - _sentAt >= _current.timeoutMs) {
+    finish(AT_TIMEOUT);
+  }
+
+  if (!_active) startNext();
+}
+
+// ---------- Application side ----------
+
+void ModemAT::dispatch() {
+  if (!_task) poll();
+  deliver();
+}
+
+void ModemAT::deliver() {
+  for (;;) {
+    lock();
+    if (_eventCount == 0) {
+      unlock();
+      return;
+    }
+    Event event = _events[_eventHead];
+    _events[_eventHead].result.response = "";
+    _events[_eventHead].line = "";
+    _eventHead = (_eventHead + 1) % AT_EVENT_QUEUE;
+    _eventCount--;
+    unlock();
+
+    if (event.type == EVENT_COMPLETE) {
+      if (event.cb) event.cb(event.result, event.ctx);
+    } else if (event.handler) {
+      event.handler(event.line);
+    }
+  }
+}
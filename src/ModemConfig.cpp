@@ -0,0 +1,146 @@
+#include "ModemConfig.h"
+
+#include <string.h>
+
+ModemConfig::ModemConfig(ModemAT &modem, const ModemSetting *settings,
+                         uint8_t count)
+  : _modem(modem), _settings(settings),
+    _count(count > MODEM_SETTINGS_MAX ? MODEM_SETTINGS_MAX : count) {
+  memset(&_report, 0, sizeof(_report));
+}
+
+uint32_t ModemConfig::fingerprint() const {
+  uint32_t hash = 2166136261UL;
+  for (uint8_t i = 0; i < _count; i++) {
+    for (const char *p = _settings[i].set; *p; p++) {
+      hash = (hash ^ (uint8_t)*p) * 16777619UL;
+    }
+    hash = (hash ^ '\n') * 16777619UL;
+  }
+  return hash;
+}
+
+AtResult ModemConfig::send(const String &line, uint32_t timeoutMs) {
+  _report.roundTrips++;
+  return _modem.exec(line.c_str(), timeoutMs);
+}
+
+bool ModemConfig::run(uint32_t storedFingerprint) {
+  unsigned long start = millis();
+  memset(&_report, 0, sizeof(_report));
+  _report.warm = storedFingerprint == fingerprint();
+
+  bool pending[MODEM_SETTINGS_MAX];
+  for (uint8_t i = 0; i < _count; i++) pending[i] = true;
+
+  if (_report.warm) {
+    _report.verified = verify(pending);
+  }
+
+  // Writing only the per-boot settings leaves the profile as it was
+  bool profileChanged = false;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (pending[i] && !(_settings[i].flags & MODEM_SET_ALWAYS)) {
+      profileChanged = true;
+    }
+  }
+
+  apply(pending);
+
+  // Keep what was written in the modem's user profile
+  if (_report.applied && profileChanged) send("AT&W", 2000);
+
+  _report.elapsedMs = millis() - start;
+  return _report.failed == 0;
+}
+
+bool ModemConfig::verify(bool *pending) {
+  bool answered = true;
+  uint8_t i = 0;
+
+  while (i < _count) {
+    // Settings that cannot be read back are trusted on a warm boot,
+    // unless the modem forgets them on every power cycle
+    if (!_settings[i].query) {
+      pending[i] = (_settings[i].flags & MODEM_SET_ALWAYS) != 0;
+      i++;
+      continue;
+    }
+
+    String line = "AT";
+    uint8_t first = i;
+    while (i < _count) {
+      if (!_settings[i].query) break;
+      size_t add = strlen(_settings[i].query) + (i > first ? 1 : 0);
+      if (i > first && line.length() + add > MODEM_CHAIN_MAX) break;
+      if (i > first) line += ';';
+      line += _settings[i].query;
+      i++;
+    }
+
+    AtResult result = send(line, 2000);
+    if (!result.ok()) {
+      answered = false;  // Leaves this chain's settings pending
+      continue;
+    }
+
+    for (uint8_t j = first; j < i; j++) {
+      pending[j] = result.response.indexOf(_settings[j].expect) < 0;
+    }
+  }
+  return answered;
+}
+
+void ModemConfig::apply(const bool *pending) {
+  uint8_t i = 0;
+
+  while (i < _count) {
+    if (!pending[i]) {
+      i++;
+      continue;
+    }
+
+    if (_settings[i].flags & MODEM_SET_SOLO) {
+      applyOne(i++);
+      continue;
+    }
+
+    // Chain consecutive pending settings
+    String line = "AT";
+    uint8_t first = i;
+    uint32_t timeoutMs = 0;
+    while (i < _count && pending[i] && !(_settings[i].flags & MODEM_SET_SOLO)) {
+      size_t add = strlen(_settings[i].set) + (i > first ? 1 : 0);
+      if (i > first && line.length() + add > MODEM_CHAIN_MAX) break;
+      if (i > first) line += ';';
+      line += _settings[i].set;
+      timeoutMs += _settings[i].timeoutMs;
+      i++;
+    }
+
+    if (i - first == 1) {
+      applyOne(first);
+    } else if (send(line, timeoutMs).ok()) {
+      _report.applied += i - first;
+    } else {
+      // The modem stops at the first error: find it and apply the rest
+      for (uint8_t j = first; j < i; j++) applyOne(j);
+    }
+  }
+}
+
+bool ModemConfig::applyOne(uint8_t i) {
+  const ModemSetting &setting = _settings[i];
+  AtResult result = send(String("AT") + setting.set, setting.timeoutMs);
+
+  if (result.ok()) {
+    _report.applied++;
+    return true;
+  }
+  if (!(setting.flags & MODEM_SET_OPTIONAL)) {
+    _report.failed++;
+    Serial.printf("⚠ Modem setting AT%s failed (%s)\n", setting.set,
+      atStatusName(result.status));
+  }
+  return false;
+}
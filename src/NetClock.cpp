@@ -0,0 +1,166 @@
+#include "NetClock.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Shorter spans give too coarse a drift from 1 s CCLK resolution
+#define DRIFT_MIN_SPAN_MS  (30UL * 60UL * 1000UL)
+// Anything beyond this is a clock step (operator time change), not drift
+#define DRIFT_MAX_PPM      1000
+
+int32_t daysFromCivil(int32_t y, uint8_t m, uint8_t d) {
+  y -= m <= 2;
+  int32_t era = (y >= 0 ? y : y - 399) / 400;
+  uint32_t yoe = (uint32_t)(y - era * 400);
+  uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+NetClock::NetClock()
+  : _valid(false), _syncRequested(false), _tzMinutes(0), _lastMs(0),
+    _wraps(0), _anchorUtcMs(0), _anchorMs(0), _firstUtcMs(0), _firstMs(0),
+    _nextSyncMs(0), _jobCount(0) {
+  memset(_jobs, 0, sizeof(_jobs));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+uint64_t NetClock::extend(unsigned long nowMs) {
+  uint32_t ms = (uint32_t)nowMs;
+  if (ms < _lastMs) _wraps++;
+  _lastMs = ms;
+  return ((uint64_t)_wraps << 32) | ms;
+}
+
+bool NetClock::syncFromCclk(const char *resp, unsigned long nowMs) {
+  const char *q = resp ? strchr(resp, '"') : nullptr;
+  int yy, mo, dd, hh, mi, ss, zz;
+  char sign;
+  int n = q ? sscanf(q + 1, "%d/%d/%d,%d:%d:%d%c%d",
+                     &yy, &mo, &dd, &hh, &mi, &ss, &sign, &zz) : 0;
+
+  // The modem reports 70/01/01 or 80/01/06 until the network sent the
+  // time; two-digit years are 2000-based, so both would read as 20xx
+  if (n < 6 || yy < 20 || yy >= 70 || mo < 1 || mo > 12 || dd < 1 || dd > 31) {
+    syncFailed(nowMs);
+    return false;
+  }
+
+  int16_t tz = _tzMinutes;
+  if (n == 8 && (sign == '+' || sign == '-')) {
+    tz = (int16_t)(zz * 15 * (sign == '-' ? -1 : 1));  // Quarter hours
+  }
+
+  time_t localSec = (time_t)daysFromCivil(2000 + yy, mo, dd) * 86400 +
+                    hh * 3600 + mi * 60 + ss;
+  sync(localSec - tz * 60, tz, nowMs);
+  return true;
+}
+
+time_t NetClock::utc(unsigned long nowMs) {
+  if (!_valid) return 0;
+  int64_t elapsed = (int64_t)(extend(nowMs) - _anchorMs);
+  int64_t utcMs = _anchorUtcMs + elapsed +
+                  elapsed * _stats.driftPpm / 1000000;
+  return (time_t)(utcMs / 1000);
+}
+
+void NetClock::sync(time_t utcSec, int16_t tzMinutes, unsigned long nowMs) {
+  uint64_t ms = extend(nowMs);
+  // CCLK truncates to the second: the true time is somewhere in it
+  int64_t utcMs = (int64_t)utcSec * 1000 + 500;
+
+  if (_valid) {
+    int64_t elapsed = (int64_t)(ms - _anchorMs);
+    int64_t predicted = _anchorUtcMs + elapsed +
+                        elapsed * _stats.driftPpm / 1000000;
+    _stats.lastStepMs = (int32_t)(utcMs - predicted);
+
+    int64_t span = (int64_t)(ms - _firstMs);
+    if (span >= (int64_t)DRIFT_MIN_SPAN_MS) {
+      int64_t ppm = ((utcMs - _firstUtcMs) - span) * 1000000 / span;
+      if (ppm > DRIFT_MAX_PPM || ppm < -DRIFT_MAX_PPM) {
+        // Time was set, not drifted: measure again from here
+        _firstUtcMs = utcMs;
+        _firstMs = ms;
+        _stats.driftPpm = 0;
+      } else {
+        _stats.driftPpm = (int32_t)ppm;
+      }
+    }
+  } else {
+    _firstUtcMs = utcMs;
+    _firstMs = ms;
+  }
+
+  _anchorUtcMs = utcMs;
+  _anchorMs = ms;
+  _tzMinutes = tzMinutes;
+  _valid = true;
+  _syncRequested = false;
+  _nextSyncMs = ms + NETCLOCK_SYNC_INTERVAL;
+  _stats.syncs++;
+
+  schedule(local(nowMs));
+}
+
+void NetClock::syncFailed(unsigned long nowMs) {
+  _stats.failures++;
+  _syncRequested = false;
+  _nextSyncMs = extend(nowMs) + NETCLOCK_RETRY_INTERVAL;
+}
+
+bool NetClock::syncDue(unsigned long nowMs) {
+  return _syncRequested || extend(nowMs) >= _nextSyncMs;
+}
+
+time_t NetClock::nextOccurrence(uint16_t minuteOfDay, time_t after) const {
+  time_t day = after / 86400;
+  time_t at = day * 86400 + (time_t)minuteOfDay * 60;
+  return at > after ? at : at + 86400;
+}
+
+void NetClock::schedule(time_t localSec) {
+  // Jobs already scheduled keep their due time, so a clock step can
+  // neither skip nor repeat a run
+  for (uint8_t i = 0; i < _jobCount; i++) {
+    if (_jobs[i].due == 0) {
+      _jobs[i].due = nextOccurrence(_jobs[i].minuteOfDay, localSec);
+    }
+  }
+}
+
+int NetClock::addDaily(uint8_t hour, uint8_t minute, ClockJob job) {
+  if (_jobCount >= NETCLOCK_JOBS || !job || hour > 23 || minute > 59) {
+    return -1;
+  }
+
+  Job &j = _jobs[_jobCount];
+  j.fn = job;
+  j.minuteOfDay = hour * 60 + minute;
+  j.due = 0;
+  if (_valid) {
+    j.due = nextOccurrence(j.minuteOfDay,
+                           (time_t)(_anchorUtcMs / 1000) + _tzMinutes * 60);
+  }
+  return _jobCount++;
+}
+
+time_t NetClock::nextDue(int index) const {
+  if (index < 0 || index >= _jobCount) return 0;
+  return _jobs[index].due;
+}
+
+void NetClock::tick(unsigned long nowMs) {
+  if (!_valid) return;
+
+  time_t now = local(nowMs);
+  for (uint8_t i = 0; i < _jobCount; i++) {
+    Job &j = _jobs[i];
+    if (j.due == 0 || now < j.due) continue;
+
+    // One run however many due times were missed
+    j.due = nextOccurrence(j.minuteOfDay, now);
+    j.fn(now);
+  }
+}
@@ -0,0 +1,114 @@
+#include "NetworkRegistration.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+const char *regStatusName(RegStatus status) {
+  switch (status) {
+    case REG_NOT_SEARCHING: return "NOT_SEARCHING";
+    case REG_HOME:          return "HOME";
+    case REG_SEARCHING:     return "SEARCHING";
+    case REG_DENIED:        return "DENIED";
+    case REG_UNKNOWN:       return "UNKNOWN";
+    case REG_ROAMING:       return "ROAMING";
+    case REG_SMS_HOME:      return "SMS_HOME";
+    case REG_SMS_ROAMING:   return "SMS_ROAMING";
+  }
+  return "?";
+}
+
+static bool isRegistered(RegStatus status) {
+  return status == REG_HOME || status == REG_ROAMING ||
+         status == REG_SMS_HOME || status == REG_SMS_ROAMING;
+}
+
+// Up to max comma separated fields, quotes kept; returns the count
+static uint8_t splitFields(const char *args, const char **fields,
+                           uint8_t max) {
+  uint8_t n = 0;
+  while (*args == ' ') args++;
+  while (n < max && *args && *args != '\r' && *args != '\n') {
+    fields[n++] = args;
+    const char *comma = strchr(args, ',');
+    if (!comma) break;
+    args = comma + 1;
+  }
+  return n;
+}
+
+NetworkRegistration::NetworkRegistration()
+  : _registered(false), _act(-1), _csq(99), _since(0), _changes(0),
+    _onChange(nullptr) {
+  for (uint8_t i = 0; i < REG_DOMAINS; i++) _status[i] = REG_UNKNOWN;
+}
+
+const char *NetworkRegistration::accessTechName() const {
+  switch (_act) {
+    case 0: case 1: case 3: return "GSM";
+    case 2: case 4: case 5: case 6: return "UMTS";
+    case 7: return "LTE";
+  }
+  return "?";
+}
+
+bool NetworkRegistration::update(const char *line, unsigned long nowMs) {
+  if (strncmp(line, "+CREG:", 6) == 0) {
+    return updateReg(REG_CS, line + 6, nowMs);
+  }
+  if (strncmp(line, "+CGREG:", 7) == 0) {
+    return updateReg(REG_PS, line + 7, nowMs);
+  }
+  if (strncmp(line, "+CEREG:", 7) == 0) {
+    return updateReg(REG_EPS, line + 7, nowMs);
+  }
+  if (strncmp(line, "+CSQ:", 5) == 0) {
+    int rssi = atoi(line + 5);
+    if (rssi < 0 || (rssi > 31 && rssi != 99)) return false;
+    _csq = (uint8_t)rssi;
+    return true;
+  }
+  return false;
+}
+
+void NetworkRegistration::updateAll(const char *response,
+                                    unsigned long nowMs) {
+  while (*response) {
+    update(response, nowMs);
+    const char *nl = strchr(response, '\n');
+    if (!nl) break;
+    response = nl + 1;
+  }
+}
+
+bool NetworkRegistration::updateReg(RegDomain domain, const char *args,
+                                    unsigned long nowMs) {
+  // URC:    <stat>[,<lac>,<ci>[,<AcT>]]
+  // Answer: <n>,<stat>[,<lac>,<ci>[,<AcT>]]
+  // Only the answer has an unquoted second field.
+  const char *f[5];
+  uint8_t n = splitFields(args, f, 5);
+  if (n == 0) return false;
+
+  uint8_t statIdx = (n >= 2 && *f[1] != '"') ? 1 : 0;
+  int stat = atoi(f[statIdx]);
+  if (stat < REG_NOT_SEARCHING || stat > REG_SMS_ROAMING) return false;
+  _status[domain] = (RegStatus)stat;
+
+  // AcT follows <lac>,<ci>
+  if (n > statIdx + 3) {
+    _act = (int8_t)atoi(f[statIdx + 3]);
+  }
+
+  bool registered = false;
+  for (uint8_t i = 0; i < REG_DOMAINS; i++) {
+    if (isRegistered(_status[i])) registered = true;
+  }
+
+  if (registered != _registered) {
+    _registered = registered;
+    _since = nowMs;
+    _changes++;
+    if (_onChange) _onChange(registered, nowMs);
+  }
+  return true;
+}
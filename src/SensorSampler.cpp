@@ -0,0 +1,115 @@
+#include "SensorSampler.h"
+
+SensorSampler::SensorSampler(uint8_t gasPin, uint8_t nh3Pin, uint8_t flamePin,
+                             DhtRmt &dht)
+  : _gasPin(gasPin), _nh3Pin(nh3Pin), _flamePin(flamePin), _dht(dht),
+    _sampleHz(SENSOR_SAMPLE_HZ), _dhtIntervalMs(2000),
+    _sampleTask(nullptr), _dhtTask(nullptr) {
+  _mux = portMUX_INITIALIZER_UNLOCKED;
+  memset(&_snap, 0, sizeof(_snap));
+  _snap.temperature = NAN;
+  _snap.humidity = NAN;
+}
+
+bool SensorSampler::begin(uint16_t sampleHz, uint32_t dhtIntervalMs,
+                          BaseType_t core) {
+  if (_sampleTask) return false;
+
+  _adc.begin(_gasPin, _nh3Pin);
+
+  _sampleHz = sampleHz ? sampleHz : SENSOR_SAMPLE_HZ;
+  _dhtIntervalMs = dhtIntervalMs < DHT_MIN_INTERVAL ? DHT_MIN_INTERVAL
+                                                    : dhtIntervalMs;
+
+  // Sampling preempts loop() and the display; a DHT11 transaction sleeps
+  // ~25 ms and runs below everything else
+  BaseType_t rc = xTaskCreatePinnedToCore(sampleTaskEntry, "sensors", 3072,
+                                          this, 5, &_sampleTask, core);
+  if (rc != pdPASS) {
+    _sampleTask = nullptr;
+    Serial.println("❌ Sensor task failed to start");
+    return false;
+  }
+
+  rc = xTaskCreatePinnedToCore(dhtTaskEntry, "dht", 3072, this, 1,
+                               &_dhtTask, core);
+  if (rc != pdPASS) {
+    _dhtTask = nullptr;
+    Serial.println("❌ DHT task failed to start");
+    return false;
+  }
+  return true;
+}
+
+void SensorSampler::snapshot(SensorSnapshot &out) {
+  portENTER_CRITICAL(&_mux);
+  out = _snap;
+  portEXIT_CRITICAL(&_mux);
+}
+
+void SensorSampler::sampleTaskEntry(void *arg) {
+  SensorSampler *self = static_cast<SensorSampler *>(arg);
+  TickType_t period = pdMS_TO_TICKS(1000 / self->_sampleHz);
+  if (period == 0) period = 1;
+
+  TickType_t wake = xTaskGetTickCount();
+  for (;;) {
+    vTaskDelayUntil(&wake, period);
+
+    // vTaskDelayUntil() catches up missed periods without sleeping
+    if ((TickType_t)(xTaskGetTickCount() - wake) >= period) {
+      portENTER_CRITICAL(&self->_mux);
+      self->_snap.overruns++;
+      portEXIT_CRITICAL(&self->_mux);
+    }
+
+    self->sampleOnce(millis());
+  }
+}
+
+void SensorSampler::dhtTaskEntry(void *arg) {
+  SensorSampler *self = static_cast<SensorSampler *>(arg);
+  TickType_t wake = xTaskGetTickCount();
+  for (;;) {
+    self->readDht(millis());
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(self->_dhtIntervalMs));
+  }
+}
+
+void SensorSampler::sampleOnce(uint32_t now) {
+  SensorSample sample;
+  sample.ms = now;
+  sample.gasMv = _snap.gasMv;
+  sample.nh3Mv = _snap.nh3Mv;
+  _adc.read(sample.gasMv, sample.nh3Mv);
+  sample.flame = digitalRead(_flamePin) == LOW;
+
+  bool queued = _ring.put(sample);
+
+  portENTER_CRITICAL(&_mux);
+  if (sample.flame != _snap.flame || _snap.samples == 0) {
+    _snap.flameChangedAt = now;
+  }
+  _snap.sampledAt = now;
+  _snap.gasMv = sample.gasMv;
+  _snap.nh3Mv = sample.nh3Mv;
+  _snap.flame = sample.flame;
+  _snap.samples++;
+  if (!queued) _snap.dropped++;
+  _snap.seq++;
+  portEXIT_CRITICAL(&_mux);
+}
+
+void SensorSampler::readDht(uint32_t now) {
+  // Both values come from one captured frame
+  float temperature = NAN;
+  float humidity = NAN;
+  _dht.read(temperature, humidity);
+
+  portENTER_CRITICAL(&_mux);
+  _snap.temperature = temperature;
+  _snap.humidity = humidity;
+  _snap.dhtAt = now;
+  _snap.seq++;
+  portEXIT_CRITICAL(&_mux);
+}
@@ -0,0 +1,152 @@
+#include "SmsComposer.h"
+
+#include <string.h>
+
+#include <TinyGsmSmsPdu.h>
+
+SmsComposer::SmsComposer(char *buf, size_t size) : _buf(buf), _size(size) {
+  reset();
+}
+
+void SmsComposer::reset() {
+  _len = 0;
+  _septets = 0;
+  _units = 0;
+  _gsm = true;
+  _overflow = false;
+  _truncated = false;
+  _cp = 0;
+  _pending = 0;
+  if (_size) _buf[0] = '\0';
+  beginField();
+}
+
+void SmsComposer::beginField() {
+  _mark.len = _len;
+  _mark.septets = _septets;
+  _mark.units = _units;
+  _mark.gsm = _gsm;
+  _overflow = false;
+}
+
+bool SmsComposer::endField() {
+  bool fits = !_overflow && _pending == 0 && used() <= budget();
+  if (!fits) {
+    _len = _mark.len;
+    _septets = _mark.septets;
+    _units = _mark.units;
+    _gsm = _mark.gsm;
+    _pending = 0;
+    _truncated = true;
+    if (_size) _buf[_len] = '\0';
+  }
+  beginField();
+  return fits;
+}
+
+bool SmsComposer::add(const char *text) {
+  beginField();
+  put(text);
+  return endField();
+}
+
+bool SmsComposer::add(const char *text, const char *shortText) {
+  bool truncated = _truncated;
+  if (add(text)) return true;
+  // Falling back to the short form is not a truncation by itself
+  _truncated = truncated;
+  return add(shortText);
+}
+
+// Same alphabet as the PDU encoder that sends the text, so a message
+// that fits here is never split into two parts on the air
+void SmsComposer::count(uint32_t cp) {
+  int16_t code = TinyGsmSmsPdu::gsm7Code(cp);
+  if (code < 0) _gsm = false;
+  else _septets += code > 0x7F ? 2 : 1;
+  _units += cp > 0xFFFF ? 2 : 1;
+}
+
+void SmsComposer::putBytes(const char *text, size_t n) {
+  if (_overflow) return;
+  if (_len + n >= _size) {
+    _overflow = true;
+    return;
+  }
+  memcpy(_buf + _len, text, n);
+
+  for (size_t i = 0; i < n; i++) {
+    uint8_t b = (uint8_t)text[i];
+    if (_pending) {
+      _cp = (_cp << 6) | (b & 0x3F);
+      if (--_pending == 0) count(_cp);
+    } else if (b < 0x80) {
+      count(b);
+    } else if ((b & 0xE0) == 0xC0) {
+      _cp = b & 0x1F;
+      _pending = 1;
+    } else if ((b & 0xF0) == 0xE0) {
+      _cp = b & 0x0F;
+      _pending = 2;
+    } else {
+      _cp = b & 0x07;
+      _pending = 3;
+    }
+  }
+
+  _len += n;
+  _buf[_len] = '\0';
+}
+
+SmsComposer &SmsComposer::put(const char *text) {
+  putBytes(text, strlen(text));
+  return *this;
+}
+
+SmsComposer &SmsComposer::put(char c) {
+  putBytes(&c, 1);
+  return *this;
+}
+
+SmsComposer &SmsComposer::put(long value) {
+  char digits[12];
+  uint8_t n = 0;
+  unsigned long v = value < 0 ? 0UL - (unsigned long)value
+                              : (unsigned long)value;
+  do {
+    digits[sizeof(digits) - 1 - n++] = '0' + v % 10;
+    v /= 10;
+  } while (v);
+  if (value < 0) digits[sizeof(digits) - 1 - n++] = '-';
+  putBytes(digits + sizeof(digits) - n, n);
+  return *this;
+}
+
+// Same rounding as String(float, decimals), without dtoa's allocations
+SmsComposer &SmsComposer::put(float value, uint8_t decimals) {
+  if (value != value) return put("nan");
+
+  if (value < 0) {
+    put('-');
+    value = -value;
+  }
+
+  float rounding = 0.5f;
+  for (uint8_t i = 0; i < decimals; i++) rounding /= 10.0f;
+  value += rounding;
+
+  unsigned long whole = (unsigned long)value;
+  float frac = value - (float)whole;
+  put((long)whole);
+
+  if (decimals) {
+    put('.');
+    while (decimals--) {
+      frac *= 10.0f;
+      uint8_t digit = (uint8_t)frac;
+      put((char)('0' + digit));
+      frac -= digit;
+    }
+  }
+  return *this;
+}
@@ -0,0 +1,208 @@
+#include "SmsOutbox.h"
+
+SmsOutbox::SmsOutbox(ModemAT &modem)
+  : _modem(modem), _count(0), _seq(0), _ref(0), _inFlight(-1),
+    _pduMode(false), _resultHook(nullptr) {
+  for (uint8_t i = 0; i < SMS_OUTBOX_SIZE; i++) _slots[i].used = false;
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+bool SmsOutbox::send(const String &number, const String &text,
+                     SmsPriority priority, uint32_t *id) {
+  TinyGsmSmsPdu pdu;
+  uint8_t segments = pdu.begin(number.c_str(), text.c_str(), 0);
+  if (!segments) {
+    _stats.rejected++;
+    Serial.println("❌ SMS to " + number + " cannot be encoded, dropped");
+    return false;
+  }
+
+  int slot = -1;
+  for (uint8_t i = 0; i < SMS_OUTBOX_SIZE; i++) {
+    if (!_slots[i].used) {
+      slot = i;
+      break;
+    }
+  }
+
+  // An evicted message is reported failed once the new one is stored, so
+  // the hook sees a consistent outbox even if it queues another message
+  bool evicted = false;
+  uint32_t evictedId = 0;
+  String evictedNumber;
+  uint8_t evictedAttempts = 0;
+  if (slot < 0) {
+    slot = pickVictim(priority);
+    if (slot < 0) {
+      _stats.rejected++;
+      Serial.println("❌ SMS outbox full, message dropped");
+      return false;
+    }
+    Serial.println("⚠ SMS outbox full, evicting message to " +
+                   _slots[slot].number);
+    evicted = true;
+    evictedId = _slots[slot].seq;
+    evictedNumber = _slots[slot].number;
+    evictedAttempts = _slots[slot].attempts;
+    release(slot);
+    _stats.failed++;
+  }
+
+  Message &msg = _slots[slot];
+  msg.used = true;
+  msg.priority = priority;
+  msg.attempts = 0;
+  msg.ref = ++_ref;
+  msg.segment = 0;
+  msg.segments = segments;
+  msg.seq = ++_seq;
+  if (!msg.seq) msg.seq = ++_seq;          // 0 is never an id
+  msg.queuedAt = millis();
+  msg.nextTryAt = msg.queuedAt;
+  msg.number = number;
+  msg.text = text;
+  _count++;
+  _stats.queued++;
+  if (id) *id = msg.seq;
+
+  Serial.printf("✉ SMS queued to %s (%u bytes, %s, %u part(s), prio %d, depth %u)\n",
+    number.c_str(), text.length(), pdu.ucs2() ? "UCS-2" : "GSM-7",
+    segments, priority, _count);
+
+  if (evicted && _resultHook) {
+    _resultHook(evictedId, evictedNumber, false, evictedAttempts);
+  }
+  return true;
+}
+
+// Lowest priority, then newest, never the one in flight
+int SmsOutbox::pickVictim(SmsPriority incoming) const {
+  int victim = -1;
+  for (uint8_t i = 0; i < SMS_OUTBOX_SIZE; i++) {
+    const Message &m = _slots[i];
+    if (!m.used || (int)i == _inFlight || m.priority >= incoming) continue;
+    if (victim < 0 ||
+        m.priority < _slots[victim].priority ||
+        (m.priority == _slots[victim].priority &&
+         m.seq > _slots[victim].seq)) {
+      victim = i;
+    }
+  }
+  return victim;
+}
+
+// Highest priority, then oldest, among the messages due now
+int SmsOutbox::pickNext(unsigned long now) const {
+  int next = -1;
+  for (uint8_t i = 0; i < SMS_OUTBOX_SIZE; i++) {
+    const Message &m = _slots[i];
+    if (!m.used || (long)(now - m.nextTryAt) < 0) continue;
+    if (next < 0 ||
+        m.priority > _slots[next].priority ||
+        (m.priority == _slots[next].priority && m.seq < _slots[next].seq)) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+void SmsOutbox::poll() {
+  if (_inFlight >= 0 || _count == 0) return;
+
+  int slot = pickNext(millis());
+  if (slot >= 0) submit(slot);
+}
+
+void SmsOutbox::submit(int slot) {
+  Message &msg = _slots[slot];
+
+  TinyGsmSmsPdu pdu;
+  char hex[TINY_GSM_PDU_HEX_MAX];
+  pdu.begin(msg.number.c_str(), msg.text.c_str(), msg.ref);
+  uint16_t tpduLen = pdu.encode(msg.segment, hex, sizeof(hex));
+
+  if (!_pduMode) {
+    // Completion order follows queue order, so CMGS below runs after this
+    if (!_modem.enqueue("AT+CMGF=0", 1000, onSetupDone, this)) return;
+  }
+
+  char cmd[16];
+  snprintf(cmd, sizeof(cmd), "AT+CMGS=%u", tpduLen);
+  if (!_modem.enqueue(cmd, SMS_SUBMIT_TIMEOUT, onSubmitDone, this, hex)) {
+    return;  // AT queue full, try again on the next poll()
+  }
+
+  msg.attempts++;
+  _inFlight = slot;
+  _stats.parts++;
+  Serial.printf("✉ Submitting SMS to %s, part %u/%u (attempt %u/%u)\n",
+    msg.number.c_str(), msg.segment + 1, msg.segments, msg.attempts,
+    SMS_MAX_ATTEMPTS);
+}
+
+void SmsOutbox::onSetupDone(const AtResult &result, void *ctx) {
+  SmsOutbox *self = static_cast<SmsOutbox *>(ctx);
+  self->_pduMode = result.ok();
+}
+
+void SmsOutbox::onSubmitDone(const AtResult &result, void *ctx) {
+  static_cast<SmsOutbox *>(ctx)->complete(result);
+}
+
+void SmsOutbox::complete(const AtResult &result) {
+  int slot = _inFlight;
+  _inFlight = -1;
+  if (slot < 0) return;
+
+  Message &msg = _slots[slot];
+  unsigned long now = millis();
+
+  if (result.ok() && ++msg.segment < msg.segments) {
+    // Next part right away, same attempt budget
+    msg.nextTryAt = now;
+  } else if (result.ok()) {
+    uint32_t queueMs = now - msg.queuedAt;
+    _stats.sent++;
+    _stats.lastSubmitMs = result.elapsedMs;
+    _stats.totalSubmitMs += result.elapsedMs;
+    if (result.elapsedMs > _stats.maxSubmitMs) {
+      _stats.maxSubmitMs = result.elapsedMs;
+    }
+    _stats.lastQueueMs = queueMs;
+    if (queueMs > _stats.maxQueueMs) _stats.maxQueueMs = queueMs;
+
+    Serial.printf("✅ SMS sent to %s in %lu ms (%lu ms since queued)\n",
+      msg.number.c_str(), (unsigned long)result.elapsedMs,
+      (unsigned long)queueMs);
+    if (_resultHook) _resultHook(msg.seq, msg.number, true, msg.attempts);
+    release(slot);
+  } else {
+    // The modem may have lost PDU mode (restart, +CMS ERROR) - resend it
+    _pduMode = false;
+
+    if (msg.attempts >= SMS_MAX_ATTEMPTS) {
+      _stats.failed++;
+      Serial.printf("❌ SMS to %s failed (%s), giving up\n",
+        msg.number.c_str(), atStatusName(result.status));
+      if (_resultHook) _resultHook(msg.seq, msg.number, false, msg.attempts);
+      release(slot);
+    } else {
+      _stats.retries++;
+      unsigned long backoff = (unsigned long)SMS_RETRY_BASE_MS
+                              << (msg.attempts - 1);
+      msg.nextTryAt = now + backoff;
+      Serial.printf("⏱ SMS to %s failed (%s), retry in %lu ms\n",
+        msg.number.c_str(), atStatusName(result.status), backoff);
+    }
+  }
+
+  poll();
+}
+
+void SmsOutbox::release(int slot) {
+  Message &msg = _slots[slot];
+  msg.used = false;
+  msg.number = "";
+  msg.text = "";
+  _count--;
+}
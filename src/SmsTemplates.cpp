@@ -0,0 +1,127 @@
+#include "SmsTemplates.h"
+
+void appendAlertReasons(SmsComposer &msg, const AlertLimits &limits,
+                        float temp, float hum, int gas, int nh3, bool fire) {
+  size_t start = msg.length();
+
+  if (fire)
+    msg.add("🔥 FIRE DETECTED\n", "FIRE\n");
+
+  msg.beginField();
+  if (temp < limits.tempLow)
+    msg.put("❄ TEMP LOW (").put(temp, 1).put("C)\n");
+  else if (temp > limits.tempHigh)
+    msg.put("🔥 TEMP HIGH (").put(temp, 1).put("C)\n");
+  msg.endField();
+
+  msg.beginField();
+  if (hum < limits.humLow)
+    msg.put("💧 HUMIDITY LOW (").put(hum, 0).put("%)\n");
+  else if (hum > limits.humHigh)
+    msg.put("💧 HUMIDITY HIGH (").put(hum, 0).put("%)\n");
+  msg.endField();
+
+  msg.beginField();
+  if (gas > limits.gas)
+    msg.put("🧪 GAS HIGH (").put(gas).put(" PPM)\n");
+  msg.endField();
+
+  msg.beginField();
+  if (nh3 > limits.nh3)
+    msg.put("☠ AMMONIA HIGH (").put(nh3).put(" PPM)\n");
+  msg.endField();
+
+  if (msg.length() == start) msg.add("Unknown alert\n");
+}
+
+void composeCallAlert(SmsComposer &msg, const AlertLimits &limits,
+                      int attempt, float temp, float hum, int gas, int nh3,
+                      bool fire) {
+  msg.beginField();
+  msg.put("ALERT #").put(attempt).put('\n');
+  msg.endField();
+
+  // Alert reasons
+  if (fire) msg.add("FIRE! ");
+  if (temp < limits.tempLow) msg.add("COLD ");
+  if (temp > limits.tempHigh) msg.add("HOT ");
+  if (hum < limits.humLow) msg.add("DRY ");
+  if (hum > limits.humHigh) msg.add("WET ");
+  if (gas > limits.gas) msg.add("GAS ");
+  if (nh3 > limits.nh3) msg.add("NH3 ");
+
+  msg.add("\n");
+
+  // Current values
+  msg.beginField();
+  msg.put("T:").put(temp, 1).put("C ");
+  msg.put("H:").put(hum, 0).put("% ");
+  msg.put("G:").put(gas).put(' ');
+  msg.put("N:").put(nh3);
+  msg.endField();
+  msg.add("\nCalling now");
+}
+
+void composeParameters(SmsComposer &msg, float temp, float hum, int gas,
+                       int nh3, bool fire) {
+  msg.add("ENV MONITOR:\n");
+
+  msg.beginField();
+  msg.put("Temp: ").put(temp, 1).put("C\n");
+  msg.endField();
+
+  msg.beginField();
+  msg.put("Humidity: ").put(hum, 0).put("%\n");
+  msg.endField();
+
+  msg.beginField();
+  msg.put("Carbon Monoxide: ").put(gas).put(" PPM\n");
+  if (!msg.endField()) {
+    msg.beginField();
+    msg.put("CO: ").put(gas).put(" PPM\n");
+    msg.endField();
+  }
+
+  msg.beginField();
+  msg.put("Ammonia: ").put(nh3).put(" PPM\n");
+  msg.endField();
+
+  msg.add(fire ? "Fire: YES" : "Fire: NO");
+}
+
+void composeDailyReport(SmsComposer &msg, float minTemp, float maxTemp,
+                        float minHum, float maxHum) {
+  msg.add("📊 DAILY REPORT\n", "DAILY REPORT\n");
+
+  msg.beginField();
+  msg.put("Temp Min: ").put(minTemp, 1).put("C\n");
+  if (!msg.endField()) {
+    msg.beginField();
+    msg.put("Tmin:").put(minTemp, 1).put("C\n");
+    msg.endField();
+  }
+
+  msg.beginField();
+  msg.put("Temp Max: ").put(maxTemp, 1).put("C\n");
+  if (!msg.endField()) {
+    msg.beginField();
+    msg.put("Tmax:").put(maxTemp, 1).put("C\n");
+    msg.endField();
+  }
+
+  msg.beginField();
+  msg.put("Hum Min: ").put(minHum, 0).put("%\n");
+  if (!msg.endField()) {
+    msg.beginField();
+    msg.put("Hmin:").put(minHum, 0).put("%\n");
+    msg.endField();
+  }
+
+  msg.beginField();
+  msg.put("Hum Max: ").put(maxHum, 0).put("%");
+  if (!msg.endField()) {
+    msg.beginField();
+    msg.put("Hmax:").put(maxHum, 0).put("%");
+    msg.endField();
+  }
+}
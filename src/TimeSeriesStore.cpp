@@ -0,0 +1,243 @@
+#include "TimeSeriesStore.h"
+
+#include <string.h>
+
+static_assert(sizeof(TimeSeriesStore) <= TS_BUDGET_BYTES,
+              "TimeSeriesStore exceeds its RAM budget");
+static_assert(TS_BLOCK_SECONDS <= 64, "Block masks are 64 bit");
+
+void TsRollup::reset(uint32_t at) {
+  start = at;
+  count = 0;
+  flame = 0;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    lo[c] = INT16_MAX;
+    hi[c] = INT16_MIN;
+    sum[c] = 0;
+  }
+}
+
+void TsRollup::add(const TsSample &sample) {
+  count++;
+  if (sample.flame) flame++;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    int16_t v = sample.value[c];
+    if (v < lo[c]) lo[c] = v;
+    if (v > hi[c]) hi[c] = v;
+    sum[c] += v;
+  }
+}
+
+void TsRollup::merge(const TsRollup &other) {
+  count += other.count;
+  flame += other.flame;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    if (other.lo[c] < lo[c]) lo[c] = other.lo[c];
+    if (other.hi[c] > hi[c]) hi[c] = other.hi[c];
+    sum[c] += other.sum[c];
+  }
+}
+
+void TsRollup::merge(const TsPoint &point) {
+  count += point.count;
+  flame += point.flame;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    if (point.min[c] < lo[c]) lo[c] = point.min[c];
+    if (point.max[c] > hi[c]) hi[c] = point.max[c];
+    sum[c] += (int32_t)point.mean[c] * point.count;
+  }
+}
+
+int16_t TsRollup::mean(uint8_t channel) const {
+  if (!count) return 0;
+  int32_t half = sum[channel] >= 0 ? count / 2 : -(int32_t)(count / 2);
+  return (int16_t)((sum[channel] + half) / (int32_t)count);
+}
+
+void TsRollup::toPoint(TsPoint &point) const {
+  point.t = start;
+  point.count = count;
+  point.flame = flame;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    point.min[c] = lo[c];
+    point.max[c] = hi[c];
+    point.mean[c] = mean(c);
+  }
+}
+
+TimeSeriesStore::TimeSeriesStore()
+  : _openStart(0), _openValid(0), _openFlame(0), _any(false), _lastSec(0),
+    _samples(0), _rejected(0), _quantized(0) {
+  memset(_blkValid, 0, sizeof(_blkValid));
+  memset(_blkStart, 0, sizeof(_blkStart));
+}
+
+bool TimeSeriesStore::add(uint32_t sec, const TsSample &sample) {
+  if (_any && sec <= _lastSec) {
+    _rejected++;
+    return false;
+  }
+
+  uint32_t blockStart = sec - sec % TS_BLOCK_SECONDS;
+  if (_any && blockStart != _openStart) closeBlock();
+  if (!_any || blockStart != _openStart) {
+    _openStart = blockStart;
+    _openValid = 0;
+    _openFlame = 0;
+  }
+
+  uint8_t i = sec - blockStart;
+  _openValid |= 1ULL << i;
+  if (sample.flame) _openFlame |= 1ULL << i;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    _openValue[c][i] = sample.value[c];
+  }
+
+  // Rollups see the exact values; a closed minute feeds the hour
+  TsRollup one;
+  one.reset(sec);
+  one.add(sample);
+  TsRollup minute;
+  if (_minutes.merge(one, minute)) {
+    TsRollup hour;
+    _hours.merge(minute, hour);
+  }
+
+  _any = true;
+  _lastSec = sec;
+  _samples++;
+  return true;
+}
+
+void TimeSeriesStore::closeBlock() {
+  uint16_t slot = (_openStart / TS_BLOCK_SECONDS) % TS_RAW_BLOCKS;
+  _blkStart[slot] = _openStart;
+  _blkValid[slot] = _openValid;
+  _blkFlame[slot] = _openFlame;
+
+  bool quantized = false;
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    int16_t lo = INT16_MAX;
+    int16_t hi = INT16_MIN;
+    for (uint8_t i = 0; i < TS_BLOCK_SECONDS; i++) {
+      if (!(_openValid & (1ULL << i))) continue;
+      if (_openValue[c][i] < lo) lo = _openValue[c][i];
+      if (_openValue[c][i] > hi) hi = _openValue[c][i];
+    }
+    if (lo > hi) lo = hi = 0;
+
+    // Smallest shift that fits the block's range into a byte
+    uint32_t range = (uint32_t)(hi - lo);
+    uint8_t shift = 0;
+    while ((range >> shift) > 255) shift++;
+    if (shift) quantized = true;
+
+    _blkBase[c][slot] = lo;
+    _blkShift[c][slot] = shift;
+    for (uint8_t i = 0; i < TS_BLOCK_SECONDS; i++) {
+      _blkCode[c][slot][i] = (_openValid & (1ULL << i))
+        ? (uint8_t)((uint32_t)(_openValue[c][i] - lo) >> shift) : 0;
+    }
+  }
+  if (quantized) _quantized++;
+}
+
+uint32_t TimeSeriesStore::queryBlock(uint32_t block, uint32_t from,
+                                     uint32_t to, TsVisitor visit, void *ctx,
+                                     bool &stopped) const {
+  uint32_t start = block * TS_BLOCK_SECONDS;
+  bool open = start == _openStart;
+  uint16_t slot = block % TS_RAW_BLOCKS;
+  if (!open && (_blkStart[slot] != start || !_blkValid[slot])) return 0;
+
+  uint64_t valid = open ? _openValid : _blkValid[slot];
+  uint64_t flame = open ? _openFlame : _blkFlame[slot];
+
+  uint32_t rows = 0;
+  TsPoint point;
+  point.count = 1;
+  for (uint8_t i = 0; i < TS_BLOCK_SECONDS; i++) {
+    uint32_t t = start + i;
+    if (t < from) continue;
+    if (t > to) break;
+    if (!(valid & (1ULL << i))) continue;
+
+    point.t = t;
+    point.flame = (flame >> i) & 1;
+    for (uint8_t c = 0; c < TS_ANALOG; c++) {
+      int16_t v;
+      if (open) {
+        v = _openValue[c][i];
+      } else {
+        // Middle of the quantization step
+        uint8_t shift = _blkShift[c][slot];
+        int32_t q = (int32_t)_blkCode[c][slot][i] << shift;
+        if (shift) q += 1 << (shift - 1);
+        v = (int16_t)(_blkBase[c][slot] + q);
+      }
+      point.min[c] = point.max[c] = point.mean[c] = v;
+    }
+    rows++;
+    if (!visit(point, ctx)) {
+      stopped = true;
+      break;
+    }
+  }
+  return rows;
+}
+
+uint32_t TimeSeriesStore::query(TsTier tier, uint32_t from, uint32_t to,
+                                TsVisitor visit, void *ctx) const {
+  if (!_any || from > to) return 0;
+  bool stopped = false;
+
+  if (tier == TS_MINUTES) return _minutes.query(from, to, visit, ctx, stopped);
+  if (tier == TS_HOURS) return _hours.query(from, to, visit, ctx, stopped);
+
+  uint32_t newest = _openStart / TS_BLOCK_SECONDS;
+  uint32_t first = from / TS_BLOCK_SECONDS;
+  if (newest >= TS_RAW_BLOCKS && first < newest - (TS_RAW_BLOCKS - 1)) {
+    first = newest - (TS_RAW_BLOCKS - 1);
+  }
+
+  uint32_t rows = 0;
+  for (uint32_t b = first; b <= newest && !stopped; b++) {
+    if (b * TS_BLOCK_SECONDS > to) break;
+    rows += queryBlock(b, from, to, visit, ctx, stopped);
+  }
+  return rows;
+}
+
+TsStats TimeSeriesStore::stats() const {
+  TsStats s;
+  s.samples = _samples;
+  s.rejected = _rejected;
+  s.quantizedBlocks = _quantized;
+  s.minutesStored = _minutes.stored();
+  s.hoursStored = _hours.stored();
+
+  uint32_t newest = _openStart / TS_BLOCK_SECONDS;
+  uint16_t seconds = 0;
+  for (uint16_t i = 0; i < TS_RAW_BLOCKS; i++) {
+    uint32_t block = _blkStart[i] / TS_BLOCK_SECONDS;
+    if (!_blkValid[i] || block == newest) continue;
+    if (newest >= TS_RAW_BLOCKS && block < newest - (TS_RAW_BLOCKS - 1)) {
+      continue;
+    }
+    seconds += __builtin_popcountll(_blkValid[i]);
+  }
+  if (_any) seconds += __builtin_popcountll(_openValid);
+  s.secondsStored = seconds;
+  return s;
+}
+
+float TimeSeriesStore::bytesPerSecondSample() {
+  size_t perBlock = sizeof(uint32_t) + 2 * sizeof(uint64_t) +
+                    TS_ANALOG * (sizeof(int16_t) + sizeof(uint8_t) +
+                                 TS_BLOCK_SECONDS);
+  return (float)perBlock / TS_BLOCK_SECONDS;
+}
+
+size_t TimeSeriesStore::bytes() {
+  return sizeof(TimeSeriesStore);
+}
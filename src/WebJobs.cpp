@@ -0,0 +1,133 @@
+#include "WebJobs.h"
+
+WebJobs::WebJobs() : _nextId(1), _mux(portMUX_INITIALIZER_UNLOCKED) {
+  memset(_jobs, 0, sizeof(_jobs));
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+uint16_t WebJobs::submit(WebJobKind kind) {
+  unsigned long now = millis();
+  uint16_t id = 0;
+
+  portENTER_CRITICAL(&_mux);
+  int slot = -1;
+  for (uint8_t i = 0; i < WEB_JOB_SLOTS; i++) {
+    WebJobState state = _jobs[i].state;
+    if (state == JOB_QUEUED || state == JOB_RUNNING) continue;
+    if (state == JOB_FREE) {
+      slot = i;
+      break;
+    }
+    if (slot < 0 || (long)(_jobs[i].finishedAt - _jobs[slot].finishedAt) < 0) {
+      slot = i;   // Finished longest ago
+    }
+  }
+
+  if (slot >= 0) {
+    WebJob &job = _jobs[slot];
+    id = _nextId++;
+    if (!_nextId) _nextId = 1;  // 0 means "none"
+    job.id = id;
+    job.kind = kind;
+    job.state = JOB_QUEUED;
+    job.queuedAt = now;
+    job.startedAt = 0;
+    job.finishedAt = 0;
+    job.text[0] = 0;
+    _stats.submitted++;
+  } else {
+    _stats.rejected++;
+  }
+  portEXIT_CRITICAL(&_mux);
+  return id;
+}
+
+bool WebJobs::next(WebJob &job) {
+  unsigned long now = millis();
+  bool found = false;
+
+  portENTER_CRITICAL(&_mux);
+  int oldest = -1;
+  for (uint8_t i = 0; i < WEB_JOB_SLOTS; i++) {
+    if (_jobs[i].state != JOB_QUEUED) continue;
+    if (oldest < 0 || (int16_t)(_jobs[i].id - _jobs[oldest].id) < 0) {
+      oldest = i;
+    }
+  }
+  if (oldest >= 0) {
+    WebJob &slot = _jobs[oldest];
+    slot.state = JOB_RUNNING;
+    slot.startedAt = now;
+    uint32_t wait = now - slot.queuedAt;
+    if (wait > _stats.maxWaitMs) _stats.maxWaitMs = wait;
+    job = slot;
+    found = true;
+  }
+  portEXIT_CRITICAL(&_mux);
+  return found;
+}
+
+void WebJobs::finish(uint16_t id, bool ok, const char *text) {
+  unsigned long now = millis();
+
+  portENTER_CRITICAL(&_mux);
+  for (uint8_t i = 0; i < WEB_JOB_SLOTS; i++) {
+    WebJob &job = _jobs[i];
+    if (job.id != id || job.state != JOB_RUNNING) continue;
+    job.state = ok ? JOB_DONE : JOB_FAILED;
+    job.finishedAt = now;
+    strncpy(job.text, text ? text : "", WEB_JOB_TEXT_LEN - 1);
+    job.text[WEB_JOB_TEXT_LEN - 1] = 0;
+    if (ok) _stats.done++;
+    else _stats.failed++;
+    break;
+  }
+  portEXIT_CRITICAL(&_mux);
+}
+
+bool WebJobs::get(uint16_t id, WebJob &job) {
+  bool found = false;
+  portENTER_CRITICAL(&_mux);
+  for (uint8_t i = 0; i < WEB_JOB_SLOTS; i++) {
+    if (_jobs[i].state != JOB_FREE && _jobs[i].id == id) {
+      job = _jobs[i];
+      found = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_mux);
+  return found;
+}
+
+bool WebJobs::pending(WebJobKind kind) {
+  bool found = false;
+  portENTER_CRITICAL(&_mux);
+  for (uint8_t i = 0; i < WEB_JOB_SLOTS; i++) {
+    if (_jobs[i].kind == kind &&
+        (_jobs[i].state == JOB_QUEUED || _jobs[i].state == JOB_RUNNING)) {
+      found = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_mux);
+  return found;
+}
+
+WebJobStats WebJobs::stats() {
+  WebJobStats s;
+  portENTER_CRITICAL(&_mux);
+  s = _stats;
+  portEXIT_CRITICAL(&_mux);
+  return s;
+}
+
+const char *webJobStateName(WebJobState state) {
+  switch (state) {
+    case JOB_FREE:    return "free";
+    case JOB_QUEUED:  return "queued";
+    case JOB_RUNNING: return "running";
+    case JOB_DONE:    return "done";
+    case JOB_FAILED:  return "failed";
+  }
+  return "?";
+}
@@ -1,19 +1,44 @@
 // ================== LIBRARIES ==================
-#include <DHT.h>
 #include <SPI.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7789.h>
 #include <WiFi.h>
 #include <WebServer.h>
 #include <Preferences.h>
+#include "ModemAT.h"
+#include "AlertEscalation.h"
+#include "CountingTFT.h"
+#include "Dashboard.h"
+#include "SensorSampler.h"
+#include "DhtRmt.h"
+#include "FlameTrigger.h"
+#include "SignalFilter.h"
+#include "GasCurve.h"
+#include "SmsOutbox.h"
+#include "SmsComposer.h"
+#include "SmsTemplates.h"
+#include "NetClock.h"
+#include "NetworkRegistration.h"
+#include "BootSequence.h"
+#include "ModemConfig.h"
+#include "TimeSeriesStore.h"
+#include "EventJournal.h"
+#include "ChunkedResponse.h"
+#include "WebJobs.h"
+#include "LiveFeed.h"
+#include <sys/time.h>
 
 // ===== GAS SENSOR STABILITY FILTER =====
-#define GAS_FILTER_SIZE 10
+// Median rejects single-sample spikes, the average smooths what is left
+#define GAS_MEDIAN_SIZE 5
+#define GAS_FILTER_SIZE 25    // 0.5 s at 50 Hz
 
-int gasSamples[GAS_FILTER_SIZE];
-int nh3Samples[GAS_FILTER_SIZE];
-uint8_t gasIndex = 0;
-bool filterFilled = false;
+SlidingMedian<int, GAS_MEDIAN_SIZE> gasMedian;
+SlidingMedian<int, GAS_MEDIAN_SIZE> nh3Median;
+MovingAverage<int, GAS_FILTER_SIZE> gasAverage;
+MovingAverage<int, GAS_FILTER_SIZE> nh3Average;
+int filteredGasMv = 0;
+int filteredNH3Mv = 0;
 
 bool dailyReportEnabled = true;
 float lastValidTemp = 25.0;
@@ -37,9 +62,6 @@ String phoneNumbers[MAX_CONTACTS] = {
   "+944444444444"
 };
 
-int currentContactIndex = 0;
-int attemptsForCurrentNumber = 0;
-bool alertAcknowledged = false;
 
 // ================== DAILY STATS ==================
 struct DailyStats {
@@ -51,7 +73,6 @@ struct DailyStats {
 };
 
 DailyStats todayStats;
-int lastRecordedDay = -1;
 
 void resetDailyStats() {
   todayStats.minTemp = 1000;
@@ -83,75 +104,181 @@ void updateActiveContacts() {
 
 // ===== FUNCTION PROTOTYPES =====
 String sendATCommand(const char *cmd, uint32_t waitMs);
-bool sendSMS(String phoneNumber, String message);
-bool getNetworkTime(int &hour, int &minute, int &day);
+bool sendSMS(const String &phoneNumber, const char *message,
+             SmsPriority priority = SMS_PRIO_NORMAL, uint32_t *id = nullptr);
+void handleModemURC(const String &urc);
+void escalationCallEvent(CallEvent event);
+void registerModemURCs();
+bool modemReady();
+void handleHistory();
+void handleEvents();
+void onTestSmsResult(uint32_t smsId, bool sent, uint8_t attempts);
+
+// Background start-up stages, see BOOT STAGES below
+BootSequence boot;
+
+// ================== MODEM AT ENGINE ==================
+ModemAT modem;
+SmsOutbox smsOutbox(modem);
+
+// ================== EVENT JOURNAL ==================
+// Alarms, calls, SMS results and settings changes, kept on flash
+EventJournal journal;
+
+// Last digits of a number, enough to tell contacts apart in the log
+static const char *numberTail(const String &number) {
+  const char *s = number.c_str();
+  size_t len = number.length();
+  return len > JOURNAL_DETAIL_LEN ? s + len - JOURNAL_DETAIL_LEN : s;
+}
 
-bool getNetworkTime(int &hour, int &minute, int &day) {
-  String resp = sendATCommand("AT+CCLK?", 2000);
-  int q1 = resp.indexOf("\"");
-  int q2 = resp.indexOf("\"", q1 + 1);
-  if (q1 < 0 || q2 < 0) return false;
+// ================== LIVE FEED ==================
+// Readings and alert / call changes pushed to /live subscribers
+LiveFeed live;
 
-  String t = resp.substring(q1 + 1, q2);
-  
-  // Check if time is valid (not 1970)
-  String year = t.substring(0, 2);
-  if (year.toInt() < 20) {
+void onSmsResult(uint32_t id, const String &number, bool sent,
+                 uint8_t attempts) {
+  journal.append(sent ? JEV_SMS_SENT : JEV_SMS_FAILED, attempts, 0, 0,
+                 numberTail(number));
+  onTestSmsResult(id, sent, attempts);
+}
+
+// ================== NETWORK REGISTRATION ==================
+#define REGISTRATION_TIMEOUT 60000
+
+NetworkRegistration netReg;
+
+void onRegistrationURC(const String &urc) {
+  netReg.update(urc.c_str(), millis());
+}
+
+void onRegistrationChanged(bool registered, unsigned long now) {
+  if (registered) boot.milestone("registered");
+  Serial.printf("%s Network %s (%s, CSQ %u)\n",
+    registered ? "✅" : "⚠", registered ? "registered" : "lost",
+    netReg.accessTechName(), netReg.csq());
+}
+
+void onRegistrationQuery(const AtResult &result, void *) {
+  if (result.ok()) netReg.updateAll(result.response.c_str(), millis());
+}
+
+// ================== NETWORK CLOCK ==================
+#define DAILY_REPORT_HOUR   8
+#define DAILY_REPORT_MINUTE 0
+
+NetClock netClock;
+bool clockQueryPending = false;
+
+// Keep the system clock in step so time()/localtime() agree with netClock
+void setSystemClock(unsigned long nowMs) {
+  struct timeval tv;
+  tv.tv_sec = netClock.utc(nowMs);
+  tv.tv_usec = 0;
+  settimeofday(&tv, nullptr);
+
+  // POSIX TZ offsets are west of UTC
+  int16_t tz = netClock.tzMinutes();
+  char zone[16];
+  snprintf(zone, sizeof(zone), "NET%c%d:%02d", tz > 0 ? '-' : '+',
+           abs(tz) / 60, abs(tz) % 60);
+  setenv("TZ", zone, 1);
+  tzset();
+}
+
+void onNetworkTime(const AtResult &result, void *) {
+  clockQueryPending = false;
+  unsigned long now = millis();
+
+  if (!result.ok()) {
+    netClock.syncFailed(now);
+    return;
+  }
+  if (!netClock.syncFromCclk(result.response.c_str(), now)) {
     Serial.println("⚠ Network time not synchronized yet");
-    return false;
+    return;
   }
-  
-  day = t.substring(6, 8).toInt();
-  hour = t.substring(9, 11).toInt();
-  minute = t.substring(12, 14).toInt();
-  return true;
+
+  setSystemClock(now);
+  const ClockStats &cs = netClock.stats();
+  Serial.printf("🕒 Clock synced (step %ld ms, drift %ld ppm)\n",
+    (long)cs.lastStepMs, (long)cs.driftPpm);
 }
 
-void checkDailyReport() {
-  if (!dailyReportEnabled) return;
+// +CTZV: the network sent a new time / zone, pick it up now
+void onTimeZoneURC(const String &urc) {
+  netClock.requestSync();
+}
 
-  int hour, minute, day;
-  if (!getNetworkTime(hour, minute, day)) return;
+void serviceClock() {
+  unsigned long now = millis();
+  if (!clockQueryPending && netClock.syncDue(now)) {
+    // Result is handled in onNetworkTime() once +CCLK arrives
+    clockQueryPending = modem.enqueue("AT+CCLK?", 2000, onNetworkTime);
+  }
+  netClock.tick(now);
+}
 
-  if (day != lastRecordedDay && hour == 8 && minute < 5) {
-    String msg = "📊 DAILY REPORT\n";
-    msg += "Temp Min: " + String(todayStats.minTemp,1) + "C\n";
-    msg += "Temp Max: " + String(todayStats.maxTemp,1) + "C\n";
-    msg += "Hum Min: " + String(todayStats.minHum,0) + "%\n";
-    msg += "Hum Max: " + String(todayStats.maxHum,0) + "%";
+// Runs from netClock.tick() once a day at DAILY_REPORT_HOUR
+void sendDailyReport(time_t local) {
+  if (!dailyReportEnabled) return;
 
-    sendSMS(phoneNumbers[0], msg);
+  char text[SMS_TEXT_MAX];
+  SmsComposer msg(text, sizeof(text));
+  composeDailyReport(msg, todayStats.minTemp, todayStats.maxTemp,
+                     todayStats.minHum, todayStats.maxHum);
 
-    lastRecordedDay = day;
-    resetDailyStats();
-  }
+  sendSMS(phoneNumbers[0], msg.c_str(), SMS_PRIO_LOW);
+  resetDailyStats();
 }
 
 // ===== SENSOR CALIBRATION =====
-#define ADC_MAX 4095.0
 #define ADC_VREF 3.3
 #define MQ2_RL 10.0
-#define MQ2_R0 9.83
+// R0 = Rs in clean air / the datasheet's clean-air Rs/R0 factor. The
+// clean-air output is the zero point the old linear map() used
+#define MQ2_CLEAN_AIR_RATIO 9.83
+#define MQ2_CLEAN_AIR_MV    240
+#define MQ2_R0 (MQ2_RL * (ADC_VREF * 1000.0 - MQ2_CLEAN_AIR_MV) / \
+                MQ2_CLEAN_AIR_MV / MQ2_CLEAN_AIR_RATIO)
 #define MQ137_RL 10.0
 #define MQ137_R0 12.0
 #define GAS_MAX_PPM   5000
 #define NH3_MAX_PPM   300
 
+// MQ-2 reported as carbon monoxide (see sendParametersSMS)
+struct Mq2Model : Mq2CoCurve {
+  static constexpr double VC = ADC_VREF, RL = MQ2_RL, R0 = MQ2_R0;
+  static constexpr double MAX_PPM = GAS_MAX_PPM;
+};
+
+struct Mq137Model : Mq137Nh3Curve {
+  static constexpr double VC = ADC_VREF, RL = MQ137_RL, R0 = MQ137_R0;
+  static constexpr double MAX_PPM = NH3_MAX_PPM;
+};
+
 // ================== DHT ==================
 #define DHTPIN 2
-#define DHTTYPE DHT11
-DHT dht(DHTPIN, DHTTYPE);
+DhtRmt dht(DHTPIN, DHT_MODEL_11);
 
 // ================== SENSORS ==================
 #define MQ_GAS_PIN   34
 #define MQ137_PIN    35
 #define FLAME_PIN    33
 
+// Gas / flame sampling rate, independent of the display tick
+#define SENSOR_RATE_HZ   50
+#define DHT_INTERVAL     2000
+
+SensorSampler sensors(MQ_GAS_PIN, MQ137_PIN, FLAME_PIN, dht);
+bool lastFlameState = false;
+
 // ================== LCD (WAVESHARE 1.5") ==================
 #define TFT_CS   5
 #define TFT_DC   16
 #define TFT_RST  17
-Adafruit_ST7789 tft = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
+CountingST7789 tft(TFT_CS, TFT_DC, TFT_RST);
+Dashboard dashboard(tft);
 
 // ================== A7670 MODEM ==================
 #define MODEM_PWRKEY   4
@@ -170,8 +297,13 @@ Preferences preferences;
 String TO_PHONE_NUMBER = "+918010845905";
 
 // ================== THRESHOLDS ==================
-int GAS_LIMIT = 1800;
-int AMMONIA_LIMIT = 200;
+// In ppm on the datasheet curves. The old 1800 / 200 were points on the
+// linear map() scale (1255 / 2120 mV) and mean nothing in ppm.
+// CO: EN 50291 alarms within 40 min at 100 ppm and 3 min at 300 ppm;
+// 200 ppm is also the anchor point of the MQ-2 curve (about 420 mV).
+// NH3: OSHA PEL 50 ppm (about 1550 mV on the MQ-137)
+int GAS_LIMIT = 200;
+int AMMONIA_LIMIT = 50;
 float TEMP_LOW  = 10.0;
 float TEMP_HIGH = 35.0;
 float HUM_LOW   = 30.0;
@@ -196,21 +328,54 @@ enum CallState {
 };
 
 CallState callState = CALL_IDLE;
-unsigned long callStartTime = 0;
-unsigned long lastCallAttempt = 0;
 int callAttempts = 0;
 const int MAX_CALL_ATTEMPTS = 5;
 const unsigned long CALL_TIMEOUT = 45000;
+const unsigned long CALL_SETUP_TIMEOUT = 10000;  // Dial -> ringing
+const unsigned long CALL_ANSWER_HOLD = 5000;     // Keep answered call up
 const unsigned long RETRY_DELAY = 3000;  // ✅ REDUCED TO 3 SECONDS
 const unsigned long ALERT_COOLDOWN = 300000;
-unsigned long alertCooldownStart = 0;
 
 String currentAlertType = "";
-bool callInProgress = false;
+
+AlertEscalation escalation;
+
+// The ladder is driven from loop() and from the flame task
+SemaphoreHandle_t escalationMutex = nullptr;
+
+// Per-call SMS, handed to the outbox by loop() (which owns it) after
+// the dial is queued
+struct PendingCallSMS {
+  bool pending;
+  uint8_t contact;
+  uint8_t attempt;
+};
+PendingCallSMS pendingCallSMS = {false, 0, 0};
+
+// ================== FLAME FAST PATH ==================
+FlameTrigger flameTrigger;
+
+// Edge -> first ATD written, measured for the field logs. Armed by the
+// flame task, stamped by the modem UART task, reported by loop()
+portMUX_TYPE flameLatencyMux = portMUX_INITIALIZER_UNLOCKED;
+volatile bool flameLatencyArmed = false;
+volatile uint32_t flameEdgeUs = 0;
+volatile uint32_t flameFirstAtUs = 0;
+
+// Readings that triggered the current escalation, sent with each call
+struct AlertReadings {
+  float temp;
+  float hum;
+  int gas;
+  int nh3;
+  bool fire;
+};
+AlertReadings alertReadings = {0, 0, 0, 0, false};
 
 // ================== DISPLAY TEST MODE ==================
 #define DISPLAY_TEST_MODE false
 #define X_OFFSET 0
+#define FRAME_REPORT_EVERY 30   // Print frame time histograms every N frames
   
 // ================== WEB SERVER HTML ==================
 const char CONFIG_PAGE[] PROGMEM = R"rawliteral(
@@ -315,6 +480,7 @@ const char CONFIG_PAGE[] PROGMEM = R"rawliteral(
   <div><strong>Daily Report:</strong> Enabled (8:00 AM)</div>
   <div><strong>Temperature:</strong> <span id="displayTemp">Loading...</span> °C</div>
   <div><strong>Humidity:</strong> <span id="displayHum">Loading...</span> %</div>
+  <div><strong>Live:</strong> <span id="liveReading">Connecting...</span></div>
 </div>
 
 <form id="configForm">
@@ -389,6 +555,7 @@ function loadSettings() {
 }
 
 loadSettings();
+startLive();
 
 document.getElementById('configForm').addEventListener('submit', e => {
   e.preventDefault();
@@ -417,14 +584,44 @@ document.getElementById('configForm').addEventListener('submit', e => {
   });
 });
 
+// Pushed by the device over /live
+function startLive() {
+  const live = new EventSource('/live');
+  live.addEventListener('reading', e => {
+    const d = JSON.parse(e.data);
+    liveReading.textContent = d.temp + ' °C, ' + d.hum + ' %, gas ' + d.gas +
+      ' ppm, NH3 ' + d.nh3 + ' ppm' + (d.flame ? ', FLAME' : '') +
+      (d.alert ? ' – ALERT (' + d.call + ')' : '');
+  });
+  live.onerror = () => liveReading.textContent = 'Reconnecting...';
+}
+
+// Long actions answer 202 with a job id; poll it until it is finished
+function runJob(url, label) {
+  fetch(url, {method:'POST'})
+    .then(r => r.ok ? r.json() : Promise.reject(r.status))
+    .then(j => pollJob(j.job, label))
+    .catch(() => alert(label + ': not available right now'));
+}
+
+function pollJob(id, label) {
+  fetch('/job?id=' + id)
+    .then(r => r.json())
+    .then(j => {
+      if (j.state == 'queued' || j.state == 'running') {
+        setTimeout(() => pollJob(id, label), 1000);
+      } else {
+        alert(label + ': ' + j.text);
+      }
+    });
+}
+
 function testSMS() {
-  fetch('/testSMS', {method:'POST'})
-    .then(() => alert('Test SMS sent!'));
+  runJob('/testSMS', 'Test SMS');
 }
 
 function testCall() {
-  fetch('/testCall', {method:'POST'})
-    .then(() => alert('Test call initiated!'));
+  runJob('/testCall', 'Test call');
 }
 </script>
 
@@ -449,425 +646,557 @@ void powerOnModem() {
   Serial.println("Modem powered on.");
 }
 
-void sendAT(const char *cmd, uint32_t waitMs = 1000) {
-  Serial.print("AT CMD: ");
-  Serial.println(cmd);
-  Serial1.flush();
-  Serial1.println(cmd);
-  
-  unsigned long start = millis();
-  while (millis() - start < waitMs) {
-    if (Serial1.available()) {
-      Serial.write(Serial1.read());
-    }
-  }
+// Returns as soon as the modem answers; waitMs is only the upper bound
+bool sendAT(const char *cmd, uint32_t waitMs = 1000) {
+  return modem.exec(cmd, waitMs).ok();
 }
 
 void hangupCall() {
   Serial.println("Hanging up call...");
-  sendAT("ATH", 1000);
-  callInProgress = false;
+  modem.enqueue("ATH", 1000);
 }
 
-String filterASCII(const String &in) {
-  String out = "";
-  for (int i = 0; i < in.length(); i++) {
-    char c = in[i];
-    if (c >= 32 && c <= 126) out += c;
-  }
-  return out;
+String sendATCommand(const char *cmd, uint32_t waitMs = 2000) {
+  return modem.exec(cmd, waitMs).response;
 }
 
-String sendATCommand(const char *cmd, uint32_t waitMs = 2000) {
-  Serial.print("AT CMD: ");
-  Serial.println(cmd);
-  Serial1.println(cmd);
-  
-  unsigned long start = millis();
-  String response = "";
-  
-  while (millis() - start < waitMs) {
-    while (Serial1.available()) {
-      char c = Serial1.read();
-      if (c >= 32 && c <= 126) {
-        response += c;
-        Serial.write(c);
-      }
-    }
-  }
-  
-  return response;
+// ================== MODEM SETTINGS ==================
+// Applied chained, verified with one query batch on warm boots
+// (see ModemConfig.h). Changing this table changes the fingerprint and
+// forces a full apply on the next boot.
+const ModemSetting modemSettings[] = {
+  { "+CFUN=1", "+CFUN?", "+CFUN: 1", 10000, MODEM_SET_SOLO },
+  { "+CGDCONT=1,\"IP\",\"airtelgprs.com\"", "+CGDCONT?",
+    "+CGDCONT: 1,\"IP\",\"airtelgprs.com\"", 1000, 0 },
+  { "+CNMP=2", "+CNMP?", "+CNMP: 2", 1000, 0 },          // LTE + 3G + 2G
+  { "+CRC=1", "+CRC?", "+CRC: 1", 500, 0 },              // Call result codes
+  { "+CLIP=1", "+CLIP?", "+CLIP: 1", 500, 0 },           // Caller ID
+  { "+CMGF=0", "+CMGF?", "+CMGF: 0", 500, 0 },           // PDU, see SmsOutbox
+  { "+CSCS=\"GSM\"", "+CSCS?", "+CSCS: \"GSM\"", 500, 0 },
+  { "+CTZU=1", "+CTZU?", "+CTZU: 1", 500, 0 },           // RTC from network
+  { "+CTZR=1", "+CTZR?", "+CTZR: 1", 500, 0 },           // +CTZV reports
+  // Registration and signal changes arrive as URCs
+  { "+CREG=2", "+CREG?", "+CREG: 2,", 500, 0 },
+  { "+CGREG=2", "+CGREG?", "+CGREG: 2,", 500, 0 },
+  { "+CEREG=2", "+CEREG?", "+CEREG: 2,", 500, 0 },
+  { "+AUTOCSQ=1,1", "+AUTOCSQ?", "+AUTOCSQ: 1,1", 500, 0 },
+  // Call progress URCs; no read command and not kept by AT&W
+  { "+CLCC=1", nullptr, nullptr, 500, MODEM_SET_ALWAYS },
+  // VoLTE / IMS where the firmware knows them
+  { "+CVOLTE=1", nullptr, nullptr, 1000, MODEM_SET_SOLO | MODEM_SET_OPTIONAL },
+  { "+QCFG=\"ims\",1", nullptr, nullptr, 1000,
+    MODEM_SET_SOLO | MODEM_SET_OPTIONAL },
+};
+
+ModemConfig modemConfig(modem, modemSettings,
+                        sizeof(modemSettings) / sizeof(modemSettings[0]));
+
+void onOperatorQuery(const AtResult &result, void *) {
+  if (result.ok()) Serial.println("Operator: " + result.response);
 }
 
 void initModem() {
   Serial.println("Initializing modem...");
-  
-  sendAT("AT", 500);
-  
-  // Set full functionality mode
-  sendAT("AT+CFUN=1", 2000);
-  delay(2000);
-  
-  // Set Airtel APN for data/voice
-  sendAT("AT+CGDCONT=1,\"IP\",\"airtelgprs.com\"", 1000);
-  delay(500);
-  
-  // Activate PDP context
-  sendAT("AT+CGACT=1,1", 2000);
-  delay(500);
-  sendAT("AT+CRC=1", 500);   // Call result codes
-  sendAT("AT+CLIP=1", 500);  // Caller ID
-
-  // Attach to network
-  sendAT("AT+CGATT=1", 2000);
-  delay(1000);
-  
-  // Enable VoLTE if available
-  sendAT("AT+CVOLTE=1", 1000);
-  delay(500);
-  
-  // Enable IMS for voice over LTE
-  sendAT("AT+QCFG=\"ims\",1", 1000);
-  delay(500);
-  
-  // Set network mode to automatic (LTE + 3G + 2G)
-  sendAT("AT+CNMP=2", 1000);
-  
-  // Wait for network registration (accepts status 6 for LTE voice)
+
+  uint32_t stored = preferences.getUInt("modemcfg", 0);
+  bool configured = modemConfig.run(stored);
+  if (configured && stored != modemConfig.fingerprint()) {
+    preferences.putUInt("modemcfg", modemConfig.fingerprint());
+  }
+
+  const ModemInitReport &init = modemConfig.report();
+  Serial.printf("✓ Modem config %s%s: %u round trips, %lu ms, %u applied, %u failed\n",
+    init.warm ? "warm" : "cold", init.verified ? " (verified)" : "",
+    init.roundTrips, (unsigned long)init.elapsedMs, init.applied,
+    init.failed);
+
+  // Attach and PDP context are network actions, not settings
+  modem.enqueue("AT+CGATT=1", 10000);
+  modem.enqueue("AT+CGACT=1,1", 10000);
+
+  // Current state once; the answers go through the same parser
+  modem.enqueue("AT+CREG?;+CGREG?;+CEREG?;+CSQ", 2000, onRegistrationQuery);
+
+  // Continue as soon as any domain reports registration
   Serial.println("Waiting for network...");
-  bool registered = false;
-  
-  for (int i = 0; i < 60; i++) {
-    String resp = sendATCommand("AT+CREG?", 1000);
-    
-    // Accept status 1, 5, or 6 (6 is OK for LTE with VoLTE)
-    if (resp.indexOf("+CREG: 0,1") >= 0 || 
-        resp.indexOf("+CREG: 0,5") >= 0 || 
-        resp.indexOf("+CREG: 0,6") >= 0) {
-      Serial.println("\n✅ Network registered!");
-      registered = true;
-      break;
-    }
-    
-    Serial.print(".");
-    delay(1000);
+  unsigned long waitStart = millis();
+  while (!netReg.registered() &&
+         millis() - waitStart < REGISTRATION_TIMEOUT) {
+    modem.dispatch();
+    delay(10);
   }
-  
-  if (!registered) {
-    Serial.println("\n⚠ Warning: Network registration incomplete");
+
+  if (netReg.registered()) {
+    Serial.printf("✅ Network registered after %lu ms\n",
+      millis() - waitStart);
+  } else {
+    Serial.println("⚠ Warning: Network registration incomplete");
   }
-  
-  // Check signal strength
-  String csq = sendATCommand("AT+CSQ", 1000);
-  Serial.println("Signal: " + csq);
-  
-  // Check network operator
-  String cops = sendATCommand("AT+COPS?", 2000);
-  Serial.println("Operator: " + cops);
-  
-  // Verify APN
-  String apn = sendATCommand("AT+CGDCONT?", 1000);
-  Serial.println("APN: " + apn);
-  
-  // SMS settings
-  sendAT("AT+CMGF=1", 500);
-  sendAT("AT+CSCS=\"GSM\"", 500);
-  
-  // Voice call settings
-  sendAT("AT+CLIP=1", 500);
-  sendAT("AT+CLCC=1", 500);
-  
+
+  Serial.printf("Signal: CSQ %u (%d dBm), %s\n", netReg.csq(),
+    netReg.rssiDbm(), netReg.accessTechName());
+  modem.enqueue("AT+COPS?", 2000, onOperatorQuery);
+
   Serial.println("Modem ready.");
 }
 
-bool sendSMS(String phoneNumber, String message) {
-  Serial.println("Sending SMS to: " + phoneNumber);
-  Serial.println("Message: " + message);
-  Serial.println("Message length: " + String(message.length()));
-  
-  // Clear buffer first
-  while (Serial1.available()) Serial1.read();
-  
-  // Set text mode
-  Serial1.println("AT+CMGF=1");
-  delay(500);
-  while (Serial1.available()) Serial1.read();
-  
-  // Set encoding to GSM
-  Serial1.println("AT+CSCS=\"GSM\"");
-  delay(300);
-  while (Serial1.available()) Serial1.read();
-  
-  // Send CMGS command
-  String cmd = "AT+CMGS=\"" + phoneNumber + "\"";
-  Serial1.println(cmd);
-  delay(1000);
-  
-  // Wait for > prompt
-  unsigned long promptStart = millis();
-  bool gotPrompt = false;
-  while (millis() - promptStart < 3000) {
-    if (Serial1.available()) {
-      char c = Serial1.read();
-      Serial.write(c);
-      if (c == '>') {
-        gotPrompt = true;
-        break;
-      }
-    }
-  }
-  
-  if (!gotPrompt) {
-    Serial.println("ERROR: No > prompt received");
-    return false;
-  }
-  
-  // Send message
-  Serial1.print(message);
-  delay(100);
-  Serial1.write(26);  // CTRL+Z
-  Serial1.flush();
-  
-  // Wait for response
-  unsigned long start = millis();
-  String response = "";
-  bool success = false;
-  
-  while (millis() - start < 15000) {
-    if (Serial1.available()) {
-      char c = Serial1.read();
-      response += c;
-      Serial.write(c);
-      
-      if (response.indexOf("+CMGS:") >= 0) {
-        success = true;
-      }
-      
-      if (response.indexOf("OK") >= 0 && success) {
-        Serial.println("\n✅ SMS sent successfully!");
-        return true;
-      }
-      
-      if (response.indexOf("ERROR") >= 0 || response.indexOf("+CMS ERROR") >= 0) {
-        Serial.println("\n❌ SMS failed with error");
-        return false;
-      }
-    }
+// Queued, returns at once; the outbox reports delivery on Serial
+bool sendSMS(const String &phoneNumber, const char *message,
+             SmsPriority priority, uint32_t *id) {
+  Serial.print("Message: ");
+  Serial.println(message);
+  return smsOutbox.send(phoneNumber, message, priority, id);
+}
+
+void onAlertDialResult(const AtResult &result, void *) {
+  if (result.ok()) {
+    Serial.println("📞 Call initiated successfully");
+    escalationCallEvent(CALL_EVT_DIAL_OK);
+  } else {
+    Serial.println("❌ Call failed: " + result.response);
+    escalationCallEvent(CALL_EVT_DIAL_FAILED);
   }
-  
-  Serial.println("\n⏱ SMS timeout!");
-  return false;
 }
 
-bool makeDirectCall(String phoneNumber) {
-  // Check network status - accept 1, 5, or 6 for LTE
-  String creg = sendATCommand("AT+CREG?", 1000);
-  
-  if (creg.indexOf("+CREG: 0,1") < 0 && 
-      creg.indexOf("+CREG: 0,5") < 0 && 
-      creg.indexOf("+CREG: 0,6") < 0) {
+// Progress is reported by URCs (see onCallProgressURC), no AT+CLCC polling
+bool queueAlertCall(String phoneNumber) {
+  if (!netReg.registered()) {
     Serial.println("❌ No network - cannot make call");
-    Serial.println("Status: " + creg);
     return false;
   }
-  
-  sendAT("ATH", 500);
-  delay(300);
+  if (!modem.enqueue("ATH", 1000)) return false;
 
   String cmd = "ATD" + phoneNumber + ";";
-  String response = sendATCommand(cmd.c_str(), 3000);
+  return modem.enqueue(cmd.c_str(), 3000, onAlertDialResult);
+}
 
-  if (response.indexOf("OK") >= 0) {
-    callInProgress = true;
-    callStartTime = millis();
-    callState = CALL_DIALING;
-    Serial.println("📞 Call initiated successfully");
-    return true;
-  }
-  
-  if (response.indexOf("ERROR") >= 0 || response.indexOf("CME ERROR") >= 0) {
-    Serial.println("❌ Call failed: " + response);
-  }
+// Texts are in SmsTemplates.cpp
+AlertLimits alertLimits() {
+  AlertLimits limits = {TEMP_LOW, TEMP_HIGH, HUM_LOW, HUM_HIGH,
+                        GAS_LIMIT, AMMONIA_LIMIT};
+  return limits;
+}
 
-  return false;
+// ✅ COMBINED SMS: Stats + Alert Reason (Single Message)
+void sendCallAlertSMS(const String &phone, int attempt,
+                      float temp, float hum, int gas, int nh3, bool fire) {
+  char text[SMS_TEXT_MAX];
+  SmsComposer msg(text, sizeof(text));
+  composeCallAlert(msg, alertLimits(), attempt, temp, hum, gas, nh3, fire);
+  sendSMS(phone, msg.c_str(), SMS_PRIO_ALERT);
 }
 
-void checkCallStatus() {
-  if (!callInProgress) return;
+void sendParametersSMS(float temp, float hum, int gas, int nh3, bool fire) {
+  char text[SMS_TEXT_MAX];
+  SmsComposer message(text, sizeof(text));
+  composeParameters(message, temp, hum, gas, nh3, fire);
+  sendSMS(phoneNumbers[0], message.c_str(), SMS_PRIO_ALERT);
+}
 
-  String response = filterASCII(sendATCommand("AT+CLCC", 1500));
+// ================== CALL ESCALATION ==================
+void lockEscalation() {
+  xSemaphoreTakeRecursive(escalationMutex, portMAX_DELAY);
+}
 
-  int idx = response.indexOf("+CLCC:");
-  
-  // ⚡ QUICK DETECTION: No active call means declined/failed
-  if (idx < 0) {
-    // Check if call was recently started (give 10 seconds for ringing)
-    if (millis() - callStartTime > 10000) {
-      Serial.println("❌ Call declined or no answer");
-      hangupCall();
-      return;
-    }
-    
-    // If timeout exceeded, hangup
-    if (millis() - callStartTime > CALL_TIMEOUT) {
-      Serial.println("⏱ Call timeout");
-      hangupCall();
-    }
-    return;
-  }
+void unlockEscalation() {
+  xSemaphoreGiveRecursive(escalationMutex);
+}
 
-  int p2 = response.indexOf(',', idx);
-  p2 = response.indexOf(',', p2 + 1);
-  int p3 = response.indexOf(',', p2 + 1);
-  if (p2 < 0 || p3 < 0) return;
+void escalationCallEvent(CallEvent event) {
+  lockEscalation();
+  escalation.onCallEvent(event, millis());
+  unlockEscalation();
+}
+
+// Runs with the escalation lock held, possibly on the flame task:
+// only queues commands, never waits for the modem
+bool startAlertCall(uint8_t contact, uint8_t attempt) {
+  Serial.printf("📞 Calling contact %d/%d (Attempt %d/%d)\n",
+    contact + 1,
+    activeContacts,
+    attempt,
+    MAX_ATTEMPTS_PER_NUMBER
+  );
+
+  if (!queueAlertCall(activePhoneList[contact])) return false;
+
+  // ✅ SEND SMS WITH EACH CALL, once the dial is on its way
+  pendingCallSMS.contact = contact;
+  pendingCallSMS.attempt = attempt;
+  pendingCallSMS.pending = true;
+  return true;
+}
 
-  int stat = response.substring(p2 + 1, p3).toInt();
+void sendPendingCallSMS() {
+  if (!pendingCallSMS.pending) return;
+  pendingCallSMS.pending = false;
+
+  sendCallAlertSMS(
+    activePhoneList[pendingCallSMS.contact],
+    pendingCallSMS.attempt,
+    alertReadings.temp, alertReadings.hum,
+    alertReadings.gas, alertReadings.nh3, alertReadings.fire
+  );
+}
+
+// An escalation nobody answers loops DIALING -> WAIT_RETRY for every
+// attempt on every contact, two records each. Journal only the first
+// dial to each contact per round of the ladder and skip the gaps between
+// dials: the ladder fixes how many dials a contact gets, so all that is
+// lost is the time of each unanswered retry. Ringing and answered calls
+// are still journaled every time.
+static bool journalCallState(EscalationState from, EscalationState to) {
+  switch (to) {
+    case ESC_WAIT_RETRY:
+      // Start of an alert, not a gap between two dials
+      return from == ESC_IDLE || from == ESC_ACKNOWLEDGED;
+    case ESC_DIALING:
+      return escalation.attempt() == 0;
+    default:
+      return true;
+  }
+}
 
-  switch (stat) {
-    case 0: // ANSWERED
+void onEscalationStateChanged(EscalationState from, EscalationState to,
+                              unsigned long now) {
+  Serial.printf("📞 Escalation %s -> %s at %lu ms\n",
+    escalationStateName(from), escalationStateName(to), now);
+
+  switch (to) {
+    case ESC_DIALING:   callState = CALL_DIALING;   break;
+    case ESC_RINGING:   callState = CALL_RINGING;   break;
+    case ESC_CONNECTED:
       Serial.println("✅ CALL ANSWERED – ALERT ACKNOWLEDGED");
-      alertAcknowledged = true;
       callState = CALL_CONNECTED;
-      delay(5000);
-      hangupCall();
       break;
-
-    case 3: // RINGING
-      callState = CALL_RINGING;
+    case ESC_WAIT_RETRY:
+      callState = (from == ESC_IDLE || from == ESC_ACKNOWLEDGED)
+                  ? CALL_IDLE : CALL_FAILED;
       break;
+    default:            callState = CALL_IDLE;      break;
+  }
 
-    case 6: // BUSY / REJECTED
-      Serial.println("📵 Call rejected/busy");
-      hangupCall();
-      break;
+  callAttempts = escalation.totalAttempts();
+  if (journalCallState(from, to)) {
+    journal.append(JEV_CALL_STATE, to, escalation.contact(),
+                   escalation.attempt());
   }
+  live.publish("call", "{\"state\":\"%s\",\"contact\":%u,\"attempt\":%u}",
+    escalationStateName(to), escalation.contact(), escalation.attempt());
 }
 
-void resetCallState() {
-  currentContactIndex = 0;
-  attemptsForCurrentNumber = 0;
-  callInProgress = false;
-  alertAcknowledged = false;
-  callState = CALL_IDLE;
-}
+void setupEscalation() {
+  escalationMutex = xSemaphoreCreateRecursiveMutex();
+
+  EscalationConfig config;
+  config.maxAttempts = MAX_ATTEMPTS_PER_NUMBER;
+  config.retryDelay = RETRY_DELAY;
+  config.setupTimeout = CALL_SETUP_TIMEOUT;
+  config.callTimeout = CALL_TIMEOUT;
+  config.answerHold = CALL_ANSWER_HOLD;
+  config.cooldown = ALERT_COOLDOWN;
+
+  EscalationActions actions;
+  actions.dial = startAlertCall;
+  actions.hangup = hangupCall;
+  actions.stateChanged = onEscalationStateChanged;
 
-// ✅ NEW FUNCTION: Get Alert Reasons
-String getAlertReasons(float temp, float hum, int gas, int nh3, bool fire) {
-  String reason = "";
+  escalation.begin(config, actions);
+}
 
-  if (fire)
-    reason += "🔥 FIRE DETECTED\n";
+void handleAlerts(float temp, float hum, int gas, int nh3, bool fire) {
 
-  if (temp < TEMP_LOW)
-    reason += "❄ TEMP LOW (" + String(temp,1) + "C)\n";
-  else if (temp > TEMP_HIGH)
-    reason += "🔥 TEMP HIGH (" + String(temp,1) + "C)\n";
+  bool alertActive =
+    fire ||
+    (temp < TEMP_LOW || temp > TEMP_HIGH) ||
+    (hum < HUM_LOW || hum > HUM_HIGH) ||
+    (gas > GAS_LIMIT) ||
+    (nh3 > AMMONIA_LIMIT);
 
-  if (hum < HUM_LOW)
-    reason += "💧 HUMIDITY LOW (" + String(hum,0) + "%)\n";
-  else if (hum > HUM_HIGH)
-    reason += "💧 HUMIDITY HIGH (" + String(hum,0) + "%)\n";
+  alertReadings.temp = temp;
+  alertReadings.hum = hum;
+  alertReadings.gas = gas;
+  alertReadings.nh3 = nh3;
+  alertReadings.fire = fire;
 
-  if (gas > GAS_LIMIT)
-    reason += "🧪 GAS HIGH (" + String(gas) + " PPM)\n";
+  lockEscalation();
+  escalation.setAlert(alertActive, activeContacts, millis());
+  unlockEscalation();
+}
 
-  if (nh3 > AMMONIA_LIMIT)
-    reason += "☠ AMMONIA HIGH (" + String(nh3) + " PPM)\n";
+// Flame task: start the ladder straight from the debounced edge,
+// the threshold evaluation catches up on the next loop() pass
+void onFlameChanged(bool active, uint32_t edgeUs) {
+  if (!active) return;   // Clearing goes through the normal evaluation
+
+  portENTER_CRITICAL(&flameLatencyMux);
+  flameEdgeUs = edgeUs;
+  flameFirstAtUs = 0;
+  flameLatencyArmed = true;
+  portEXIT_CRITICAL(&flameLatencyMux);
+
+  lockEscalation();
+  alertReadings.fire = true;
+  escalation.setAlert(true, activeContacts, millis());
+  unlockEscalation();
+
+  journal.append(JEV_FLAME);
+  live.publish("flame", "{\"active\":true}");
+  Serial.printf("🔥 Flame edge confirmed after %lu us\n",
+    (unsigned long)(micros() - edgeUs));
+}
 
-  if (reason == "") reason = "Unknown alert\n";
+// Modem UART task, right after a command hit the wire. Only the dial
+// counts: a CSQ poll or SMS already queued ahead of it is not the alarm
+void onModemWrite(const char *cmd) {
+  if (!flameLatencyArmed || strncmp(cmd, "ATD", 3) != 0) return;
+  uint32_t now = micros();
+  portENTER_CRITICAL(&flameLatencyMux);
+  if (flameLatencyArmed) {
+    flameFirstAtUs = now;
+    flameLatencyArmed = false;
+  }
+  portEXIT_CRITICAL(&flameLatencyMux);
+}
 
-  return reason;
+void reportFlameLatency() {
+  if (!flameFirstAtUs) return;
+  portENTER_CRITICAL(&flameLatencyMux);
+  uint32_t firstAtUs = flameFirstAtUs;
+  uint32_t latencyUs = firstAtUs - flameEdgeUs;
+  flameFirstAtUs = 0;
+  portEXIT_CRITICAL(&flameLatencyMux);
+  if (!firstAtUs) return;   // Re-armed by a new edge in between
+  Serial.printf("🔥 Flame edge -> first ATD: %lu us\n",
+    (unsigned long)latencyUs);
 }
 
-// ✅ COMBINED SMS: Stats + Alert Reason (Single Message)
-void sendCallAlertSMS(String phone, int attempt,
-                      float temp, float hum, int gas, int nh3, bool fire) {
+// ================== WEB SERVER TASK ==================
+// handleClient() runs on its own task, so a slow client or a long export
+// never holds up sampling and alarms in loop(), and a busy loop() never
+// leaves the page hanging. Handlers therefore do not touch loop()'s
+// state directly:
+//  - settings are exchanged through webConfig under configMutex; loop()
+//    picks up changes in applyWebConfig()
+//  - test SMS / test call are WebJobs, started and finished by loop()
+//  - history is read in short slices under historyMutex
+//
+// WebServer still serves one connection at a time, so a /job poll that
+// arrives during a /history or /events export waits for it to finish.
+// For the largest export (30 min of seconds, ~100 KB) test_chunked_export
+// measures that wait at ~0.1 s for a LAN client and ~6 s at 16 KB/s. A
+// client that stops reading is dropped after one stalled write (~10 s in
+// the core's WiFiClient). The worst case is one that reads just above
+// ChunkedResponse's ~1 KB/s floor: about 100 s.
+#define WEB_TASK_STACK 8192
+#define WEB_POLL_MS    2
+
+struct WebConfig {
+  String phone[MAX_CONTACTS];
+  float tempLow;
+  float tempHigh;
+  float humLow;
+  float humHigh;
+  bool dailyReport;
+};
 
-  String msg = "ALERT #" + String(attempt) + "\n";
-  
-  // Alert reasons
-  if (fire) msg += "FIRE! ";
-  if (temp < TEMP_LOW) msg += "COLD ";
-  if (temp > TEMP_HIGH) msg += "HOT ";
-  if (hum < HUM_LOW) msg += "DRY ";
-  if (hum > HUM_HIGH) msg += "WET ";
-  if (gas > GAS_LIMIT) msg += "GAS ";
-  if (nh3 > AMMONIA_LIMIT) msg += "NH3 ";
-  
-  msg += "\n";
-  
-  // Current values
-  msg += "T:" + String(temp,1) + "C ";
-  msg += "H:" + String(hum,0) + "% ";
-  msg += "G:" + String(gas) + " ";
-  msg += "N:" + String(nh3);
-  msg += "\nCalling now";
+struct WebStats {
+  uint32_t requests;
+  uint32_t lastUs;
+  uint32_t maxUs;
+  uint32_t alertRequests;   // Served while an escalation was running
+  uint32_t maxAlertUs;
+  uint32_t maxPollGapMs;    // Longest stretch between handleClient() calls
+};
 
-  sendSMS(phone, msg);
+WebJobs webJobs;
+SemaphoreHandle_t configMutex = nullptr;
+SemaphoreHandle_t historyMutex = nullptr;
+WebConfig webConfig;
+bool webConfigChanged = false;    // Under configMutex
+WebStats webStats;                // Under webStatsMux, written by the web task
+portMUX_TYPE webStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+uint16_t testSmsJob = 0;
+uint32_t testSmsId = 0;           // Outbox id of the test message
+
+void lockConfig() {
+  xSemaphoreTake(configMutex, portMAX_DELAY);
 }
 
-void sendParametersSMS(float temp, float hum, int gas, int nh3, bool fire) {
-  String message = "ENV MONITOR:\n";
-  message += "Temp: " + String(temp, 1) + "C\n";
-  message += "Humidity: " + String(hum, 0) + "%\n";
-  message += "Carbon Monoxide: " + String(gas) + " PPM\n";
-  message += "Ammonia: " + String(nh3) + " PPM\n";
-  message += "Fire: " + String(fire ? "YES" : "NO");
-  
-  sendSMS(phoneNumbers[0], message);
+void unlockConfig() {
+  xSemaphoreGive(configMutex);
 }
 
-// ✅ UPDATED handleAlerts Function
-void handleAlerts(float temp, float hum, int gas, int nh3, bool fire) {
+// loop()'s settings -> webConfig, after loading them at boot
+void publishWebConfig() {
+  lockConfig();
+  for (int i = 0; i < MAX_CONTACTS; i++) webConfig.phone[i] = phoneNumbers[i];
+  webConfig.tempLow = TEMP_LOW;
+  webConfig.tempHigh = TEMP_HIGH;
+  webConfig.humLow = HUM_LOW;
+  webConfig.humHigh = HUM_HIGH;
+  webConfig.dailyReport = dailyReportEnabled;
+  webConfigChanged = false;
+  unlockConfig();
+}
 
-  bool alertActive =
-    fire ||
-    (temp < TEMP_LOW || temp > TEMP_HIGH) ||
-    (hum < HUM_LOW || hum > HUM_HIGH) ||
-    (gas > GAS_LIMIT) ||
-    (nh3 > AMMONIA_LIMIT);
+// webConfig -> loop()'s settings and NVS, when the page saved new ones
+void applyWebConfig() {
+  WebConfig config;
+  lockConfig();
+  bool changed = webConfigChanged;
+  if (changed) {
+    config = webConfig;
+    webConfigChanged = false;
+  }
+  unlockConfig();
+  if (!changed) return;
+
+  for (int i = 0; i < MAX_CONTACTS; i++) {
+    String key = "phone" + String(i);
+    phoneNumbers[i] = config.phone[i];
+    preferences.putString(key.c_str(), phoneNumbers[i]);
+  }
 
-  if (!alertActive) {
-    resetCallState();
+  TEMP_LOW  = config.tempLow;
+  TEMP_HIGH = config.tempHigh;
+  HUM_LOW   = config.humLow;
+  HUM_HIGH  = config.humHigh;
+
+  preferences.putFloat("tlow", TEMP_LOW);
+  preferences.putFloat("thigh", TEMP_HIGH);
+  preferences.putFloat("hlow", HUM_LOW);
+  preferences.putFloat("hhigh", HUM_HIGH);
+
+  updateActiveContacts();
+  journal.append(JEV_CONFIG, activeContacts);
+  Serial.printf("✓ Settings applied, %d contacts\n", activeContacts);
+}
+
+void startTestSMS(uint16_t id) {
+  if (testSmsJob) {
+    webJobs.finish(id, false, "Test SMS already pending");
+    return;
+  }
+  if (!sendSMS(phoneNumbers[0], "✅ Test SMS from ESP32", SMS_PRIO_NORMAL,
+               &testSmsId)) {
+    webJobs.finish(id, false, "Outbox full");
     return;
   }
+  // Finished from the outbox result, see onTestSmsResult(). Alerts to the
+  // same number must not finish it, so match the message, not the number.
+  testSmsJob = id;
+}
 
-  if (activeContacts == 0) return;
+// Also called, with no attempts made, when an alert evicts the test
+// message from a full outbox
+void onTestSmsResult(uint32_t smsId, bool sent, uint8_t attempts) {
+  if (!testSmsJob || smsId != testSmsId) return;
+  webJobs.finish(testSmsJob, sent,
+                 sent ? "Sent" : attempts ? "Failed" : "Dropped for an alert");
+  testSmsJob = 0;
+  testSmsId = 0;
+}
 
-  if (alertAcknowledged) return;
+void onTestCallDialed(const AtResult &result, void *ctx) {
+  uint16_t id = (uint16_t)(uintptr_t)ctx;
+  if (result.ok()) {
+    Serial.println("📞 Call initiated successfully");
+  } else {
+    Serial.println("❌ Call failed: " + result.response);
+  }
+  webJobs.finish(id, result.ok(),
+                 result.ok() ? "Dialing" : atStatusName(result.status));
+}
 
-  if (callInProgress) {
-    checkCallStatus();
+void startTestCall(uint16_t id) {
+  if (!modemReady()) {
+    webJobs.finish(id, false, "Modem starting");
     return;
   }
 
-  if (currentContactIndex >= activeContacts) {
-    currentContactIndex = 0;
+  // Cached from +CREG/+CGREG/+CEREG URCs, no AT round trip
+  if (!netReg.registered()) {
+    Serial.println("❌ No network - cannot make call");
+    webJobs.finish(id, false, "No network");
+    return;
   }
 
-  if (millis() - lastCallAttempt < RETRY_DELAY) return;
+  // ATH would cut an alert call short
+  lockEscalation();
+  bool escalating = escalation.state() != ESC_IDLE;
+  unlockEscalation();
+  if (escalating) {
+    webJobs.finish(id, false, "Alert in progress");
+    return;
+  }
 
-  Serial.printf("📞 Calling contact %d/%d (Attempt %d/2)\n",
-    currentContactIndex + 1,
-    activeContacts,
-    attemptsForCurrentNumber + 1
-  );
+  String cmd = "ATD" + phoneNumbers[0] + ";";
+  if (!modem.enqueue("ATH", 500) ||
+      !modem.enqueue(cmd.c_str(), 3000, onTestCallDialed,
+                     (void *)(uintptr_t)id)) {
+    webJobs.finish(id, false, "AT queue full");
+  }
+}
 
-  // ✅ SEND SMS WITH EACH CALL
-  sendCallAlertSMS(
-    activePhoneList[currentContactIndex],
-    attemptsForCurrentNumber + 1,
-    temp, hum, gas, nh3, fire
-  );
+// loop(): start whatever the page queued
+void runWebJobs() {
+  WebJob job;
+  while (webJobs.next(job)) {
+    switch (job.kind) {
+      case JOB_TEST_SMS:  startTestSMS(job.id);  break;
+      case JOB_TEST_CALL: startTestCall(job.id); break;
+    }
+  }
+}
 
-  makeDirectCall(activePhoneList[currentContactIndex]);
+// Handler time once the request has been parsed, split by whether an
+// alert escalation was running at the time
+void timedRequest(void (*handler)()) {
+  uint32_t start = micros();
+  handler();
+  uint32_t us = micros() - start;
+
+  lockEscalation();
+  bool escalating = escalation.state() != ESC_IDLE;
+  unlockEscalation();
+
+  portENTER_CRITICAL(&webStatsMux);
+  webStats.requests++;
+  webStats.lastUs = us;
+  if (us > webStats.maxUs) webStats.maxUs = us;
+  if (escalating) {
+    webStats.alertRequests++;
+    if (us > webStats.maxAlertUs) webStats.maxAlertUs = us;
+  }
+  portEXIT_CRITICAL(&webStatsMux);
+}
+
+// Consistent copy for loop()'s stats line
+WebStats webStatsSnapshot() {
+  WebStats s;
+  portENTER_CRITICAL(&webStatsMux);
+  s = webStats;
+  portEXIT_CRITICAL(&webStatsMux);
+  return s;
+}
 
-  lastCallAttempt = millis();
-  attemptsForCurrentNumber++;
+void onTimed(const char *uri, HTTPMethod method, void (*handler)()) {
+  server.on(uri, method, [handler]() { timedRequest(handler); });
+}
 
-  if (attemptsForCurrentNumber >= MAX_ATTEMPTS_PER_NUMBER) {
-    attemptsForCurrentNumber = 0;
-    currentContactIndex++;
+void webServerTask(void *) {
+  unsigned long lastPoll = millis();
+  for (;;) {
+    uint32_t gap = millis() - lastPoll;
+    portENTER_CRITICAL(&webStatsMux);
+    if (gap > webStats.maxPollGapMs) webStats.maxPollGapMs = gap;
+    portEXIT_CRITICAL(&webStatsMux);
+    server.handleClient();
+    live.service();
+    lastPoll = millis();
+    vTaskDelay(pdMS_TO_TICKS(WEB_POLL_MS));
   }
 }
 
@@ -877,53 +1206,95 @@ void handleRoot() {
 }
 
 void handleGetSettings() {
+  lockConfig();
   String json = "{";
 
   for (int i = 0; i < MAX_CONTACTS; i++) {
-    json += "\"phone" + String(i) + "\":\"" + phoneNumbers[i] + "\",";
+    json += "\"phone" + String(i) + "\":\"" + webConfig.phone[i] + "\",";
   }
 
-  json += "\"tlow\":" + String(TEMP_LOW, 1) + ",";
-  json += "\"thigh\":" + String(TEMP_HIGH, 1) + ",";
-  json += "\"hlow\":" + String(HUM_LOW, 1) + ",";
-  json += "\"hhigh\":" + String(HUM_HIGH, 1) + ",";
-  json += "\"dailyReport\":" + String(dailyReportEnabled ? "true" : "false");
+  json += "\"tlow\":" + String(webConfig.tempLow, 1) + ",";
+  json += "\"thigh\":" + String(webConfig.tempHigh, 1) + ",";
+  json += "\"hlow\":" + String(webConfig.humLow, 1) + ",";
+  json += "\"hhigh\":" + String(webConfig.humHigh, 1) + ",";
+  json += "\"dailyReport\":" + String(webConfig.dailyReport ? "true" : "false");
 
   json += "}";
+  unlockConfig();
   server.send(200, "application/json", json);
 }
 
+// Stored for loop() to apply, see applyWebConfig()
 void handleSetSettings() {
+  WebConfig config;
 
   for (int i = 0; i < MAX_CONTACTS; i++) {
-    String key = "phone" + String(i);
-    phoneNumbers[i] = server.arg(key);
-    preferences.putString(key.c_str(), phoneNumbers[i]);
+    config.phone[i] = server.arg("phone" + String(i));
   }
 
-  TEMP_LOW  = server.arg("tlow").toFloat();
-  TEMP_HIGH = server.arg("thigh").toFloat();
-  HUM_LOW   = server.arg("hlow").toFloat();
-  HUM_HIGH  = server.arg("hhigh").toFloat();
+  config.tempLow  = server.arg("tlow").toFloat();
+  config.tempHigh = server.arg("thigh").toFloat();
+  config.humLow   = server.arg("hlow").toFloat();
+  config.humHigh  = server.arg("hhigh").toFloat();
 
-  preferences.putFloat("tlow", TEMP_LOW);
-  preferences.putFloat("thigh", TEMP_HIGH);
-  preferences.putFloat("hlow", HUM_LOW);
-  preferences.putFloat("hhigh", HUM_HIGH);
-
-  updateActiveContacts();
+  lockConfig();
+  config.dailyReport = webConfig.dailyReport;
+  webConfig = config;
+  webConfigChanged = true;
+  unlockConfig();
 
   server.send(200, "application/json", "{\"success\":true}");
 }
 
+// 202 with the job id, the page polls /job?id=
+void submitJob(WebJobKind kind) {
+  uint16_t id = webJobs.submit(kind);
+  if (!id) {
+    server.send(503, "application/json", "{\"error\":\"busy\"}");
+    return;
+  }
+  server.sendHeader("Location", "/job?id=" + String(id));
+  server.send(202, "application/json", "{\"job\":" + String(id) + "}");
+}
+
 void handleTestSMS() {
-  sendSMS(phoneNumbers[0], "✅ Test SMS from ESP32");
-  server.send(200, "text/plain", "OK");
+  submitJob(JOB_TEST_SMS);
 }
 
 void handleTestCall() {
-  makeDirectCall(phoneNumbers[0]);
-  server.send(200, "text/plain", "OK");
+  if (!modemReady()) {
+    server.send(503, "text/plain", "Modem starting");
+    return;
+  }
+  submitJob(JOB_TEST_CALL);
+}
+
+void handleLive() {
+  if (!live.subscribe(server.client())) {
+    server.send(503, "text/plain", "Too many live clients");
+    return;
+  }
+  // The feed keeps the socket; let the server move on to the next request
+  server.client() = WiFiClient();
+  Serial.printf("📡 /live client connected, %u total\n", live.clients());
+}
+
+void handleJob() {
+  WebJob job;
+  if (!webJobs.get(server.arg("id").toInt(), job)) {
+    server.send(404, "application/json", "{\"error\":\"unknown job\"}");
+    return;
+  }
+
+  unsigned long now = millis();
+  unsigned long started = job.startedAt ? job.startedAt : now;
+  unsigned long finished = job.finishedAt ? job.finishedAt : now;
+  char json[160];
+  snprintf(json, sizeof(json),
+    "{\"job\":%u,\"state\":\"%s\",\"text\":\"%s\",\"waitMs\":%lu,\"runMs\":%lu}",
+    job.id, webJobStateName(job.state), job.text,
+    started - job.queuedAt, job.startedAt ? finished - started : 0UL);
+  server.send(200, "application/json", json);
 }
 
 // ================== DISPLAY UTILITIES ==================
@@ -945,65 +1316,9 @@ void lcdScanAnimation() {
   tft.fillScreen(ST77XX_BLACK);
 }
 
-void drawRoundedCard(int x, int y, int w, int h, uint16_t bgColor, uint16_t borderColor) {
-  tft.fillRoundRect(x, y, w, h, 6, bgColor);
-  tft.drawRoundRect(x, y, w, h, 6, borderColor);
-}
-
-void drawSensorCard(int x, int y, int w, int h, const char* label, String value, 
-                    const char* unit, uint16_t valueColor, bool alert) {
-  uint16_t bgColor = alert ? 0x2000 : 0x1082;
-  uint16_t borderColor = alert ? ST77XX_RED : 0x4208;
-  drawRoundedCard(x, y, w, h, bgColor, borderColor);
-  
-  tft.setTextSize(1);
-  tft.setTextColor(0x8410);
-  tft.setCursor(x + 6, y + 6);
-  tft.print(label);
-  
-  tft.setTextSize(3);
-  tft.setTextColor(valueColor);
-  int16_t x1, y1;
-  uint16_t tw, th;
-  tft.getTextBounds(value.c_str(), 0, 0, &x1, &y1, &tw, &th);
-  tft.setCursor(x + (w - tw) / 2, y + h/2 - 8);
-  tft.print(value);
-  
-  tft.setTextSize(1);
-  tft.setTextColor(0xC618);
-  tft.getTextBounds(unit, 0, 0, &x1, &y1, &tw, &th);
-  tft.setCursor(x + w - tw - 6, y + h - th - 6);
-  tft.print(unit);
-}
-
-void drawStatusBar(int y, const char* text, uint16_t bgColor, uint16_t textColor) {
-  tft.fillRect(0, y, 240, 32, bgColor);
-  tft.setTextSize(2);
-  tft.setTextColor(textColor);
-  int16_t x1, y1;
-  uint16_t tw, th;
-  tft.getTextBounds(text, 0, 0, &x1, &y1, &tw, &th);
-  tft.setCursor((240 - tw) / 2, y + 8);
-  tft.print(text);
-  
-  if (callState == CALL_DIALING || callState == CALL_RINGING) {
-    tft.fillCircle(15, y + 16, 5, ST77XX_ORANGE);
-    tft.fillCircle(225, y + 16, 5, ST77XX_ORANGE);
-  } else if (callState == CALL_CONNECTED) {
-    tft.fillCircle(15, y + 16, 5, ST77XX_GREEN);
-    tft.fillCircle(225, y + 16, 5, ST77XX_GREEN);
-  }
-}
-
 void updateDisplay(float t, float h, int gas, int nh3, int flame) {
-  tft.fillScreen(0x0000);
-  
-  tft.fillRect(0, 0, 240, 28, 0x0349);
-  tft.setTextSize(2);
-  tft.setTextColor(ST77XX_WHITE);
-  tft.setCursor(20, 6);
-  tft.print("ENVIRONMENT");
-  
+  DashboardView view;
+
   uint16_t indicatorColor = ST77XX_GREEN;
   if (callState == CALL_DIALING || callState == CALL_RINGING) {
     indicatorColor = ST77XX_ORANGE;
@@ -1012,72 +1327,99 @@ void updateDisplay(float t, float h, int gas, int nh3, int flame) {
   } else if (callAttempts > 0) {
     indicatorColor = ST77XX_YELLOW;
   }
-  tft.fillCircle(220, 14, 5, indicatorColor);
-  
+  view.indicatorColor = indicatorColor;
+
   bool tempAlert = (t < TEMP_LOW || t > TEMP_HIGH);
-  String tempStr = String(t, 1);
-  drawSensorCard(5, 35, 110, 70, "TEMPERATURE", tempStr, "C", 
-                 tempAlert ? ST77XX_RED : ST77XX_CYAN, tempAlert);
-  
+  view.cards[0] = { "TEMPERATURE", String(t, 1), "C",
+                    (uint16_t)(tempAlert ? ST77XX_RED : ST77XX_CYAN), tempAlert };
+
   bool humAlert = (h < HUM_LOW || h > HUM_HIGH);
-  String humStr = String(h, 0);
-  drawSensorCard(125, 35, 110, 70, "HUMIDITY", humStr, "%", 
-                 humAlert ? ST77XX_RED : ST77XX_CYAN, humAlert);
-  
+  view.cards[1] = { "HUMIDITY", String(h, 0), "%",
+                    (uint16_t)(humAlert ? ST77XX_RED : ST77XX_CYAN), humAlert };
+
   bool gasAlert = gas > GAS_LIMIT;
-  String gasStr = String(gas);
-  drawSensorCard(5, 112, 110, 70, "GAS LEVEL", gasStr, "PPM", 
-                 gasAlert ? ST77XX_RED : ST77XX_GREEN, gasAlert);
-  
+  view.cards[2] = { "GAS LEVEL", String(gas), "PPM",
+                    (uint16_t)(gasAlert ? ST77XX_RED : ST77XX_GREEN), gasAlert };
+
   bool nh3Alert = nh3 > AMMONIA_LIMIT;
-  String nh3Str = String(nh3);
-  drawSensorCard(125, 112, 110, 70, "AMMONIA", nh3Str, "PPM", 
-                 nh3Alert ? ST77XX_RED : ST77XX_GREEN, nh3Alert);
-  
+  view.cards[3] = { "AMMONIA", String(nh3), "PPM",
+                    (uint16_t)(nh3Alert ? ST77XX_RED : ST77XX_GREEN), nh3Alert };
+
+  StatusView &status = view.status;
+  status.textColor = ST77XX_WHITE;
+  status.callDots = CALL_DOTS_NONE;
+  if (callState == CALL_DIALING || callState == CALL_RINGING) {
+    status.callDots = CALL_DOTS_ACTIVE;
+  } else if (callState == CALL_CONNECTED) {
+    status.callDots = CALL_DOTS_CONNECTED;
+  }
+
   if (flame == LOW) {
-    drawStatusBar(189, "! FIRE DETECTED !", ST77XX_RED, ST77XX_WHITE);
-    tft.fillCircle(15, 205, 6, ST77XX_YELLOW);
-    tft.fillCircle(225, 205, 6, ST77XX_YELLOW);
+    status.text = "! FIRE DETECTED !";
+    status.bgColor = ST77XX_RED;
+    status.decor = DECOR_FIRE;
   }
   else if (tempAlert || gasAlert || nh3Alert || humAlert) {
     if (callState == CALL_CONNECTED) {
-      drawStatusBar(189, "CALL CONNECTED", ST77XX_GREEN, ST77XX_WHITE);
+      status.text = "CALL CONNECTED";
+      status.bgColor = ST77XX_GREEN;
     } else if (callState == CALL_RINGING) {
-      drawStatusBar(189, "CALLING...", 0xFD20, ST77XX_WHITE);
+      status.text = "CALLING...";
+      status.bgColor = 0xFD20;
     } else if (callAttempts > 0) {
-      drawStatusBar(189, "ALERT - CALLING", ST77XX_RED, ST77XX_WHITE);
+      status.text = "ALERT - CALLING";
+      status.bgColor = ST77XX_RED;
     } else {
-      drawStatusBar(189, "ALERT ACTIVE", 0xF800, ST77XX_WHITE);
+      status.text = "ALERT ACTIVE";
+      status.bgColor = 0xF800;
     }
-    tft.drawTriangle(15, 211, 20, 199, 25, 211, ST77XX_YELLOW);
-    tft.drawTriangle(215, 211, 220, 199, 225, 211, ST77XX_YELLOW);
+    status.decor = DECOR_ALERT;
   }
   else {
-    drawStatusBar(189, "ALL SYSTEMS OK", 0x0560, ST77XX_WHITE);
-    tft.fillCircle(15, 205, 4, ST77XX_GREEN);
-    tft.fillCircle(225, 205, 4, ST77XX_GREEN);
+    status.text = "ALL SYSTEMS OK";
+    status.bgColor = 0x0560;
+    status.decor = DECOR_OK;
+  }
+
+  // Framebuffer builds flush asynchronously, so count SPI traffic between
+  // frames rather than around render()
+  static uint32_t lastBytes = 0;
+  static uint16_t framesSinceReport = 0;
+  dashboard.render(view);
+
+  uint32_t bytes = tft.bytesWritten();
+  Serial.printf("Display: %s, %u regions, %lu SPI bytes\n",
+    dashboard.lastWasFull() ? "full" : "partial",
+    dashboard.lastRegions(),
+    (unsigned long)(bytes - lastBytes));
+  lastBytes = bytes;
+
+  if (++framesSinceReport >= FRAME_REPORT_EVERY) {
+    dashboard.printHistograms();
+    framesSinceReport = 0;
   }
-  
-  tft.drawFastHLine(0, 28, 240, 0x4208);
-  tft.drawFastHLine(0, 188, 240, 0x4208);
 }
 
-// ================== SETUP ==================
-void setup() {
+// ================== BOOT STAGES ==================
+// setup() only starts what alarms need (settings, sensors, flame
+// interrupt); display, WiFi and modem come up in background stages.
+#define MODEM_ALIVE_TIMEOUT 15000
 
-  Serial.begin(115200);
-  delay(300);
-  Serial.println("\n=== ENVIRONMENT MONITOR STARTING ===");
+int bootDisplay = -1;
+int bootWifi = -1;
+int bootInfo = -1;
+int bootModem = -1;
+bool bootReported = false;
 
-  pinMode(FLAME_PIN, INPUT);
-  dht.begin();
-  Serial.println("✓ Sensors initialized");
+bool modemReady() {
+  return boot.done(bootModem);
+}
 
+void displayStage() {
   tft.init(240, 280);
   tft.setRotation(1);
   tft.setAddrWindow(X_OFFSET, 0, 240 + X_OFFSET, 240);
-  tft.fillScreen(ST77XX_BLACK);
-
+  dashboard.begin();
   tft.fillScreen(ST77XX_BLACK);
 
   for (int y = 0; y < 240; y += 4) {
@@ -1086,8 +1428,6 @@ void setup() {
     tft.drawFastHLine(0, y, 240, ST77XX_BLACK);
   }
 
-  tft.fillScreen(ST77XX_BLACK);
-
   tft.fillScreen(ST77XX_BLACK);
   tft.setTextSize(3);
   tft.setTextColor(ST77XX_CYAN);
@@ -1097,9 +1437,6 @@ void setup() {
   tft.print("MONITOR");
   delay(1200);
 
-  displayReady = true;
-  Serial.println("✓ Display ready");
-
   if (DISPLAY_TEST_MODE) {
     tft.fillScreen(ST77XX_RED);
     tft.setTextSize(3);
@@ -1110,42 +1447,37 @@ void setup() {
     tft.print("TEST");
     while (1) delay(1000);
   }
+}
 
-  preferences.begin("envmonitor", false);
-
-  for (int i = 0; i < MAX_CONTACTS; i++) {
-    String key = "phone" + String(i);
-    phoneNumbers[i] = preferences.getString(key.c_str(), phoneNumbers[i]);
-  }
-
-  dailyReportEnabled = true;
-
-  TEMP_LOW  = preferences.getFloat("tlow", 10.0);
-  TEMP_HIGH = preferences.getFloat("thigh", 35.0);
-  HUM_LOW   = preferences.getFloat("hlow", 30.0);
-  HUM_HIGH  = preferences.getFloat("hhigh", 80.0);
-
-  updateActiveContacts();
-  resetDailyStats();
-
-  Serial.println("✓ Preferences loaded");
-
+void wifiStage() {
   Serial.println("Starting WiFi AP...");
   WiFi.mode(WIFI_AP);
   WiFi.softAP(AP_SSID, AP_PASSWORD);
-  IPAddress IP = WiFi.softAPIP();
   Serial.print("✓ AP IP: ");
-  Serial.println(IP);
-
-  server.on("/", handleRoot);
-  server.on("/getSettings", handleGetSettings);
-  server.on("/setSettings", HTTP_POST, handleSetSettings);
-  server.on("/testSMS", HTTP_POST, handleTestSMS);
-  server.on("/testCall", HTTP_POST, handleTestCall);
+  Serial.println(WiFi.softAPIP());
+
+  onTimed("/", HTTP_GET, handleRoot);
+  onTimed("/getSettings", HTTP_GET, handleGetSettings);
+  onTimed("/setSettings", HTTP_POST, handleSetSettings);
+  onTimed("/testSMS", HTTP_POST, handleTestSMS);
+  onTimed("/testCall", HTTP_POST, handleTestCall);
+  onTimed("/job", HTTP_GET, handleJob);
+  onTimed("/history", HTTP_GET, handleHistory);
+  onTimed("/events", HTTP_GET, handleEvents);
+  onTimed("/live", HTTP_GET, handleLive);
   server.begin();
 
+  // Same core as the modem UART task, below it in priority
+  if (xTaskCreatePinnedToCore(webServerTask, "web", WEB_TASK_STACK, nullptr,
+                              1, nullptr, 0) != pdPASS) {
+    Serial.println("❌ Web server task failed to start");
+    return;
+  }
   Serial.println("✓ Web server started");
+}
 
+// After splash and WiFi: show the AP details, then hand the panel to loop()
+void infoStage() {
   tft.fillScreen(ST77XX_BLACK);
   tft.setTextSize(2);
   tft.setTextColor(ST77XX_CYAN);
@@ -1159,7 +1491,7 @@ void setup() {
   tft.setCursor(10, 75);
   tft.print("PASS: "); tft.print(AP_PASSWORD);
   tft.setCursor(10, 90);
-  tft.print("IP: ");   tft.print(IP);
+  tft.print("IP: ");   tft.print(WiFi.softAPIP());
 
   tft.setTextColor(ST77XX_YELLOW);
   tft.setCursor(10, 120);
@@ -1169,105 +1501,506 @@ void setup() {
 
   delay(4000);
 
+  dashboard.invalidate();
+  displayReady = true;
+  Serial.println("✓ Display ready");
+}
+
+// Polls AT instead of a fixed wait after power-on
+bool waitModemAlive() {
+  unsigned long start = millis();
+  while (millis() - start < MODEM_ALIVE_TIMEOUT) {
+    if (sendAT("AT", 500)) return true;
+  }
+  return false;
+}
+
+// Until this stage is done it is the only user of modem.exec()/dispatch()
+void modemStage() {
   Serial1.begin(115200, SERIAL_8N1, MODEM_RX, MODEM_TX);
+  modem.begin(Serial1);
+  registerModemURCs();
+  modem.setWriteHook(onModemWrite);
+  modem.startTask(0);  // UART owned by core 0, loop() stays on core 1
   powerOnModem();
-  delay(5000);
+  if (!waitModemAlive()) {
+    Serial.println("⚠ Modem not answering, continuing anyway");
+  }
   initModem();
   Serial.println("✓ Modem initialized");
+}
 
-  tft.fillScreen(ST77XX_BLACK);
-  tft.setTextSize(2);
-  tft.setTextColor(ST77XX_GREEN);
-  tft.setCursor(30, 110);
-  tft.print("SYSTEM READY");
+// ================== SETUP ==================
+void setup() {
+
+  Serial.begin(115200);
+  delay(300);
+  Serial.println("\n=== ENVIRONMENT MONITOR STARTING ===");
+
+  preferences.begin("envmonitor", false);
+
+  journal.begin();
+  journal.append(JEV_BOOT, esp_reset_reason());
+  smsOutbox.setResultHook(onSmsResult);
+
+  for (int i = 0; i < MAX_CONTACTS; i++) {
+    String key = "phone" + String(i);
+    phoneNumbers[i] = preferences.getString(key.c_str(), phoneNumbers[i]);
+  }
+
+  dailyReportEnabled = true;
+
+  TEMP_LOW  = preferences.getFloat("tlow", 10.0);
+  TEMP_HIGH = preferences.getFloat("thigh", 35.0);
+  HUM_LOW   = preferences.getFloat("hlow", 30.0);
+  HUM_HIGH  = preferences.getFloat("hhigh", 80.0);
+
+  configMutex = xSemaphoreCreateMutex();
+  historyMutex = xSemaphoreCreateMutex();
+  publishWebConfig();
+
+  updateActiveContacts();
+  resetDailyStats();
+  netClock.addDaily(DAILY_REPORT_HOUR, DAILY_REPORT_MINUTE, sendDailyReport);
+  setupEscalation();
+
+  Serial.println("✓ Preferences loaded");
+
+  dht.begin();
+  sensors.begin(SENSOR_RATE_HZ, DHT_INTERVAL);
+  flameTrigger.begin(FLAME_PIN, onFlameChanged);
+  Serial.println("✓ Sensors initialized");
+
+  bootDisplay = boot.add("display", displayStage);
+  bootWifi = boot.add("wifi", wifiStage, 0, 6144);
+  bootInfo = boot.add("info", infoStage,
+                      BOOT_BIT(bootDisplay) | BOOT_BIT(bootWifi));
+  bootModem = boot.add("modem", modemStage, 0, 6144);
+  boot.start();
 
-  delay(2000);
   Serial.println("=== MONITORING ACTIVE ===");
 }
 
-float getSensorResistance(int adcValue, float RL) {
-  float voltage = (adcValue / ADC_MAX) * ADC_VREF;
-  if (voltage <= 0.01) voltage = 0.01;
-  return ((ADC_VREF - voltage) * RL) / voltage;
+// Datasheet log-log curves through compile-time tables, see GasCurve.h
+int getGasPPM(int mv) {
+  return gasCurvePpm<Mq2Model>(mv);
 }
 
-int getGasPPM(int adc) {
-  return constrain(map(adc, 300, 3800, 0, 5000), 0, 5000);
+int getNH3PPM(int mv) {
+  return gasCurvePpm<Mq137Model>(mv);
 }
 
-int getNH3PPM(int adc) {
-  return constrain(map(adc, 300, 3800, 0, 300), 0, 300);
+
+// ================== HISTORY ==================
+// One sample per second into the 1 s / 1 min / 1 h rings
+TimeSeriesStore history;
+uint32_t lastHistorySec = 0;
+
+static int16_t clampHistory(long v) {
+  return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t)v);
 }
 
-int smoothValue(int *buffer, int newValue) {
-  buffer[gasIndex] = newValue;
+void recordHistory(const SensorSnapshot &snap, bool flame) {
+  uint32_t sec = millis() / 1000;
+  if (sec == lastHistorySec) return;
+  lastHistorySec = sec;
+
+  float t = snap.temperature;
+  float h = snap.humidity;
+  if (isnan(t) || t < 0 || t > 60) t = lastValidTemp;
+  if (isnan(h) || h < 0 || h > 100) h = lastValidHum;
+
+  TsSample sample;
+  sample.value[TS_TEMP] = clampHistory(lroundf(t * 10));
+  sample.value[TS_HUM] = clampHistory(lroundf(h * 10));
+  sample.value[TS_GAS] = clampHistory(getGasPPM(filteredGasMv));
+  sample.value[TS_NH3] = clampHistory(getNH3PPM(filteredNH3Mv));
+  sample.flame = flame;
+  xSemaphoreTake(historyMutex, portMAX_DELAY);
+  history.add(sec, sample);
+  xSemaphoreGive(historyMutex);
+}
 
-  int sum = 0;
-  int count = filterFilled ? GAS_FILTER_SIZE : gasIndex + 1;
+// ================== HISTORY EXPORT ==================
+// GET /history?format=csv|json&tier=s|m|h&last=<s>|from=<t>&to=<t>&step=<s>
+// GET /events?format=csv|json&last=<s>|from=<t>&to=<t>&types=NAME,NAME
+//
+// Times are unix seconds once the clock is set, seconds of uptime before.
+// Without a range the last hour of history / the whole journal is sent.
+// step re-buckets history rows to that many seconds (min / max / mean).
+// Rows are streamed from the stores through a ChunkedResponse, so memory
+// use does not depend on the range.
+
+static const char *const HISTORY_CHANNELS[TS_ANALOG] = {
+  "temp", "hum", "gas", "nh3"
+};
 
-  for (int i = 0; i < count; i++) {
-    sum += buffer[i];
+// Unix time minus seconds of uptime, 0 while the clock is not set
+static uint32_t exportUtcOffset() {
+  time_t now = time(nullptr);
+  if (now < (time_t)JOURNAL_MIN_UTC) return 0;
+  return (uint32_t)now - millis() / 1000;
+}
+
+static bool exportCsv() {
+  return server.arg("format") == "csv";
+}
+
+static uint32_t exportArg(const char *name, uint32_t fallback) {
+  if (!server.hasArg(name)) return fallback;
+  return strtoul(server.arg(name).c_str(), nullptr, 10);
+}
+
+static void exportDone(const char *path, const ChunkedResponse &out,
+                       uint32_t rows, unsigned long startMs) {
+  Serial.printf("📤 %s: %lu rows, %lu bytes in %u chunks, %lu ms, free heap low %lu%s\n",
+    path, (unsigned long)rows, (unsigned long)out.bytes(), out.chunks(),
+    millis() - startMs, (unsigned long)out.lowestHeap(),
+    out.stalled() ? ", client too slow, dropped" : "");
+}
+
+#define HISTORY_SLICE_ROWS 16
+
+struct HistorySlice {
+  TsPoint rows[HISTORY_SLICE_ROWS];
+  uint8_t count;
+};
+
+static bool onHistorySliceRow(const TsPoint &point, void *ctx) {
+  HistorySlice &slice = *static_cast<HistorySlice *>(ctx);
+  slice.rows[slice.count++] = point;
+  return slice.count < HISTORY_SLICE_ROWS;
+}
+
+struct HistoryExport {
+  ChunkedResponse *out;
+  bool csv;
+  uint32_t utcOffset;
+  uint32_t step;
+  uint32_t rows;
+  bool pending;         // acc holds rows not yet written
+  TsRollup acc;
+};
+
+static void writeHistoryRow(HistoryExport &x, const TsPoint &p) {
+  ChunkedResponse &out = *x.out;
+  uint32_t utc = x.utcOffset ? x.utcOffset + p.t : 0;
+
+  if (x.csv) {
+    out.printf("%lu,%lu,%u,%u", (unsigned long)utc, (unsigned long)p.t,
+      p.count, p.flame);
+  } else {
+    out.printf("%s{\"utc\":%lu,\"up\":%lu,\"n\":%u,\"flame\":%u",
+      x.rows ? "," : "", (unsigned long)utc, (unsigned long)p.t, p.count,
+      p.flame);
   }
 
-  return sum / count;
+  // Temperature and humidity are kept in tenths
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    float scale = c <= TS_HUM ? 0.1f : 1.0f;
+    uint8_t decimals = c <= TS_HUM ? 1 : 0;
+    if (!x.csv) out.printf(",\"%s\":[", HISTORY_CHANNELS[c]);
+    out.printf(x.csv ? ",%.*f,%.*f,%.*f" : "%.*f,%.*f,%.*f]",
+      decimals, p.mean[c] * scale, decimals, p.min[c] * scale,
+      decimals, p.max[c] * scale);
+  }
+  out.print(x.csv ? "\n" : "}");
+  x.rows++;
 }
 
+static bool onHistoryPoint(const TsPoint &point, void *ctx) {
+  HistoryExport &x = *static_cast<HistoryExport *>(ctx);
 
-void processModemURC() {
-  static String urc = "";
+  if (!x.step) {
+    writeHistoryRow(x, point);
+    return x.out->ok();
+  }
+
+  uint32_t bucket = point.t - point.t % x.step;
+  if (x.pending && bucket != x.acc.start) {
+    TsPoint row;
+    x.acc.toPoint(row);
+    writeHistoryRow(x, row);
+    x.pending = false;
+  }
+  if (!x.pending) {
+    x.acc.reset(bucket);
+    x.pending = true;
+  }
+  x.acc.merge(point);
+  return x.out->ok();
+}
 
-  while (Serial1.available()) {
-    char c = Serial1.read();
-    if (c == '\n') {
-      urc.trim();
+void handleHistory() {
+  unsigned long startMs = millis();
+  uint32_t nowSec = millis() / 1000;
+
+  HistoryExport x;
+  x.csv = exportCsv();
+  x.utcOffset = exportUtcOffset();
+  x.step = exportArg("step", 0);
+  x.rows = 0;
+  x.pending = false;
+
+  uint32_t from, to;
+  if (server.hasArg("from")) {
+    from = exportArg("from", 0);
+    to = exportArg("to", x.utcOffset + nowSec);
+    from = from > x.utcOffset ? from - x.utcOffset : 0;
+    to = to > x.utcOffset ? to - x.utcOffset : 0;
+  } else {
+    uint32_t last = exportArg("last", 3600);
+    from = nowSec > last ? nowSec - last : 0;
+    to = nowSec;
+  }
+  if (from > to) {
+    server.send(400, "text/plain", "Bad range");
+    return;
+  }
 
-      if (urc.length()) {
-        Serial.println("📡 URC: " + urc);
+  // Finest tier that still covers the range, unless asked for one
+  String tierArg = server.arg("tier");
+  uint32_t span = to - from;
+  TsTier tier = span <= TS_RAW_BLOCKS * TS_BLOCK_SECONDS ? TS_SECONDS
+              : span <= TS_MINUTE_BUCKETS * 60UL ? TS_MINUTES : TS_HOURS;
+  if (tierArg == "s") tier = TS_SECONDS;
+  else if (tierArg == "m") tier = TS_MINUTES;
+  else if (tierArg == "h") tier = TS_HOURS;
+
+  ChunkedResponse out(server);
+  x.out = &out;
+  out.begin(200, x.csv ? "text/csv" : "application/json");
+
+  if (x.csv) {
+    out.print("utc,uptime,count,flame");
+    for (uint8_t c = 0; c < TS_ANALOG; c++) {
+      const char *name = HISTORY_CHANNELS[c];
+      out.printf(",%s,%s_min,%s_max", name, name, name);
+    }
+    out.print("\n");
+  } else {
+    out.printf("{\"tier\":\"%s\",\"step\":%lu,\"rows\":[",
+      tier == TS_SECONDS ? "s" : tier == TS_MINUTES ? "m" : "h",
+      (unsigned long)x.step);
+  }
 
-        // 🔥 IMMEDIATE DECLINE DETECTION
-        if (urc.indexOf("NO CARRIER") >= 0 ||
-            urc.indexOf("BUSY") >= 0 ||
-            urc.indexOf("CALL END") >= 0) {
+  // Rows are copied out a slice at a time, so recordHistory() only ever
+  // waits for one short query, never for the client
+  uint32_t period = tier == TS_SECONDS ? 1 : tier == TS_MINUTES ? 60 : 3600;
+  HistorySlice slice;
+  uint32_t cursor = from;
+  do {
+    slice.count = 0;
+    xSemaphoreTake(historyMutex, portMAX_DELAY);
+    history.query(tier, cursor, to, onHistorySliceRow, &slice);
+    xSemaphoreGive(historyMutex);
+
+    for (uint8_t i = 0; i < slice.count && out.ok(); i++) {
+      onHistoryPoint(slice.rows[i], &x);
+    }
+    if (slice.count) cursor = slice.rows[slice.count - 1].t + period;
+  } while (slice.count == HISTORY_SLICE_ROWS && out.ok());
+  if (x.pending && out.ok()) {
+    TsPoint row;
+    x.acc.toPoint(row);
+    writeHistoryRow(x, row);
+  }
+
+  if (!x.csv) out.print("]}");
+  out.end();
+  exportDone("/history", out, x.rows, startMs);
+}
+
+struct EventExport {
+  ChunkedResponse *out;
+  bool csv;
+  uint32_t rows;
+};
+
+static bool onJournalRecord(const JournalRecord &r, void *ctx) {
+  EventExport &x = *static_cast<EventExport *>(ctx);
+
+  char detail[JOURNAL_DETAIL_LEN + 1];
+  memcpy(detail, r.detail, JOURNAL_DETAIL_LEN);
+  detail[JOURNAL_DETAIL_LEN] = 0;
+
+  if (x.csv) {
+    x.out->printf("%lu,%lu,%lu,%s,%u,%u,%ld,%s\n", (unsigned long)r.seq,
+      (unsigned long)r.utc, (unsigned long)r.uptimeMs,
+      journalEventName(r.type), r.code, r.arg, (long)r.value, detail);
+  } else {
+    x.out->printf("%s{\"seq\":%lu,\"utc\":%lu,\"upMs\":%lu,\"type\":\"%s\","
+      "\"code\":%u,\"arg\":%u,\"value\":%ld,\"detail\":\"%s\"}",
+      x.rows ? "," : "", (unsigned long)r.seq, (unsigned long)r.utc,
+      (unsigned long)r.uptimeMs, journalEventName(r.type), r.code, r.arg,
+      (long)r.value, detail);
+  }
+  x.rows++;
+  return x.out->ok();
+}
 
-          Serial.println("❌ Call ended by remote");
-          hangupCall();
-          callState = CALL_FAILED;
-        }
+// "ALARM_START,SMS_FAILED" -> type mask
+static uint32_t parseEventTypes(const String &list) {
+  if (!list.length()) return JOURNAL_ALL_TYPES;
+  uint32_t mask = 0;
+  for (uint8_t t = 1; t < JEV_TYPES; t++) {
+    const char *name = journalEventName(t);
+    int at = list.indexOf(name);
+    while (at >= 0) {
+      int end = at + strlen(name);
+      if ((at == 0 || list[at - 1] == ',') &&
+          (end == (int)list.length() || list[end] == ',')) {
+        mask |= JOURNAL_TYPE_BIT(t);
+        break;
       }
-      urc = "";
-    } else {
-      urc += c;
+      at = list.indexOf(name, at + 1);
     }
   }
+  return mask;
+}
+
+void handleEvents() {
+  unsigned long startMs = millis();
+  uint32_t utcOffset = exportUtcOffset();
+  uint32_t nowUtc = utcOffset ? utcOffset + millis() / 1000 : 0;
+
+  // Records only carry unix time; without a clock, send everything
+  uint32_t from = 0, to = UINT32_MAX;
+  if (nowUtc && server.hasArg("from")) {
+    from = exportArg("from", 0);
+    to = exportArg("to", nowUtc);
+  } else if (nowUtc && server.hasArg("last")) {
+    uint32_t last = exportArg("last", 0);
+    from = nowUtc > last ? nowUtc - last : 0;
+    to = nowUtc;
+  }
+
+  EventExport x;
+  x.csv = exportCsv();
+  x.rows = 0;
+
+  ChunkedResponse out(server);
+  x.out = &out;
+  out.begin(200, x.csv ? "text/csv" : "application/json");
+  out.print(x.csv ? "seq,utc,uptime_ms,type,code,arg,value,detail\n"
+                  : "{\"events\":[");
+
+  journal.query(from, to, parseEventTypes(server.arg("types")),
+                onJournalRecord, &x);
+
+  if (!x.csv) out.print("]}");
+  out.end();
+  exportDone("/events", out, x.rows, startMs);
+}
+
+// Feed every sample taken since the last call through the gas filters
+void drainSensorSamples() {
+  SensorSample sample;
+  while (sensors.read(sample)) {
+    filteredGasMv = gasAverage.add(gasMedian.add(sample.gasMv));
+    filteredNH3Mv = nh3Average.add(nh3Median.add(sample.nh3Mv));
+  }
+}
+
+void handleModemURC(const String &urc) {
+  Serial.println("📡 URC: " + urc);
+}
+
+// 🔥 IMMEDIATE DECLINE DETECTION
+void onCallEndedURC(const String &urc) {
+  Serial.println("📡 URC: " + urc);
+  escalationCallEvent(CALL_EVT_ENDED);
+}
+
+// +CLCC: <id>,<dir>,<stat>,<mode>,<mpty>[,<number>,<type>]
+void onCallProgressURC(const String &urc) {
+  Serial.println("📡 URC: " + urc);
+
+  if (urc.startsWith("VOICE CALL: BEGIN")) {
+    escalationCallEvent(CALL_EVT_ANSWERED);
+    return;
+  }
+
+  CallEvent event;
+  if (!clccCallEvent(urc.c_str(), event)) return;  // Dialing, held, ...
+
+  if (event == CALL_EVT_ENDED) Serial.println("📵 Call rejected/busy");
+  escalationCallEvent(event);
+}
+
+void onIncomingURC(const String &urc) {
+  Serial.println("📨 URC: " + urc);
+}
+
+void registerModemURCs() {
+  modem.setUrcHandler(handleModemURC);
+  modem.onUrc("NO CARRIER", onCallEndedURC);
+  modem.onUrc("BUSY", onCallEndedURC);
+  modem.onUrc("NO ANSWER", onCallEndedURC);
+  modem.onUrc("VOICE CALL: END", onCallEndedURC);
+  modem.onUrc("CALL END", onCallEndedURC);
+  modem.onUrc("+CLCC:", onCallProgressURC);
+  modem.onUrc("VOICE CALL: BEGIN", onCallProgressURC);
+  modem.onUrc("RING", onIncomingURC);
+  modem.onUrc("+CLIP:", onIncomingURC);
+  modem.onUrc("+CMTI:", onIncomingURC);
+  modem.onUrc("+CTZV:", onTimeZoneURC);
+  modem.onUrc("+CREG:", onRegistrationURC);
+  modem.onUrc("+CGREG:", onRegistrationURC);
+  modem.onUrc("+CEREG:", onRegistrationURC);
+  modem.onUrc("+CSQ:", onRegistrationURC);
+  netReg.setChangeHandler(onRegistrationChanged);
+}
+
+void processModemURC() {
+  modem.dispatch();
 }
 
 // ================== MAIN LOOP ==================
 void loop() {
-  processModemURC();
+  // The modem stage dispatches on its own until it is done
+  bool modemUp = modemReady();
+  if (modemUp) processModemURC();
+  lockEscalation();
+  escalation.tick(millis());
+  unlockEscalation();
+  sendPendingCallSMS();
+  if (modemUp) {
+    smsOutbox.poll();
+    serviceClock();
+  }
+  reportFlameLatency();
 
-  server.handleClient();
-  
-  if (displayReady && (millis() - lastDisplayUpdate >= DISPLAY_INTERVAL)) {
-    lastDisplayUpdate = millis();
-    
-    float temperature = dht.readTemperature();
-    float humidity = dht.readHumidity();
-    int gasADC = analogRead(MQ_GAS_PIN);
-    int nh3ADC = analogRead(MQ137_PIN);
+  applyWebConfig();
+  runWebJobs();
 
-    int gasRaw = getGasPPM(gasADC);
-    int nh3Raw = getNH3PPM(nh3ADC);
+  if (!bootReported && boot.allDone()) {
+    boot.printReport();
+    bootReported = true;
+  }
 
-    int gasValue = smoothValue(gasSamples, gasRaw);
-    int nh3Value = smoothValue(nh3Samples, nh3Raw);
+  drainSensorSamples();
 
-    gasIndex++;
-    if (gasIndex >= GAS_FILTER_SIZE) {
-      gasIndex = 0;
-      filterFilled = true;
-    }
+  SensorSnapshot snap;
+  sensors.snapshot(snap);
+
+  // A flame change is acted on right away instead of at the next tick
+  bool flameNow = snap.flame || flameTrigger.active();
+  bool flameChanged = flameNow != lastFlameState;
+  recordHistory(snap, flameNow);
 
-    int flameValue = digitalRead(FLAME_PIN);
+  // Readings and alarms run from boot, the display once its stages are done
+  if (snap.dhtAt &&
+      (flameChanged || millis() - lastDisplayUpdate >= DISPLAY_INTERVAL)) {
+    boot.milestone("first reading");
+    lastDisplayUpdate = millis();
+    lastFlameState = flameNow;
+
+    float temperature = snap.temperature;
+    float humidity = snap.humidity;
+    int gasValue = getGasPPM(filteredGasMv);
+    int nh3Value = getNH3PPM(filteredNH3Mv);
+    int flameValue = flameNow ? LOW : HIGH;
     
     if (isnan(temperature) || temperature < 0 || temperature > 60) temperature = lastValidTemp;
     if (isnan(humidity) || humidity < 0 || humidity > 100) humidity = lastValidHum;
@@ -1276,9 +2009,10 @@ void loop() {
     lastValidHum  = humidity;
 
     updateDailyStats(temperature, humidity);
-    checkDailyReport();
     
-    updateDisplay(temperature, humidity, gasValue, nh3Value, flameValue);
+    if (displayReady) {
+      updateDisplay(temperature, humidity, gasValue, nh3Value, flameValue);
+    }
     
     Serial.println("--- Sensor Readings ---");
     Serial.print("Temperature: "); Serial.print(temperature); Serial.println(" °C");
@@ -1286,6 +2020,51 @@ void loop() {
     Serial.print("Gas: "); Serial.print(gasValue); Serial.println(" PPM");
     Serial.print("Ammonia: "); Serial.print(nh3Value); Serial.println(" PPM");
     Serial.print("Flame: "); Serial.println(flameValue == LOW ? "DETECTED" : "None");
+    Serial.printf("Samples: %lu (%lu dropped, %lu late)\n",
+      (unsigned long)snap.samples, (unsigned long)snap.dropped,
+      (unsigned long)snap.overruns);
+    const SmsStats &sms = smsOutbox.stats();
+    Serial.printf("SMS: depth %u, %lu sent (%lu PDUs), %lu failed, %lu retries, submit avg %lu / max %lu ms\n",
+      smsOutbox.depth(), (unsigned long)sms.sent, (unsigned long)sms.parts,
+      (unsigned long)sms.failed,
+      (unsigned long)sms.retries, (unsigned long)smsOutbox.averageSubmitMs(),
+      (unsigned long)sms.maxSubmitMs);
+    const AdcStream &adc = sensors.adc();
+    Serial.printf("ADC: %lu conv in %lu us last batch, %lu ns/conv avg, %lu overflows\n",
+      (unsigned long)adc.lastBatchSamples(), (unsigned long)adc.lastBatchUs(),
+      (unsigned long)adc.nsPerSample(), (unsigned long)adc.overflows());
+    const DhtStats &dhts = sensors.dhtStats();
+    Serial.printf("DHT: %lu/%lu ok, %lu checksum, %lu frame, %lu no reply, %lu us read (max %lu), %lu us decode\n",
+      (unsigned long)dhts.ok, (unsigned long)dhts.reads,
+      (unsigned long)dhts.checksumErrors, (unsigned long)dhts.frameErrors,
+      (unsigned long)dhts.noResponse, (unsigned long)dhts.lastLatencyUs,
+      (unsigned long)dhts.maxLatencyUs, (unsigned long)dhts.lastDecodeUs);
+    TsStats hs = history.stats();
+    Serial.printf("History: %u s / %u min / %u h stored, %.2f B per 1 s sample, %u bytes\n",
+      hs.secondsStored, hs.minutesStored, hs.hoursStored,
+      TimeSeriesStore::bytesPerSecondSample(),
+      (unsigned)TimeSeriesStore::bytes());
+    JournalStats js = journal.stats();
+    Serial.printf("Journal: %lu logged, %lu on flash, %lu dropped, %lu write errors, segments %lu..%lu, flush %lu us (max %lu)\n",
+      (unsigned long)js.appended, (unsigned long)js.written,
+      (unsigned long)js.dropped, (unsigned long)js.writeErrors,
+      (unsigned long)js.firstSegment, (unsigned long)js.lastSegment,
+      (unsigned long)js.lastFlushUs, (unsigned long)js.maxFlushUs);
+    WebStats ws = webStatsSnapshot();
+    WebJobStats wj = webJobs.stats();
+    Serial.printf("Web: %lu requests, %lu us last / %lu us max, %lu during alerts (max %lu us), poll gap max %lu ms, jobs %lu done / %lu failed, wait max %lu ms\n",
+      (unsigned long)ws.requests, (unsigned long)ws.lastUs,
+      (unsigned long)ws.maxUs, (unsigned long)ws.alertRequests,
+      (unsigned long)ws.maxAlertUs,
+      (unsigned long)ws.maxPollGapMs, (unsigned long)wj.done,
+      (unsigned long)wj.failed, (unsigned long)wj.maxWaitMs);
+    LiveStats ls = live.stats();
+    Serial.printf("Live: %u clients (peak %u), %lu events, publish %lu us (max %lu), fan-out %lu us (max %lu), %lu B sent, %lu slow dropped, %lu closed\n",
+      ls.clients, ls.peakClients, (unsigned long)ls.events,
+      (unsigned long)ls.lastPublishUs, (unsigned long)ls.maxPublishUs,
+      (unsigned long)ls.lastServiceUs, (unsigned long)ls.maxServiceUs,
+      (unsigned long)ls.bytesSent, (unsigned long)ls.dropped,
+      (unsigned long)ls.closed);
     Serial.println();
     
     handleAlerts(temperature, humidity, gasValue, nh3Value, flameValue == LOW);
@@ -1299,16 +2078,42 @@ void loop() {
     
     if (alertCondition && !lastAlertState) {
       Serial.println("🚨 ALERT STARTED → Sending SMS");
+      uint8_t reasons = 0;
+      if (flameValue == LOW) reasons |= JOURNAL_REASON_FIRE;
+      if (temperature < TEMP_LOW || temperature > TEMP_HIGH) {
+        reasons |= JOURNAL_REASON_TEMP;
+      }
+      if (humidity < HUM_LOW || humidity > HUM_HIGH) {
+        reasons |= JOURNAL_REASON_HUM;
+      }
+      if (gasValue > GAS_LIMIT) reasons |= JOURNAL_REASON_GAS;
+      if (nh3Value > AMMONIA_LIMIT) reasons |= JOURNAL_REASON_NH3;
+      journal.append(JEV_ALARM_START, 0, 0, reasons);
+      live.publish("alert", "{\"active\":true,\"reasons\":%u}", reasons);
       sendParametersSMS(temperature, humidity, gasValue, nh3Value, flameValue == LOW);
       smsSentForCurrentAlert = true;
     }
 
     if (!alertCondition && lastAlertState) {
       Serial.println("✅ ALERT CLEARED");
+      journal.append(JEV_ALARM_CLEAR);
+      live.publish("alert", "{\"active\":false}");
       smsSentForCurrentAlert = false;
     }
 
     lastAlertState = alertCondition;
+
+    if (live.clients()) {
+      lockEscalation();
+      EscalationState esc = escalation.state();
+      unlockEscalation();
+      live.publish("reading",
+        "{\"up\":%lu,\"temp\":%.1f,\"hum\":%.1f,\"gas\":%d,\"nh3\":%d,"
+        "\"flame\":%s,\"alert\":%s,\"call\":\"%s\"}",
+        millis() / 1000, temperature, humidity, gasValue, nh3Value,
+        flameValue == LOW ? "true" : "false",
+        alertCondition ? "true" : "false", escalationStateName(esc));
+    }
   }
   
   delay(10);
@@ -0,0 +1,311 @@
+// ================== NATIVE GFX MOCK ==================
+// Host stand-in for Adafruit_GFX with the same primitive decomposition as
+// the library: shapes and text end up in the virtual write*/draw*/fill*
+// entry points, so a subclass that counts or records those sees the same
+// calls it would on the device.
+//
+// Text uses the 6x8 classic font metrics; the glyph bitmaps are a fixed
+// pseudo pattern instead of glcdfont, which keeps pixel counts realistic
+// without pulling in the font table.
+
+#ifndef NATIVE_ADAFRUIT_GFX_H
+#define NATIVE_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+#include <vector>
+
+class Adafruit_GFX : public Print {
+ public:
+  Adafruit_GFX(int16_t w, int16_t h)
+    : _width(w), _height(h), cursor_x(0), cursor_y(0),
+      textcolor(0xFFFF), textbgcolor(0xFFFF), textsize(1), wrap(true) {}
+  virtual ~Adafruit_GFX() {}
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void startWrite() {}
+  virtual void endWrite() {}
+  virtual void writePixel(int16_t x, int16_t y, uint16_t color) {
+    drawPixel(x, y, color);
+  }
+  virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                             uint16_t color) {
+    fillRect(x, y, w, h, color);
+  }
+  virtual void writeFastVLine(int16_t x, int16_t y, int16_t h,
+                              uint16_t color) {
+    drawFastVLine(x, y, h, color);
+  }
+  virtual void writeFastHLine(int16_t x, int16_t y, int16_t w,
+                              uint16_t color) {
+    drawFastHLine(x, y, w, color);
+  }
+  virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                         uint16_t color) {
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) {
+      std::swap(x0, y0);
+      std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+      std::swap(x0, x1);
+      std::swap(y0, y1);
+    }
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+      if (steep) writePixel(y0, x0, color);
+      else writePixel(x0, y0, color);
+      err -= dy;
+      if (err < 0) {
+        y0 += ystep;
+        err += dx;
+      }
+    }
+  }
+
+  virtual void drawFastVLine(int16_t x, int16_t y, int16_t h,
+                             uint16_t color) {
+    startWrite();
+    writeLine(x, y, x, y + h - 1, color);
+    endWrite();
+  }
+  virtual void drawFastHLine(int16_t x, int16_t y, int16_t w,
+                             uint16_t color) {
+    startWrite();
+    writeLine(x, y, x + w - 1, y, color);
+    endWrite();
+  }
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                        uint16_t color) {
+    startWrite();
+    for (int16_t i = x; i < x + w; i++) writeFastVLine(i, y, h, color);
+    endWrite();
+  }
+  virtual void fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+  }
+
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                uint16_t color) {
+    if (x0 == x1) {
+      if (y0 > y1) std::swap(y0, y1);
+      drawFastVLine(x0, y0, y1 - y0 + 1, color);
+    } else if (y0 == y1) {
+      if (x0 > x1) std::swap(x0, x1);
+      drawFastHLine(x0, y0, x1 - x0 + 1, color);
+    } else {
+      startWrite();
+      writeLine(x0, y0, x1, y1, color);
+      endWrite();
+    }
+  }
+
+  void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+    startWrite();
+    writeFastVLine(x0, y0 - r, 2 * r + 1, color);
+    fillCircleHelper(x0, y0, r, 3, 0, color);
+    endWrite();
+  }
+
+  void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+                     uint16_t color) {
+    int16_t maxRadius = (w < h ? w : h) / 2;
+    if (r > maxRadius) r = maxRadius;
+    startWrite();
+    writeFillRect(x + r, y, w - 2 * r, h, color);
+    fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+    fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+    endWrite();
+  }
+
+  void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
+                     uint16_t color) {
+    int16_t maxRadius = (w < h ? w : h) / 2;
+    if (r > maxRadius) r = maxRadius;
+    startWrite();
+    writeFastHLine(x + r, y, w - 2 * r, color);
+    writeFastHLine(x + r, y + h - 1, w - 2 * r, color);
+    writeFastVLine(x, y + r, h - 2 * r, color);
+    writeFastVLine(x + w - 1, y + r, h - 2 * r, color);
+    drawCircleHelper(x + r, y + r, r, 1, color);
+    drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+    drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+    drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+    endWrite();
+  }
+
+  void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                    int16_t x2, int16_t y2, uint16_t color) {
+    drawLine(x0, y0, x1, y1, color);
+    drawLine(x1, y1, x2, y2, color);
+    drawLine(x2, y2, x0, y0, color);
+  }
+
+  // ---------- Text ----------
+
+  void setTextSize(uint8_t s) { textsize = s ? s : 1; }
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextColor(uint16_t c, uint16_t bg) {
+    textcolor = c;
+    textbgcolor = bg;
+  }
+  void setCursor(int16_t x, int16_t y) {
+    cursor_x = x;
+    cursor_y = y;
+  }
+  void setTextWrap(bool w) { wrap = w; }
+  int16_t getCursorX() const { return cursor_x; }
+  int16_t getCursorY() const { return cursor_y; }
+
+  void getTextBounds(const char *str, int16_t x, int16_t y, int16_t *x1,
+                     int16_t *y1, uint16_t *w, uint16_t *h) {
+    size_t n = 0;
+    while (str[n] && str[n] != '\n') n++;
+    *x1 = x;
+    *y1 = y;
+    *w = n * 6 * textsize;
+    *h = n ? 8 * textsize : 0;
+  }
+  void getTextBounds(const String &str, int16_t x, int16_t y, int16_t *x1,
+                     int16_t *y1, uint16_t *w, uint16_t *h) {
+    getTextBounds(str.c_str(), x, y, x1, y1, w, h);
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      cursor_x = 0;
+      cursor_y += textsize * 8;
+    } else if (c != '\r') {
+      if (wrap && cursor_x + textsize * 6 > _width) {
+        cursor_x = 0;
+        cursor_y += textsize * 8;
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize);
+      cursor_x += textsize * 6;
+    }
+    return 1;
+  }
+  using Print::write;
+
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                uint16_t bg, uint8_t size) {
+    startWrite();
+    for (int8_t i = 0; i < 5; i++) {
+      uint8_t line = glyphColumn(c, i);
+      for (int8_t j = 0; j < 8; j++, line >>= 1) {
+        if (line & 1) {
+          if (size == 1) writePixel(x + i, y + j, color);
+          else writeFillRect(x + i * size, y + j * size, size, size, color);
+        } else if (bg != color) {
+          if (size == 1) writePixel(x + i, y + j, bg);
+          else writeFillRect(x + i * size, y + j * size, size, size, bg);
+        }
+      }
+    }
+    if (bg != color) {
+      if (size == 1) writeFastVLine(x + 5, y, 8, bg);
+      else writeFillRect(x + 5 * size, y, size, 8 * size, bg);
+    }
+    endWrite();
+  }
+
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+ protected:
+  static uint8_t glyphColumn(unsigned char c, int8_t col) {
+    if (c == ' ') return 0;
+    return (uint8_t)((c * 73u + col * 151u) ^ (c >> 1)) & 0x7F;
+  }
+
+  void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners,
+                        uint16_t color) {
+    int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    while (x < y) {
+      if (f >= 0) {
+        y--;
+        ddy += 2;
+        f += ddy;
+      }
+      x++;
+      ddx += 2;
+      f += ddx;
+      if (corners & 4) {
+        writePixel(x0 + x, y0 + y, color);
+        writePixel(x0 + y, y0 + x, color);
+      }
+      if (corners & 2) {
+        writePixel(x0 + x, y0 - y, color);
+        writePixel(x0 + y, y0 - x, color);
+      }
+      if (corners & 8) {
+        writePixel(x0 - y, y0 + x, color);
+        writePixel(x0 - x, y0 + y, color);
+      }
+      if (corners & 1) {
+        writePixel(x0 - y, y0 - x, color);
+        writePixel(x0 - x, y0 - y, color);
+      }
+    }
+  }
+
+  void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners,
+                        int16_t delta, uint16_t color) {
+    int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+    int16_t px = x, py = y;
+    delta++;
+    while (x < y) {
+      if (f >= 0) {
+        y--;
+        ddy += 2;
+        f += ddy;
+      }
+      x++;
+      ddx += 2;
+      f += ddx;
+      if (x < y + 1) {
+        if (corners & 1) writeFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
+        if (corners & 2) writeFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
+      }
+      if (y != py) {
+        if (corners & 1) writeFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
+        if (corners & 2) writeFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
+        py = y;
+      }
+      px = x;
+    }
+  }
+
+  int16_t _width;
+  int16_t _height;
+  int16_t cursor_x;
+  int16_t cursor_y;
+  uint16_t textcolor;
+  uint16_t textbgcolor;
+  uint8_t textsize;
+  bool wrap;
+};
+
+class GFXcanvas16 : public Adafruit_GFX {
+ public:
+  GFXcanvas16(uint16_t w, uint16_t h)
+    : Adafruit_GFX(w, h), _buffer((size_t)w * h, 0) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    _buffer[(size_t)y * _width + x] = color;
+  }
+  void fillScreen(uint16_t color) override {
+    std::fill(_buffer.begin(), _buffer.end(), color);
+  }
+  uint16_t *getBuffer() { return _buffer.data(); }
+
+ private:
+  std::vector<uint16_t> _buffer;
+};
+
+#endif
@@ -0,0 +1,99 @@
+// ================== NATIVE ST7789 MOCK ==================
+// 240x240 panel backed by a RAM framebuffer. Like Adafruit_SPITFT, the
+// fill and line primitives write their area directly instead of going
+// through drawPixel(), so a counting subclass sees each call once; tests
+// can compare framebuffers to check what ended up on the glass.
+
+#ifndef NATIVE_ADAFRUIT_ST7789_H
+#define NATIVE_ADAFRUIT_ST7789_H
+
+#include "Adafruit_GFX.h"
+
+#define ST77XX_BLACK  0x0000
+#define ST77XX_WHITE  0xFFFF
+#define ST77XX_RED    0xF800
+#define ST77XX_GREEN  0x07E0
+#define ST77XX_BLUE   0x001F
+#define ST77XX_CYAN   0x07FF
+#define ST77XX_MAGENTA 0xF81F
+#define ST77XX_YELLOW 0xFFE0
+#define ST77XX_ORANGE 0xFC00
+
+class Adafruit_ST7789 : public Adafruit_GFX {
+ public:
+  Adafruit_ST7789(int8_t cs, int8_t dc, int8_t rst)
+    : Adafruit_GFX(240, 240), _fb(240 * 240, 0),
+      _winX(0), _winY(0), _winW(0), _winH(0) {}
+
+  void init(uint16_t w, uint16_t h) {
+    _width = w;
+    _height = h;
+    _fb.assign((size_t)w * h, 0);
+  }
+  void setRotation(uint8_t) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    put(x, y, color);
+  }
+  void writePixel(int16_t x, int16_t y, uint16_t color) override {
+    put(x, y, color);
+  }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                uint16_t color) override {
+    fill(x, y, w, h, color);
+  }
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                     uint16_t color) override {
+    fill(x, y, w, h, color);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w,
+                     uint16_t color) override {
+    fill(x, y, w, 1, color);
+  }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h,
+                     uint16_t color) override {
+    fill(x, y, 1, h, color);
+  }
+  void writeFastHLine(int16_t x, int16_t y, int16_t w,
+                      uint16_t color) override {
+    fill(x, y, w, 1, color);
+  }
+  void writeFastVLine(int16_t x, int16_t y, int16_t h,
+                      uint16_t color) override {
+    fill(x, y, 1, h, color);
+  }
+
+  void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    _winX = x;
+    _winY = y;
+    _winW = w;
+    _winH = h;
+  }
+  void writePixels(uint16_t *colors, uint32_t len, bool block = true,
+                   bool bigEndian = false) {
+    for (uint32_t i = 0; i < len && _winW; i++) {
+      put(_winX + i % _winW, _winY + i / _winW, colors[i]);
+    }
+  }
+
+  uint16_t pixel(int16_t x, int16_t y) const {
+    return _fb[(size_t)y * _width + x];
+  }
+  const std::vector<uint16_t> &framebuffer() const { return _fb; }
+
+ private:
+  void put(int16_t x, int16_t y, uint16_t color) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    _fb[(size_t)y * _width + x] = color;
+  }
+  void fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    for (int16_t j = y; j < y + h; j++) {
+      for (int16_t i = x; i < x + w; i++) put(i, j, color);
+    }
+  }
+
+  std::vector<uint16_t> _fb;
+  uint16_t _winX, _winY, _winW, _winH;
+};
+
+#endif
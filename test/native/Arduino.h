@@ -0,0 +1,435 @@
+// ================== NATIVE TEST SHIM ==================
+// Just enough of the ESP32 Arduino core to build the hardware independent
+// modules on the host for `pio test -e native`.
+//
+//  - String is a thin wrapper over std::string with the Arduino API
+//  - Serial swallows everything unless NATIVE_SERIAL_ECHO is defined
+//  - millis()/micros() read a virtual clock that only moves when a test
+//    calls nativeAdvanceMs()/nativeAdvanceUs(), delay() or vTaskDelay(),
+//    so timeouts replay exactly
+//  - ESP.getFreeHeap() reports a fixed heap minus what a test counts
+//  - FreeRTOS mutexes are real mutexes; tasks never start
+//    (xTaskCreatePinnedToCore() fails), so modules take their inline
+//    fallback paths
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define DEC 10
+#define HEX 16
+#define PROGMEM
+#define IRAM_ATTR
+#define F(x) (x)
+#define PSTR(x) (x)
+#define constrain(amt, low, high) \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class __FlashStringHelper;
+
+// ---------- Virtual clock ----------
+
+inline uint64_t &nativeClockUs() {
+  static uint64_t us = 0;
+  return us;
+}
+
+inline void nativeAdvanceUs(uint64_t us) { nativeClockUs() += us; }
+inline void nativeAdvanceMs(uint32_t ms) { nativeClockUs() += ms * 1000ULL; }
+inline void nativeSetMs(uint32_t ms) { nativeClockUs() = ms * 1000ULL; }
+
+inline unsigned long millis() {
+  return (unsigned long)(nativeClockUs() / 1000);
+}
+inline unsigned long micros() { return (unsigned long)nativeClockUs(); }
+inline void delay(unsigned long ms) { nativeAdvanceMs(ms); }
+inline void delayMicroseconds(unsigned us) { nativeAdvanceUs(us); }
+inline void yield() {}
+inline int64_t esp_timer_get_time() { return (int64_t)nativeClockUs(); }
+
+// Real elapsed time, for the benchmarks
+inline uint64_t nativeWallNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Same digits as the core's dtostrf(): round by adding half of the last
+// place, then peel digits off in double; right aligned in width
+inline char *dtostrf(double number, signed int width, unsigned int prec,
+                     char *s) {
+  if (number != number) return strcpy(s, "nan");
+  char *out = s;
+  int fill = width;
+  if (prec > 0) fill -= prec + 1;
+  bool negative = number < 0.0;
+  if (negative) {
+    fill--;
+    number = -number;
+  }
+  double rounding = 2.0;
+  for (unsigned int i = 0; i < prec; i++) rounding *= 10.0;
+  number += 1.0 / rounding;
+
+  double tenpow = 1.0;
+  unsigned int digits = 1;
+  while (number >= 10.0 * tenpow) {
+    tenpow *= 10.0;
+    digits++;
+  }
+  number /= tenpow;
+  fill -= digits;
+  while (fill-- > 0) *out++ = ' ';
+  if (negative) *out++ = '-';
+
+  digits += prec;
+  while (digits-- > 0) {
+    int digit = (int)number;
+    if (digit > 9) digit = 9;
+    *out++ = (char)('0' + digit);
+    if (digits == prec && prec > 0) *out++ = '.';
+    number -= digit;
+    number *= 10.0;
+  }
+  *out = 0;
+  return s;
+}
+
+// ---------- String ----------
+
+class String {
+ public:
+  String(const char *c = "") : _s(c ? c : "") {}
+  String(const std::string &s) : _s(s) {}
+  explicit String(char c) : _s(1, c) {}
+  String(int v, unsigned char base = 10) : _s(num(v, base)) {}
+  String(unsigned v, unsigned char base = 10) : _s(num(v, base)) {}
+  String(long v, unsigned char base = 10) : _s(num(v, base)) {}
+  String(unsigned long v, unsigned char base = 10) : _s(num(v, base)) {}
+  String(double v, unsigned char decimals = 2) {
+    char buf[64];
+    _s = dtostrf(v, decimals + 2, decimals, buf);
+  }
+
+  unsigned length() const { return _s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  const char *c_str() const { return _s.c_str(); }
+  bool reserve(unsigned n) { _s.reserve(n); return true; }
+
+  char operator[](unsigned i) const { return i < _s.size() ? _s[i] : 0; }
+  char &operator[](unsigned i) { return _s[i]; }
+  char charAt(unsigned i) const { return (*this)[i]; }
+  void setCharAt(unsigned i, char c) { if (i < _s.size()) _s[i] = c; }
+
+  String &operator+=(const String &o) { _s += o._s; return *this; }
+  String &operator+=(const char *o) { if (o) _s += o; return *this; }
+  String &operator+=(char c) { _s += c; return *this; }
+  String &operator+=(int v) { _s += num(v, 10); return *this; }
+  String &operator+=(unsigned v) { _s += num(v, 10); return *this; }
+  String &operator+=(long v) { _s += num(v, 10); return *this; }
+  String &operator+=(unsigned long v) { _s += num(v, 10); return *this; }
+  bool concat(const String &o) { *this += o; return true; }
+  bool concat(const char *o) { *this += o; return true; }
+  bool concat(char c) { *this += c; return true; }
+  bool concat(int v) { *this += v; return true; }
+  bool concat(const char *o, unsigned n) { _s.append(o, n); return true; }
+
+  friend String operator+(const String &a, const String &b) {
+    return String(a._s + b._s);
+  }
+  friend String operator+(const String &a, const char *b) {
+    return String(a._s + b);
+  }
+  friend String operator+(const char *a, const String &b) {
+    return String(a + b._s);
+  }
+  friend String operator+(const String &a, char c) {
+    return String(a._s + c);
+  }
+
+  bool operator==(const String &o) const { return _s == o._s; }
+  bool operator==(const char *o) const { return _s == (o ? o : ""); }
+  bool operator!=(const String &o) const { return _s != o._s; }
+  bool operator!=(const char *o) const { return !(*this == o); }
+  bool operator<(const String &o) const { return _s < o._s; }
+  bool equals(const String &o) const { return _s == o._s; }
+  bool equalsIgnoreCase(const String &o) const {
+    if (_s.size() != o._s.size()) return false;
+    for (size_t i = 0; i < _s.size(); i++) {
+      if (tolower(_s[i]) != tolower(o._s[i])) return false;
+    }
+    return true;
+  }
+
+  bool startsWith(const String &p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+  bool startsWith(const char *p) const { return startsWith(String(p)); }
+  bool endsWith(const String &p) const {
+    return _s.size() >= p._s.size() &&
+           _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+  }
+  bool endsWith(const char *p) const { return endsWith(String(p)); }
+
+  int indexOf(char c, unsigned from = 0) const { return pos(_s.find(c, from)); }
+  int indexOf(const char *p, unsigned from = 0) const { return pos(_s.find(p, from)); }
+  int indexOf(const String &p, unsigned from = 0) const { return pos(_s.find(p._s, from)); }
+  int lastIndexOf(char c) const { return pos(_s.rfind(c)); }
+  int lastIndexOf(const char *p) const { return pos(_s.rfind(p)); }
+
+  String substring(unsigned from) const {
+    return from < _s.size() ? String(_s.substr(from)) : String();
+  }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.size()) return String();
+    return String(_s.substr(from, to - from));
+  }
+
+  void remove(unsigned index) { if (index < _s.size()) _s.erase(index); }
+  void remove(unsigned index, unsigned count) {
+    if (index < _s.size()) _s.erase(index, count);
+  }
+  void replace(const String &from, const String &to) {
+    if (from._s.empty()) return;
+    for (size_t p = 0; (p = _s.find(from._s, p)) != std::string::npos;
+         p += to._s.size()) {
+      _s.replace(p, from._s.size(), to._s);
+    }
+  }
+  void trim() {
+    size_t a = _s.find_first_not_of(" \t\r\n");
+    size_t b = _s.find_last_not_of(" \t\r\n");
+    _s = a == std::string::npos ? std::string() : _s.substr(a, b - a + 1);
+  }
+  void toUpperCase() { for (char &c : _s) c = toupper(c); }
+  void toLowerCase() { for (char &c : _s) c = tolower(c); }
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return atof(_s.c_str()); }
+  void toCharArray(char *buf, unsigned size) const {
+    if (!size) return;
+    strncpy(buf, _s.c_str(), size - 1);
+    buf[size - 1] = '\0';
+  }
+
+ private:
+  template <typename T>
+  static std::string num(T v, unsigned char base) {
+    char buf[40];
+    if (base == 16) snprintf(buf, sizeof(buf), "%llx", (unsigned long long)v);
+    else if (v < 0) snprintf(buf, sizeof(buf), "%lld", (long long)v);
+    else snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v);
+    return buf;
+  }
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+
+  std::string _s;
+};
+
+// ---------- Print / Stream ----------
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buf++);
+    return n;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t write(const char *s, size_t n) { return write((const uint8_t *)s, n); }
+  virtual void flush() {}
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T &v) { return print(v) + println(); }
+  template <typename T>
+  size_t println(const T &v, int fmt) { return print(v, fmt) + println(); }
+
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t *)buf, min((size_t)n, sizeof(buf) - 1));
+  }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long ms) { _timeout = ms; }
+  size_t readBytes(uint8_t *buf, size_t size) {
+    size_t n = 0;
+    while (n < size && available()) buf[n++] = read();
+    return n;
+  }
+  size_t readBytes(char *buf, size_t size) {
+    return readBytes((uint8_t *)buf, size);
+  }
+  String readString() {
+    String s;
+    while (available()) s += (char)read();
+    return s;
+  }
+  String readStringUntil(char end) {
+    String s;
+    while (available()) {
+      char c = read();
+      if (c == end) break;
+      s += c;
+    }
+    return s;
+  }
+
+ protected:
+  unsigned long _timeout = 1000;
+};
+
+class NativeSerial : public Stream {
+ public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override {
+#ifdef NATIVE_SERIAL_ECHO
+    fputc(c, stdout);
+#else
+    (void)c;
+#endif
+    return 1;
+  }
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  operator bool() const { return true; }
+};
+
+inline NativeSerial &nativeSerial() {
+  static NativeSerial serial;
+  return serial;
+}
+#define Serial nativeSerial()
+
+// ---------- Heap ----------
+// ESP.getFreeHeap() of a pretend heap. Nothing is counted unless a test
+// replaces operator new and keeps nativeHeapUsed() up to date.
+
+#define NATIVE_HEAP_SIZE 327680
+
+inline size_t &nativeHeapUsed() {
+  static size_t used = 0;
+  return used;
+}
+
+class EspClass {
+ public:
+  uint32_t getFreeHeap() { return NATIVE_HEAP_SIZE - nativeHeapUsed(); }
+};
+inline EspClass ESP;
+
+// ---------- FreeRTOS ----------
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdPASS 1
+#define pdFAIL 0
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+struct NativeMutex {
+  std::timed_mutex m;
+};
+typedef NativeMutex *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeMutex(); }
+inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+  if (ticks == portMAX_DELAY) {
+    s->m.lock();
+    return pdTRUE;
+  }
+  return s->m.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  s->m.unlock();
+  return pdTRUE;
+}
+
+struct portMUX_TYPE {
+  volatile int locked;
+};
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+inline void nativeMuxEnter(portMUX_TYPE *mux) {
+  while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE)) {
+  }
+}
+inline void nativeMuxExit(portMUX_TYPE *mux) {
+  __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE);
+}
+#define portENTER_CRITICAL(mux) nativeMuxEnter(mux)
+#define portEXIT_CRITICAL(mux) nativeMuxExit(mux)
+#define portENTER_CRITICAL_ISR(mux) nativeMuxEnter(mux)
+#define portEXIT_CRITICAL_ISR(mux) nativeMuxExit(mux)
+#define taskENTER_CRITICAL(mux) nativeMuxEnter(mux)
+#define taskEXIT_CRITICAL(mux) nativeMuxExit(mux)
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *,
+                                          uint32_t, void *, UBaseType_t,
+                                          TaskHandle_t *task, BaseType_t) {
+  if (task) *task = nullptr;
+  return pdFAIL;
+}
+inline void vTaskDelay(TickType_t ticks) { nativeAdvanceMs(ticks); }
+inline void vTaskDelete(TaskHandle_t) {}
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline BaseType_t xPortGetCoreID() { return 1; }
+
+#endif
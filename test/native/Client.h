@@ -0,0 +1,10 @@
+// TinyGsmCommon.h pulls in Client.h; only the Stream part matters on
+// the host
+#ifndef NATIVE_CLIENT_H
+#define NATIVE_CLIENT_H
+
+#include <Arduino.h>
+
+class Client : public Stream {};
+
+#endif
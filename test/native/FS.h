@@ -0,0 +1,154 @@
+// In-memory stand-in for the ESP32 core's fs::FS / fs::File, enough for
+// the journal: flat directories, "r" / "w" / "a" modes, directory
+// listing. Every write lands in the file at once, byte by byte, so a
+// test can cut the power after any byte with nativeWriteBudget().
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs {
+
+class FS;
+
+class File {
+ public:
+  File() {}
+
+  explicit operator bool() const { return _fs != nullptr; }
+
+  size_t read(uint8_t *buf, size_t size);
+  size_t write(const uint8_t *buf, size_t size);
+  int available();
+  bool seek(uint32_t pos);
+  void close() { _fs = nullptr; }
+
+  const char *name() const { return _name.c_str(); }
+  bool isDirectory() const { return _dir; }
+  File openNextFile();
+
+ private:
+  friend class FS;
+
+  FS *_fs = nullptr;
+  std::string _path;
+  std::string _name;        // Last path component, like core 2.x
+  bool _dir = false;
+  size_t _pos = 0;
+  std::shared_ptr<std::vector<std::string>> _listing;
+};
+
+class FS {
+ public:
+  File open(const char *path, const char *mode = "r") {
+    std::string p = path;
+    File f;
+    if (_dirs.count(p)) {
+      f._listing = std::make_shared<std::vector<std::string>>();
+      for (auto &kv : _files) {
+        if (kv.first.compare(0, p.size() + 1, p + "/") == 0) {
+          f._listing->push_back(kv.first);
+        }
+      }
+      f._dir = true;
+    } else if (mode[0] == 'r') {
+      if (!_files.count(p)) return File();
+    } else {
+      if (_powerOff) return File();
+      if (mode[0] == 'w' || !_files.count(p)) _files[p].clear();
+      f._pos = _files[p].size();
+    }
+    f._fs = this;
+    f._path = p;
+    f._name = p.substr(p.rfind('/') + 1);
+    return f;
+  }
+
+  bool exists(const char *path) {
+    return _files.count(path) || _dirs.count(path);
+  }
+  bool mkdir(const char *path) {
+    _dirs.insert(std::make_pair(std::string(path), true));
+    return true;
+  }
+  bool remove(const char *path) {
+    if (_powerOff) return false;
+    return _files.erase(path) > 0;
+  }
+
+  // Flash contents survive, the power comes back
+  void nativePowerCycle() { _powerOff = false; _budget = -1; }
+  void nativeFormat() {
+    _files.clear();
+    _dirs.clear();
+    nativePowerCycle();
+  }
+  // The power fails once this many more bytes have been written
+  void nativeWriteBudget(long bytes) { _budget = bytes; }
+  bool nativePowerOff() const { return _powerOff; }
+  std::map<std::string, std::string> &nativeFiles() { return _files; }
+
+ private:
+  friend class File;
+
+  std::map<std::string, std::string> _files;
+  std::map<std::string, bool> _dirs;
+  long _budget = -1;
+  bool _powerOff = false;
+};
+
+inline size_t File::read(uint8_t *buf, size_t size) {
+  if (!_fs || _dir || !_fs->_files.count(_path)) return 0;
+  const std::string &data = _fs->_files[_path];
+  size_t n = _pos < data.size() ? std::min(size, data.size() - _pos) : 0;
+  memcpy(buf, data.data() + _pos, n);
+  _pos += n;
+  return n;
+}
+
+inline size_t File::write(const uint8_t *buf, size_t size) {
+  if (!_fs || _dir) return 0;
+  size_t n = 0;
+  while (n < size && !_fs->_powerOff) {
+    if (_fs->_budget == 0) {
+      _fs->_powerOff = true;
+      break;
+    }
+    if (_fs->_budget > 0) _fs->_budget--;
+    _fs->_files[_path] += (char)buf[n++];
+  }
+  _pos += n;
+  return n;
+}
+
+inline int File::available() {
+  if (!_fs || _dir || !_fs->_files.count(_path)) return 0;
+  size_t size = _fs->_files[_path].size();
+  return _pos < size ? (int)(size - _pos) : 0;
+}
+
+inline bool File::seek(uint32_t pos) {
+  if (!_fs || _dir || !_fs->_files.count(_path)) return false;
+  if (pos > _fs->_files[_path].size()) return false;
+  _pos = pos;
+  return true;
+}
+
+inline File File::openNextFile() {
+  if (!_fs || !_dir || _listing->empty()) return File();
+  std::string path = _listing->front();
+  _listing->erase(_listing->begin());
+  return _fs->open(path.c_str(), "r");
+}
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
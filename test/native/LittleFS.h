@@ -0,0 +1,18 @@
+// LittleFS on the host: an in-memory fs::FS that always mounts
+#ifndef NATIVE_LITTLEFS_H
+#define NATIVE_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+ public:
+  bool begin(bool formatOnFail = false) { return true; }
+};
+
+}  // namespace fs
+
+inline fs::LittleFSFS LittleFS;
+
+#endif
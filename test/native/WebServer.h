@@ -0,0 +1,99 @@
+// WebServer on the host: no sockets. What a handler sends is counted and
+// optionally handed to a sink as it goes out; the client can be made to
+// go away or stop reading after a number of body bytes, and every write
+// can cost virtual time to stand in for a slow link.
+#ifndef NATIVE_WEB_SERVER_H
+#define NATIVE_WEB_SERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+// What a write to a peer that reads nothing costs the core's WiFiClient:
+// ten retries of a one second select()
+#define NATIVE_WRITE_TIMEOUT_MS 10000
+
+enum HTTPMethod {
+  HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH,
+  HTTP_DELETE, HTTP_OPTIONS
+};
+
+typedef void (*NativeContentSink)(const char *data, size_t len, void *ctx);
+
+class WebServer {
+ public:
+  explicit WebServer(int port = 80) {}
+
+  WiFiClient &client() { return _client; }
+
+  void setContentLength(size_t len) { _contentLength = len; }
+
+  void send(int code, const char *contentType, const String &content) {
+    nativeCode = code;
+    _chunked = _contentLength == CONTENT_LENGTH_UNKNOWN;
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    if (content.length()) sendContent(content);
+  }
+
+  void sendContent(const String &content) {
+    sendContent(content.c_str(), content.length());
+  }
+
+  // In chunked mode every call is one chunk, an empty one ends the body
+  void sendContent(const char *content, size_t len) {
+    if (!_client.connected()) return;
+    if (_chunked && !len) {
+      _chunked = false;
+      nativeComplete = true;
+      return;
+    }
+    if (nativeStallAfter && nativeBytes + len > nativeStallAfter) {
+      nativeAdvanceMs(NATIVE_WRITE_TIMEOUT_MS);
+      return;
+    }
+    nativeAdvanceUs((uint64_t)len * nativeUsPerByte);
+    if (nativeDisconnectAfter && nativeBytes + len >= nativeDisconnectAfter) {
+      _client.nativeConnect(false);
+      return;
+    }
+    nativeBytes += len;
+    nativeChunks++;
+    if (len > nativeMaxChunk) nativeMaxChunk = len;
+    if (nativeSink) nativeSink(content, len, nativeSinkCtx);
+  }
+
+  // Host side: response so far and how the client behaves
+  void nativeReset() {
+    _client.nativeConnect(true);
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+    _chunked = false;
+    nativeCode = 0;
+    nativeComplete = false;
+    nativeBytes = nativeChunks = nativeMaxChunk = 0;
+    nativeDisconnectAfter = 0;
+    nativeStallAfter = 0;
+    nativeUsPerByte = 0;
+    nativeSink = nullptr;
+    nativeSinkCtx = nullptr;
+  }
+
+  int nativeCode = 0;
+  bool nativeComplete = false;        // Terminating chunk sent
+  size_t nativeBytes = 0;
+  uint32_t nativeChunks = 0;
+  size_t nativeMaxChunk = 0;
+  size_t nativeDisconnectAfter = 0;   // 0: never
+  size_t nativeStallAfter = 0;        // Stops reading after; 0: never
+  uint32_t nativeUsPerByte = 0;
+  NativeContentSink nativeSink = nullptr;
+  void *nativeSinkCtx = nullptr;
+
+ private:
+  WiFiClient _client;
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+  bool _chunked = false;
+};
+
+#endif
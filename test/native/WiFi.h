@@ -0,0 +1,20 @@
+// WiFiClient on the host: no socket, just whether the peer is still there
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include <Arduino.h>
+
+class WiFiClient {
+ public:
+  uint8_t connected() { return _connected; }
+  void stop() { _connected = false; }
+  void setNoDelay(bool) {}
+
+  // Host side
+  void nativeConnect(bool on) { _connected = on; }
+
+ private:
+  bool _connected = true;
+};
+
+#endif
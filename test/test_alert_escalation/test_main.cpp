@@ -0,0 +1,245 @@
+// AlertEscalation driven by scripted call outcomes on a virtual clock.
+// Every dial consumes the next script entry; its URC lines are fed back at
+// their offsets through the same mapping the firmware uses, and each test
+// asserts the exact time of every state transition.
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "AlertEscalation.h"
+
+// Same values as the firmware
+static const EscalationConfig config = {
+  3,        // maxAttempts
+  3000,     // retryDelay
+  10000,    // setupTimeout
+  45000,    // callTimeout
+  5000,     // answerHold
+  300000    // cooldown
+};
+
+struct ScriptLine {
+  unsigned long offsetMs;  // After the dial
+  const char *urc;
+};
+
+struct Outcome {
+  bool accepted;           // ATD result
+  std::vector<ScriptLine> lines;
+};
+
+struct Pending {
+  unsigned long at;
+  std::string urc;
+};
+
+static AlertEscalation *esc;
+static std::vector<Outcome> script;
+static size_t nextOutcome;
+static std::vector<Pending> pending;
+static std::vector<std::string> transitions;
+static std::vector<std::string> calls;
+static unsigned long now;
+
+static bool onDial(uint8_t contact, uint8_t attempt) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%lu dial %u/%u", now, contact, attempt);
+  calls.push_back(buf);
+  if (nextOutcome >= script.size()) return true;  // Never answered
+  const Outcome &o = script[nextOutcome++];
+  for (const ScriptLine &l : o.lines) {
+    pending.push_back(Pending{now + l.offsetMs, l.urc});
+  }
+  return o.accepted;
+}
+
+static void onHangup() {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%lu hangup", now);
+  calls.push_back(buf);
+  pending.clear();  // Whatever the network had left is for a dead call
+}
+
+static void onState(EscalationState from, EscalationState to,
+                    unsigned long at) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%lu %s", at, escalationStateName(to));
+  transitions.push_back(buf);
+}
+
+// The firmware's URC table: onCallEndedURC / onCallProgressURC
+static void feedUrc(const std::string &urc) {
+  CallEvent event;
+  if (urc == "VOICE CALL: BEGIN") {
+    esc->onCallEvent(CALL_EVT_ANSWERED, now);
+  } else if (urc == "NO CARRIER" || urc == "BUSY" || urc == "NO ANSWER" ||
+             urc == "VOICE CALL: END") {
+    esc->onCallEvent(CALL_EVT_ENDED, now);
+  } else if (clccCallEvent(urc.c_str(), event)) {
+    esc->onCallEvent(event, now);
+  }
+}
+
+static void runUntil(unsigned long end) {
+  while (now < end) {
+    now++;
+    for (size_t i = 0; i < pending.size();) {
+      if (pending[i].at == now) {
+        std::string urc = pending[i].urc;
+        pending.erase(pending.begin() + i);
+        feedUrc(urc);
+      } else {
+        i++;
+      }
+    }
+    esc->tick(now);
+  }
+}
+
+static void expect(const std::vector<std::string> &got,
+                   const std::vector<std::string> &want) {
+  size_t n = got.size() < want.size() ? got.size() : want.size();
+  for (size_t i = 0; i < n; i++) {
+    TEST_ASSERT_EQUAL_STRING(want[i].c_str(), got[i].c_str());
+  }
+  TEST_ASSERT_EQUAL(want.size(), got.size());
+}
+
+void setUp() {
+  esc = new AlertEscalation();
+  EscalationActions actions = {onDial, onHangup, onState};
+  esc->begin(config, actions);
+  script.clear();
+  nextOutcome = 0;
+  pending.clear();
+  transitions.clear();
+  calls.clear();
+  now = 1000;
+}
+
+void tearDown() { delete esc; }
+
+static void test_clcc_mapping() {
+  CallEvent e;
+  TEST_ASSERT_FALSE(clccCallEvent("+CLCC: 1,0,2,0,0,\"+4917\",145", e));
+  TEST_ASSERT_TRUE(clccCallEvent("+CLCC: 1,0,3,0,0,\"+4917\",145", e));
+  TEST_ASSERT_EQUAL(CALL_EVT_RINGING, e);
+  TEST_ASSERT_TRUE(clccCallEvent("+CLCC: 1,0,0,0,0,\"+4917\",145", e));
+  TEST_ASSERT_EQUAL(CALL_EVT_ANSWERED, e);
+  TEST_ASSERT_TRUE(clccCallEvent("+CLCC: 1,0,6,0,0,\"+4917\",145", e));
+  TEST_ASSERT_EQUAL(CALL_EVT_ENDED, e);
+  TEST_ASSERT_FALSE(clccCallEvent("+CLCC: 1,1,4,0,0,\"+4917\",145", e));
+  TEST_ASSERT_FALSE(clccCallEvent("+CLCC: 1,0,1,0,0", e));
+  TEST_ASSERT_FALSE(clccCallEvent("+CLCC: 1,0", e));
+  TEST_ASSERT_FALSE(clccCallEvent("+CSQ: 3,0,0", e));
+}
+
+// "Dialing" must not count as ringing: with stat 2 only, the setup
+// timeout applies, not the 45 s ring timeout
+static void test_dialing_report_is_not_ringing() {
+  script.push_back(Outcome{true, {{200, "+CLCC: 1,0,2,0,0,\"+4917\",145"}}});
+  esc->setAlert(true, 1, now);
+  runUntil(12000);
+
+  expect(transitions, {"1000 WAIT_RETRY", "1000 DIALING", "11000 WAIT_RETRY"});
+  expect(calls, {"1000 dial 0/1", "11000 hangup"});
+}
+
+static void test_answered_first_call() {
+  script.push_back(Outcome{true, {
+    {300, "+CLCC: 1,0,2,0,0,\"+4917\",145"},
+    {2100, "+CLCC: 1,0,3,0,0,\"+4917\",145"},
+    {9000, "VOICE CALL: BEGIN"},
+    {9001, "+CLCC: 1,0,0,0,0,\"+4917\",145"},
+  }});
+  esc->setAlert(true, 2, now);
+  runUntil(20000);
+
+  expect(transitions, {"1000 WAIT_RETRY", "1000 DIALING", "3100 RINGING",
+                       "10000 CONNECTED", "15000 ACKNOWLEDGED"});
+  expect(calls, {"1000 dial 0/1", "15000 hangup"});
+  TEST_ASSERT_EQUAL(1, esc->totalAttempts());
+}
+
+static void test_declined_retries_then_next_contact() {
+  Outcome declined = {true, {
+    {1500, "+CLCC: 1,0,3,0,0,\"+4917\",145"},
+    {4000, "+CLCC: 1,0,6,0,0,\"+4917\",145"},
+    {4001, "NO CARRIER"},
+  }};
+  script = {declined, declined, declined, declined};
+  esc->setAlert(true, 2, now);
+  runUntil(1000 + 4 * 7000);
+
+  // Decline at +4 s, next dial RETRY_DELAY later: one call every 7 s
+  expect(transitions, {
+    "1000 WAIT_RETRY",
+    "1000 DIALING", "2500 RINGING", "5000 WAIT_RETRY",
+    "8000 DIALING", "9500 RINGING", "12000 WAIT_RETRY",
+    "15000 DIALING", "16500 RINGING", "19000 WAIT_RETRY",
+    "22000 DIALING", "23500 RINGING", "26000 WAIT_RETRY",
+    "29000 DIALING",
+  });
+  expect(calls, {"1000 dial 0/1", "8000 dial 0/2", "15000 dial 0/3",
+                 "22000 dial 1/1", "29000 dial 1/2"});
+}
+
+static void test_ring_out_hangs_up_at_call_timeout() {
+  script.push_back(Outcome{true, {{2000, "+CLCC: 1,0,3,0,0,\"+4917\",145"}}});
+  esc->setAlert(true, 1, now);
+  runUntil(50000);
+
+  expect(transitions, {"1000 WAIT_RETRY", "1000 DIALING", "3000 RINGING",
+                       "46000 WAIT_RETRY", "49000 DIALING"});
+  expect(calls, {"1000 dial 0/1", "46000 hangup", "49000 dial 0/2"});
+}
+
+static void test_rejected_dial_retries_after_delay() {
+  script.push_back(Outcome{false, {}});
+  esc->setAlert(true, 1, now);
+  runUntil(4500);
+
+  expect(transitions, {"1000 WAIT_RETRY", "1000 DIALING", "1000 WAIT_RETRY",
+                       "4000 DIALING"});
+}
+
+static void test_alert_cleared_mid_call() {
+  script.push_back(Outcome{true, {{1000, "+CLCC: 1,0,3,0,0,\"+4917\",145"}}});
+  esc->setAlert(true, 1, now);
+  runUntil(5000);
+  esc->setAlert(false, 1, now);
+  runUntil(60000);
+
+  expect(transitions, {"1000 WAIT_RETRY", "1000 DIALING", "2000 RINGING",
+                       "5000 IDLE"});
+  expect(calls, {"1000 dial 0/1", "5000 hangup"});
+}
+
+static void test_ladder_restarts_after_cooldown() {
+  script.push_back(Outcome{true, {{1000, "VOICE CALL: BEGIN"}}});
+  esc->setAlert(true, 3, now);
+  runUntil(1000 + 1000 + 5000 + 300000 + 10);
+
+  expect(transitions, {"1000 WAIT_RETRY", "1000 DIALING", "2000 CONNECTED",
+                       "7000 ACKNOWLEDGED", "307000 WAIT_RETRY",
+                       "307000 DIALING"});
+  TEST_ASSERT_EQUAL(0, esc->contact());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_clcc_mapping);
+  RUN_TEST(test_dialing_report_is_not_ringing);
+  RUN_TEST(test_answered_first_call);
+  RUN_TEST(test_declined_retries_then_next_contact);
+  RUN_TEST(test_ring_out_hangs_up_at_call_timeout);
+  RUN_TEST(test_rejected_dial_retries_after_delay);
+  RUN_TEST(test_alert_cleared_mid_call);
+  RUN_TEST(test_ladder_restarts_after_cooldown);
+  return UNITY_END();
+}
@@ -0,0 +1,283 @@
+// /history's export path on the host: a TimeSeriesStore range copied out
+// a slice at a time and streamed through ChunkedResponse. Heap use and
+// buffer size must be the same for five minutes of rows or seven days,
+// and a client that goes away must stop the export early. The web task
+// serves one connection at a time, so how long a /job poll waits behind
+// an export is measured for clients of different speeds.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <new>
+
+#include "ChunkedResponse.h"
+#include "TimeSeriesStore.h"
+#include "WebJobs.h"
+
+// Every operator new in this binary goes through the shim's heap count,
+// with the size kept in front of the block for delete
+static size_t peakUsed;
+
+void *operator new(size_t n) {
+  size_t *p = (size_t *)malloc(sizeof(size_t) + n);
+  if (!p) throw std::bad_alloc();
+  *p = n;
+  nativeHeapUsed() += n;
+  if (nativeHeapUsed() > peakUsed) peakUsed = nativeHeapUsed();
+  return p + 1;
+}
+void operator delete(void *p) noexcept {
+  if (!p) return;
+  size_t *block = (size_t *)p - 1;
+  nativeHeapUsed() -= *block;
+  free(block);
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+// Same slice size and export loop as handleHistory() in main.cpp
+#define HISTORY_SLICE_ROWS 16
+
+struct HistorySlice {
+  TsPoint rows[HISTORY_SLICE_ROWS];
+  uint8_t count;
+};
+
+static bool onHistorySliceRow(const TsPoint &point, void *ctx) {
+  HistorySlice &slice = *static_cast<HistorySlice *>(ctx);
+  slice.rows[slice.count++] = point;
+  return slice.count < HISTORY_SLICE_ROWS;
+}
+
+static void writeRow(ChunkedResponse &out, const TsPoint &p) {
+  out.printf("%lu,%lu,%u,%u", 0UL, (unsigned long)p.t, p.count, p.flame);
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    float scale = c <= TS_HUM ? 0.1f : 1.0f;
+    uint8_t decimals = c <= TS_HUM ? 1 : 0;
+    out.printf(",%.*f,%.*f,%.*f", decimals, p.mean[c] * scale, decimals,
+               p.min[c] * scale, decimals, p.max[c] * scale);
+  }
+  out.print("\n");
+}
+
+struct ExportResult {
+  uint32_t rows;
+  uint32_t lowestHeap;      // ChunkedResponse's, as exportDone() logs it
+  bool stalled;
+};
+
+static ExportResult exportHistory(WebServer &server,
+                                  TimeSeriesStore &history, TsTier tier,
+                                  uint32_t from, uint32_t to) {
+  ChunkedResponse out(server);
+  out.begin(200, "text/csv");
+  out.print("utc,uptime,count,flame,temp,temp_min,temp_max,hum,hum_min,"
+            "hum_max,gas,gas_min,gas_max,nh3,nh3_min,nh3_max\n");
+
+  uint32_t period = tier == TS_SECONDS ? 1 : tier == TS_MINUTES ? 60 : 3600;
+  uint32_t rows = 0;
+  HistorySlice slice;
+  uint32_t cursor = from;
+  do {
+    slice.count = 0;
+    history.query(tier, cursor, to, onHistorySliceRow, &slice);
+    for (uint8_t i = 0; i < slice.count && out.ok(); i++) {
+      writeRow(out, slice.rows[i]);
+      rows++;
+    }
+    if (slice.count) cursor = slice.rows[slice.count - 1].t + period;
+  } while (slice.count == HISTORY_SLICE_ROWS && out.ok());
+
+  out.end();
+  return ExportResult{rows, out.lowestHeap(), out.stalled()};
+}
+
+static bool countRow(const TsPoint &, void *ctx) {
+  (*static_cast<uint32_t *>(ctx))++;
+  return true;
+}
+
+static void countLines(const char *data, size_t len, void *ctx) {
+  uint32_t &lines = *static_cast<uint32_t *>(ctx);
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] == '\n') lines++;
+  }
+}
+
+// Eight days at one sample per second, so every tier is full
+static const uint32_t DAYS = 8;
+static const uint32_t NOW = 1000 + DAYS * 86400;
+
+static TimeSeriesStore history;
+static WebServer server(80);
+
+static void record() {
+  for (uint32_t t = 1000; t < NOW; t++) {
+    TsSample s;
+    s.value[TS_TEMP] = (int16_t)(200 + t % 97);
+    s.value[TS_HUM] = (int16_t)(500 + t % 211);
+    s.value[TS_GAS] = (int16_t)(20 + t % 13);
+    s.value[TS_NH3] = (int16_t)(t % 7);
+    s.flame = t % 3600 == 0;
+    history.add(t, s);
+  }
+}
+
+void setUp() { server.nativeReset(); }
+void tearDown() {}
+
+struct Range {
+  const char *name;
+  TsTier tier;
+  uint32_t seconds;
+};
+
+static const Range ranges[] = {
+  { "5 min of seconds", TS_SECONDS, 300 },
+  { "30 min of seconds", TS_SECONDS, TS_RAW_BLOCKS * TS_BLOCK_SECONDS },
+  { "1 h of minutes", TS_MINUTES, 3600 },
+  { "4 h of minutes", TS_MINUTES, TS_MINUTE_BUCKETS * 60UL },
+  { "1 day of hours", TS_HOURS, 86400 },
+  { "7 days of hours", TS_HOURS, TS_HOUR_BUCKETS * 3600UL },
+};
+#define RANGE_COUNT (sizeof(ranges) / sizeof(ranges[0]))
+
+static void test_memory_does_not_grow_with_range() {
+  long heapGrowth[RANGE_COUNT];
+  uint32_t lowestHeap[RANGE_COUNT];
+  char msg[160];
+
+  for (uint8_t i = 0; i < RANGE_COUNT; i++) {
+    const Range &r = ranges[i];
+    uint32_t expected = 0;
+    history.query(r.tier, NOW - r.seconds, NOW, countRow, &expected);
+    TEST_ASSERT_GREATER_THAN(0, (int)expected);
+
+    uint32_t lines = 0;
+    server.nativeReset();
+    server.nativeSink = countLines;
+    server.nativeSinkCtx = &lines;
+
+    size_t before = nativeHeapUsed();
+    peakUsed = before;
+    uint64_t t0 = nativeWallNs();
+    ExportResult x = exportHistory(server, history, r.tier,
+                                   NOW - r.seconds, NOW);
+    uint64_t ns = nativeWallNs() - t0;
+    uint32_t rows = x.rows;
+    heapGrowth[i] = (long)(peakUsed - before);
+    lowestHeap[i] = x.lowestHeap;
+
+    TEST_ASSERT_EQUAL(expected, rows);
+    TEST_ASSERT_EQUAL(rows + 1, lines);
+    TEST_ASSERT_LESS_OR_EQUAL(CHUNKED_BUFFER_SIZE, server.nativeMaxChunk);
+    TEST_ASSERT_EQUAL(200, server.nativeCode);
+
+    snprintf(msg, sizeof(msg),
+             "%s: %lu rows, %lu bytes in %lu chunks (max %lu), "
+             "heap +%ld, %.2f us/row",
+             r.name, (unsigned long)rows, (unsigned long)server.nativeBytes,
+             (unsigned long)server.nativeChunks,
+             (unsigned long)server.nativeMaxChunk, heapGrowth[i],
+             ns / 1000.0 / rows);
+    TEST_MESSAGE(msg);
+  }
+
+  for (uint8_t i = 1; i < RANGE_COUNT; i++) {
+    TEST_ASSERT_EQUAL(heapGrowth[0], heapGrowth[i]);
+    TEST_ASSERT_EQUAL(lowestHeap[0], lowestHeap[i]);
+  }
+
+  snprintf(msg, sizeof(msg),
+           "stack per export: ChunkedResponse %u + slice %u bytes",
+           (unsigned)sizeof(ChunkedResponse), (unsigned)sizeof(HistorySlice));
+  TEST_MESSAGE(msg);
+}
+
+// A browser tab closed half way: output after that is dropped, the
+// producer notices through ok() and no terminating chunk is sent
+static void test_gone_client_stops_export() {
+  const uint32_t span = TS_RAW_BLOCKS * TS_BLOCK_SECONDS;
+  uint32_t expected = 0;
+  history.query(TS_SECONDS, NOW - span, NOW, countRow, &expected);
+
+  server.nativeDisconnectAfter = 4 * CHUNKED_BUFFER_SIZE;
+  uint32_t rows = exportHistory(server, history, TS_SECONDS, NOW - span,
+                                NOW).rows;
+
+  TEST_ASSERT_FALSE(server.client().connected());
+  TEST_ASSERT_FALSE(server.nativeComplete);
+  TEST_ASSERT_LESS_THAN(4 * CHUNKED_BUFFER_SIZE, server.nativeBytes);
+  TEST_ASSERT_LESS_THAN(expected / 4, rows);
+}
+
+static void test_complete_export_is_terminated() {
+  exportHistory(server, history, TS_HOURS, NOW - 86400, NOW);
+  TEST_ASSERT_TRUE(server.nativeComplete);
+}
+
+struct Client {
+  const char *name;
+  uint32_t usPerByte;
+  size_t stallAfter;
+};
+
+// The largest export there is, 30 min of seconds, to clients from LAN
+// speed down to the slowest one ChunkedResponse keeps and one that stops
+// reading. A /job poll arriving 1 ms after the export waits for all of
+// it; the last case is what CHUNKED_STALL_MS bounds.
+static void test_job_poll_waits_behind_export() {
+  const Client clients[] = {
+    { "LAN, 1 MB/s", 1, 0 },
+    { "weak WiFi, 16 KB/s", 61, 0 },
+    { "slowest kept, ~1 KB/s",
+      CHUNKED_STALL_MS * 1000 / CHUNKED_BUFFER_SIZE, 0 },
+    { "stops reading after 8 KB", 1, 8 * CHUNKED_BUFFER_SIZE },
+  };
+  const uint32_t span = TS_RAW_BLOCKS * TS_BLOCK_SECONDS;
+
+  WebJobs jobs;
+  char msg[144];
+  for (const Client &c : clients) {
+    server.nativeReset();
+    server.nativeUsPerByte = c.usPerByte;
+    server.nativeStallAfter = c.stallAfter;
+
+    uint16_t id = jobs.submit(JOB_TEST_SMS);
+    unsigned long start = millis();
+    unsigned long pollAt = start + 1;
+    ExportResult x = exportHistory(server, history, TS_SECONDS, NOW - span,
+                                   NOW);
+    // handleClient() gets to the /job request only now
+    WebJob job;
+    TEST_ASSERT_TRUE(jobs.get(id, job));
+    unsigned long waitMs = millis() - pollAt;
+
+    if (c.stallAfter) {
+      TEST_ASSERT_TRUE(x.stalled);
+      TEST_ASSERT_FALSE(server.client().connected());
+      TEST_ASSERT_LESS_OR_EQUAL(c.stallAfter, server.nativeBytes);
+      TEST_ASSERT_LESS_OR_EQUAL(NATIVE_WRITE_TIMEOUT_MS + 10, waitMs);
+    } else {
+      TEST_ASSERT_FALSE(x.stalled);
+      TEST_ASSERT_TRUE(server.nativeComplete);
+      // Every chunk within CHUNKED_STALL_MS
+      TEST_ASSERT_LESS_OR_EQUAL(
+        (server.nativeChunks + 1) * CHUNKED_STALL_MS, waitMs);
+    }
+
+    snprintf(msg, sizeof(msg), "%s: %lu bytes sent, /job waits %lu ms%s",
+             c.name, (unsigned long)server.nativeBytes, waitMs,
+             x.stalled ? " (client dropped)" : "");
+    TEST_MESSAGE(msg);
+  }
+}
+
+int main(int argc, char **argv) {
+  record();
+  UNITY_BEGIN();
+  RUN_TEST(test_memory_does_not_grow_with_range);
+  RUN_TEST(test_gone_client_stops_export);
+  RUN_TEST(test_complete_export_is_terminated);
+  RUN_TEST(test_job_poll_waits_behind_export);
+  return UNITY_END();
+}
@@ -0,0 +1,205 @@
+// Retained dashboard on the mock GFX backend: CountingST7789 counts what
+// each frame pushes, and the mock panel's framebuffer shows whether an
+// incremental frame leaves exactly the picture a full redraw would.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "CountingTFT.h"
+#include "Dashboard.h"
+
+struct Reading {
+  float t;
+  float h;
+  int gas;
+  int nh3;
+  bool calling;
+};
+
+// Same card contents and thresholds as updateDisplay()
+static DashboardView makeView(const Reading &r) {
+  DashboardView view;
+  view.indicatorColor = r.calling ? ST77XX_ORANGE : ST77XX_GREEN;
+
+  bool tempAlert = r.t < 10 || r.t > 40;
+  view.cards[0] = { "TEMPERATURE", String(r.t, 1), "C",
+                    (uint16_t)(tempAlert ? ST77XX_RED : ST77XX_CYAN), tempAlert };
+  bool humAlert = r.h < 20 || r.h > 80;
+  view.cards[1] = { "HUMIDITY", String(r.h, 0), "%",
+                    (uint16_t)(humAlert ? ST77XX_RED : ST77XX_CYAN), humAlert };
+  bool gasAlert = r.gas > 1000;
+  view.cards[2] = { "GAS LEVEL", String(r.gas), "PPM",
+                    (uint16_t)(gasAlert ? ST77XX_RED : ST77XX_GREEN), gasAlert };
+  bool nh3Alert = r.nh3 > 50;
+  view.cards[3] = { "AMMONIA", String(r.nh3), "PPM",
+                    (uint16_t)(nh3Alert ? ST77XX_RED : ST77XX_GREEN), nh3Alert };
+
+  bool alert = tempAlert || humAlert || gasAlert || nh3Alert;
+  view.status.textColor = ST77XX_WHITE;
+  view.status.callDots = r.calling ? CALL_DOTS_ACTIVE : CALL_DOTS_NONE;
+  view.status.text = alert ? (r.calling ? "ALERT - CALLING" : "ALERT ACTIVE")
+                           : "ALL SYSTEMS OK";
+  view.status.bgColor = alert ? ST77XX_RED : 0x0560;
+  view.status.decor = alert ? DECOR_ALERT : DECOR_OK;
+  return view;
+}
+
+static CountingST7789 *tft;
+static Dashboard *dash;
+
+// What a from-scratch redraw of the same view puts on a fresh panel
+static void expectSameAsFullRedraw(const DashboardView &view) {
+  CountingST7789 refTft(0, 0, 0);
+  Dashboard ref(refTft);
+  ref.render(view);
+  TEST_ASSERT_TRUE(ref.lastWasFull());
+
+  const std::vector<uint16_t> &a = tft->framebuffer();
+  const std::vector<uint16_t> &b = refTft.framebuffer();
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i] != b[i]) {
+      char msg[80];
+      snprintf(msg, sizeof(msg), "pixel (%u,%u) is %04x, full redraw %04x",
+               (unsigned)(i % 240), (unsigned)(i / 240), a[i], b[i]);
+      TEST_FAIL_MESSAGE(msg);
+    }
+  }
+}
+
+static uint32_t renderCounting(const DashboardView &view) {
+  tft->resetCounters();
+  dash->render(view);
+  return tft->pixelsWritten();
+}
+
+void setUp() {
+  tft = new CountingST7789(0, 0, 0);
+  dash = new Dashboard(*tft);
+  dash->begin();
+}
+
+void tearDown() {
+  delete dash;
+  delete tft;
+}
+
+static void test_first_frame_is_full() {
+  uint32_t px = renderCounting(makeView({22.5f, 45, 300, 10, false}));
+  TEST_ASSERT_TRUE(dash->lastWasFull());
+  // Chrome alone is the whole screen
+  TEST_ASSERT_GREATER_OR_EQUAL(240 * 240, (int)px);
+  // Indicator, 4 frames, 4 values, status; the header is chrome
+  TEST_ASSERT_EQUAL(10, dash->lastRegions());
+}
+
+static void test_unchanged_frame_pushes_nothing() {
+  DashboardView view = makeView({22.5f, 45, 300, 10, false});
+  dash->render(view);
+  TEST_ASSERT_EQUAL(0, (int)renderCounting(view));
+  TEST_ASSERT_EQUAL(0, dash->lastRegions());
+  TEST_ASSERT_EQUAL(0, (int)tft->bytesWritten());
+}
+
+static void test_value_change_redraws_only_its_box() {
+  dash->render(makeView({22.5f, 45, 300, 10, false}));
+  DashboardView next = makeView({22.6f, 45, 300, 10, false});
+  uint32_t px = renderCounting(next);
+
+  TEST_ASSERT_EQUAL(1, dash->lastRegions());
+  // Four size-3 glyphs: 4 * 18 x 24
+  TEST_ASSERT_LESS_OR_EQUAL(4 * 18 * 24, (int)px);
+  expectSameAsFullRedraw(next);
+}
+
+static void test_narrower_value_is_trimmed() {
+  dash->render(makeView({22.5f, 45, 1000, 10, false}));
+  DashboardView next = makeView({22.5f, 45, 87, 10, false});
+  renderCounting(next);
+  TEST_ASSERT_EQUAL(1, dash->lastRegions());
+  expectSameAsFullRedraw(next);
+
+  next = makeView({22.5f, 45, 912, 10, false});
+  renderCounting(next);
+  expectSameAsFullRedraw(next);
+}
+
+static void test_alert_flip_redraws_card_and_status() {
+  dash->render(makeView({22.5f, 45, 300, 10, false}));
+  DashboardView next = makeView({22.5f, 45, 1450, 10, false});
+  renderCounting(next);
+
+  // Gas card frame + value, status bar
+  TEST_ASSERT_EQUAL(3, dash->lastRegions());
+  expectSameAsFullRedraw(next);
+
+  next = makeView({22.5f, 45, 1450, 10, true});
+  renderCounting(next);
+  // Indicator and status only
+  TEST_ASSERT_EQUAL(2, dash->lastRegions());
+  expectSameAsFullRedraw(next);
+}
+
+static void test_counter_includes_window_overhead() {
+  tft->resetCounters();
+  tft->fillRect(0, 0, 10, 10, 0xFFFF);
+  tft->drawFastHLine(0, 0, 5, 0);
+  TEST_ASSERT_EQUAL(105, (int)tft->pixelsWritten());
+  TEST_ASSERT_EQUAL(210 + 2 * TFT_WINDOW_OVERHEAD, (int)tft->bytesWritten());
+}
+
+// A day of readings at the 2 s display period compressed into 300 frames:
+// slow drift, occasional gas spikes and a call
+static void test_bench_incremental_vs_full() {
+  const int FRAMES = 300;
+  uint64_t fullBytes = 0, incBytes = 0;
+  CountingST7789 fullTft(0, 0, 0);
+  Dashboard full(fullTft);
+
+  Reading r = {21.0f, 40, 250, 8, false};
+  uint32_t seed = 12345;
+  DashboardView view;
+  for (int f = 0; f < FRAMES; f++) {
+    seed = seed * 1103515245 + 12345;
+    int step = (seed >> 16) % 5;
+    if (step == 0) r.t += 0.1f;
+    if (step == 1) r.h += 1;
+    if (step == 2) r.gas += ((seed >> 8) & 15) - 7;
+    if (f >= 120 && f < 160) r.gas = 1300 + f;
+    if (f == 160) r.gas = 260;
+    r.calling = f >= 125 && f < 150;
+    view = makeView(r);
+
+    // What updateDisplay() did before: clear and redraw everything
+    fullTft.resetCounters();
+    full.invalidate();
+    full.render(view);
+    fullBytes += fullTft.bytesWritten();
+
+    tft->resetCounters();
+    dash->render(view);
+    if (f > 0) incBytes += tft->bytesWritten();
+  }
+  expectSameAsFullRedraw(view);
+
+  double fullAvg = (double)fullBytes / FRAMES;
+  double incAvg = (double)incBytes / (FRAMES - 1);
+  TEST_ASSERT_LESS_THAN(fullAvg / 10, incAvg);
+
+  char msg[120];
+  snprintf(msg, sizeof(msg),
+           "SPI bytes/frame: full redraw %.0f, retained %.0f (%.1fx less)",
+           fullAvg, incAvg, fullAvg / incAvg);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_frame_is_full);
+  RUN_TEST(test_unchanged_frame_pushes_nothing);
+  RUN_TEST(test_value_change_redraws_only_its_box);
+  RUN_TEST(test_narrower_value_is_trimmed);
+  RUN_TEST(test_alert_flip_redraws_card_and_status);
+  RUN_TEST(test_counter_includes_window_overhead);
+  RUN_TEST(test_bench_incremental_vs_full);
+  return UNITY_END();
+}
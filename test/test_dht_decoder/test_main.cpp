@@ -0,0 +1,182 @@
+// DhtDecoder fed with pulse trains in the form DhtRmt hands over (level,
+// microseconds, starting with the released line), with the spread of
+// real DHT11/DHT22 parts: frame and checksum handling, the 0/1 decision
+// at the datasheet's timing limits, and the decode cost.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <math.h>
+
+#include <vector>
+
+#include "DhtDecoder.h"
+
+// DHT11, 55 %RH 23.4 C: 37 00 17 04 52
+static const DhtPulse dht11[] = {
+  {1, 24}, {0, 80}, {1, 88}, {0, 49}, {1, 28}, {0, 53}, {1, 26}, {0, 50},
+  {1, 66}, {0, 54}, {1, 72}, {0, 49}, {1, 22}, {0, 50}, {1, 71}, {0, 55},
+  {1, 73}, {0, 54}, {1, 69}, {0, 51}, {1, 24}, {0, 53}, {1, 24}, {0, 54},
+  {1, 22}, {0, 56}, {1, 28}, {0, 55}, {1, 25}, {0, 49}, {1, 23}, {0, 51},
+  {1, 22}, {0, 51}, {1, 22}, {0, 49}, {1, 23}, {0, 52}, {1, 27}, {0, 52},
+  {1, 24}, {0, 52}, {1, 68}, {0, 49}, {1, 22}, {0, 52}, {1, 69}, {0, 51},
+  {1, 69}, {0, 48}, {1, 66}, {0, 52}, {1, 24}, {0, 50}, {1, 27}, {0, 53},
+  {1, 26}, {0, 55}, {1, 23}, {0, 52}, {1, 26}, {0, 54}, {1, 68}, {0, 50},
+  {1, 25}, {0, 49}, {1, 27}, {0, 50}, {1, 28}, {0, 54}, {1, 71}, {0, 51},
+  {1, 22}, {0, 48}, {1, 74}, {0, 51}, {1, 25}, {0, 50}, {1, 23}, {0, 49},
+  {1, 67}, {0, 52}, {1, 22}, {0, 56},
+};
+
+// DHT22, 65.2 %RH -10.1 C: 02 8C 80 65 73
+static const DhtPulse dht22Negative[] = {
+  {1, 40}, {0, 84}, {1, 83}, {0, 54}, {1, 25}, {0, 56}, {1, 28}, {0, 48},
+  {1, 28}, {0, 50}, {1, 22}, {0, 55}, {1, 26}, {0, 53}, {1, 22}, {0, 49},
+  {1, 67}, {0, 49}, {1, 24}, {0, 52}, {1, 67}, {0, 52}, {1, 27}, {0, 48},
+  {1, 28}, {0, 48}, {1, 23}, {0, 51}, {1, 74}, {0, 56}, {1, 66}, {0, 50},
+  {1, 22}, {0, 56}, {1, 23}, {0, 52}, {1, 68}, {0, 54}, {1, 24}, {0, 49},
+  {1, 25}, {0, 49}, {1, 23}, {0, 51}, {1, 23}, {0, 51}, {1, 22}, {0, 52},
+  {1, 23}, {0, 56}, {1, 25}, {0, 50}, {1, 27}, {0, 49}, {1, 73}, {0, 55},
+  {1, 66}, {0, 50}, {1, 23}, {0, 52}, {1, 25}, {0, 49}, {1, 70}, {0, 51},
+  {1, 24}, {0, 52}, {1, 68}, {0, 49}, {1, 22}, {0, 52}, {1, 66}, {0, 54},
+  {1, 71}, {0, 52}, {1, 72}, {0, 55}, {1, 28}, {0, 49}, {1, 22}, {0, 55},
+  {1, 69}, {0, 48}, {1, 74}, {0, 50},
+};
+
+#define COUNT(a) (sizeof(a) / sizeof(a[0]))
+
+// A frame for data with fixed 0 / 1 high times
+static std::vector<DhtPulse> frame(const uint8_t data[5], uint16_t zeroUs,
+                                   uint16_t oneUs) {
+  std::vector<DhtPulse> p = {{1, 30}, {0, 80}, {1, 80}};
+  for (int bit = 0; bit < DHT_FRAME_BITS; bit++) {
+    p.push_back({0, 50});
+    p.push_back({1, (uint16_t)(data[bit / 8] & (0x80 >> (bit % 8))
+                                 ? oneUs : zeroUs)});
+  }
+  p.push_back({0, 50});
+  return p;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_dht11_capture() {
+  uint8_t data[5];
+  TEST_ASSERT_EQUAL(DHT_OK, dhtDecode(dht11, COUNT(dht11), data));
+  TEST_ASSERT_EQUAL_HEX8(0x37, data[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x52, data[4]);
+
+  float t, h;
+  dhtConvert(DHT_MODEL_11, data, t, h);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 23.4, t);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 55.0, h);
+}
+
+static void test_dht22_negative_capture() {
+  uint8_t data[5];
+  TEST_ASSERT_EQUAL(DHT_OK,
+                    dhtDecode(dht22Negative, COUNT(dht22Negative), data));
+
+  float t, h;
+  dhtConvert(DHT_MODEL_22, data, t, h);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, -10.1, t);
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 65.2, h);
+}
+
+// The capture may start before the sensor answers, with the line still
+// released, or right at its first low
+static void test_leading_high_is_optional() {
+  uint8_t data[5];
+  TEST_ASSERT_EQUAL(DHT_OK, dhtDecode(dht11 + 1, COUNT(dht11) - 1, data));
+  TEST_ASSERT_EQUAL_HEX8(0x17, data[2]);
+}
+
+// Datasheet limits: 0 is 26-28 us high, 1 is 70 us; parts and the RMT
+// filter stretch that to roughly 20-35 and 60-80
+static void test_bit_timing_limits() {
+  const uint8_t bytes[5] = {0xA5, 0x0F, 0xF0, 0x5A, 0xFE};
+  const uint16_t zeros[] = {1, 20, 28, 35, DHT_BIT_THRESHOLD_US};
+  const uint16_t ones[] = {DHT_BIT_THRESHOLD_US + 1, 60, 70, 80, 200};
+  uint8_t data[5];
+
+  for (uint16_t z : zeros) {
+    for (uint16_t o : ones) {
+      std::vector<DhtPulse> p = frame(bytes, z, o);
+      TEST_ASSERT_EQUAL(DHT_OK, dhtDecode(p.data(), p.size(), data));
+      TEST_ASSERT_EQUAL_MEMORY(bytes, data, 5);
+    }
+  }
+}
+
+// Sum of the four bytes modulo 256
+static void test_checksum() {
+  std::vector<DhtPulse> p(dht11, dht11 + COUNT(dht11));
+  uint8_t data[5];
+
+  // Top bit of the humidity byte read as a 1
+  p[4].us = 70;
+  TEST_ASSERT_EQUAL(DHT_CHECKSUM_ERROR, dhtDecode(p.data(), p.size(), data));
+
+  const uint8_t wraps[5] = {0xFF, 0x80, 0x7F, 0x03, 0x01};
+  p = frame(wraps, 25, 70);
+  TEST_ASSERT_EQUAL(DHT_OK, dhtDecode(p.data(), p.size(), data));
+}
+
+static void test_broken_frames() {
+  uint8_t data[5];
+  const DhtPulse idle[] = {{1, 5000}};
+  TEST_ASSERT_EQUAL(DHT_NO_RESPONSE, dhtDecode(idle, 1, data));
+  TEST_ASSERT_EQUAL(DHT_NO_RESPONSE, dhtDecode(dht11, 0, data));
+
+  // Cut by the receive idle threshold mid frame
+  TEST_ASSERT_EQUAL(DHT_FRAME_ERROR, dhtDecode(dht11, 40, data));
+  // Last data bit's high missing
+  TEST_ASSERT_EQUAL(DHT_FRAME_ERROR, dhtDecode(dht11, COUNT(dht11) - 2,
+                                               data));
+  // The trailing low is not needed
+  TEST_ASSERT_EQUAL(DHT_OK, dhtDecode(dht11, COUNT(dht11) - 1, data));
+
+  // Two highs in a row: a low pulse fell below the RMT glitch filter
+  std::vector<DhtPulse> p(dht11, dht11 + COUNT(dht11));
+  p.erase(p.begin() + 21);
+  TEST_ASSERT_EQUAL(DHT_FRAME_ERROR, dhtDecode(p.data(), p.size(), data));
+
+  // Zero-length high: RMT end-of-frame marker inside the frame
+  p.assign(dht11, dht11 + COUNT(dht11));
+  p[30].us = 0;
+  TEST_ASSERT_EQUAL(DHT_FRAME_ERROR, dhtDecode(p.data(), p.size(), data));
+}
+
+static void test_bench_decode() {
+  const int N = 200000;
+  uint8_t data[5];
+  uint32_t sink = 0;
+  float t, h;
+
+  uint64_t t0 = nativeWallNs();
+  for (int i = 0; i < N; i++) {
+    if (dhtDecode(dht11, COUNT(dht11), data) == DHT_OK) {
+      dhtConvert(DHT_MODEL_11, data, t, h);
+      sink += data[i % 5];
+    }
+  }
+  uint64_t ns = nativeWallNs() - t0;
+  TEST_ASSERT_NOT_EQUAL(0, sink);
+
+  char msg[64];
+  snprintf(msg, sizeof(msg), "decode + convert: %.1f ns/frame",
+           (double)ns / N);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dht11_capture);
+  RUN_TEST(test_dht22_negative_capture);
+  RUN_TEST(test_leading_high_is_optional);
+  RUN_TEST(test_bit_timing_limits);
+  RUN_TEST(test_checksum);
+  RUN_TEST(test_broken_frames);
+  RUN_TEST(test_bench_decode);
+  return UNITY_END();
+}
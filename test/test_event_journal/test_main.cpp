@@ -0,0 +1,226 @@
+// EventJournal on an in-memory LittleFS: records round trip through the
+// RAM ring and the segment files, segments rotate, a power loss after
+// any byte of a batch leaves a journal that recovers every complete
+// record and carries on behind it, and queries visit outside the lock.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <LittleFS.h>
+
+#include <vector>
+
+#include "EventJournal.h"
+
+static std::vector<JournalRecord> seen;
+
+static bool collect(const JournalRecord &record, void *ctx) {
+  seen.push_back(record);
+  return true;
+}
+
+static uint32_t queryAll(EventJournal &journal) {
+  seen.clear();
+  return journal.query(0, UINT32_MAX, JOURNAL_ALL_TYPES, collect, nullptr);
+}
+
+// Sequence numbers from first up, no gaps, values as appended
+static void expectSequence(uint32_t first, uint32_t count) {
+  TEST_ASSERT_EQUAL(count, (uint32_t)seen.size());
+  for (uint32_t i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL(first + i, seen[i].seq);
+    TEST_ASSERT_EQUAL((int32_t)(first + i), seen[i].value);
+  }
+}
+
+static void appendNumbered(EventJournal &journal, uint32_t from,
+                           uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    TEST_ASSERT_TRUE(journal.append(JEV_CALL_STATE, 2, 1,
+                                    (int32_t)(from + i), "0170"));
+  }
+}
+
+void setUp() {
+  nativeSetMs(1000);
+  LittleFS.nativeFormat();
+}
+
+void tearDown() {}
+
+static void test_round_trip_and_filters() {
+  EventJournal journal;
+  TEST_ASSERT_TRUE(journal.begin());
+  journal.append(JEV_BOOT, 3);
+  journal.append(JEV_ALARM_START, 0, 0, JOURNAL_REASON_GAS);
+  journal.flush();
+  journal.append(JEV_SMS_SENT, 1, 0, 0, "12345678");  // Still in RAM
+
+  TEST_ASSERT_EQUAL(3, queryAll(journal));
+  TEST_ASSERT_EQUAL(JEV_BOOT, seen[0].type);
+  TEST_ASSERT_EQUAL(3, seen[0].code);
+  TEST_ASSERT_EQUAL(JOURNAL_REASON_GAS, seen[1].value);
+  TEST_ASSERT_EQUAL(0, memcmp("12345678", seen[2].detail, 8));
+
+  seen.clear();
+  TEST_ASSERT_EQUAL(1, journal.query(0, UINT32_MAX,
+                                     JOURNAL_TYPE_BIT(JEV_SMS_SENT),
+                                     collect, nullptr));
+  // Everything has a clock on the host: a range before it matches none
+  TEST_ASSERT_EQUAL(0, journal.query(1, JOURNAL_MIN_UTC, JOURNAL_ALL_TYPES,
+                                     collect, nullptr));
+}
+
+static void test_segments_rotate() {
+  EventJournal journal;
+  journal.begin();
+  const uint32_t total = (JOURNAL_SEGMENTS + 1) * JOURNAL_SEGMENT_RECORDS + 5;
+  for (uint32_t n = 1; n <= total; n += JOURNAL_RAM_RECORDS) {
+    uint32_t count = total - n + 1 < JOURNAL_RAM_RECORDS
+                     ? total - n + 1 : JOURNAL_RAM_RECORDS;
+    appendNumbered(journal, n, count);
+    journal.flush();
+  }
+
+  JournalStats stats = journal.stats();
+  TEST_ASSERT_EQUAL(total, stats.written);
+  TEST_ASSERT_EQUAL(JOURNAL_SEGMENTS - 1,
+                    (int)(stats.lastSegment - stats.firstSegment));
+  TEST_ASSERT_EQUAL(JOURNAL_SEGMENTS, (int)LittleFS.nativeFiles().size());
+
+  // The oldest segments are gone, the rest reads back in order
+  queryAll(journal);
+  uint32_t kept = (JOURNAL_SEGMENTS - 1) * JOURNAL_SEGMENT_RECORDS + 5;
+  expectSequence(total - kept + 1, kept);
+}
+
+// Cut the power after every byte offset of a 256 byte batch write, boot
+// again and check what survived
+static void test_power_loss_at_every_byte() {
+  const uint32_t before = 20;
+  const uint32_t batch = JOURNAL_BATCH_RECORDS;
+  const long batchBytes = batch * sizeof(JournalRecord);
+
+  for (long cut = 0; cut <= batchBytes; cut++) {
+    LittleFS.nativeFormat();
+    {
+      EventJournal journal;
+      journal.begin();
+      appendNumbered(journal, 1, before);
+      journal.flush();
+
+      appendNumbered(journal, before + 1, batch);
+      LittleFS.nativeWriteBudget(cut);
+      journal.flush();
+    }
+    LittleFS.nativePowerCycle();
+
+    EventJournal journal;
+    TEST_ASSERT_TRUE(journal.begin());
+    uint32_t complete = before + cut / sizeof(JournalRecord);
+    bool torn = cut % sizeof(JournalRecord) != 0;
+    TEST_ASSERT_EQUAL(torn ? 1 : 0, (int)journal.stats().damaged);
+
+    queryAll(journal);
+    expectSequence(1, complete);
+
+    // New records follow the last complete one, never the torn bytes
+    appendNumbered(journal, complete + 1, 3);
+    journal.flush();
+    queryAll(journal);
+    expectSequence(1, complete + 3);
+    if (torn) {
+      TEST_ASSERT_EQUAL(journal.stats().firstSegment + 1,
+                        journal.stats().lastSegment);
+    }
+  }
+}
+
+// A record that reads back with a bad CRC ends the readable part of its
+// segment; later segments still count
+static void test_corrupt_record_mid_journal() {
+  {
+    EventJournal journal;
+    journal.begin();
+    appendNumbered(journal, 1, 16);
+    journal.flush();
+  }
+  std::string &segment = LittleFS.nativeFiles().begin()->second;
+  segment[5 * sizeof(JournalRecord) + 12] ^= 0x40;
+
+  EventJournal journal;
+  journal.begin();
+  TEST_ASSERT_EQUAL(1, (int)journal.stats().damaged);
+  appendNumbered(journal, 17, 2);
+  journal.flush();
+
+  queryAll(journal);
+  TEST_ASSERT_EQUAL(5 + 2, (int)seen.size());
+  TEST_ASSERT_EQUAL(5, seen[4].seq);
+  TEST_ASSERT_EQUAL(6, seen[5].seq);    // Numbering goes on after the CRC
+  TEST_ASSERT_EQUAL(17, seen[5].value);
+}
+
+// The visitor runs without the file lock: it may flush (as the writer
+// task would meanwhile) and append, and the query still sees every record
+// that existed when it started exactly once
+static EventJournal *busy;
+static uint32_t busyCalls;
+
+static bool flushWhileVisiting(const JournalRecord &record, void *ctx) {
+  seen.push_back(record);
+  if (++busyCalls % 5 == 0) {
+    busy->append(JEV_CONFIG, 0, 0, -1);
+    busy->flush();
+  }
+  return true;
+}
+
+static void test_visitor_runs_outside_the_lock() {
+  EventJournal journal;
+  journal.begin();
+  busy = &journal;
+  busyCalls = 0;
+
+  const uint32_t onFile = 3 * JOURNAL_QUERY_SLICE + 5;
+  const uint32_t inRam = JOURNAL_QUERY_SLICE + 3;
+  appendNumbered(journal, 1, onFile);
+  journal.flush();
+  appendNumbered(journal, onFile + 1, inRam);
+
+  seen.clear();
+  uint32_t rows = journal.query(0, UINT32_MAX, JOURNAL_ALL_TYPES,
+                                flushWhileVisiting, nullptr);
+  TEST_ASSERT_EQUAL(onFile + inRam, rows);
+  expectSequence(1, onFile + inRam);
+
+  // What the visitor appended is there for the next query
+  TEST_ASSERT_EQUAL(onFile + inRam + busyCalls / 5, queryAll(journal));
+}
+
+// A visitor that returns false stops the query
+static bool firstThree(const JournalRecord &record, void *ctx) {
+  seen.push_back(record);
+  return seen.size() < 3;
+}
+
+static void test_visitor_stops() {
+  EventJournal journal;
+  journal.begin();
+  appendNumbered(journal, 1, 40);
+  journal.flush();
+  seen.clear();
+  TEST_ASSERT_EQUAL(3, journal.query(0, UINT32_MAX, JOURNAL_ALL_TYPES,
+                                     firstThree, nullptr));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip_and_filters);
+  RUN_TEST(test_segments_rotate);
+  RUN_TEST(test_power_loss_at_every_byte);
+  RUN_TEST(test_corrupt_record_mid_journal);
+  RUN_TEST(test_visitor_runs_outside_the_lock);
+  RUN_TEST(test_visitor_stops);
+  return UNITY_END();
+}
@@ -0,0 +1,188 @@
+// MQ sensor curves: the compile-time tables against the same chain
+// computed with libm pow()/log10(), around the MAX_PPM knee in particular,
+// and the cost of one conversion.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <math.h>
+
+#include "GasCurve.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+// Same calibration as main.cpp
+#define ADC_VREF 3.3
+#define MQ2_RL 10.0
+#define MQ2_CLEAN_AIR_RATIO 9.83
+#define MQ2_CLEAN_AIR_MV    240
+#define MQ2_R0 (MQ2_RL * (ADC_VREF * 1000.0 - MQ2_CLEAN_AIR_MV) / \
+                MQ2_CLEAN_AIR_MV / MQ2_CLEAN_AIR_RATIO)
+#define MQ137_RL 10.0
+#define MQ137_R0 12.0
+#define GAS_MAX_PPM   5000
+#define NH3_MAX_PPM   300
+
+struct Mq2Model : Mq2CoCurve {
+  static constexpr double VC = ADC_VREF, RL = MQ2_RL, R0 = MQ2_R0;
+  static constexpr double MAX_PPM = GAS_MAX_PPM;
+};
+
+struct Mq137Model : Mq137Nh3Curve {
+  static constexpr double VC = ADC_VREF, RL = MQ137_RL, R0 = MQ137_R0;
+  static constexpr double MAX_PPM = NH3_MAX_PPM;
+};
+
+// The model before the table existed, with libm
+template <class Model>
+static double refPpm(double mv) {
+  if (mv >= Model::VC * 1000.0) return Model::MAX_PPM;
+  double v = (mv < 10 ? 10 : mv) / 1000.0;
+  double ratio = Model::RL * (Model::VC - v) / v / Model::R0;
+  double ppm = pow(10, (log10(ratio) - Model::Y0) / Model::SLOPE + Model::X0);
+  return ppm > Model::MAX_PPM ? Model::MAX_PPM : ppm;
+}
+
+// Every millivolt within 1 ppm (integer rounding) or 0.2 % of the reading
+// (linear interpolation over GAS_CURVE_STEP_MV), whichever is larger
+template <class Model>
+static void checkTable(const char *name) {
+  double worstAbs = 0, worstScore = 0;
+  int worstMv = 0;
+  for (int mv = 0; mv <= 3400; mv++) {
+    double ref = refPpm<Model>(mv);
+    double err = fabs(gasCurvePpm<Model>(mv) - ref);
+    double allowed = ref * 0.002 > 1 ? ref * 0.002 : 1;
+    if (err > worstAbs) worstAbs = err;
+    if (err / allowed > worstScore) {
+      worstScore = err / allowed;
+      worstMv = mv;
+    }
+  }
+  char msg[112];
+  snprintf(msg, sizeof(msg),
+           "%s: worst error %.2f ppm, %.0f%% of the budget at %d mV", name,
+           worstAbs, worstScore * 100, worstMv);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_OR_EQUAL(1.0, worstScore);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_constexpr_math_matches_libm() {
+  for (double x = 0.001; x < 1e6; x *= 1.37) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, log(x), gascurve::ln(x));
+  }
+  for (double x = -30; x < 30; x += 0.173) {
+    TEST_ASSERT_FLOAT_WITHIN(exp(x) * 1e-9, exp(x), gascurve::exp(x));
+  }
+}
+
+// R0 is the clean-air resistance: the clean-air output must come out at
+// the datasheet's clean-air Rs/R0
+static void test_mq2_r0_is_clean_air_resistance() {
+  double v = MQ2_CLEAN_AIR_MV / 1000.0;
+  double rs = MQ2_RL * (ADC_VREF - v) / v;
+  TEST_ASSERT_FLOAT_WITHIN(1e-9, MQ2_CLEAN_AIR_RATIO, rs / Mq2Model::R0);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 12.97, Mq2Model::R0);
+
+  // Datasheet anchor: Rs/R0 = 10^Y0 at 10^X0 ppm
+  double anchorRs = pow(10, Mq2CoCurve::Y0) * Mq2Model::R0;
+  double anchorMv = 1000.0 * ADC_VREF * MQ2_RL / (MQ2_RL + anchorRs);
+  TEST_ASSERT_INT_WITHIN(1, 200, gasCurvePpm<Mq2Model>((uint16_t)anchorMv));
+}
+
+static void test_mq2_table_accuracy() { checkTable<Mq2Model>("MQ-2"); }
+
+static void test_mq137_table_accuracy() {
+  checkTable<Mq137Model>("MQ-137");
+}
+
+// Where the curve crosses MAX_PPM the reading must rise straight into the
+// clamp; interpolating towards a clamped entry read up to 64 ppm low here
+static void test_no_dip_at_clamp_knee() {
+  int knee = 0;
+  while (refPpm<Mq2Model>(knee) < GAS_MAX_PPM) knee++;
+  for (int mv = knee - 48; mv <= knee + 48; mv++) {
+    TEST_ASSERT_INT_WITHIN(3, (int)lround(refPpm<Mq2Model>(mv)),
+                           gasCurvePpm<Mq2Model>(mv));
+  }
+  TEST_ASSERT_EQUAL(GAS_MAX_PPM, gasCurvePpm<Mq2Model>(knee));
+
+  knee = 0;
+  while (refPpm<Mq137Model>(knee) < NH3_MAX_PPM) knee++;
+  TEST_ASSERT_EQUAL(NH3_MAX_PPM, gasCurvePpm<Mq137Model>(knee));
+  TEST_ASSERT_INT_WITHIN(1, (int)lround(refPpm<Mq137Model>(knee - 1)),
+                         gasCurvePpm<Mq137Model>(knee - 1));
+}
+
+static void test_monotonic_and_saturated() {
+  uint16_t prevGas = 0, prevNh3 = 0;
+  for (uint32_t mv = 0; mv <= 65535; mv++) {
+    uint16_t gas = gasCurvePpm<Mq2Model>(mv);
+    uint16_t nh3 = gasCurvePpm<Mq137Model>(mv);
+    TEST_ASSERT_GREATER_OR_EQUAL(prevGas, gas);
+    TEST_ASSERT_GREATER_OR_EQUAL(prevNh3, nh3);
+    TEST_ASSERT_LESS_OR_EQUAL(GAS_MAX_PPM, gas);
+    TEST_ASSERT_LESS_OR_EQUAL(NH3_MAX_PPM, nh3);
+    prevGas = gas;
+    prevNh3 = nh3;
+  }
+  TEST_ASSERT_EQUAL(GAS_MAX_PPM, gasCurvePpm<Mq2Model>(3300));
+  TEST_ASSERT_EQUAL(NH3_MAX_PPM, gasCurvePpm<Mq137Model>(3300));
+}
+
+static uint64_t ticks() {
+#ifdef HAVE_TSC
+  return __rdtsc();
+#else
+  return nativeWallNs();
+#endif
+}
+
+static void test_bench_lookup_vs_libm() {
+  const int ROUNDS = 200;
+  volatile uint32_t sink = 0;
+  volatile double dsink = 0;
+
+  uint64_t t0 = ticks();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (uint16_t mv = 0; mv < 3300; mv++) sink += gasCurvePpm<Mq2Model>(mv);
+  }
+  uint64_t table = ticks() - t0;
+
+  t0 = ticks();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (uint16_t mv = 0; mv < 3300; mv++) dsink += refPpm<Mq2Model>(mv);
+  }
+  uint64_t libm = ticks() - t0;
+
+  const double n = ROUNDS * 3300.0;
+  char msg[120];
+  snprintf(msg, sizeof(msg), "per conversion: table %.1f, pow/log10 %.1f %s",
+           table / n, libm / n,
+#ifdef HAVE_TSC
+           "TSC cycles"
+#else
+           "ns"
+#endif
+  );
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(libm, table);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_constexpr_math_matches_libm);
+  RUN_TEST(test_mq2_r0_is_clean_air_resistance);
+  RUN_TEST(test_mq2_table_accuracy);
+  RUN_TEST(test_mq137_table_accuracy);
+  RUN_TEST(test_no_dip_at_clamp_knee);
+  RUN_TEST(test_monotonic_and_saturated);
+  RUN_TEST(test_bench_lookup_vs_libm);
+  return UNITY_END();
+}
@@ -0,0 +1,162 @@
+// TinyGsmMatcher against the String::endsWith() chain it replaced in the
+// A76xx waitResponse(): a recorded modem transcript must produce the same
+// hits at the same byte offsets, and the benchmark reports the per-byte
+// cost of both.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "TinyGsmMatcher.h"
+
+#define NL "\r\n"
+
+static const char OK_[] = "OK" NL;
+static const char ERROR_[] = "ERROR" NL;
+static const char CME_[] = NL "+CME ERROR:";
+static const char CMS_[] = NL "+CMS ERROR:";
+static const char CIPRXGET_[] = NL "+CIPRXGET:";
+static const char RECEIVE_[] = NL "+RECEIVE:";
+static const char IPCLOSE_[] = "+IPCLOSE:";
+static const char CIPEVENT_[] = "+CIPEVENT:";
+
+static const char *const patterns[] = {
+  OK_, ERROR_, CME_, CMS_, nullptr,
+  CIPRXGET_, RECEIVE_, IPCLOSE_, CIPEVENT_
+};
+#define PATTERN_COUNT 9
+
+// Socket session with a SMS send and unsolicited traffic mixed in, as
+// captured from an A7670 at 115200 baud
+static const char transcript[] =
+  "AT" NL NL "OK" NL
+  "AT+CSQ" NL NL "+CSQ: 21,99" NL NL "OK" NL
+  "AT+CREG?" NL NL "+CREG: 0,1" NL NL "OK" NL
+  "AT+NETOPEN" NL NL "OK" NL NL "+NETOPEN: 0" NL
+  "AT+CIPOPEN=0,\"TCP\",\"example.com\",80" NL NL "OK" NL
+  NL "+CIPOPEN: 0,0" NL
+  "AT+CIPSEND=0,18" NL NL ">GET / HTTP/1.0" NL NL NL "OK" NL
+  NL "+CIPSEND: 0,18,18" NL
+  NL "+CIPRXGET: 1,0" NL
+  "AT+CIPRXGET=4,0" NL NL "+CIPRXGET: 4,0,512" NL NL "OK" NL
+  "AT+CIPRXGET=2,0,512" NL NL "+CIPRXGET: 2,0,512,0" NL
+  "HTTP/1.0 200 OK" NL "Content-Type: text/html" NL NL
+  "<html><body>OK ERROR +RECEIVE +IPCLOSE</body></html>" NL NL "OK" NL
+  NL "+RECEIVE: 0,64" NL
+  "AT+CPIN?" NL NL "+CME ERROR: 10" NL
+  "AT+CMGS=\"+491701234567\"" NL NL "> " "Fire alarm" "\x1a" NL
+  NL "+CMS ERROR: 500" NL
+  "AT+CMGS=\"+491701234567\"" NL NL "> " "Fire alarm" "\x1a" NL
+  NL "+CMGS: 12" NL NL "OK" NL
+  "+IPCLOSE: 0,1" NL
+  "AT+CIPCLOSE=0" NL NL "ERROR" NL
+  "+CIPEVENT: NETWORK CLOSED UNEXPECTEDLY" NL
+  "AT+NETCLOSE" NL NL "OK" NL;
+
+struct Hit {
+  size_t offset;
+  int8_t index;
+};
+
+// What the A76xx drivers did before the matcher
+static std::vector<Hit> replayEndsWith(const char *data, size_t len) {
+  std::vector<Hit> hits;
+  String buffer;
+  for (size_t i = 0; i < len; i++) {
+    buffer += data[i];
+    for (int8_t p = 0; p < PATTERN_COUNT; p++) {
+      if (patterns[p] && buffer.endsWith(patterns[p])) {
+        hits.push_back(Hit{i, p});
+        buffer = "";
+        break;
+      }
+    }
+  }
+  return hits;
+}
+
+static std::vector<Hit> replayMatcher(const char *data, size_t len) {
+  std::vector<Hit> hits;
+  TinyGsmMatcher<PATTERN_COUNT> match;
+  for (uint8_t p = 0; p < PATTERN_COUNT; p++) match.add(patterns[p]);
+  for (size_t i = 0; i < len; i++) {
+    int8_t hit = match.push(data[i]);
+    if (hit >= 0) {
+      hits.push_back(Hit{i, hit});
+      match.reset();
+    }
+  }
+  return hits;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_same_hits_as_endswith() {
+  std::vector<Hit> a = replayEndsWith(transcript, sizeof(transcript) - 1);
+  std::vector<Hit> b = replayMatcher(transcript, sizeof(transcript) - 1);
+
+  TEST_ASSERT_GREATER_THAN(15, (int)a.size());
+  TEST_ASSERT_EQUAL(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    TEST_ASSERT_EQUAL(a[i].offset, b[i].offset);
+    TEST_ASSERT_EQUAL(a[i].index, b[i].index);
+  }
+}
+
+static void test_every_pattern_seen() {
+  std::vector<Hit> hits = replayMatcher(transcript, sizeof(transcript) - 1);
+  bool seen[PATTERN_COUNT] = {};
+  for (const Hit &h : hits) seen[h.index] = true;
+  for (int p = 0; p < PATTERN_COUNT; p++) {
+    TEST_ASSERT_EQUAL(patterns[p] != nullptr, seen[p]);
+  }
+}
+
+static void test_pattern_longer_than_window() {
+  std::string longPattern(100, 'x');
+  longPattern += "END";
+  TinyGsmMatcher<1, 16> match;
+  match.add(longPattern.c_str());
+
+  int8_t hit = -1;
+  for (char c : std::string(200, 'x') + "END") hit = match.push(c);
+  TEST_ASSERT_EQUAL(0, hit);
+
+  // Only the last 16 bytes are compared
+  match.reset();
+  for (char c : std::string("yyyy") + std::string(13, 'x') + "END") {
+    hit = match.push(c);
+  }
+  TEST_ASSERT_EQUAL(0, hit);
+}
+
+static void test_bench_transcript() {
+  const int ROUNDS = 2000;
+  const size_t len = sizeof(transcript) - 1;
+  size_t sink = 0;
+
+  uint64_t t0 = nativeWallNs();
+  for (int r = 0; r < ROUNDS; r++) sink += replayEndsWith(transcript, len).size();
+  uint64_t t1 = nativeWallNs();
+  for (int r = 0; r < ROUNDS; r++) sink += replayMatcher(transcript, len).size();
+  uint64_t t2 = nativeWallNs();
+
+  TEST_ASSERT_GREATER_THAN(0, (int)sink);
+  double bytes = (double)ROUNDS * len;
+  char msg[96];
+  snprintf(msg, sizeof(msg), "endsWith: %.1f ns/byte, matcher: %.1f ns/byte",
+           (t1 - t0) / bytes, (t2 - t1) / bytes);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_same_hits_as_endswith);
+  RUN_TEST(test_every_pattern_seen);
+  RUN_TEST(test_pattern_longer_than_window);
+  RUN_TEST(test_bench_transcript);
+  return UNITY_END();
+}
@@ -0,0 +1,271 @@
+// ModemAT against a scripted fake modem: result codes, URC routing, the
+// '>' payload prompt and resynchronisation after a timeout, plus the
+// per-command cost of the engine itself.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <deque>
+#include <string>
+
+#include "ModemAT.h"
+
+// Plays the modem: every complete line the engine writes is checked
+// against the script, and the scripted answer is queued for reading.
+class FakeModem : public Stream {
+ public:
+  struct Step {
+    std::string cmd;
+    std::string reply;
+  };
+
+  void expect(const char *cmd, const char *reply) {
+    _script.push_back(Step{cmd, reply});
+  }
+  void send(const char *bytes) { _rx += bytes; }
+
+  int available() override { return (int)(_rx.size() - _rxPos); }
+  int read() override {
+    if (_rxPos >= _rx.size()) return -1;
+    int c = (uint8_t)_rx[_rxPos++];
+    if (_rxPos == _rx.size()) {
+      _rx.clear();
+      _rxPos = 0;
+    }
+    return c;
+  }
+  int peek() override {
+    return _rxPos < _rx.size() ? (uint8_t)_rx[_rxPos] : -1;
+  }
+
+  size_t write(uint8_t c) override {
+    _tx += (char)c;
+    if (c == '\n' || c == 26 || c == 27) {
+      std::string line = _tx;
+      while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+        line.pop_back();
+      }
+      _written.push_back(line);
+      _tx.clear();
+      if (!_script.empty() && _script.front().cmd == line) {
+        _rx += _script.front().reply;
+        _script.pop_front();
+      }
+    }
+    return 1;
+  }
+  using Print::write;
+
+  std::deque<std::string> &written() { return _written; }
+  bool scriptDone() const { return _script.empty(); }
+
+ private:
+  std::deque<Step> _script;
+  std::deque<std::string> _written;
+  std::string _rx;
+  size_t _rxPos = 0;
+  std::string _tx;
+};
+
+static FakeModem *fake;
+static ModemAT *at;
+
+static String lastUrc;
+static int urcCalls;
+
+static void onRing(const String &line) {
+  lastUrc = line;
+  urcCalls++;
+}
+
+struct Outcome {
+  int calls;
+  AtResult result;
+};
+
+static void record(const AtResult &result, void *ctx) {
+  Outcome *out = static_cast<Outcome *>(ctx);
+  out->calls++;
+  out->result = result;
+}
+
+static void run(uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    at->dispatch();
+    nativeAdvanceMs(1);
+  }
+  at->dispatch();
+}
+
+void setUp() {
+  nativeSetMs(1000);
+  fake = new FakeModem();
+  at = new ModemAT();
+  at->begin(*fake);
+  lastUrc = "";
+  urcCalls = 0;
+}
+
+void tearDown() {
+  delete at;
+  delete fake;
+}
+
+static void test_ok_collects_response_without_echo() {
+  fake->expect("AT+CSQ", "AT+CSQ\r\n+CSQ: 21,99\r\n\r\nOK\r\n");
+  Outcome out = {};
+  at->enqueue("AT+CSQ", 1000, record, &out);
+  run(5);
+
+  TEST_ASSERT_EQUAL(1, out.calls);
+  TEST_ASSERT_EQUAL(AT_OK, out.result.status);
+  TEST_ASSERT_EQUAL_STRING("+CSQ: 21,99", out.result.response.c_str());
+}
+
+static void test_error_codes() {
+  fake->expect("AT+CPIN?", "+CME ERROR: 10\r\n");
+  fake->expect("AT+CMGS=\"1\"", "ERROR\r\n");
+  Outcome cme = {}, err = {};
+  at->enqueue("AT+CPIN?", 1000, record, &cme);
+  at->enqueue("AT+CMGS=\"1\"", 1000, record, &err);
+  run(5);
+
+  TEST_ASSERT_EQUAL(AT_CME_ERROR, cme.result.status);
+  TEST_ASSERT_EQUAL_STRING("+CME ERROR: 10", cme.result.response.c_str());
+  TEST_ASSERT_EQUAL(AT_ERROR, err.result.status);
+}
+
+static void test_urc_in_flight_goes_to_handler() {
+  at->onUrc("RING", onRing);
+  at->onUrc("+CLCC:", onRing);
+  fake->expect("AT+CREG?", "RING\r\n+CREG: 0,1\r\nOK\r\n");
+  Outcome out = {};
+  at->enqueue("AT+CREG?", 1000, record, &out);
+  run(5);
+
+  TEST_ASSERT_EQUAL(1, urcCalls);
+  TEST_ASSERT_EQUAL_STRING("RING", lastUrc.c_str());
+  TEST_ASSERT_EQUAL_STRING("+CREG: 0,1", out.result.response.c_str());
+
+  // Solicited by AT+CLCC, so part of the response, not a URC
+  fake->expect("AT+CLCC", "+CLCC: 1,0,3,0,0,\"123\",129\r\nOK\r\n");
+  at->enqueue("AT+CLCC", 1000, record, &out);
+  run(5);
+  TEST_ASSERT_EQUAL(1, urcCalls);
+  TEST_ASSERT_EQUAL_STRING("+CLCC: 1,0,3,0,0,\"123\",129",
+                           out.result.response.c_str());
+}
+
+static void test_payload_after_prompt() {
+  fake->expect("AT+CMGS=\"+4917\"", "> ");
+  fake->expect("Hello\x1a", "+CMGS: 7\r\n\r\nOK\r\n");
+  Outcome out = {};
+  at->enqueue("AT+CMGS=\"+4917\"", 5000, record, &out, "Hello");
+  run(5);
+
+  TEST_ASSERT_EQUAL(AT_OK, out.result.status);
+  TEST_ASSERT_EQUAL_STRING("+CMGS: 7", out.result.response.c_str());
+  TEST_ASSERT_TRUE(fake->scriptDone());
+}
+
+// The regression: a late OK to a timed out command used to complete the
+// next one before the modem had even seen it
+static void test_late_ok_after_timeout_is_discarded() {
+  Outcome slow = {}, next = {};
+  at->enqueue("AT+COPS=?", 100, record, &slow);
+  at->enqueue("AT+CSQ", 1000, record, &next);
+  run(100);
+  TEST_ASSERT_EQUAL(AT_TIMEOUT, slow.result.status);
+
+  // Still draining: the next command must not have been written
+  TEST_ASSERT_EQUAL(1, (int)fake->written().size());
+
+  fake->send("+COPS: (2,\"Net\",\"Net\",\"26201\",7)\r\n\r\nOK\r\n");
+  run(AT_RESYNC_QUIET_MS / 2);
+  TEST_ASSERT_EQUAL(0, next.calls);
+  TEST_ASSERT_EQUAL(1, (int)fake->written().size());
+  TEST_ASSERT_EQUAL(2, (int)at->discardedCount());
+
+  fake->expect("AT+CSQ", "+CSQ: 18,99\r\nOK\r\n");
+  run(AT_RESYNC_QUIET_MS);
+  TEST_ASSERT_EQUAL(2, (int)fake->written().size());
+  TEST_ASSERT_EQUAL_STRING("AT+CSQ", fake->written().back().c_str());
+  TEST_ASSERT_EQUAL(1, next.calls);
+  TEST_ASSERT_EQUAL(AT_OK, next.result.status);
+  TEST_ASSERT_EQUAL_STRING("+CSQ: 18,99", next.result.response.c_str());
+}
+
+static void test_late_cms_error_does_not_fail_next() {
+  Outcome sms = {}, next = {};
+  fake->expect("AT+CMGS=\"1\"", "> ");
+  at->enqueue("AT+CMGS=\"1\"", 200, record, &sms, "text");
+  at->enqueue("AT", 1000, record, &next);
+  run(200);
+  TEST_ASSERT_EQUAL(AT_TIMEOUT, sms.result.status);
+
+  fake->send("+CMS ERROR: 500\r\n");
+  fake->expect("AT", "OK\r\n");
+  run(AT_RESYNC_QUIET_MS + 10);
+  TEST_ASSERT_EQUAL(AT_OK, next.result.status);
+  TEST_ASSERT_EQUAL(1, (int)at->discardedCount());
+}
+
+static void test_urcs_still_delivered_while_draining() {
+  at->onUrc("RING", onRing);
+  Outcome slow = {};
+  at->enqueue("AT+CMGL", 50, record, &slow);
+  run(50);
+  fake->send("RING\r\nOK\r\n");
+  run(5);
+
+  TEST_ASSERT_EQUAL(1, urcCalls);
+  TEST_ASSERT_EQUAL(1, (int)at->discardedCount());
+}
+
+static void test_missed_prompt_is_cancelled() {
+  Outcome out = {};
+  at->enqueue("AT+CMGS=\"1\"", 100, record, &out, "text");
+  run(100);
+
+  TEST_ASSERT_EQUAL(AT_TIMEOUT, out.result.status);
+  TEST_ASSERT_EQUAL(2, (int)fake->written().size());
+  TEST_ASSERT_EQUAL_STRING("\x1b", fake->written().back().c_str());
+}
+
+static void test_bench_command_round_trip() {
+  const int N = 20000;
+  Outcome out = {};
+  uint64_t worst = 0;
+  uint64_t start = nativeWallNs();
+  for (int i = 0; i < N; i++) {
+    fake->expect("AT+CSQ", "AT+CSQ\r\n+CSQ: 21,99\r\n\r\nOK\r\n");
+    uint64_t t0 = nativeWallNs();
+    at->enqueue("AT+CSQ", 1000, record, &out);
+    at->dispatch();   // write, read the answer, deliver
+    uint64_t t = nativeWallNs() - t0;
+    if (t > worst) worst = t;
+    fake->written().clear();
+  }
+  uint64_t total = nativeWallNs() - start;
+
+  TEST_ASSERT_EQUAL(N, out.calls);
+  TEST_ASSERT_EQUAL(N, (int)at->completedCount());
+  char msg[96];
+  snprintf(msg, sizeof(msg), "AT round trip: %.2f us avg, %.2f us worst",
+           total / 1000.0 / N, worst / 1000.0);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ok_collects_response_without_echo);
+  RUN_TEST(test_error_codes);
+  RUN_TEST(test_urc_in_flight_goes_to_handler);
+  RUN_TEST(test_payload_after_prompt);
+  RUN_TEST(test_late_ok_after_timeout_is_discarded);
+  RUN_TEST(test_late_cms_error_does_not_fail_next);
+  RUN_TEST(test_urcs_still_delivered_while_draining);
+  RUN_TEST(test_missed_prompt_is_cancelled);
+  RUN_TEST(test_bench_command_round_trip);
+  return UNITY_END();
+}
@@ -0,0 +1,163 @@
+// ModemConfig against a fake modem that keeps settings the way the
+// SIM7600 does: most survive a power cycle once stored with AT&W,
+// +CLCC=1 cannot be read back and is lost on every power cycle.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ModemAT.h"
+#include "ModemConfig.h"
+
+class ConfigModem : public Stream {
+ public:
+  std::map<std::string, std::string> live;
+  std::map<std::string, std::string> profile;
+  bool clcc = false;
+  std::vector<std::string> lines;
+  int profileWrites = 0;
+
+  void powerCycle() {
+    live = profile;
+    clcc = false;
+  }
+
+  int available() override { return (int)(_rx.size() - _rxPos); }
+  int read() override {
+    return _rxPos < _rx.size() ? (uint8_t)_rx[_rxPos++] : -1;
+  }
+  int peek() override {
+    return _rxPos < _rx.size() ? (uint8_t)_rx[_rxPos] : -1;
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == '\n') {
+      lines.push_back(_tx);
+      _rx += answer(_tx);
+      _tx.clear();
+    } else if (c != '\r') {
+      _tx += (char)c;
+    }
+    return 1;
+  }
+  using Print::write;
+
+ private:
+  // AT+A=1;+B? runs left to right and stops at the first error
+  std::string answer(const std::string &line) {
+    if (line.compare(0, 2, "AT") != 0) return "\r\nERROR\r\n";
+    std::string out;
+    size_t pos = 2;
+    while (pos <= line.size()) {
+      size_t end = line.find(';', pos);
+      if (end == std::string::npos) end = line.size();
+      std::string cmd = line.substr(pos, end - pos);
+      pos = end + 1;
+
+      if (cmd == "&W") {
+        profile = live;
+        profileWrites++;
+      } else if (cmd == "+CLCC=1") {
+        clcc = true;
+      } else if (cmd.size() > 1 && cmd.back() == '?' && cmd != "+CLCC?") {
+        std::string name = cmd.substr(0, cmd.size() - 1);
+        out += "\r\n" + name + ": " + live[name] + "\r\n";
+      } else if (cmd.find('=') != std::string::npos && cmd[0] == '+' &&
+                 cmd.compare(0, 7, "+CVOLTE") != 0) {
+        live[cmd.substr(0, cmd.find('='))] = cmd.substr(cmd.find('=') + 1);
+      } else {
+        return out + "\r\nERROR\r\n";
+      }
+    }
+    return out + "\r\nOK\r\n";
+  }
+
+  std::string _rx;
+  size_t _rxPos = 0;
+  std::string _tx;
+};
+
+// The kinds of entry main.cpp's table has
+static const ModemSetting settings[] = {
+  { "+CFUN=1", "+CFUN?", "+CFUN: 1", 10000, MODEM_SET_SOLO },
+  { "+CRC=1", "+CRC?", "+CRC: 1", 500, 0 },
+  { "+CLIP=1", "+CLIP?", "+CLIP: 1", 500, 0 },
+  { "+CMGF=0", "+CMGF?", "+CMGF: 0", 500, 0 },
+  { "+CREG=2", "+CREG?", "+CREG: 2", 500, 0 },
+  { "+CLCC=1", nullptr, nullptr, 500, MODEM_SET_ALWAYS },
+  { "+CVOLTE=1", nullptr, nullptr, 1000, MODEM_SET_SOLO | MODEM_SET_OPTIONAL },
+};
+#define SETTING_COUNT (sizeof(settings) / sizeof(settings[0]))
+
+static ConfigModem *uart;
+static ModemAT *at;
+static ModemConfig *config;
+
+void setUp() {
+  nativeSetMs(1000);
+  uart = new ConfigModem();
+  at = new ModemAT();
+  at->begin(*uart);
+  config = new ModemConfig(*at, settings, SETTING_COUNT);
+}
+
+void tearDown() {
+  delete config;
+  delete at;
+  delete uart;
+}
+
+static void test_cold_boot_applies_and_stores() {
+  TEST_ASSERT_TRUE(config->run(0));
+  const ModemInitReport &r = config->report();
+  TEST_ASSERT_FALSE(r.warm);
+  TEST_ASSERT_EQUAL(SETTING_COUNT - 1, r.applied);   // +CVOLTE unsupported
+  TEST_ASSERT_EQUAL(0, r.failed);
+  TEST_ASSERT_TRUE(uart->clcc);
+  TEST_ASSERT_EQUAL(1, uart->profileWrites);
+}
+
+// A warm boot trusts the stored profile, but +CLCC=1 was never in it
+static void test_warm_boot_reapplies_clcc() {
+  config->run(0);
+  uint32_t stored = config->fingerprint();
+  uart->powerCycle();
+  uart->lines.clear();
+  TEST_ASSERT_FALSE(uart->clcc);
+
+  TEST_ASSERT_TRUE(config->run(stored));
+  const ModemInitReport &r = config->report();
+  TEST_ASSERT_TRUE(r.warm);
+  TEST_ASSERT_TRUE(r.verified);
+  TEST_ASSERT_TRUE(uart->clcc);
+  TEST_ASSERT_EQUAL(1, r.applied);
+  // One query batch, +CLCC=1, and no profile rewrite for it
+  TEST_ASSERT_EQUAL(2, r.roundTrips);
+  TEST_ASSERT_EQUAL(1, uart->profileWrites);
+  TEST_ASSERT_EQUAL_STRING("AT+CLCC=1", uart->lines.back().c_str());
+}
+
+// A setting that reads back differently is written and stored again
+static void test_warm_boot_repairs_drifted_setting() {
+  config->run(0);
+  uint32_t stored = config->fingerprint();
+  uart->profile["+CMGF"] = "1";
+  uart->powerCycle();
+
+  TEST_ASSERT_TRUE(config->run(stored));
+  TEST_ASSERT_EQUAL_STRING("0", uart->live["+CMGF"].c_str());
+  TEST_ASSERT_EQUAL(2, config->report().applied);     // +CMGF and +CLCC
+  TEST_ASSERT_EQUAL(2, uart->profileWrites);
+  TEST_ASSERT_TRUE(uart->clcc);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_cold_boot_applies_and_stores);
+  RUN_TEST(test_warm_boot_reapplies_clcc);
+  RUN_TEST(test_warm_boot_repairs_drifted_setting);
+  return UNITY_END();
+}
@@ -0,0 +1,190 @@
+// NetClock on virtual time: CCLK parsing, drift tracking across millis()
+// wraps, and the daily report firing exactly once per day however the
+// loop stalls or the network steps the clock.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "NetClock.h"
+
+// Same schedule as main.cpp
+#define DAILY_REPORT_HOUR   8
+#define DAILY_REPORT_MINUTE 0
+
+#define DAY_MS    (86400ULL * 1000ULL)
+#define TZ_QUARTERS 8                   // +02:00
+
+static std::vector<time_t> runs;
+
+static void onReport(time_t local) { runs.push_back(local); }
+
+// CCLK answer for a local time, as the modem prints it
+static const char *cclk(time_t localSec, int quarters) {
+  static char buf[48];
+  struct tm tm;
+  gmtime_r(&localSec, &tm);
+  snprintf(buf, sizeof(buf), "+CCLK: \"%02d/%02d/%02d,%02d:%02d:%02d%c%02d\"",
+           tm.tm_year % 100, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+           tm.tm_min, tm.tm_sec, quarters < 0 ? '-' : '+', abs(quarters));
+  return buf;
+}
+
+static time_t localAt(int y, int mo, int d, int h, int mi, int s) {
+  return (time_t)daysFromCivil(y, mo, d) * 86400 + h * 3600 + mi * 60 + s;
+}
+
+// millis() as the device returns it
+static unsigned long millis32(uint64_t ms) { return (uint32_t)ms; }
+
+void setUp() { runs.clear(); }
+void tearDown() {}
+
+static void test_days_from_civil() {
+  TEST_ASSERT_EQUAL(0, daysFromCivil(1970, 1, 1));
+  TEST_ASSERT_EQUAL(-1, daysFromCivil(1969, 12, 31));
+  TEST_ASSERT_EQUAL(11017, daysFromCivil(2000, 3, 1));
+  TEST_ASSERT_EQUAL(19782, daysFromCivil(2024, 2, 29));
+  TEST_ASSERT_EQUAL(20742, daysFromCivil(2026, 10, 16));
+}
+
+static void test_cclk_sync() {
+  NetClock clock;
+  TEST_ASSERT_TRUE(clock.syncDue(0));
+
+  // Not registered yet: the modem still reports its reset date
+  TEST_ASSERT_FALSE(clock.syncFromCclk("+CCLK: \"80/01/06,00:00:12+00\"",
+                                       1000));
+  TEST_ASSERT_FALSE(clock.valid());
+  TEST_ASSERT_EQUAL(1, (int)clock.stats().failures);
+  TEST_ASSERT_FALSE(clock.syncDue(1000 + NETCLOCK_RETRY_INTERVAL - 1));
+  TEST_ASSERT_TRUE(clock.syncDue(1000 + NETCLOCK_RETRY_INTERVAL));
+
+  TEST_ASSERT_TRUE(clock.syncFromCclk("+CCLK: \"26/10/16,08:30:15+08\"",
+                                      5000));
+  TEST_ASSERT_TRUE(clock.valid());
+  TEST_ASSERT_EQUAL(120, clock.tzMinutes());
+  TEST_ASSERT_EQUAL(1792139415 - 7200, (long)clock.utc(5000));
+  TEST_ASSERT_EQUAL(1792139415 + 3600, (long)clock.local(5000 + 3600000));
+  TEST_ASSERT_FALSE(clock.syncDue(5000 + NETCLOCK_SYNC_INTERVAL - 1));
+  TEST_ASSERT_TRUE(clock.syncDue(5000 + NETCLOCK_SYNC_INTERVAL));
+
+  clock.requestSync();
+  TEST_ASSERT_TRUE(clock.syncDue(6000));
+}
+
+// 120 days of a loop ticking every ~2 s with random stalls for calls and
+// SMS, a three-day hang, a network whose clock runs 80 ppm faster than
+// millis() and two millis() wraps. Every local day in which the loop got
+// to run at or after 08:00 sends exactly one report, the others none.
+static void test_once_per_day_across_stalls() {
+  const int DAYS = 120;
+  const double NET_RATE = 1.0 + 80e-6;
+  const time_t start = localAt(2026, 10, 16, 7, 59, 40);
+  const uint64_t msOffset = 0xFFFFFFFFULL - 30ULL * 60 * 1000;  // Wraps early
+
+  NetClock clock;
+  int job = clock.addDaily(DAILY_REPORT_HOUR, DAILY_REPORT_MINUTE, onReport);
+  TEST_ASSERT_EQUAL(0, job);
+  TEST_ASSERT_EQUAL(0, (long)clock.nextDue(job));
+
+  std::mt19937 rng(16);
+  std::uniform_int_distribution<int> jitter(1500, 2500);
+  std::uniform_real_distribution<double> u(0, 1);
+
+  const time_t reportTime = (time_t)DAILY_REPORT_HOUR * 3600 +
+                            DAILY_REPORT_MINUTE * 60;
+  // Local days that had at least one tick at or after the report time
+  std::set<time_t> daysTicked;
+  auto networkLocal = [&](uint64_t ms) {
+    return start + (time_t)((ms - msOffset) * NET_RATE / 1000.0);
+  };
+
+  uint64_t ms = msOffset;
+  const uint64_t end = msOffset + DAYS * DAY_MS;
+  bool hung = false;
+  while (ms < end) {
+    unsigned long now = millis32(ms);
+    if (clock.syncDue(now)) {
+      TEST_ASSERT_TRUE(clock.syncFromCclk(
+        cclk(networkLocal(ms), TZ_QUARTERS), now));
+    }
+    clock.tick(now);
+
+    time_t local = clock.local(now);
+    if (local >= start + 20) {
+      daysTicked.insert((local - reportTime) / 86400);
+    }
+
+    uint64_t step = jitter(rng);
+    double r = u(rng);
+    if (r < 0.002) step = 60000 + (uint64_t)(u(rng) * 30 * 60000);  // Call
+    else if (r < 0.01) step = 17000;                            // Blocking SMS
+    if (!hung && ms - msOffset > 40 * DAY_MS) {
+      step = 3 * DAY_MS + 5 * 3600000ULL;                       // Watchdog off
+      hung = true;
+    }
+    ms += step;
+  }
+
+  // One run per day it could run on, never two on the same day
+  std::set<time_t> daysRun;
+  for (time_t local : runs) {
+    TEST_ASSERT_TRUE(daysRun.insert((local - reportTime) / 86400).second);
+  }
+  TEST_ASSERT_TRUE(daysRun == daysTicked);
+  TEST_ASSERT_EQUAL((int)daysTicked.size(), (int)runs.size());
+  TEST_ASSERT_LESS_THAN(DAYS, (int)runs.size());      // The hang cost days
+
+  // Still on time after 120 days of drift
+  unsigned long now = millis32(end);
+  TEST_ASSERT_INT_WITHIN(1, (long)networkLocal(end), (long)clock.local(now));
+  TEST_ASSERT_INT_WITHIN(3, 80, clock.stats().driftPpm);
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "%d days, %u runs, %u syncs, drift %ld ppm",
+           DAYS, (unsigned)runs.size(), (unsigned)clock.stats().syncs,
+           (long)clock.stats().driftPpm);
+  TEST_MESSAGE(msg);
+}
+
+// The operator setting the time back must not repeat the report, setting
+// it forward past 08:00 must send it once
+static void test_clock_steps() {
+  NetClock clock;
+  clock.addDaily(DAILY_REPORT_HOUR, DAILY_REPORT_MINUTE, onReport);
+
+  clock.syncFromCclk(cclk(localAt(2026, 10, 16, 7, 59, 50), 8), 0);
+  clock.tick(20000);
+  TEST_ASSERT_EQUAL(1, (int)runs.size());
+
+  clock.syncFromCclk(cclk(localAt(2026, 10, 16, 7, 0, 0), 8), 30000);
+  for (unsigned long t = 30000; t < 30000 + 2 * 3600000UL; t += 2000) {
+    clock.tick(t);
+  }
+  TEST_ASSERT_EQUAL(1, (int)runs.size());
+
+  clock.syncFromCclk(cclk(localAt(2026, 10, 17, 6, 0, 0), 8), 8000000);
+  clock.tick(8000000);
+  clock.syncFromCclk(cclk(localAt(2026, 10, 17, 9, 30, 0), 8), 8002000);
+  clock.tick(8002000);
+  clock.tick(8004000);
+  TEST_ASSERT_EQUAL(2, (int)runs.size());
+  TEST_ASSERT_EQUAL((long)localAt(2026, 10, 17, 9, 30, 0), (long)runs[1]);
+
+  // Next one tomorrow, not again today
+  TEST_ASSERT_EQUAL((long)localAt(2026, 10, 18, 8, 0, 0),
+                    (long)clock.nextDue(0));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_days_from_civil);
+  RUN_TEST(test_cclk_sync);
+  RUN_TEST(test_once_per_day_across_stalls);
+  RUN_TEST(test_clock_steps);
+  return UNITY_END();
+}
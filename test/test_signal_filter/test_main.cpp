@@ -0,0 +1,218 @@
+// Gas channel filters against brute-force references, plus the noise and
+// step response of the median -> moving average chain the firmware runs
+// at SENSOR_SAMPLE_HZ.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "SignalFilter.h"
+
+// Same chain as main.cpp
+#define GAS_MEDIAN_SIZE 5
+#define GAS_FILTER_SIZE 25    // 0.5 s at 50 Hz
+
+struct GasChain {
+  SlidingMedian<int, GAS_MEDIAN_SIZE> median;
+  MovingAverage<int, GAS_FILTER_SIZE> average;
+
+  int add(int mv) { return average.add(median.add(mv)); }
+};
+
+static int refMedian(const std::vector<int> &x, size_t end, size_t n) {
+  size_t begin = end >= n ? end - n : 0;
+  std::vector<int> w(x.begin() + begin, x.begin() + end);
+  std::sort(w.begin(), w.end());
+  return w[(w.size() - 1) / 2];
+}
+
+static int refAverage(const std::vector<int> &x, size_t end, size_t n) {
+  size_t begin = end >= n ? end - n : 0;
+  int32_t sum = 0;
+  for (size_t i = begin; i < end; i++) sum += x[i];
+  return sum / (int32_t)(end - begin);
+}
+
+// Noisy gas trace: slow drift, white noise and sparse one-sample spikes
+// like the ADC picks up when the modem transmits
+static std::vector<int> gasTrace(size_t n, double noiseMv, double spikeRate,
+                                 uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> noise(0, noiseMv);
+  std::uniform_real_distribution<double> u(0, 1);
+  std::vector<int> x(n);
+  for (size_t i = 0; i < n; i++) {
+    double v = 900 + 50 * sin(i / 400.0) + noise(rng);
+    if (u(rng) < spikeRate) v += u(rng) < 0.5 ? 1500 : -800;
+    x[i] = (int)lround(v);
+  }
+  return x;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_median_matches_sorted_window() {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> d(0, 20);  // Plenty of duplicates
+  std::vector<int> x;
+  SlidingMedian<int, GAS_MEDIAN_SIZE> med5;
+  SlidingMedian<int, 8> med8;
+  for (size_t i = 0; i < 5000; i++) {
+    x.push_back(d(rng));
+    TEST_ASSERT_EQUAL(refMedian(x, x.size(), 5), med5.add(x.back()));
+    TEST_ASSERT_EQUAL(refMedian(x, x.size(), 8), med8.add(x.back()));
+  }
+}
+
+static void test_average_matches_window_sum() {
+  std::vector<int> x = gasTrace(5000, 30, 0.02, 3);
+  MovingAverage<int, GAS_FILTER_SIZE> avg;
+  for (size_t i = 0; i < x.size(); i++) {
+    TEST_ASSERT_EQUAL(refAverage(x, i + 1, GAS_FILTER_SIZE), avg.add(x[i]));
+  }
+  TEST_ASSERT_TRUE(avg.filled());
+}
+
+// Up to two spikes in a row never get past a 5-sample median
+static void test_median_rejects_short_bursts() {
+  SlidingMedian<int, GAS_MEDIAN_SIZE> med;
+  for (int i = 0; i < 10; i++) med.add(1000);
+  for (int burst = 1; burst <= 2; burst++) {
+    for (int i = 0; i < burst; i++) TEST_ASSERT_EQUAL(1000, med.add(4095));
+    for (int i = 0; i < 5; i++) TEST_ASSERT_EQUAL(1000, med.add(1000));
+  }
+  // Three in a row is a level change, not a spike
+  med.add(4095);
+  med.add(4095);
+  TEST_ASSERT_EQUAL(4095, med.add(4095));
+}
+
+static double rms(const std::vector<int> &a, const std::vector<int> &b,
+                  size_t from) {
+  double s = 0;
+  for (size_t i = from; i < a.size(); i++) {
+    double e = a[i] - b[i];
+    s += e * e;
+  }
+  return sqrt(s / (a.size() - from));
+}
+
+static void test_noise_rejection() {
+  const size_t N = 20000;
+  std::vector<int> clean = gasTrace(N, 0, 0, 11);
+  std::vector<int> noisy = gasTrace(N, 25, 0.03, 11);
+
+  GasChain chain;
+  MovingAverage<int, GAS_FILTER_SIZE> averageOnly;
+  std::vector<int> out(N), outAvg(N);
+  // Samples further than 20 mV off the clean trace
+  size_t off = 0, offAvg = 0;
+  for (size_t i = 0; i < N; i++) {
+    out[i] = chain.add(noisy[i]);
+    outAvg[i] = averageOnly.add(noisy[i]);
+    if (i < 50) continue;
+    if (abs(out[i] - clean[i]) > 20) off++;
+    if (abs(outAvg[i] - clean[i]) > 20) offAvg++;
+  }
+
+  double rawErr = rms(noisy, clean, 50);
+  double chainErr = rms(out, clean, 50);
+  double avgErr = rms(outAvg, clean, 50);
+
+  // A 25-sample average alone cuts white noise by ~5x, but every spike
+  // still moves it by 1500 / 25 = 60 mV; the median takes those out
+  // first and only a rare cluster of three gets through
+  TEST_ASSERT_LESS_THAN(rawErr / 5, chainErr);
+  TEST_ASSERT_LESS_THAN(avgErr / 2, chainErr);
+  TEST_ASSERT_LESS_THAN(N / 100, off);
+
+  char msg[160];
+  snprintf(msg, sizeof(msg),
+           "rms error: raw %.1f mV, average only %.1f mV (%u off by >20), "
+           "chain %.1f mV (%u off by >20)", rawErr, avgErr,
+           (unsigned)offAvg, chainErr, (unsigned)off);
+  TEST_MESSAGE(msg);
+}
+
+// A real concentration step: the chain delays it by the median's half
+// window, then ramps linearly over the average window with no overshoot
+static void test_step_response() {
+  GasChain chain;
+  for (int i = 0; i < 100; i++) chain.add(800);
+
+  int prev = 800;
+  int settled = -1;
+  int half = -1;
+  for (int i = 0; i < 100; i++) {
+    int y = chain.add(2400);
+    TEST_ASSERT_GREATER_OR_EQUAL(prev, y);
+    TEST_ASSERT_LESS_OR_EQUAL(2400, y);
+    if (half < 0 && y >= 1600) half = i + 1;
+    if (settled < 0 && y == 2400) settled = i + 1;
+    prev = y;
+  }
+
+  // Median switches on the 3rd new sample, the average is full 24 later
+  const int delay = GAS_MEDIAN_SIZE / 2;
+  TEST_ASSERT_EQUAL(delay + GAS_FILTER_SIZE, settled);
+  TEST_ASSERT_INT_WITHIN(1, delay + GAS_FILTER_SIZE / 2 + 1, half);
+
+  char msg[96];
+  snprintf(msg, sizeof(msg),
+           "step 800 -> 2400 mV: 50%% after %d samples, settled after %d "
+           "(%d ms at 50 Hz)", half, settled, settled * 20);
+  TEST_MESSAGE(msg);
+}
+
+// The fraction bits let the integer EMA reach the exact target; without
+// them a step of less than 2^SHIFT would stall short of it
+static void test_ema_step_converges_exactly() {
+  Ema<4> ema;
+  TEST_ASSERT_EQUAL(1000, ema.add(1000));
+  int n63 = 0;
+  int y = 0;
+  for (int i = 1; i <= 400; i++) {
+    y = ema.add(1010);
+    if (!n63 && y >= 1006) n63 = i;
+  }
+  TEST_ASSERT_EQUAL(1010, y);
+  // Time constant ~ 2^SHIFT samples
+  TEST_ASSERT_INT_WITHIN(4, 16, n63);
+
+  ema.reset();
+  TEST_ASSERT_EQUAL(500, ema.add(500));
+}
+
+static void test_bench_chain() {
+  std::vector<int> x = gasTrace(200000, 25, 0.03, 5);
+  GasChain chain;
+  int32_t sink = 0;
+
+  uint64_t t0 = nativeWallNs();
+  for (int v : x) sink += chain.add(v);
+  uint64_t ns = nativeWallNs() - t0;
+
+  TEST_ASSERT_NOT_EQUAL(0, sink);
+  char msg[80];
+  snprintf(msg, sizeof(msg), "median(5) + average(25): %.1f ns/sample",
+           (double)ns / x.size());
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_median_matches_sorted_window);
+  RUN_TEST(test_average_matches_window_sum);
+  RUN_TEST(test_median_rejects_short_bursts);
+  RUN_TEST(test_noise_rejection);
+  RUN_TEST(test_step_response);
+  RUN_TEST(test_ema_step_converges_exactly);
+  RUN_TEST(test_bench_chain);
+  return UNITY_END();
+}
@@ -0,0 +1,226 @@
+// SmsOutbox over ModemAT against a fake modem that answers the PDU mode
+// exchange: every message that leaves the outbox, sent, given up on or
+// evicted, must be reported through the result hook exactly once.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "ModemAT.h"
+#include "SmsOutbox.h"
+
+class SmsModem : public Stream {
+ public:
+  enum Mode { SILENT, ACCEPT, REJECT };
+
+  Mode mode = ACCEPT;
+  int submits = 0;
+  int lines = 0;                    // Command lines written to the modem
+
+  int available() override { return (int)(_rx.size() - _rxPos); }
+  int read() override {
+    return _rxPos < _rx.size() ? (uint8_t)_rx[_rxPos++] : -1;
+  }
+  int peek() override {
+    return _rxPos < _rx.size() ? (uint8_t)_rx[_rxPos] : -1;
+  }
+
+  size_t write(uint8_t c) override {
+    if (c == 26) {                  // Ctrl-Z ends the PDU
+      _tx.clear();
+      submits++;
+      if (mode == ACCEPT) _rx += "\r\n+CMGS: 7\r\n\r\nOK\r\n";
+      if (mode == REJECT) _rx += "\r\n+CMS ERROR: 500\r\n";
+    } else if (c == '\n') {
+      lines++;
+      if (mode != SILENT) {
+        if (_tx.rfind("AT+CMGS=", 0) == 0) _rx += "\r\n> ";
+        else _rx += "\r\nOK\r\n";
+      }
+      _tx.clear();
+    } else if (c != '\r') {
+      _tx += (char)c;
+    }
+    return 1;
+  }
+  using Print::write;
+
+ private:
+  std::string _rx;
+  size_t _rxPos = 0;
+  std::string _tx;
+};
+
+struct HookCall {
+  uint32_t id;
+  std::string number;
+  bool sent;
+  uint8_t attempts;
+};
+
+static SmsModem *uart;
+static ModemAT *at;
+static SmsOutbox *outbox;
+static std::vector<HookCall> results;
+
+static void onResult(uint32_t id, const String &number, bool sent,
+                     uint8_t attempts) {
+  results.push_back(HookCall{id, number.c_str(), sent, attempts});
+}
+
+static void pump(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t++) {
+    at->dispatch();
+    outbox->poll();
+    nativeAdvanceMs(1);
+  }
+}
+
+void setUp() {
+  nativeSetMs(1000);
+  uart = new SmsModem();
+  at = new ModemAT();
+  at->begin(*uart);
+  outbox = new SmsOutbox(*at);
+  outbox->setResultHook(onResult);
+  results.clear();
+}
+
+void tearDown() {
+  delete outbox;
+  delete at;
+  delete uart;
+}
+
+static String number(int i) { return String("+49170000") + String(i); }
+
+// An alarm during boot queues SMS before the modem stage is done with the
+// AT engine; nothing may reach the modem until loop() polls the outbox
+static void test_send_only_queues() {
+  TEST_ASSERT_TRUE(outbox->send(number(1), "Gas alert", SMS_PRIO_ALERT));
+  TEST_ASSERT_TRUE(outbox->send(number(2), "Gas alert", SMS_PRIO_ALERT));
+  at->poll();
+  at->dispatch();
+  TEST_ASSERT_EQUAL(0, at->pending());
+  TEST_ASSERT_EQUAL(0, uart->lines);
+  TEST_ASSERT_FALSE(outbox->busy());
+  TEST_ASSERT_EQUAL(2, outbox->depth());
+
+  outbox->poll();
+  TEST_ASSERT_TRUE(outbox->busy());
+  TEST_ASSERT_EQUAL(2, at->pending());      // AT+CMGF=0, AT+CMGS
+  pump(100);
+  TEST_ASSERT_EQUAL(2, (int)results.size());
+  TEST_ASSERT_EQUAL(0, outbox->depth());
+}
+
+static void test_sent_message_is_reported() {
+  uint32_t id = 0;
+  TEST_ASSERT_TRUE(outbox->send(number(1), "Gas alert", SMS_PRIO_ALERT, &id));
+  TEST_ASSERT_NOT_EQUAL(0, id);
+  pump(50);
+
+  TEST_ASSERT_EQUAL(1, (int)results.size());
+  TEST_ASSERT_EQUAL(id, results[0].id);
+  TEST_ASSERT_EQUAL_STRING(number(1).c_str(), results[0].number.c_str());
+  TEST_ASSERT_TRUE(results[0].sent);
+  TEST_ASSERT_EQUAL(1, results[0].attempts);
+  TEST_ASSERT_EQUAL(0, outbox->depth());
+}
+
+static void test_gives_up_after_max_attempts() {
+  uart->mode = SmsModem::REJECT;
+  outbox->send(number(1), "Daily report", SMS_PRIO_LOW);
+  // 5 + 10 + 20 s of backoff between the four attempts
+  pump(40000);
+
+  TEST_ASSERT_EQUAL(SMS_MAX_ATTEMPTS, uart->submits);
+  TEST_ASSERT_EQUAL(1, (int)results.size());
+  TEST_ASSERT_FALSE(results[0].sent);
+  TEST_ASSERT_EQUAL(SMS_MAX_ATTEMPTS, results[0].attempts);
+  TEST_ASSERT_EQUAL(1, (int)outbox->stats().failed);
+}
+
+// A full outbox makes room for an alert by dropping the newest low
+// priority message; its sender must hear about it
+static void test_eviction_is_reported_as_failed() {
+  uart->mode = SmsModem::SILENT;      // First message stays in flight
+  for (int i = 1; i <= SMS_OUTBOX_SIZE; i++) {
+    TEST_ASSERT_TRUE(outbox->send(number(i), "Daily report", SMS_PRIO_LOW));
+    outbox->poll();
+  }
+  TEST_ASSERT_EQUAL(0, (int)results.size());
+
+  TEST_ASSERT_TRUE(outbox->send(number(99), "Gas alert", SMS_PRIO_ALERT));
+  TEST_ASSERT_EQUAL(1, (int)results.size());
+  TEST_ASSERT_EQUAL_STRING(number(SMS_OUTBOX_SIZE).c_str(),
+                           results[0].number.c_str());
+  TEST_ASSERT_FALSE(results[0].sent);
+  TEST_ASSERT_EQUAL(0, results[0].attempts);
+  TEST_ASSERT_EQUAL(SMS_OUTBOX_SIZE, outbox->depth());
+  TEST_ASSERT_EQUAL(1, (int)outbox->stats().failed);
+}
+
+// Messages to the same number are told apart by id, in whatever order
+// they finish; this is how main.cpp finds its test SMS among the alerts
+static void test_results_carry_the_message_id() {
+  uart->mode = SmsModem::SILENT;
+  uint32_t ids[SMS_OUTBOX_SIZE];
+  TEST_ASSERT_TRUE(outbox->send(number(1), "Gas alert", SMS_PRIO_ALERT,
+                                &ids[0]));
+  for (int i = 1; i < SMS_OUTBOX_SIZE; i++) {
+    SmsPriority prio = i == 3 ? SMS_PRIO_NORMAL : SMS_PRIO_LOW;
+    TEST_ASSERT_TRUE(outbox->send(number(1), "Test SMS", prio, &ids[i]));
+    for (int k = 0; k < i; k++) TEST_ASSERT_NOT_EQUAL(ids[k], ids[i]);
+  }
+
+  // Alerts evict the low priority messages newest first, then the test
+  // message
+  for (int i = 1; i < SMS_OUTBOX_SIZE; i++) {
+    TEST_ASSERT_TRUE(outbox->send(number(1), "Gas alert", SMS_PRIO_ALERT));
+  }
+  TEST_ASSERT_EQUAL(SMS_OUTBOX_SIZE - 1, (int)results.size());
+  TEST_ASSERT_EQUAL(ids[SMS_OUTBOX_SIZE - 1], results[0].id);
+  TEST_ASSERT_EQUAL(ids[3], results.back().id);
+  TEST_ASSERT_FALSE(results.back().sent);
+  TEST_ASSERT_EQUAL(0, results.back().attempts);
+
+  // The rest go out once the modem answers, each reported once under its
+  // own id
+  results.clear();
+  uart->mode = SmsModem::ACCEPT;
+  pump(60000);
+  TEST_ASSERT_EQUAL(SMS_OUTBOX_SIZE, (int)results.size());
+  int first = 0;
+  for (size_t i = 0; i < results.size(); i++) {
+    TEST_ASSERT_TRUE(results[i].sent);
+    for (size_t k = 0; k < i; k++) {
+      TEST_ASSERT_NOT_EQUAL(results[k].id, results[i].id);
+    }
+    if (results[i].id == ids[0]) first++;
+  }
+  TEST_ASSERT_EQUAL(1, first);
+}
+
+static void test_full_of_alerts_rejects_without_report() {
+  uart->mode = SmsModem::SILENT;
+  for (int i = 1; i <= SMS_OUTBOX_SIZE; i++) {
+    outbox->send(number(i), "Gas alert", SMS_PRIO_ALERT);
+  }
+  TEST_ASSERT_FALSE(outbox->send(number(99), "Gas alert", SMS_PRIO_ALERT));
+  TEST_ASSERT_EQUAL(0, (int)results.size());
+  TEST_ASSERT_EQUAL(1, (int)outbox->stats().rejected);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_send_only_queues);
+  RUN_TEST(test_sent_message_is_reported);
+  RUN_TEST(test_gives_up_after_max_attempts);
+  RUN_TEST(test_eviction_is_reported_as_failed);
+  RUN_TEST(test_results_carry_the_message_id);
+  RUN_TEST(test_full_of_alerts_rejects_without_report);
+  return UNITY_END();
+}
@@ -0,0 +1,204 @@
+// TinyGsmSmsPdu against published SMS-SUBMIT vectors (GSM-7 packing,
+// escape pairs, UCS-2, concatenation UDH with fill bits), SmsComposer's
+// one-SMS budget against the encoder's segment count, and encode speed.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <string>
+
+#include <TinyGsmSmsPdu.h>
+
+#include "SmsComposer.h"
+
+static char hex[TINY_GSM_PDU_HEX_MAX];
+
+static std::string repeat(const char *s, int n) {
+  std::string r;
+  while (n--) r += s;
+  return r;
+}
+
+// Unpack n septets starting at bit offset fill of hex user data
+static std::string unpack(const char *ud, int fill, int n) {
+  std::string out;
+  for (int i = 0; i < n; i++) {
+    int v = 0;
+    for (int k = 0; k < 7; k++) {
+      int bit = fill + 7 * i + k;
+      int octet = 0;
+      sscanf(ud + 2 * (bit / 8), "%2x", &octet);
+      v |= ((octet >> (bit % 8)) & 1) << k;
+    }
+    out += (char)v;
+  }
+  return out;
+}
+
+// Offsets in the hex PDU for the 4-digit test number +4917
+static int udl(const char *pdu) {
+  int v = 0;
+  sscanf(pdu + 18, "%2x", &v);
+  return v;
+}
+static const char *ud(const char *pdu) { return pdu + 20; }
+
+void setUp() {}
+void tearDown() {}
+
+// The dreamfabric.com SMS-SUBMIT example without its validity period:
+// "hellohello" to +46708251358
+static void test_gsm7_single() {
+  TinyGsmSmsPdu pdu;
+  TEST_ASSERT_EQUAL(1, pdu.begin("+46708251358", "hellohello", 0));
+  TEST_ASSERT_FALSE(pdu.ucs2());
+  TEST_ASSERT_EQUAL(22, pdu.encode(0, hex, sizeof(hex)));
+  TEST_ASSERT_EQUAL_STRING("0001000B916407281553F800000AE8329BFD4697D9EC37",
+                           hex);
+
+  // National number, odd digit count padded with F
+  TEST_ASSERT_EQUAL(1, pdu.begin("12345", "How are you?", 0));
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("00010005812143F50000"
+                           "0CC8F71D14969741F977FD07", hex);
+}
+
+// Extension characters go out as ESC + code and count two septets
+static void test_gsm7_escape() {
+  TinyGsmSmsPdu pdu;
+  pdu.begin("+4917", "\xE2\x82\xAC", 0);     // €
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("000100049194710000029B32", hex);
+
+  pdu.begin("+4917", "[", 0);
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("000100049194710000021B1E", hex);
+
+  // 80 escape pairs fill one SMS exactly, one more makes two parts
+  TEST_ASSERT_EQUAL(1, pdu.begin("+4917", repeat("{", 80).c_str(), 0));
+  TEST_ASSERT_EQUAL(2, pdu.begin("+4917", repeat("{", 81).c_str(), 0));
+}
+
+// Anything outside GSM 03.38 switches the whole text to UCS-2, astral
+// code points as surrogate pairs
+static void test_ucs2() {
+  TinyGsmSmsPdu pdu;
+  pdu.begin("+4917", "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82", 0);
+  TEST_ASSERT_TRUE(pdu.ucs2());
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("000100049194710008"
+                           "0C041F04400438043204350442", hex);
+
+  pdu.begin("+4917", "A\xF0\x9F\x94\xA5", 0);    // A🔥
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("0001000491947100080600"
+                           "41D83DDD25", hex);
+
+  // A backtick has no GSM-7 code
+  pdu.begin("+4917", "`", 0);
+  TEST_ASSERT_TRUE(pdu.ucs2());
+}
+
+// 161 septets: 153 + 8 behind a 6-octet UDH, the text starting after one
+// fill bit so it lands on a septet boundary
+static void test_concatenated_gsm7() {
+  std::string text = repeat("x", 153) + "hellohel";
+  TinyGsmSmsPdu pdu;
+  TEST_ASSERT_EQUAL(2, pdu.begin("+4917", text.c_str(), 0x2A));
+
+  TEST_ASSERT_EQUAL(9 + 140, pdu.encode(0, hex, sizeof(hex)));
+  TEST_ASSERT_EQUAL(0, strncmp(hex, "004100049194710000A0"
+                                    "0500032A0201", 32));
+  TEST_ASSERT_EQUAL_STRING(repeat("x", 153).c_str(),
+                           unpack(ud(hex), 49, 153).c_str());
+
+  pdu.encode(1, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("0041000491947100000F0500032A0202"
+                           "D06536FB8D2EB301", hex);
+}
+
+// An escape pair or surrogate pair never straddles two parts
+static void test_concatenation_keeps_pairs() {
+  TinyGsmSmsPdu pdu;
+  std::string text = repeat("x", 152) + "\xE2\x82\xAC" + repeat("y", 7);
+  TEST_ASSERT_EQUAL(2, pdu.begin("+4917", text.c_str(), 1));
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL(7 + 152, udl(hex));
+  pdu.encode(1, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL(7 + 2 + 7, udl(hex));
+  TEST_ASSERT_EQUAL_STRING("\x1B\x65y", unpack(ud(hex), 49, 3).c_str());
+
+  text = repeat("\xD0\x96", 66) + "\xF0\x9F\x94\xA5" + "zzz";  // Ж x66, 🔥
+  TEST_ASSERT_EQUAL(2, pdu.begin("+4917", text.c_str(), 1));
+  pdu.encode(0, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL(6 + 66 * 2, udl(hex));
+  pdu.encode(1, hex, sizeof(hex));
+  TEST_ASSERT_EQUAL_STRING("050003010202"
+                           "D83DDD25007A007A007A", ud(hex));
+}
+
+// What SmsComposer accepts as one SMS must go out as one PDU, and the
+// first character over its budget must make two
+static void test_composer_agrees_with_encoder() {
+  static const char *const chars[] = {
+    "a", "{", "\xE2\x82\xAC", "\xC3\xA9", "\xC3\xA7", "`",
+    "\xE2\x9D\x84", "\xF0\x9F\x94\xA5", "\n", "@", "\xC2\xA7",
+  };
+  const int n = sizeof(chars) / sizeof(chars[0]);
+  char buf[1024];
+  TinyGsmSmsPdu pdu;
+  for (int a = 0; a < n; a++) {
+    for (int b = 0; b < n; b++) {
+      SmsComposer c(buf, sizeof(buf));
+      c.put(chars[a]);
+      while (c.add(chars[b])) {}
+      TEST_ASSERT_TRUE(c.truncated());
+      TEST_ASSERT_EQUAL(1, pdu.begin("+4917", c.c_str(), 0));
+      TEST_ASSERT_EQUAL(c.ucs2(), pdu.ucs2());
+
+      std::string over = std::string(c.c_str()) + chars[b];
+      TEST_ASSERT_EQUAL(2, pdu.begin("+4917", over.c_str(), 0));
+    }
+  }
+}
+
+static void bench(const char *name, const std::string &text) {
+  const int N = 20000;
+  TinyGsmSmsPdu pdu;
+  uint32_t sink = 0;
+  uint8_t parts = 0;
+
+  uint64_t t0 = nativeWallNs();
+  for (int i = 0; i < N; i++) {
+    parts = pdu.begin("+491701234567", text.c_str(), (uint8_t)i);
+    for (uint8_t s = 0; s < parts; s++) {
+      sink += pdu.encode(s, hex, sizeof(hex));
+    }
+  }
+  uint64_t ns = nativeWallNs() - t0;
+  TEST_ASSERT_NOT_EQUAL(0, sink);
+
+  char msg[112];
+  snprintf(msg, sizeof(msg), "%s, %u part(s): %.2f us/message, %.1f MB/s",
+           name, parts, ns / 1000.0 / N,
+           (double)text.size() * N / (ns / 1000.0));
+  TEST_MESSAGE(msg);
+}
+
+static void test_bench_encode() {
+  bench("GSM-7 160 chars", repeat("Gas alert ", 16));
+  bench("UCS-2 70 units", "\xF0\x9F\x94\xA5" + repeat("T:31.5C ", 8) + "12");
+  bench("GSM-7 450 chars", repeat("Daily report ", 34) + "abcdefgh");
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_gsm7_single);
+  RUN_TEST(test_gsm7_escape);
+  RUN_TEST(test_ucs2);
+  RUN_TEST(test_concatenated_gsm7);
+  RUN_TEST(test_concatenation_keeps_pairs);
+  RUN_TEST(test_composer_agrees_with_encoder);
+  RUN_TEST(test_bench_encode);
+  return UNITY_END();
+}
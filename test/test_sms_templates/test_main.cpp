@@ -0,0 +1,270 @@
+// The composer based SMS templates against the String += versions they
+// replaced: byte-identical text whenever the old text fit one SMS, one SMS
+// otherwise, and the heap allocations each version makes per message.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <new>
+#include <string>
+
+#include "SmsTemplates.h"
+
+// Every operator new in this binary, which is where String's buffers
+// come from on the host
+static size_t allocations;
+
+void *operator new(size_t n) {
+  allocations++;
+  void *p = malloc(n ? n : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static const AlertLimits limits = {10.0f, 35.0f, 30.0f, 80.0f, 200, 50};
+
+// ---- The replaced functions, as they were ----
+
+static String oldAlertReasons(float temp, float hum, int gas, int nh3,
+                              bool fire) {
+  String reason = "";
+
+  if (fire)
+    reason += "🔥 FIRE DETECTED\n";
+
+  if (temp < limits.tempLow)
+    reason += "❄ TEMP LOW (" + String(temp,1) + "C)\n";
+  else if (temp > limits.tempHigh)
+    reason += "🔥 TEMP HIGH (" + String(temp,1) + "C)\n";
+
+  if (hum < limits.humLow)
+    reason += "💧 HUMIDITY LOW (" + String(hum,0) + "%)\n";
+  else if (hum > limits.humHigh)
+    reason += "💧 HUMIDITY HIGH (" + String(hum,0) + "%)\n";
+
+  if (gas > limits.gas)
+    reason += "🧪 GAS HIGH (" + String(gas) + " PPM)\n";
+
+  if (nh3 > limits.nh3)
+    reason += "☠ AMMONIA HIGH (" + String(nh3) + " PPM)\n";
+
+  if (reason == "") reason = "Unknown alert\n";
+
+  return reason;
+}
+
+static String oldCallAlert(int attempt, float temp, float hum, int gas,
+                           int nh3, bool fire) {
+  String msg = "ALERT #" + String(attempt) + "\n";
+
+  if (fire) msg += "FIRE! ";
+  if (temp < limits.tempLow) msg += "COLD ";
+  if (temp > limits.tempHigh) msg += "HOT ";
+  if (hum < limits.humLow) msg += "DRY ";
+  if (hum > limits.humHigh) msg += "WET ";
+  if (gas > limits.gas) msg += "GAS ";
+  if (nh3 > limits.nh3) msg += "NH3 ";
+
+  msg += "\n";
+
+  msg += "T:" + String(temp,1) + "C ";
+  msg += "H:" + String(hum,0) + "% ";
+  msg += "G:" + String(gas) + " ";
+  msg += "N:" + String(nh3);
+  msg += "\nCalling now";
+  return msg;
+}
+
+static String oldParameters(float temp, float hum, int gas, int nh3,
+                            bool fire) {
+  String message = "ENV MONITOR:\n";
+  message += "Temp: " + String(temp, 1) + "C\n";
+  message += "Humidity: " + String(hum, 0) + "%\n";
+  message += "Carbon Monoxide: " + String(gas) + " PPM\n";
+  message += "Ammonia: " + String(nh3) + " PPM\n";
+  message += "Fire: " + String(fire ? "YES" : "NO");
+  return message;
+}
+
+static String oldDailyReport(float minTemp, float maxTemp, float minHum,
+                             float maxHum) {
+  String msg = "📊 DAILY REPORT\n";
+  msg += "Temp Min: " + String(minTemp,1) + "C\n";
+  msg += "Temp Max: " + String(maxTemp,1) + "C\n";
+  msg += "Hum Min: " + String(minHum,0) + "%\n";
+  msg += "Hum Max: " + String(maxHum,0) + "%";
+  return msg;
+}
+
+// ---- Helpers ----
+
+// Does the old text fit one SMS: 160 GSM-7 septets or 70 UTF-16 units
+static bool fitsOneSms(const String &text) {
+  char buf[1024];
+  SmsComposer c(buf, sizeof(buf));
+  c.put(text.c_str());
+  return c.used() <= c.budget();
+}
+
+static int checked;
+static int abbreviated;
+
+static void expectSame(const String &old, SmsComposer &now) {
+  checked++;
+  TEST_ASSERT_TRUE(now.used() <= now.budget());
+  if (fitsOneSms(old)) {
+    TEST_ASSERT_EQUAL_STRING(old.c_str(), now.c_str());
+    TEST_ASSERT_FALSE(now.truncated());
+  } else {
+    abbreviated++;
+  }
+}
+
+// Sensor values as the DHT11 and the gas curves produce them: 0.1 C steps
+// over 0..50 C, whole percent over 20..90 %RH, whole ppm. String pads
+// single-digit 0-decimal values to two characters, the composer does
+// not; the DHT11 never reports humidity below 20 %
+static float dhtTemp(int i) { return (float)(i / 10.0); }
+
+void setUp() { checked = abbreviated = 0; }
+void tearDown() {}
+
+static void test_dht_range_formats_like_string() {
+  char buf[SMS_TEXT_MAX];
+  for (int i = 0; i <= 500; i++) {
+    SmsComposer c(buf, sizeof(buf));
+    c.put(dhtTemp(i), 1);
+    TEST_ASSERT_EQUAL_STRING(String(dhtTemp(i), 1).c_str(), c.c_str());
+  }
+  for (int h = 10; h <= 100; h++) {
+    SmsComposer c(buf, sizeof(buf));
+    c.put((float)h, 0);
+    TEST_ASSERT_EQUAL_STRING(String((float)h, 0).c_str(), c.c_str());
+  }
+}
+
+static void test_call_alert_matches_old_text() {
+  char buf[SMS_TEXT_MAX];
+  for (int i = 0; i <= 500; i += 7) {
+    for (int hum = 20; hum <= 90; hum += 5) {
+      for (int gas : {31, 199, 201, 4999, 5000}) {
+        for (int nh3 : {0, 51, 300}) {
+          for (int fire = 0; fire < 2; fire++) {
+            int attempt = 1 + (i + hum) % 12;
+            SmsComposer c(buf, sizeof(buf));
+            composeCallAlert(c, limits, attempt, dhtTemp(i), hum, gas, nh3,
+                             fire);
+            expectSame(oldCallAlert(attempt, dhtTemp(i), hum, gas, nh3, fire),
+                       c);
+          }
+        }
+      }
+    }
+  }
+  TEST_ASSERT_EQUAL(0, abbreviated);
+}
+
+static void test_parameters_match_old_text() {
+  char buf[SMS_TEXT_MAX];
+  for (int i = 0; i <= 500; i += 3) {
+    for (int hum = 20; hum <= 90; hum += 7) {
+      for (int gas : {0, 31, 450, 5000}) {
+        for (int nh3 : {0, 12, 300}) {
+          SmsComposer c(buf, sizeof(buf));
+          composeParameters(c, dhtTemp(i), hum, gas, nh3, i & 1);
+          expectSame(oldParameters(dhtTemp(i), hum, gas, nh3, i & 1), c);
+        }
+      }
+    }
+  }
+}
+
+static void test_alert_reasons_match_old_text() {
+  char buf[SMS_TEXT_MAX];
+  for (int i = 0; i <= 500; i += 11) {
+    for (int hum = 20; hum <= 90; hum += 5) {
+      for (int gas : {50, 5000}) {
+        for (int nh3 : {10, 300}) {
+          for (int fire = 0; fire < 2; fire++) {
+            SmsComposer c(buf, sizeof(buf));
+            appendAlertReasons(c, limits, dhtTemp(i), hum, gas, nh3, fire);
+            expectSame(oldAlertReasons(dhtTemp(i), hum, gas, nh3, fire), c);
+          }
+        }
+      }
+    }
+  }
+  TEST_MESSAGE((std::to_string(checked) + " alert reason texts, " +
+                std::to_string(abbreviated) +
+                " over one SMS and abbreviated").c_str());
+}
+
+// The emoji makes the report UCS-2, where the old text needs two parts;
+// the new one shortens the last line instead
+static void test_daily_report_stays_one_sms() {
+  char buf[SMS_TEXT_MAX];
+  SmsComposer c(buf, sizeof(buf));
+  composeDailyReport(c, 18.4f, 31.9f, 35, 72);
+  String old = oldDailyReport(18.4f, 31.9f, 35, 72);
+
+  TEST_ASSERT_FALSE(fitsOneSms(old));
+  TEST_ASSERT_TRUE(c.ucs2());
+  TEST_ASSERT_LESS_OR_EQUAL(SMS_UCS2_BUDGET, c.used());
+  TEST_ASSERT_EQUAL_STRING(
+    "📊 DAILY REPORT\nTemp Min: 18.4C\nTemp Max: 31.9C\nHum Min: 35%\n"
+    "Hmax:72%", c.c_str());
+}
+
+static void test_bench_allocations() {
+  char buf[SMS_TEXT_MAX];
+  const int N = 2000;
+
+  allocations = 0;
+  uint64_t t0 = nativeWallNs();
+  size_t bytes = 0;
+  for (int n = 0; n < N; n++) {
+    float t = dhtTemp(n % 500);
+    bytes += oldCallAlert(n % 9 + 1, t, 85, 4200, 120, n & 1).length();
+    bytes += oldParameters(t, 85, 4200, 120, n & 1).length();
+  }
+  uint64_t oldNs = nativeWallNs() - t0;
+  size_t oldAllocs = allocations;
+
+  allocations = 0;
+  t0 = nativeWallNs();
+  for (int n = 0; n < N; n++) {
+    float t = dhtTemp(n % 500);
+    SmsComposer a(buf, sizeof(buf));
+    composeCallAlert(a, limits, n % 9 + 1, t, 85, 4200, 120, n & 1);
+    bytes += a.length();
+    SmsComposer p(buf, sizeof(buf));
+    composeParameters(p, t, 85, 4200, 120, n & 1);
+    bytes += p.length();
+  }
+  uint64_t newNs = nativeWallNs() - t0;
+  size_t newAllocs = allocations;
+
+  TEST_ASSERT_EQUAL(0, (int)newAllocs);
+  TEST_ASSERT_GREATER_THAN(0, (int)bytes);
+
+  char msg[160];
+  snprintf(msg, sizeof(msg),
+           "alert + parameters SMS: String %.1f allocations / %.2f us, "
+           "composer %.1f allocations / %.2f us",
+           (double)oldAllocs / N, oldNs / 1000.0 / N,
+           (double)newAllocs / N, newNs / 1000.0 / N);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dht_range_formats_like_string);
+  RUN_TEST(test_call_alert_matches_old_text);
+  RUN_TEST(test_parameters_match_old_text);
+  RUN_TEST(test_alert_reasons_match_old_text);
+  RUN_TEST(test_daily_report_stays_one_sms);
+  RUN_TEST(test_bench_allocations);
+  return UNITY_END();
+}
@@ -0,0 +1,155 @@
+// TinyGsmSpscFifo: single context semantics, a two thread producer /
+// consumer stress run that checks every element arrives once and in
+// order, and the cross-thread throughput.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include <TinyGsmFifo.h>
+
+void setUp() {}
+void tearDown() {}
+
+static void test_all_slots_usable() {
+  TinyGsmSpscFifo<uint8_t, 8> fifo;
+  for (uint8_t i = 0; i < 8; i++) TEST_ASSERT_TRUE(fifo.put(i));
+  TEST_ASSERT_FALSE(fifo.put(99));
+  TEST_ASSERT_EQUAL(8, (int)fifo.size());
+  TEST_ASSERT_EQUAL(0, fifo.free());
+
+  uint8_t c;
+  for (uint8_t i = 0; i < 8; i++) {
+    TEST_ASSERT_TRUE(fifo.get(&c));
+    TEST_ASSERT_EQUAL(i, c);
+  }
+  TEST_ASSERT_FALSE(fifo.get(&c));
+}
+
+static void test_peek_returns_element_type() {
+  TinyGsmSpscFifo<uint16_t, 4> fifo;
+  fifo.put(0x1234);
+  fifo.put(0xBEEF);
+  TEST_ASSERT_EQUAL_HEX32(0x1234, fifo.peek());
+  uint16_t v;
+  fifo.get(&v);
+  TEST_ASSERT_EQUAL_HEX32(0xBEEF, fifo.peek());
+}
+
+static void test_spans_wrap() {
+  TinyGsmSpscFifo<uint8_t, 8> fifo;
+  uint8_t buf[8];
+  fifo.put((const uint8_t *)"abcdef", 6);
+  TEST_ASSERT_EQUAL(6, fifo.get(buf, 6));
+
+  // Write index at 6: the free region is split 2 + 6
+  size_t n;
+  uint8_t *span = fifo.writeSpan(n);
+  TEST_ASSERT_NOT_NULL(span);
+  TEST_ASSERT_EQUAL(2, (int)n);
+  span[0] = 'g';
+  span[1] = 'h';
+  fifo.commit(2);
+  TEST_ASSERT_EQUAL(4, fifo.put((const uint8_t *)"ijkl", 4));
+
+  const uint8_t *filled = fifo.readSpan(n);
+  TEST_ASSERT_EQUAL(2, (int)n);
+  TEST_ASSERT_EQUAL('g', filled[0]);
+  fifo.consume(2);
+  TEST_ASSERT_EQUAL(4, fifo.get(buf, 8));
+  TEST_ASSERT_EQUAL_MEMORY("ijkl", buf, 4);
+}
+
+// Producer writes a counter through writeSpan(), consumer checks it with
+// get(); any lost, duplicated or torn element breaks the sequence
+static void test_two_thread_stress() {
+  static TinyGsmSpscFifo<uint32_t, 256> fifo;
+  const uint32_t total = 5000000;
+  std::atomic<bool> ok(true);
+
+  uint64_t start = nativeWallNs();
+  std::thread producer([&] {
+    uint32_t i = 0;
+    while (i < total) {
+      size_t n;
+      uint32_t *span = fifo.writeSpan(n);
+      if (!span) {
+        std::this_thread::yield();
+        continue;
+      }
+      if (n > total - i) n = total - i;
+      for (size_t k = 0; k < n; k++) span[k] = i + k;
+      fifo.commit(n);
+      i += n;
+    }
+  });
+
+  uint32_t expect = 0;
+  uint32_t buf[64];
+  while (expect < total) {
+    int got = fifo.get(buf, 64);
+    if (!got) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (int k = 0; k < got; k++) {
+      if (buf[k] != expect++) ok = false;
+    }
+  }
+  producer.join();
+  uint64_t ns = nativeWallNs() - start;
+
+  TEST_ASSERT_TRUE(ok.load());
+  TEST_ASSERT_EQUAL(0, (int)fifo.size());
+
+  char msg[96];
+  snprintf(msg, sizeof(msg), "SPSC two threads: %.1f M elements/s",
+           total * 1000.0 / ns);
+  TEST_MESSAGE(msg);
+}
+
+// Byte at a time, the way the UART task feeds the socket buffer
+static void test_bench_single_byte_ops() {
+  const int ROUNDS = 200000;
+  TinyGsmFifo<uint8_t, 512> plain;
+  TinyGsmSpscFifo<uint8_t, 512> spsc;
+  uint8_t c = 0;
+  uint32_t sum = 0;
+
+  uint64_t t0 = nativeWallNs();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < 64; i++) plain.put((uint8_t)i);
+    for (int i = 0; i < 64; i++) {
+      plain.get(&c);
+      sum += c;
+    }
+  }
+  uint64_t t1 = nativeWallNs();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < 64; i++) spsc.put((uint8_t)i);
+    for (int i = 0; i < 64; i++) {
+      spsc.get(&c);
+      sum += c;
+    }
+  }
+  uint64_t t2 = nativeWallNs();
+
+  TEST_ASSERT_EQUAL(2U * ROUNDS * (63 * 64 / 2), sum);
+  double ops = ROUNDS * 64.0;
+  char msg[96];
+  snprintf(msg, sizeof(msg), "put+get: TinyGsmFifo %.1f ns, SPSC %.1f ns",
+           (t1 - t0) / ops, (t2 - t1) / ops);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_all_slots_usable);
+  RUN_TEST(test_peek_returns_element_type);
+  RUN_TEST(test_spans_wrap);
+  RUN_TEST(test_two_thread_stress);
+  RUN_TEST(test_bench_single_byte_ops);
+  return UNITY_END();
+}
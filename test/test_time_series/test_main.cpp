@@ -0,0 +1,247 @@
+// TimeSeriesStore against a brute-force history of the same samples:
+// what each tier keeps and how exact it is, plus insert and range-query
+// cost and the memory per stored sample.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "TimeSeriesStore.h"
+
+struct Stored {
+  uint32_t t;
+  TsSample s;
+};
+
+// Eight days at one sample per second with the odd missed second, slow
+// daily swings and the occasional gas spike
+static std::vector<Stored> history;
+static TimeSeriesStore *store;
+
+static const uint32_t DAYS = 8;
+static const uint32_t START = 12345;
+
+static void record() {
+  std::mt19937 rng(21);
+  std::uniform_real_distribution<double> u(0, 1);
+  std::normal_distribution<double> noise(0, 1.5);
+  for (uint32_t t = START; t < START + DAYS * 86400; t++) {
+    if (u(rng) < 0.01) continue;
+    double day = (t % 86400) / 86400.0 * 2 * M_PI;
+    TsSample s;
+    s.value[TS_TEMP] = (int16_t)(245 + 40 * sin(day) + noise(rng));
+    s.value[TS_HUM] = (int16_t)(550 - 80 * sin(day) + noise(rng));
+    s.value[TS_GAS] = (int16_t)(30 + noise(rng) * 4);
+    s.value[TS_NH3] = (int16_t)(5 + u(rng) * 3);
+    if (u(rng) < 0.0005) s.value[TS_GAS] = 4000;
+    s.flame = (t / 600) % 97 == 0;
+    history.push_back(Stored{t, s});
+  }
+}
+
+struct Rows {
+  std::vector<TsPoint> points;
+  uint32_t limit = UINT32_MAX;
+};
+
+static bool collect(const TsPoint &p, void *ctx) {
+  Rows *rows = static_cast<Rows *>(ctx);
+  rows->points.push_back(p);
+  return rows->points.size() < rows->limit;
+}
+
+// Brute-force buckets of PERIOD seconds with the store's rounding, from
+// samples before until
+static std::map<uint32_t, TsRollup> buckets(uint32_t period,
+                                            uint32_t until) {
+  std::map<uint32_t, TsRollup> out;
+  for (const Stored &h : history) {
+    if (h.t >= until) break;
+    uint32_t start = h.t - h.t % period;
+    auto it = out.find(start);
+    if (it == out.end()) {
+      it = out.emplace(start, TsRollup()).first;
+      it->second.reset(start);
+    }
+    it->second.add(h.s);
+  }
+  return out;
+}
+
+static void checkRollups(TsTier tier, uint32_t period, uint32_t capacity,
+                         uint32_t until) {
+  std::map<uint32_t, TsRollup> ref = buckets(period, until);
+  Rows rows;
+  store->query(tier, 0, UINT32_MAX, collect, &rows);
+
+  // Every stored bucket plus the open one
+  TEST_ASSERT_EQUAL(capacity + 1, (int)rows.points.size());
+  TEST_ASSERT_EQUAL(std::prev(ref.end())->first, rows.points.back().t);
+
+  for (const TsPoint &p : rows.points) {
+    TEST_ASSERT_TRUE(ref.count(p.t) == 1);
+    TsPoint want;
+    ref[p.t].toPoint(want);
+    TEST_ASSERT_EQUAL(want.count, p.count);
+    TEST_ASSERT_EQUAL(want.flame, p.flame);
+    for (uint8_t c = 0; c < TS_ANALOG; c++) {
+      TEST_ASSERT_EQUAL(want.min[c], p.min[c]);
+      TEST_ASSERT_EQUAL(want.max[c], p.max[c]);
+      TEST_ASSERT_EQUAL(want.mean[c], p.mean[c]);
+    }
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_rejects_out_of_order() {
+  TimeSeriesStore s;
+  TsSample sample = {{1, 2, 3, 4}, false};
+  TEST_ASSERT_TRUE(s.add(100, sample));
+  TEST_ASSERT_FALSE(s.add(100, sample));
+  TEST_ASSERT_FALSE(s.add(99, sample));
+  TEST_ASSERT_TRUE(s.add(101, sample));
+  TEST_ASSERT_EQUAL(2, (int)s.stats().samples);
+  TEST_ASSERT_EQUAL(2, (int)s.stats().rejected);
+}
+
+// The last TS_RAW_BLOCKS minutes, exact unless a block spans more than a
+// byte; then within half a quantization step
+static void test_seconds_tier() {
+  uint32_t newest = history.back().t;
+  uint32_t oldestBlock = (newest / TS_BLOCK_SECONDS - (TS_RAW_BLOCKS - 1)) *
+                         TS_BLOCK_SECONDS;
+
+  std::vector<Stored> want;
+  std::map<uint32_t, int32_t> range[TS_ANALOG];
+  for (const Stored &h : history) {
+    if (h.t < oldestBlock) continue;
+    want.push_back(h);
+  }
+  for (uint8_t c = 0; c < TS_ANALOG; c++) {
+    std::map<uint32_t, std::pair<int16_t, int16_t>> span;
+    for (const Stored &h : want) {
+      uint32_t b = h.t - h.t % TS_BLOCK_SECONDS;
+      auto it = span.emplace(b, std::make_pair(h.s.value[c], h.s.value[c]));
+      it.first->second.first = std::min(it.first->second.first, h.s.value[c]);
+      it.first->second.second = std::max(it.first->second.second,
+                                         h.s.value[c]);
+    }
+    for (auto &kv : span) {
+      range[c][kv.first] = kv.second.second - kv.second.first;
+    }
+  }
+
+  Rows rows;
+  store->query(TS_SECONDS, 0, UINT32_MAX, collect, &rows);
+  TEST_ASSERT_EQUAL(want.size(), rows.points.size());
+  TEST_ASSERT_EQUAL(want.size(), store->stats().secondsStored);
+
+  uint32_t openBlock = newest - newest % TS_BLOCK_SECONDS;
+  for (size_t i = 0; i < want.size(); i++) {
+    const TsPoint &p = rows.points[i];
+    TEST_ASSERT_EQUAL(want[i].t, p.t);
+    TEST_ASSERT_EQUAL(want[i].s.flame, p.flame != 0);
+    uint32_t block = p.t - p.t % TS_BLOCK_SECONDS;
+    for (uint8_t c = 0; c < TS_ANALOG; c++) {
+      int32_t r = range[c][block];
+      int shift = 0;
+      while ((r >> shift) > 255) shift++;
+      int tolerance = block == openBlock || !shift ? 0 : 1 << (shift - 1);
+      TEST_ASSERT_INT_WITHIN(tolerance, want[i].s.value[c], p.mean[c]);
+    }
+  }
+
+  // A range inside the window, and a visitor that stops early
+  Rows part;
+  uint32_t from = newest - 600, to = newest - 300;
+  uint32_t n = store->query(TS_SECONDS, from, to, collect, &part);
+  TEST_ASSERT_EQUAL(n, part.points.size());
+  TEST_ASSERT_TRUE(part.points.front().t >= from);
+  TEST_ASSERT_TRUE(part.points.back().t <= to);
+
+  Rows first;
+  first.limit = 10;
+  TEST_ASSERT_EQUAL(10, store->query(TS_SECONDS, 0, newest, collect, &first));
+}
+
+static void test_minute_tier() {
+  checkRollups(TS_MINUTES, 60, TS_MINUTE_BUCKETS, UINT32_MAX);
+}
+
+// Hours are fed closed minutes, so the open hour lacks the open minute
+static void test_hour_tier() {
+  uint32_t newest = history.back().t;
+  checkRollups(TS_HOURS, 3600, TS_HOUR_BUCKETS, newest - newest % 60);
+}
+
+static void test_bench() {
+  char msg[128];
+
+  const int ROUNDS = 3;
+  uint64_t t0 = nativeWallNs();
+  for (int r = 0; r < ROUNDS; r++) {
+    TimeSeriesStore *s = new TimeSeriesStore();
+    for (const Stored &h : history) s->add(h.t, h.s);
+    delete s;
+  }
+  uint64_t ns = nativeWallNs() - t0;
+  snprintf(msg, sizeof(msg), "insert: %.1f ns/sample over %u days",
+           (double)ns / (ROUNDS * history.size()), (unsigned)DAYS);
+  TEST_MESSAGE(msg);
+
+  struct {
+    TsTier tier;
+    const char *name;
+  } tiers[] = {
+    {TS_SECONDS, "seconds"}, {TS_MINUTES, "minutes"}, {TS_HOURS, "hours"},
+  };
+  for (auto &q : tiers) {
+    const int N = 2000;
+    Rows rows;
+    rows.points.reserve(2000);
+    uint32_t total = 0;
+    t0 = nativeWallNs();
+    for (int i = 0; i < N; i++) {
+      rows.points.clear();
+      total += store->query(q.tier, 0, UINT32_MAX, collect, &rows);
+    }
+    ns = nativeWallNs() - t0;
+    snprintf(msg, sizeof(msg), "query %s: %u rows in %.1f us, %.1f ns/row",
+             q.name, total / N, ns / 1000.0 / N, (double)ns / total);
+    TEST_MESSAGE(msg);
+  }
+
+  snprintf(msg, sizeof(msg),
+           "%.2f bytes per 1 s sample (%u as raw structs), %u bytes total",
+           TimeSeriesStore::bytesPerSecondSample(), (unsigned)sizeof(TsSample),
+           (unsigned)TimeSeriesStore::bytes());
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN((float)sizeof(TsSample),
+                        TimeSeriesStore::bytesPerSecondSample());
+  TEST_ASSERT_LESS_OR_EQUAL(TS_BUDGET_BYTES, TimeSeriesStore::bytes());
+}
+
+int main(int argc, char **argv) {
+  record();
+  store = new TimeSeriesStore();
+  for (const Stored &h : history) store->add(h.t, h.s);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_rejects_out_of_order);
+  RUN_TEST(test_seconds_tier);
+  RUN_TEST(test_minute_tier);
+  RUN_TEST(test_hour_tier);
+  RUN_TEST(test_bench);
+  int failures = UNITY_END();
+  delete store;
+  return failures;
+}
@@ -0,0 +1,228 @@
+// Replays recorded UART transcripts through ModemAT and checks the event
+// ordering guarantees of the URC dispatch table: completions and URCs are
+// delivered in the order their lines arrived, URCs that arrive while a
+// command is in flight are not eaten by it, and a full event ring never
+// drops anything.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+#include "ModemAT.h"
+
+// One recorded chunk of modem output and when it arrived, relative to the
+// start of the replay
+struct TranscriptStep {
+  uint32_t atMs;
+  const char *rx;
+};
+
+class ReplayStream : public Stream {
+ public:
+  void feed(const char *bytes) { _rx += bytes; }
+  int available() override { return (int)(_rx.size() - _pos); }
+  int read() override { return _pos < _rx.size() ? (uint8_t)_rx[_pos++] : -1; }
+  int peek() override { return _pos < _rx.size() ? (uint8_t)_rx[_pos] : -1; }
+  size_t write(uint8_t c) override {
+    _tx += (char)c;
+    return 1;
+  }
+  using Print::write;
+
+  const std::string &tx() const { return _tx; }
+
+ private:
+  std::string _rx;
+  size_t _pos = 0;
+  std::string _tx;
+};
+
+static ReplayStream *uart;
+static ModemAT *at;
+static std::vector<std::string> log_;
+
+static void logLine(const char *tag, const String &line) {
+  log_.push_back(std::string(tag) + line.c_str());
+}
+
+static void onUrcLine(const String &line) { logLine("urc:", line); }
+static void onOther(const String &line) { logLine("other:", line); }
+
+static void onDone(const AtResult &result, void *ctx) {
+  std::string entry = std::string("done:") + (const char *)ctx + ":" +
+                      atStatusName(result.status);
+  if (result.response.length()) {
+    entry += ":";
+    entry += result.response.c_str();
+  }
+  log_.push_back(entry);
+}
+
+static void replay(const TranscriptStep *steps, size_t n, uint32_t tailMs) {
+  uint32_t start = millis();
+  for (size_t i = 0; i < n; i++) {
+    while (millis() - start < steps[i].atMs) {
+      at->dispatch();
+      nativeAdvanceMs(1);
+    }
+    uart->feed(steps[i].rx);
+  }
+  for (uint32_t t = 0; t <= tailMs; t++) {
+    at->dispatch();
+    nativeAdvanceMs(1);
+  }
+}
+
+void setUp() {
+  nativeSetMs(5000);
+  uart = new ReplayStream();
+  at = new ModemAT();
+  at->begin(*uart);
+  // Same table as the firmware
+  static const char *const prefixes[] = {
+    "NO CARRIER", "BUSY", "NO ANSWER", "VOICE CALL: END", "CALL END",
+    "+CLCC:", "VOICE CALL: BEGIN", "RING", "+CLIP:", "+CMTI:", "+CTZV:",
+    "+CREG:", "+CGREG:", "+CEREG:", "+CSQ:"
+  };
+  for (const char *prefix : prefixes) at->onUrc(prefix, onUrcLine);
+  at->setUrcHandler(onOther);
+  log_.clear();
+}
+
+void tearDown() {
+  delete at;
+  delete uart;
+}
+
+static void expectLog(const std::vector<std::string> &expected) {
+  TEST_ASSERT_EQUAL(expected.size(), log_.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), log_[i].c_str());
+  }
+}
+
+// Incoming call and SMS notification while the firmware polls signal
+// and registration
+static void test_urcs_during_commands_keep_arrival_order() {
+  static const TranscriptStep steps[] = {
+    {10, "AT+CSQ\r\n"},
+    {12, "\r\nRING\r\n"},
+    {14, "\r\n+CLIP: \"+4917\",145,,,,0\r\n"},
+    {20, "\r\n+CSQ: 20,99\r\n\r\nOK\r\n"},
+    {40, "AT+CREG?\r\n\r\n+CREG: 0,5\r\n"},
+    {41, "\r\n+CMTI: \"SM\",3\r\n"},
+    {45, "\r\nOK\r\n"},
+    {80, "\r\nNO CARRIER\r\n"},
+  };
+  at->enqueue("AT+CSQ", 1000, onDone, (void *)"csq");
+  at->enqueue("AT+CREG?", 1000, onDone, (void *)"creg");
+  replay(steps, sizeof(steps) / sizeof(steps[0]), 10);
+
+  expectLog({
+    "urc:RING",
+    "urc:+CLIP: \"+4917\",145,,,,0",
+    "done:csq:OK:+CSQ: 20,99",
+    "urc:+CMTI: \"SM\",3",
+    "done:creg:OK:+CREG: 0,5",
+    "urc:NO CARRIER",
+  });
+  TEST_ASSERT_EQUAL_STRING("AT+CSQ\r\nAT+CREG?\r\n", uart->tx().c_str());
+}
+
+// +CLCC is solicited by AT+CLCC but a URC otherwise (AT+CLCC=1 reporting)
+static void test_solicited_prefix_only_while_its_command_runs() {
+  static const TranscriptStep steps[] = {
+    {5, "\r\n+CLCC: 1,0,2,0,0,\"+4917\",145\r\n"},
+    {30, "AT+CLCC\r\n\r\n+CLCC: 1,0,3,0,0,\"+4917\",145\r\n\r\nOK\r\n"},
+    {60, "\r\n+CLCC: 1,0,0,0,0,\"+4917\",145\r\n"},
+    {90, "\r\nVOICE CALL: BEGIN\r\n"},
+  };
+  // AT+CLCC is only queued after the first report went out as a URC
+  replay(steps, 1, 5);
+  at->enqueue("AT+CLCC", 1000, onDone, (void *)"clcc");
+  replay(steps + 1, 3, 10);
+
+  expectLog({
+    "urc:+CLCC: 1,0,2,0,0,\"+4917\",145",
+    "done:clcc:OK:+CLCC: 1,0,3,0,0,\"+4917\",145",
+    "urc:+CLCC: 1,0,0,0,0,\"+4917\",145",
+    "urc:VOICE CALL: BEGIN",
+  });
+}
+
+// Lines with no table entry and no command in flight reach the fallback
+static void test_unknown_idle_lines_go_to_fallback() {
+  static const TranscriptStep steps[] = {
+    {1, "\r\n*ATREADY: 1\r\n"},
+    {2, "\r\nSMS DONE\r\n"},
+    {3, "\r\nRING\r\n"},
+  };
+  replay(steps, 3, 2);
+  expectLog({"other:*ATREADY: 1", "other:SMS DONE", "urc:RING"});
+}
+
+// A URC storm larger than the event ring with nobody dispatching: poll()
+// must deliver inline rather than drop
+static void test_full_event_ring_drops_nothing() {
+  std::string burst;
+  const int N = AT_EVENT_QUEUE * 3;
+  for (int i = 0; i < N; i++) {
+    burst += "\r\n+CMTI: \"SM\",";
+    burst += std::to_string(i);
+    burst += "\r\n";
+  }
+  uart->feed(burst.c_str());
+  at->poll();
+  at->dispatch();
+
+  TEST_ASSERT_EQUAL(N, (int)log_.size());
+  for (int i = 0; i < N; i++) {
+    std::string expected = "urc:+CMTI: \"SM\"," + std::to_string(i);
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), log_[i].c_str());
+  }
+  TEST_ASSERT_EQUAL(N, (int)at->urcCount());
+}
+
+// Bytes arriving one at a time across polls, as at 115200 baud with a
+// 1 ms poll period
+static void test_lines_split_across_polls() {
+  const char *chunk = "\r\n+CLIP: \"+4917\",145,,,,0\r\n";
+  for (const char *p = chunk; *p; p++) {
+    char one[2] = {*p, 0};
+    uart->feed(one);
+    at->dispatch();
+    nativeAdvanceMs(1);
+  }
+  expectLog({"urc:+CLIP: \"+4917\",145,,,,0"});
+}
+
+static void test_bench_replay_throughput() {
+  std::string burst;
+  for (int i = 0; i < 2000; i++) {
+    burst += "\r\nRING\r\n\r\n+CLIP: \"+4917\",145,,,,0\r\n";
+  }
+  uart->feed(burst.c_str());
+
+  uint64_t t0 = nativeWallNs();
+  at->dispatch();
+  uint64_t ns = nativeWallNs() - t0;
+
+  TEST_ASSERT_EQUAL(4000, (int)log_.size());
+  char msg[80];
+  snprintf(msg, sizeof(msg), "URC routing: %.2f us/line, %.1f ns/byte",
+           ns / 4000.0 / 1000.0, (double)ns / burst.size());
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_urcs_during_commands_keep_arrival_order);
+  RUN_TEST(test_solicited_prefix_only_while_its_command_runs);
+  RUN_TEST(test_unknown_idle_lines_go_to_fallback);
+  RUN_TEST(test_full_event_ring_drops_nothing);
+  RUN_TEST(test_lines_split_across_polls);
+  RUN_TEST(test_bench_replay_throughput);
+  return UNITY_END();
+}
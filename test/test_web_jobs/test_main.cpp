@@ -0,0 +1,287 @@
+// WebJobs next to a running AlertEscalation, wired the way main.cpp does
+// it: loop() ticks the ladder and starts queued jobs every LOOP_MS, the
+// web task polls every WEB_POLL_MS and a page submits test SMS / test
+// call jobs and polls /job until they finish. Both sides run in one
+// thread on the virtual clock. Every job has to finish and none may wait
+// longer than one loop() pass to start; each request's handling time is
+// reported split by whether the escalation was running, like the
+// timedRequest() figures on the device.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "AlertEscalation.h"
+#include "WebJobs.h"
+
+// Same values as the firmware
+static const EscalationConfig config = {
+  3,        // maxAttempts
+  3000,     // retryDelay
+  10000,    // setupTimeout
+  45000,    // callTimeout
+  5000,     // answerHold
+  300000    // cooldown
+};
+#define WEB_POLL_MS 2
+
+#define LOOP_MS         10      // One loop() pass with sensors and display
+#define CONTACTS        3
+#define SMS_SEND_MS     4000    // Outbox submit -> OK
+#define PAGE_POLL_MS    250     // The page's /job poll interval
+#define PAGE_SUBMIT_MS  7000    // A click on "test SMS" / "test call"
+
+static AlertEscalation *escalation;
+static WebJobs *jobs;
+static SemaphoreHandle_t escalationMutex;
+
+static int dials;
+
+static bool onDial(uint8_t, uint8_t) {
+  dials++;
+  return true;
+}
+static void onHangup() {}
+
+static bool escalating() {
+  xSemaphoreTake(escalationMutex, portMAX_DELAY);
+  bool busy = escalation->state() != ESC_IDLE;
+  xSemaphoreGive(escalationMutex);
+  return busy;
+}
+
+// ---- loop() side ----
+
+struct RunningSms {
+  uint16_t id;
+  unsigned long doneAt;
+};
+static std::vector<RunningSms> smsInFlight;
+
+// startTestSMS() / startTestCall() with the outbox and the modem
+// replaced by a fixed send time and an always accepted ATD
+static void runWebJobs(unsigned long now) {
+  WebJob job;
+  while (jobs->next(job)) {
+    if (job.kind == JOB_TEST_SMS) {
+      smsInFlight.push_back(RunningSms{job.id, now + SMS_SEND_MS});
+    } else if (escalating()) {
+      jobs->finish(job.id, false, "Alert in progress");
+    } else {
+      jobs->finish(job.id, true, "Dialing");
+    }
+  }
+  for (size_t i = 0; i < smsInFlight.size();) {
+    if ((long)(now - smsInFlight[i].doneAt) >= 0) {
+      jobs->finish(smsInFlight[i].id, true, "Sent");
+      smsInFlight.erase(smsInFlight.begin() + i);
+    } else {
+      i++;
+    }
+  }
+}
+
+// Nobody answers: every dial rings and times out
+static void loopPass(unsigned long now) {
+  xSemaphoreTake(escalationMutex, portMAX_DELAY);
+  EscalationState before = escalation->state();
+  escalation->tick(now);
+  if (before == ESC_DIALING && now - escalation->stateSince() >= 2000) {
+    escalation->onCallEvent(CALL_EVT_RINGING, now);
+  }
+  xSemaphoreGive(escalationMutex);
+  runWebJobs(now);
+}
+
+// ---- Web task side ----
+
+static char response[160];
+
+// handleTestSMS() / handleTestCall(): 202 with the job id
+static uint16_t handleSubmit(WebJobKind kind) {
+  uint16_t id = jobs->submit(kind);
+  if (id) snprintf(response, sizeof(response), "{\"job\":%u}", id);
+  else snprintf(response, sizeof(response), "{\"error\":\"busy\"}");
+  return id;
+}
+
+// handleJob()
+static bool handleJob(uint16_t id, WebJob &job) {
+  if (!jobs->get(id, job)) {
+    snprintf(response, sizeof(response), "{\"error\":\"unknown job\"}");
+    return false;
+  }
+  unsigned long now = millis();
+  unsigned long started = job.startedAt ? job.startedAt : now;
+  unsigned long finished = job.finishedAt ? job.finishedAt : now;
+  snprintf(response, sizeof(response),
+    "{\"job\":%u,\"state\":\"%s\",\"text\":\"%s\",\"waitMs\":%lu,\"runMs\":%lu}",
+    job.id, webJobStateName(job.state), job.text,
+    started - job.queuedAt, job.startedAt ? finished - started : 0UL);
+  return true;
+}
+
+struct Timings {
+  std::vector<uint32_t> ns[2];    // [escalating]
+
+  void add(bool alert, uint64_t t) { ns[alert].push_back((uint32_t)t); }
+};
+
+// timedRequest(): handler, then the escalation state for the split
+template <typename F>
+static void timed(Timings &t, F handler) {
+  uint64_t start = nativeWallNs();
+  handler();
+  uint64_t ns = nativeWallNs() - start;
+  t.add(escalating(), ns);
+}
+
+static uint32_t percentile(std::vector<uint32_t> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(size_t)(p * (v.size() - 1))];
+}
+
+static void report(const char *name, const Timings &t) {
+  static const char *const when[2] = {"idle", "during escalation"};
+  for (int a = 0; a < 2; a++) {
+    char msg[144];
+    snprintf(msg, sizeof(msg),
+             "%s %s: %u requests, p50 %.2f us, p99 %.2f us, max %.2f us",
+             name, when[a], (unsigned)t.ns[a].size(),
+             percentile(t.ns[a], 0.5) / 1000.0,
+             percentile(t.ns[a], 0.99) / 1000.0,
+             percentile(t.ns[a], 1.0) / 1000.0);
+    TEST_MESSAGE(msg);
+  }
+}
+
+void setUp() {
+  nativeSetMs(1000);
+  escalationMutex = xSemaphoreCreateMutex();
+  escalation = new AlertEscalation();
+  EscalationActions actions = {onDial, onHangup, nullptr};
+  escalation->begin(config, actions);
+  jobs = new WebJobs();
+  smsInFlight.clear();
+  dials = 0;
+}
+
+void tearDown() {
+  delete jobs;
+  delete escalation;
+  vSemaphoreDelete(escalationMutex);
+}
+
+// An alert rings through all three contacts for ten minutes, then clears;
+// the page keeps clicking both test buttons throughout and after
+static void test_jobs_during_escalation() {
+  const unsigned long alertFrom = 60000;
+  const unsigned long alertTo = alertFrom + 10 * 60000UL;
+  const unsigned long end = alertTo + 5 * 60000UL;
+
+  Timings submits, polls;
+  uint16_t watching = 0;
+  unsigned long nextSubmit = millis();
+  unsigned long nextPoll = 0;
+  int submitted = 0, finished = 0, refused = 0, smsDone = 0;
+  uint32_t maxWaitMs = 0;
+
+  for (unsigned long now = millis(); now < end; now = millis()) {
+    if (now % LOOP_MS == 0) {
+      if (now == alertFrom || now == alertTo) {
+        xSemaphoreTake(escalationMutex, portMAX_DELAY);
+        escalation->setAlert(now == alertFrom, CONTACTS, now);
+        xSemaphoreGive(escalationMutex);
+      }
+      loopPass(now);
+    }
+
+    if (now % WEB_POLL_MS == 0) {
+      if (!watching && (long)(now - nextSubmit) >= 0) {
+        WebJobKind kind = submitted % 2 ? JOB_TEST_CALL : JOB_TEST_SMS;
+        timed(submits, [&] { watching = handleSubmit(kind); });
+        TEST_ASSERT_NOT_EQUAL(0, watching);
+        submitted++;
+        nextPoll = now + PAGE_POLL_MS;
+      } else if (watching && (long)(now - nextPoll) >= 0) {
+        WebJob job;
+        bool found = false;
+        timed(polls, [&] { found = handleJob(watching, job); });
+        TEST_ASSERT_TRUE(found);
+        nextPoll = now + PAGE_POLL_MS;
+        if (job.state == JOB_DONE || job.state == JOB_FAILED) {
+          finished++;
+          maxWaitMs = std::max(maxWaitMs,
+                               (uint32_t)(job.startedAt - job.queuedAt));
+          if (job.kind == JOB_TEST_SMS) {
+            TEST_ASSERT_EQUAL(JOB_DONE, job.state);
+            smsDone++;
+          } else if (job.state == JOB_FAILED) {
+            // Refused only while the ladder runs
+            TEST_ASSERT_EQUAL_STRING("Alert in progress", job.text);
+            TEST_ASSERT_TRUE(job.startedAt >= alertFrom &&
+                             job.startedAt < alertTo);
+            refused++;
+          }
+          watching = 0;
+          nextSubmit = now + PAGE_SUBMIT_MS;
+        }
+      }
+    }
+    nativeAdvanceMs(1);
+  }
+
+  TEST_ASSERT_GREATER_OR_EQUAL(CONTACTS * config.maxAttempts, dials);
+  TEST_ASSERT_EQUAL(submitted - (watching ? 1 : 0), finished);
+  TEST_ASSERT_GREATER_THAN(0, refused);
+  TEST_ASSERT_GREATER_THAN(0, smsDone);
+  TEST_ASSERT_LESS_OR_EQUAL(LOOP_MS, maxWaitMs);
+  TEST_ASSERT_GREATER_THAN(0, (int)submits.ns[1].size());
+  TEST_ASSERT_GREATER_THAN(0, (int)polls.ns[1].size());
+
+  WebJobStats s = jobs->stats();
+  TEST_ASSERT_EQUAL(0, (int)s.rejected);
+  TEST_ASSERT_LESS_OR_EQUAL(LOOP_MS, s.maxWaitMs);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg),
+           "%d jobs, %d test calls refused during the alert, %u dials, "
+           "start wait max %lu ms",
+           finished, refused, (unsigned)dials,
+           (unsigned long)maxWaitMs);
+  TEST_MESSAGE(msg);
+  report("submit", submits);
+  report("/job", polls);
+}
+
+// Eight pages clicking at once fill the table; the ninth gets a 503 and
+// finished jobs are reused oldest first
+static void test_full_table() {
+  uint16_t ids[WEB_JOB_SLOTS];
+  for (int i = 0; i < WEB_JOB_SLOTS; i++) {
+    ids[i] = jobs->submit(JOB_TEST_SMS);
+    TEST_ASSERT_NOT_EQUAL(0, ids[i]);
+  }
+  TEST_ASSERT_EQUAL(0, jobs->submit(JOB_TEST_CALL));
+
+  WebJob job;
+  TEST_ASSERT_TRUE(jobs->next(job));
+  TEST_ASSERT_EQUAL(ids[0], job.id);
+  jobs->finish(job.id, true, "Sent");
+  uint16_t reused = jobs->submit(JOB_TEST_CALL);
+  TEST_ASSERT_NOT_EQUAL(0, reused);
+  TEST_ASSERT_FALSE(jobs->get(ids[0], job));
+  TEST_ASSERT_TRUE(jobs->get(reused, job));
+  TEST_ASSERT_EQUAL(JOB_QUEUED, job.state);
+  TEST_ASSERT_EQUAL(1, (int)jobs->stats().rejected);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_jobs_during_escalation);
+  RUN_TEST(test_full_table);
+  return UNITY_END();
+}